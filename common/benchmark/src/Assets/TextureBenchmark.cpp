@@ -0,0 +1,132 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Assets/Palette.h"
+#include "Assets/TextureBuffer.h"
+#include "Color.h"
+#include "IO/Reader.h"
+
+#include <vecmath/vec.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+#include "BenchmarkUtils.h"
+
+namespace TrenchBroom
+{
+namespace Assets
+{
+// roughly the size of the textures in all WAD files shipped with Quake
+static constexpr size_t TextureCount = 2000u;
+static constexpr size_t TextureSize = 128u;
+static constexpr size_t MipLevels = 4u;
+
+static std::vector<char> makeIndices(const size_t count)
+{
+  auto rng = std::mt19937{};
+  auto dist = std::uniform_int_distribution<int>{0, 255};
+
+  auto result = std::vector<char>(count);
+  for (auto& index : result)
+  {
+    index = static_cast<char>(dist(rng));
+  }
+  return result;
+}
+
+static Palette makePalette()
+{
+  const auto data = makeIndices(768);
+  return Palette{std::vector<unsigned char>(data.begin(), data.end())};
+}
+
+TEST_CASE("TextureBenchmark.indexedToRgba", "[TextureBenchmark]")
+{
+  const auto palette = makePalette();
+
+  auto mipSizes = std::vector<size_t>{};
+  for (size_t level = 0u; level < MipLevels; ++level)
+  {
+    const auto mipSize = sizeAtMipLevel(TextureSize, TextureSize, level);
+    mipSizes.push_back(mipSize.x() * mipSize.y());
+  }
+
+  const auto indices = makeIndices(mipSizes.front());
+  auto buffers = TextureBufferList{};
+  setMipBufferSize(buffers, MipLevels, TextureSize, TextureSize, GL_RGBA);
+
+  auto averageColor = Color{};
+  timeLambda(
+    [&]() {
+      for (size_t i = 0u; i < TextureCount; ++i)
+      {
+        for (size_t level = 0u; level < MipLevels; ++level)
+        {
+          auto reader =
+            IO::Reader::from(indices.data(), indices.data() + mipSizes[level]);
+          palette.indexedToRgba(
+            reader,
+            mipSizes[level],
+            buffers[level],
+            PaletteTransparency::Index255Transparent,
+            averageColor);
+        }
+      }
+    },
+    "Convert indexed textures to RGBA");
+
+  CHECK(averageColor.a() == 1.0f);
+}
+
+TEST_CASE("TextureBenchmark.resizeMips", "[TextureBenchmark]")
+{
+  const auto indices = makeIndices(4u * TextureSize * TextureSize);
+
+  auto buffers = TextureBufferList{};
+  setMipBufferSize(buffers, MipLevels, TextureSize, TextureSize, GL_RGBA);
+  for (auto& buffer : buffers)
+  {
+    std::copy_n(indices.begin(), buffer.size(), buffer.data());
+  }
+
+  const auto oldSize = vm::vec2s{TextureSize, TextureSize};
+  const auto newSize = vm::vec2s{TextureSize / 2u, TextureSize / 2u};
+
+  timeLambda(
+    [&]() {
+      for (size_t i = 0u; i < TextureCount / 10u; ++i)
+      {
+        auto resized = TextureBufferList{};
+        setMipBufferSize(resized, MipLevels, TextureSize, TextureSize, GL_RGBA);
+        for (size_t level = 0u; level < MipLevels; ++level)
+        {
+          std::copy_n(
+            buffers[level].data(), buffers[level].size(), resized[level].data());
+        }
+
+        resizeMips(resized, oldSize, newSize, GL_RGBA);
+      }
+    },
+    "Resize mipmapped textures");
+}
+} // namespace Assets
+} // namespace TrenchBroom
@@ -0,0 +1,164 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IO/File.h"
+#include "IO/ImageFileSystem.h"
+#include "IO/Path.h"
+
+#include <kdl/string_compare.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+#include "BenchmarkUtils.h"
+
+namespace TrenchBroom
+{
+namespace IO
+{
+// roughly the number of entries in a large pk3 file
+static constexpr size_t EntryCount = 50000u;
+
+static std::vector<Path> makePaths()
+{
+  static const auto roots =
+    std::vector<std::string>{"textures", "Models", "sound", "env"};
+
+  auto result = std::vector<Path>{};
+  result.reserve(EntryCount);
+  for (size_t i = 0u; i < EntryCount; ++i)
+  {
+    const auto& root = roots[i % roots.size()];
+    const auto dir = "Set_" + std::to_string(i % 97u);
+    const auto subDir = "sub" + std::to_string(i % 7u);
+    const auto name = "Entry_" + std::to_string(i) + ".tga";
+    result.push_back(Path(root + "/" + dir + "/" + subDir + "/" + name));
+  }
+  return result;
+}
+
+namespace
+{
+class BenchmarkFileSystem : public ImageFileSystemBase
+{
+private:
+  std::vector<Path> m_paths;
+  std::shared_ptr<File> m_file;
+
+public:
+  explicit BenchmarkFileSystem(std::vector<Path> paths)
+    : ImageFileSystemBase(nullptr, Path("/benchmark.pk3"))
+    , m_paths(std::move(paths))
+    , m_file(std::make_shared<NonOwningBufferFile>(Path("file"), nullptr, nullptr))
+  {
+    initialize();
+  }
+
+private:
+  void doReadDirectory() override
+  {
+    for (const auto& path : m_paths)
+    {
+      m_root.addFile(path, m_file);
+    }
+  }
+};
+} // namespace
+
+TEST_CASE("PathBenchmark.paths", "[PathBenchmark]")
+{
+  const auto strings = Path::asStrings(makePaths(), "/");
+
+  auto paths = std::vector<Path>{};
+  timeLambda([&]() { paths = Path::asPaths(strings); }, "Create paths");
+
+  auto copies = std::vector<Path>{};
+  timeLambda([&]() { copies = paths; }, "Copy paths");
+
+  auto concatenated = std::vector<Path>{};
+  concatenated.reserve(paths.size());
+  timeLambda(
+    [&]() {
+      const auto root = Path("/home/user/quake3/baseq3");
+      for (const auto& path : paths)
+      {
+        concatenated.push_back(root + path);
+      }
+    },
+    "Concatenate paths");
+
+  auto sortedPaths = std::map<Path, size_t, Path::Less<kdl::ci::string_less>>{};
+  timeLambda(
+    [&]() {
+      for (size_t i = 0u; i < paths.size(); ++i)
+      {
+        sortedPaths.emplace(paths[i], i);
+      }
+    },
+    "Insert paths into map");
+
+  size_t found = 0u;
+  timeLambda(
+    [&]() {
+      for (const auto& path : paths)
+      {
+        found += sortedPaths.count(path.makeLowerCase());
+      }
+    },
+    "Find paths in map");
+  CHECK(found == paths.size());
+}
+
+TEST_CASE("PathBenchmark.imageFileSystem", "[PathBenchmark]")
+{
+  const auto paths = makePaths();
+
+  auto fs = std::unique_ptr<BenchmarkFileSystem>{};
+  timeLambda(
+    [&]() { fs = std::make_unique<BenchmarkFileSystem>(paths); }, "Mount file system");
+
+  size_t found = 0u;
+  timeLambda(
+    [&]() {
+      for (const auto& path : paths)
+      {
+        if (fs->fileExists(path))
+        {
+          ++found;
+        }
+        if (fs->fileExists(path.replaceExtension("jpg")))
+        {
+          ++found;
+        }
+      }
+    },
+    "Look up files");
+  CHECK(found == paths.size());
+
+  size_t count = 0u;
+  timeLambda(
+    [&]() { count = fs->findItemsRecursively(Path("textures")).size(); },
+    "Find items recursively");
+  CHECK(count > paths.size() / 4u);
+}
+} // namespace IO
+} // namespace TrenchBroom
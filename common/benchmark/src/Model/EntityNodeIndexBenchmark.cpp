@@ -0,0 +1,147 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Model/Entity.h"
+#include "Model/EntityNode.h"
+#include "Model/EntityNodeIndex.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+#include "BenchmarkUtils.h"
+
+namespace TrenchBroom
+{
+namespace Model
+{
+static constexpr size_t EntityCount = 30000u;
+static constexpr size_t QueryCount = 1000u;
+
+static std::vector<std::unique_ptr<EntityNode>> makeEntityNodes()
+{
+  auto result = std::vector<std::unique_ptr<EntityNode>>{};
+  result.reserve(EntityCount);
+
+  for (size_t i = 0u; i < EntityCount; ++i)
+  {
+    const auto id = std::to_string(i);
+    result.push_back(std::make_unique<EntityNode>(Entity{
+      {},
+      {
+        {"classname", i % 4u == 0u ? "light" : "func_door"},
+        {"targetname", "t" + id},
+        {"target" + std::to_string(i % 4u), "t" + std::to_string((i + 1u) % EntityCount)},
+        {"light", "300"},
+        {"origin", id + " " + id + " 0"},
+      }}));
+  }
+
+  return result;
+}
+
+TEST_CASE("EntityNodeIndexBenchmark.addRemoveEntityNodes", "[EntityNodeIndexBenchmark]")
+{
+  const auto nodes = makeEntityNodes();
+
+  EntityNodeIndex index;
+  timeLambda(
+    [&]() {
+      for (const auto& node : nodes)
+      {
+        index.addEntityNode(node.get());
+      }
+    },
+    "Add entity nodes to index");
+
+  timeLambda(
+    [&]() {
+      for (const auto& node : nodes)
+      {
+        index.removeEntityNode(node.get());
+      }
+    },
+    "Remove entity nodes from index");
+
+  CHECK(index.allKeys().empty());
+}
+
+TEST_CASE("EntityNodeIndexBenchmark.queries", "[EntityNodeIndexBenchmark]")
+{
+  const auto nodes = makeEntityNodes();
+
+  EntityNodeIndex index;
+  for (const auto& node : nodes)
+  {
+    index.addEntityNode(node.get());
+  }
+
+  size_t resultCount = 0u;
+  timeLambda(
+    [&]() {
+      for (size_t i = 0u; i < QueryCount; ++i)
+      {
+        resultCount += index
+                         .findEntityNodes(
+                           EntityNodeIndexQuery::exact("targetname"), "t" + std::to_string(i))
+                         .size();
+      }
+    },
+    "Exact key queries");
+  CHECK(resultCount == QueryCount);
+
+  resultCount = 0u;
+  timeLambda(
+    [&]() {
+      for (size_t i = 0u; i < QueryCount; ++i)
+      {
+        resultCount += index
+                         .findEntityNodes(
+                           EntityNodeIndexQuery::numbered("target"), "t" + std::to_string(i))
+                         .size();
+      }
+    },
+    "Numbered key queries");
+  CHECK(resultCount == QueryCount);
+
+  resultCount = 0u;
+  timeLambda(
+    [&]() {
+      for (size_t i = 0u; i < 10u; ++i)
+      {
+        resultCount += index.allValuesForKeys(EntityNodeIndexQuery::prefix("target")).size();
+      }
+    },
+    "Prefix key queries");
+  CHECK(resultCount == 10u * 2u * EntityCount);
+
+  resultCount = 0u;
+  timeLambda(
+    [&]() {
+      for (size_t i = 0u; i < 10u; ++i)
+      {
+        resultCount += index.allValuesForKeys(EntityNodeIndexQuery::numbered("target")).size();
+      }
+    },
+    "Numbered key value queries");
+  CHECK(resultCount == 10u * EntityCount);
+}
+} // namespace Model
+} // namespace TrenchBroom
@@ -19,8 +19,8 @@
 
 #include "EntityModel.h"
 
-#include "AABBTree.h"
 #include "Assets/TextureCollection.h"
+#include "Exceptions.h"
 #include "Renderer/IndexRangeMap.h"
 #include "Renderer/PrimType.h"
 #include "Renderer/TexturedIndexRangeMap.h"
@@ -32,6 +32,9 @@
 
 #include <kdl/vector_utils.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <string>
 
 namespace TrenchBroom
@@ -63,6 +66,174 @@ void EntityModelFrame::setSkinOffset(const size_t skinOffset)
   m_skinOffset = skinOffset;
 }
 
+// EntityModel::LoadedFrame::SpacialTree
+
+/**
+ * A bounding volume hierarchy over the triangles of a frame. The nodes are stored in a
+ * single array in depth first order, so the left child of an inner node immediately
+ * follows its parent. Leaves refer to a range of triangle numbers.
+ */
+class EntityModelLoadedFrame::SpacialTree
+{
+private:
+  static constexpr size_t MaxLeafSize = 4u;
+
+  struct Node
+  {
+    vm::bbox3f bounds;
+    // the index of the right child for inner nodes, the first triangle for leaves
+    uint32_t index;
+    // the number of triangles, 0 for inner nodes
+    uint32_t count;
+  };
+
+  const std::vector<vm::vec3f>& m_tris;
+  std::vector<Node> m_nodes;
+  std::vector<uint32_t> m_triNums;
+
+public:
+  explicit SpacialTree(const std::vector<vm::vec3f>& tris)
+    : m_tris{tris}
+  {
+    const auto triCount = m_tris.size() / 3u;
+    if (triCount == 0u)
+    {
+      return;
+    }
+
+    auto centers = std::vector<vm::vec3f>{};
+    centers.reserve(triCount);
+    m_triNums.reserve(triCount);
+    for (size_t i = 0u; i < triCount; ++i)
+    {
+      centers.push_back((m_tris[3u * i] + m_tris[3u * i + 1u] + m_tris[3u * i + 2u]) / 3.0f);
+      m_triNums.push_back(static_cast<uint32_t>(i));
+    }
+
+    m_nodes.reserve(2u * triCount / MaxLeafSize + 1u);
+    build(centers, 0u, triCount);
+  }
+
+  float intersect(const vm::ray3f& ray) const
+  {
+    auto closestDistance = vm::nan<float>();
+    if (m_nodes.empty())
+    {
+      return closestDistance;
+    }
+
+    const auto invDirection = vm::vec3f{
+      1.0f / ray.direction.x(), 1.0f / ray.direction.y(), 1.0f / ray.direction.z()};
+
+    auto stack = std::vector<size_t>{0u};
+    while (!stack.empty())
+    {
+      const auto nodeIndex = stack.back();
+      const auto& node = m_nodes[nodeIndex];
+      stack.pop_back();
+
+      const auto maxDistance =
+        vm::is_nan(closestDistance) ? std::numeric_limits<float>::max() : closestDistance;
+      if (!intersectBounds(ray, invDirection, node.bounds, maxDistance))
+      {
+        continue;
+      }
+
+      if (node.count == 0u)
+      {
+        stack.push_back(node.index);
+        stack.push_back(nodeIndex + 1u);
+      }
+      else
+      {
+        for (size_t i = node.index; i < node.index + node.count; ++i)
+        {
+          const auto triNum = size_t(m_triNums[i]);
+          closestDistance = vm::safe_min(
+            closestDistance,
+            vm::intersect_ray_triangle(
+              ray,
+              m_tris[3u * triNum],
+              m_tris[3u * triNum + 1u],
+              m_tris[3u * triNum + 2u]));
+        }
+      }
+    }
+
+    return closestDistance;
+  }
+
+private:
+  size_t build(const std::vector<vm::vec3f>& centers, const size_t first, const size_t last)
+  {
+    auto bounds = vm::bbox3f::builder{};
+    auto centerBounds = vm::bbox3f::builder{};
+    for (size_t i = first; i < last; ++i)
+    {
+      const auto triNum = size_t(m_triNums[i]);
+      bounds.add(m_tris[3u * triNum]);
+      bounds.add(m_tris[3u * triNum + 1u]);
+      bounds.add(m_tris[3u * triNum + 2u]);
+      centerBounds.add(centers[triNum]);
+    }
+
+    const auto nodeIndex = m_nodes.size();
+    m_nodes.push_back(Node{bounds.bounds(), uint32_t(first), uint32_t(last - first)});
+
+    const auto size = centerBounds.bounds().size();
+    const auto axis = vm::find_max_component(size);
+    if (last - first <= MaxLeafSize || size[axis] == 0.0f)
+    {
+      return nodeIndex;
+    }
+
+    const auto mid = first + (last - first) / 2u;
+    std::nth_element(
+      m_triNums.data() + first,
+      m_triNums.data() + mid,
+      m_triNums.data() + last,
+      [&](const auto lhs, const auto rhs) { return centers[lhs][axis] < centers[rhs][axis]; });
+
+    build(centers, first, mid);
+    const auto rightIndex = build(centers, mid, last);
+
+    m_nodes[nodeIndex].index = uint32_t(rightIndex);
+    m_nodes[nodeIndex].count = 0u;
+    return nodeIndex;
+  }
+
+  static bool intersectBounds(
+    const vm::ray3f& ray,
+    const vm::vec3f& invDirection,
+    const vm::bbox3f& bounds,
+    const float maxDistance)
+  {
+    auto tMin = 0.0f;
+    auto tMax = maxDistance;
+    for (size_t i = 0u; i < 3u; ++i)
+    {
+      if (ray.direction[i] == 0.0f)
+      {
+        if (ray.origin[i] < bounds.min[i] || ray.origin[i] > bounds.max[i])
+        {
+          return false;
+        }
+        continue;
+      }
+
+      const auto t1 = (bounds.min[i] - ray.origin[i]) * invDirection[i];
+      const auto t2 = (bounds.max[i] - ray.origin[i]) * invDirection[i];
+      tMin = std::max(tMin, std::min(t1, t2));
+      tMax = std::min(tMax, std::max(t1, t2));
+      if (tMin > tMax)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
 // EntityModel::LoadedFrame
 
 EntityModelLoadedFrame::EntityModelLoadedFrame(
@@ -76,7 +247,6 @@ EntityModelLoadedFrame::EntityModelLoadedFrame(
   , m_bounds{bounds}
   , m_pitchType{pitchType}
   , m_orientation{orientation}
-  , m_spacialTree{std::make_unique<SpacialTree>()}
 {
 }
 
@@ -109,19 +279,15 @@ Orientation EntityModelLoadedFrame::orientation() const
 
 float EntityModelLoadedFrame::intersect(const vm::ray3f& ray) const
 {
-  auto closestDistance = vm::nan<float>();
-
-  const auto candidates = m_spacialTree->findIntersectors(ray);
-  for (const TriNum triNum : candidates)
-  {
-    const vm::vec3f& p1 = m_tris[triNum * 3 + 0];
-    const vm::vec3f& p2 = m_tris[triNum * 3 + 1];
-    const vm::vec3f& p3 = m_tris[triNum * 3 + 2];
-    closestDistance =
-      vm::safe_min(closestDistance, vm::intersect_ray_triangle(ray, p1, p2, p3));
-  }
+  buildSpacialTree();
+  return m_spacialTree->intersect(ray);
+}
 
-  return closestDistance;
+void EntityModelLoadedFrame::buildSpacialTree() const
+{
+  std::call_once(m_spacialTreeBuilt, [&]() {
+    m_spacialTree = std::make_unique<SpacialTree>(m_tris);
+  });
 }
 
 void EntityModelLoadedFrame::addToSpacialTree(
@@ -130,6 +296,8 @@ void EntityModelLoadedFrame::addToSpacialTree(
   const size_t index,
   const size_t count)
 {
+  assert(!m_spacialTree);
+
   switch (primType)
   {
   case Renderer::PrimType::Points:
@@ -142,19 +310,12 @@ void EntityModelLoadedFrame::addToSpacialTree(
     m_tris.reserve(m_tris.size() + count);
     for (size_t i = 0; i < count; i += 3)
     {
-      auto bounds = vm::bbox3f::builder{};
       const auto& p1 = Renderer::getVertexComponent<0>(vertices[index + i + 0]);
       const auto& p2 = Renderer::getVertexComponent<0>(vertices[index + i + 1]);
       const auto& p3 = Renderer::getVertexComponent<0>(vertices[index + i + 2]);
-      bounds.add(p1);
-      bounds.add(p2);
-      bounds.add(p3);
-
-      const size_t triIndex = m_tris.size() / 3u;
       m_tris.push_back(p1);
       m_tris.push_back(p2);
       m_tris.push_back(p3);
-      m_spacialTree->insert(bounds.bounds(), triIndex);
     }
     break;
   }
@@ -166,18 +327,11 @@ void EntityModelLoadedFrame::addToSpacialTree(
     const auto& p1 = Renderer::getVertexComponent<0>(vertices[index]);
     for (size_t i = 1; i < count - 1; ++i)
     {
-      auto bounds = vm::bbox3f::builder{};
       const auto& p2 = Renderer::getVertexComponent<0>(vertices[index + i]);
       const auto& p3 = Renderer::getVertexComponent<0>(vertices[index + i + 1]);
-      bounds.add(p1);
-      bounds.add(p2);
-      bounds.add(p3);
-
-      const size_t triIndex = m_tris.size() / 3u;
       m_tris.push_back(p1);
       m_tris.push_back(p2);
       m_tris.push_back(p3);
-      m_spacialTree->insert(bounds.bounds(), triIndex);
     }
     break;
   }
@@ -188,15 +342,9 @@ void EntityModelLoadedFrame::addToSpacialTree(
     m_tris.reserve(m_tris.size() + (count - 2) * 3);
     for (size_t i = 0; i < count - 2; ++i)
     {
-      auto bounds = vm::bbox3f::builder{};
       const auto& p1 = Renderer::getVertexComponent<0>(vertices[index + i + 0]);
       const auto& p2 = Renderer::getVertexComponent<0>(vertices[index + i + 1]);
       const auto& p3 = Renderer::getVertexComponent<0>(vertices[index + i + 2]);
-      bounds.add(p1);
-      bounds.add(p2);
-      bounds.add(p3);
-
-      const size_t triIndex = m_tris.size() / 3u;
       if (i % 2 == 0)
       {
         m_tris.push_back(p1);
@@ -209,7 +357,6 @@ void EntityModelLoadedFrame::addToSpacialTree(
         m_tris.push_back(p3);
         m_tris.push_back(p2);
       }
-      m_spacialTree->insert(bounds.bounds(), triIndex);
     }
     break;
   }
@@ -279,6 +426,13 @@ protected:
 public:
   virtual ~EntityModelMesh() = default;
 
+  virtual void visit(
+    const std::function<
+      void(const std::vector<EntityModelVertex>&, const EntityModelIndices&)>& indexedMesh,
+    const std::function<void(
+      const std::vector<EntityModelVertex>&, const EntityModelTexturedIndices&)>&
+      texturedMesh) const = 0;
+
 public:
   /**
    * Returns a renderer that renders this mesh with the given texture.
@@ -335,6 +489,16 @@ public:
       });
   }
 
+  void visit(
+    const std::function<
+      void(const std::vector<EntityModelVertex>&, const EntityModelIndices&)>& indexedMesh,
+    const std::function<void(
+      const std::vector<EntityModelVertex>&, const EntityModelTexturedIndices&)>&)
+    const override
+  {
+    indexedMesh(m_vertices, m_indices);
+  }
+
 private:
   std::unique_ptr<Renderer::TexturedIndexRangeRenderer> doBuildRenderer(
     const Texture* skin, const Renderer::VertexArray& vertices) override
@@ -380,6 +544,16 @@ public:
     });
   }
 
+  void visit(
+    const std::function<
+      void(const std::vector<EntityModelVertex>&, const EntityModelIndices&)>&,
+    const std::function<void(
+      const std::vector<EntityModelVertex>&, const EntityModelTexturedIndices&)>&
+      texturedMesh) const override
+  {
+    texturedMesh(m_vertices, m_indices);
+  }
+
 private:
   std::unique_ptr<Renderer::TexturedIndexRangeRenderer> doBuildRenderer(
     const Texture* /* skin */, const Renderer::VertexArray& vertices) override
@@ -459,6 +633,21 @@ const Texture* EntityModelSurface::skin(const size_t index) const
   return m_skins->textureByIndex(index);
 }
 
+void EntityModelSurface::visitMesh(
+  const size_t frameIndex,
+  const std::function<
+    void(const std::vector<EntityModelVertex>&, const EntityModelIndices&)>& indexedMesh,
+  const std::function<
+    void(const std::vector<EntityModelVertex>&, const EntityModelTexturedIndices&)>&
+    texturedMesh) const
+{
+  assert(frameIndex < frameCount());
+  if (m_meshes[frameIndex] != nullptr)
+  {
+    m_meshes[frameIndex]->visit(indexedMesh, texturedMesh);
+  }
+}
+
 std::unique_ptr<Renderer::TexturedIndexRangeRenderer> EntityModelSurface::buildRenderer(
   const size_t skinIndex, const size_t frameIndex)
 {
@@ -487,6 +676,21 @@ EntityModel::EntityModel(
 {
 }
 
+const std::string& EntityModel::name() const
+{
+  return m_name;
+}
+
+PitchType EntityModel::pitchType() const
+{
+  return m_pitchType;
+}
+
+Orientation EntityModel::orientation() const
+{
+  return m_orientation;
+}
+
 std::unique_ptr<Renderer::TexturedRenderer> EntityModel::buildRenderer(
   const size_t skinIndex, const size_t frameIndex) const
 {
@@ -24,15 +24,14 @@
 #include <vecmath/bbox.h>
 #include <vecmath/forward.h>
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 namespace TrenchBroom
 {
-template <typename T, size_t S, typename U>
-class AABBTree;
-
 namespace Renderer
 {
 enum class PrimType;
@@ -162,11 +161,11 @@ private:
   PitchType m_pitchType;
   Orientation m_orientation;
 
-  // For hit testing
+  // For hit testing, the spacial tree is only built when the frame is first intersected
   std::vector<vm::vec3f> m_tris;
-  using TriNum = size_t;
-  using SpacialTree = AABBTree<float, 3, TriNum>;
-  std::unique_ptr<SpacialTree> m_spacialTree;
+  class SpacialTree;
+  mutable std::unique_ptr<SpacialTree> m_spacialTree;
+  mutable std::once_flag m_spacialTreeBuilt;
 
 public:
   /**
@@ -195,7 +194,15 @@ public:
   float intersect(const vm::ray3f& ray) const override;
 
   /**
-   * Adds the given primitives to the spacial tree for this frame.
+   * Builds the spacial tree used for hit testing unless it has been built already. This
+   * is done automatically when the frame is first intersected with a ray, but it can be
+   * called earlier, e.g. from a worker thread. This function is thread safe.
+   */
+  void buildSpacialTree() const;
+
+  /**
+   * Adds the triangles of the given primitives to this frame for hit testing. Must not be
+   * called after the spacial tree has been built.
    *
    * @param vertices the vertices
    * @param primType the primitive type
@@ -326,6 +333,22 @@ public:
    */
   const Texture* skin(size_t index) const;
 
+  /**
+   * Passes the vertices and indices of the mesh for the given frame to the function
+   * matching the type of the mesh. Does nothing if no mesh was added for the given frame.
+   *
+   * @param frameIndex the index of the frame
+   * @param indexedMesh the function to call if the mesh is an indexed mesh
+   * @param texturedMesh the function to call if the mesh is a textured mesh
+   */
+  void visitMesh(
+    size_t frameIndex,
+    const std::function<
+      void(const std::vector<EntityModelVertex>&, const EntityModelIndices&)>& indexedMesh,
+    const std::function<void(
+      const std::vector<EntityModelVertex>&, const EntityModelTexturedIndices&)>&
+      texturedMesh) const;
+
   std::unique_ptr<Renderer::TexturedIndexRangeRenderer> buildRenderer(
     size_t skinIndex, size_t frameIndex);
 };
@@ -356,6 +379,10 @@ public:
    */
   explicit EntityModel(std::string name, PitchType pitchType, Orientation orientation);
 
+  const std::string& name() const;
+  PitchType pitchType() const;
+  Orientation orientation() const;
+
   /**
    * Creates a renderer to render the given frame of the model using the skin with the
    * given index.
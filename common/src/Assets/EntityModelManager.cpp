@@ -28,10 +28,45 @@
 #include "Model/EntityNode.h"
 #include "Renderer/TexturedIndexRangeRenderer.h"
 
+#include <QString>
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+
 namespace TrenchBroom
 {
 namespace Assets
 {
+namespace
+{
+/**
+ * Collects the messages logged on a worker thread so that they can be logged on the main
+ * thread.
+ */
+class BufferingLogger : public Logger
+{
+public:
+  std::vector<std::pair<LogLevel, std::string>> messages;
+
+private:
+  void doLog(const LogLevel level, const std::string& message) override
+  {
+    messages.emplace_back(level, message);
+  }
+
+  void doLog(const LogLevel level, const QString& message) override
+  {
+    messages.emplace_back(level, message.toStdString());
+  }
+};
+
+size_t maxConcurrentModelLoads()
+{
+  return std::max(size_t(std::thread::hardware_concurrency()), size_t(1));
+}
+} // namespace
+
 EntityModelManager::EntityModelManager(
   const int magFilter, const int minFilter, Logger& logger)
   : m_logger(logger)
@@ -49,10 +84,16 @@ EntityModelManager::~EntityModelManager()
 
 void EntityModelManager::clear()
 {
+  // waits for the models that are being loaded
+  m_modelLoads.clear();
+
   m_renderers.clear();
   m_models.clear();
   m_rendererMismatches.clear();
   m_modelMismatches.clear();
+  m_frameMismatches.clear();
+  m_pendingQueue.clear();
+  m_pendingSpecs.clear();
 
   m_unpreparedModels.clear();
   m_unpreparedRenderers.clear();
@@ -76,21 +117,30 @@ void EntityModelManager::setLoader(const IO::EntityModelLoader* loader)
 Renderer::TexturedRenderer* EntityModelManager::renderer(
   const Assets::ModelSpecification& spec) const
 {
-  auto* entityModel = safeGetModel(spec.path);
+  auto it = m_renderers.find(spec);
+  if (it != std::end(m_renderers))
+  {
+    return it->second.get();
+  }
 
-  if (entityModel == nullptr)
+  if (m_rendererMismatches.count(spec) > 0)
   {
     return nullptr;
   }
 
-  auto it = m_renderers.find(spec);
-  if (it != std::end(m_renderers))
+  auto* entityModel = loadedModel(spec.path);
+  if (entityModel == nullptr)
   {
-    return it->second.get();
+    enqueue(spec);
+    return nullptr;
   }
 
-  if (m_rendererMismatches.count(spec) > 0)
+  if (
+    spec.frameIndex < entityModel->frameCount()
+    && !entityModel->frame(spec.frameIndex)->loaded())
   {
+    // the renderer cannot be built until the frame's mesh is available
+    enqueue(spec);
     return nullptr;
   }
 
@@ -118,9 +168,10 @@ Renderer::TexturedRenderer* EntityModelManager::renderer(
 const EntityModelFrame* EntityModelManager::frame(
   const Assets::ModelSpecification& spec) const
 {
-  auto* model = this->safeGetModel(spec.path);
+  auto* model = loadedModel(spec.path);
   if (model == nullptr)
   {
+    enqueue(spec);
     return nullptr;
   }
   else if (spec.frameIndex >= model->frameCount())
@@ -128,12 +179,245 @@ const EntityModelFrame* EntityModelManager::frame(
     return nullptr;
   }
   else
+  {
+    const auto* frame = model->frame(spec.frameIndex);
+    if (!frame->loaded())
+    {
+      enqueue(spec);
+      return nullptr;
+    }
+    return frame;
+  }
+}
+
+bool EntityModelManager::hasPendingModels() const
+{
+  return !m_pendingSpecs.empty();
+}
+
+bool EntityModelManager::isPending(const ModelSpecification& spec) const
+{
+  return m_pendingSpecs.count(spec) > 0;
+}
+
+std::vector<ModelSpecification> EntityModelManager::loadPendingModels(
+  const std::chrono::milliseconds timeBudget)
+{
+  const auto startTime = std::chrono::steady_clock::now();
+
+  auto result = finishModelLoads();
+  auto loadedFrame = false;
+
+  while (!m_pendingQueue.empty())
+  {
+    auto spec = std::move(m_pendingQueue.front());
+    m_pendingQueue.pop_front();
+
+    if (auto it = m_modelLoads.find(spec.path); it != std::end(m_modelLoads))
+    {
+      // the frame is loaded once the model has been loaded
+      it->second.specs.push_back(std::move(spec));
+    }
+    else if (loadedModel(spec.path) != nullptr || m_modelMismatches.count(spec.path) > 0)
+    {
+      if (loadedFrame && std::chrono::steady_clock::now() - startTime >= timeBudget)
+      {
+        m_pendingQueue.push_front(std::move(spec));
+        break;
+      }
+
+      loadPendingModel(spec);
+      loadedFrame = true;
+
+      m_pendingSpecs.erase(spec);
+      result.push_back(std::move(spec));
+    }
+    else if (m_modelLoads.size() < maxConcurrentModelLoads())
+    {
+      m_pendingQueue.push_front(std::move(spec));
+      startModelLoad(m_pendingQueue.front().path);
+    }
+    else
+    {
+      m_pendingQueue.push_front(std::move(spec));
+      break;
+    }
+  }
+
+  return result;
+}
+
+EntityModel* EntityModelManager::loadedModel(const IO::Path& path) const
+{
+  auto it = m_models.find(path);
+  return it != std::end(m_models) ? it->second.get() : nullptr;
+}
+
+void EntityModelManager::enqueue(const ModelSpecification& spec) const
+{
+  if (
+    !spec.path.isEmpty() && m_modelMismatches.count(spec.path) == 0
+    && m_frameMismatches.count(spec) == 0)
+  {
+    const auto wasEmpty = m_pendingSpecs.empty();
+    if (m_pendingSpecs.insert(spec).second)
+    {
+      m_pendingQueue.push_back(spec);
+      if (wasEmpty)
+      {
+        modelsWereQueuedNotifier();
+      }
+    }
+  }
+}
+
+/**
+ * Takes all queued specifications with the given path and loads their model and frames on
+ * a worker thread.
+ */
+void EntityModelManager::startModelLoad(const IO::Path& path)
+{
+  ensure(m_loader != nullptr, "loader is null");
+
+  auto specs = std::vector<ModelSpecification>{};
+  auto frameIndices = std::vector<size_t>{};
+  m_pendingQueue.erase(
+    std::remove_if(
+      std::begin(m_pendingQueue),
+      std::end(m_pendingQueue),
+      [&](const auto& spec) {
+        if (spec.path != path)
+        {
+          return false;
+        }
+        frameIndices.push_back(spec.frameIndex);
+        specs.push_back(spec);
+        return true;
+      }),
+    std::end(m_pendingQueue));
+
+  const auto requestedSpecCount = specs.size();
+  auto result =
+    std::async(std::launch::async, [loader = m_loader, path, frameIndices]() {
+      auto logger = BufferingLogger{};
+      auto model = std::unique_ptr<EntityModel>{};
+      try
+      {
+        model = loader->initializeModel(path, logger);
+        for (const auto frameIndex : frameIndices)
+        {
+          if (frameIndex < model->frameCount() && !model->frame(frameIndex)->loaded())
+          {
+            try
+            {
+              loader->loadFrame(path, frameIndex, *model, logger);
+            }
+            catch (const std::exception& e)
+            {
+              logger.error() << "Could not load frame " << frameIndex
+                             << " of entity model " << path << ": " << e.what();
+            }
+          }
+        }
+      }
+      catch (const std::exception& e)
+      {
+        logger.error() << e.what();
+        model = nullptr;
+      }
+      return LoadedModel{std::move(model), std::move(logger.messages)};
+    });
+
+  m_modelLoads.emplace(
+    path, ModelLoad{std::move(result), std::move(specs), requestedSpecCount});
+}
+
+/**
+ * Adds the models that the worker threads have finished loading. Returns the
+ * specifications that are processed. Specifications that were queued while their model
+ * was loading and whose frames are not loaded yet are queued again.
+ */
+std::vector<ModelSpecification> EntityModelManager::finishModelLoads()
+{
+  auto result = std::vector<ModelSpecification>{};
+  for (auto it = std::begin(m_modelLoads); it != std::end(m_modelLoads);)
+  {
+    auto& [path, load] = *it;
+    if (load.result.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+    {
+      ++it;
+      continue;
+    }
+
+    auto loaded = load.result.get();
+    for (const auto& [level, message] : loaded.messages)
+    {
+      m_logger.log(level, message);
+    }
+
+    // the model may have been loaded synchronously while the worker was busy
+    auto* model = loadedModel(path);
+    const auto loadedSynchronously = model != nullptr;
+    if (!loadedSynchronously && loaded.model != nullptr)
+    {
+      model = loaded.model.get();
+      m_models.emplace(path, std::move(loaded.model));
+      m_unpreparedModels.push_back(model);
+      m_logger.debug() << "Loaded entity model " << path;
+    }
+    else if (!loadedSynchronously)
+    {
+      m_modelMismatches.insert(path);
+    }
+
+    auto requeuedSpecs = std::vector<ModelSpecification>{};
+    for (size_t i = 0u; i < load.specs.size(); ++i)
+    {
+      auto& spec = load.specs[i];
+      if (
+        model != nullptr && spec.frameIndex < model->frameCount()
+        && !model->frame(spec.frameIndex)->loaded())
+      {
+        if (loadedSynchronously || i >= load.requestedSpecCount)
+        {
+          requeuedSpecs.push_back(std::move(spec));
+          continue;
+        }
+
+        // don't retry loading a frame that failed to load
+        m_frameMismatches.insert(spec);
+      }
+
+      m_pendingSpecs.erase(spec);
+      result.push_back(std::move(spec));
+    }
+
+    // the requeued specifications were queued before any of the queued ones
+    m_pendingQueue.insert(
+      std::begin(m_pendingQueue),
+      std::make_move_iterator(std::begin(requeuedSpecs)),
+      std::make_move_iterator(std::end(requeuedSpecs)));
+
+    it = m_modelLoads.erase(it);
+  }
+
+  return result;
+}
+
+void EntityModelManager::loadPendingModel(const ModelSpecification& spec)
+{
+  auto* model = safeGetModel(spec.path);
+  if (model != nullptr && spec.frameIndex < model->frameCount())
   {
     if (!model->frame(spec.frameIndex)->loaded())
     {
       loadFrame(spec, *model);
+      if (!model->frame(spec.frameIndex)->loaded())
+      {
+        // don't retry loading a frame that failed to load
+        m_frameMismatches.insert(spec);
+      }
     }
-    return model->frame(spec.frameIndex);
   }
 }
 
@@ -20,16 +20,24 @@
 #pragma once
 
 #include "IO/Path.h"
+#include "Notifier.h"
 
 #include <kdl/vector_set.h>
 
+#include <chrono>
+#include <deque>
+#include <future>
 #include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom
 {
 class Logger;
+enum class LogLevel;
 
 namespace IO
 {
@@ -66,6 +74,34 @@ private:
   using RendererMismatches = kdl::vector_set<ModelSpecification>;
   using RendererList = std::vector<Renderer::TexturedRenderer*>;
 
+  using FrameMismatches = kdl::vector_set<ModelSpecification>;
+  using PendingQueue = std::deque<ModelSpecification>;
+  using PendingSpecs = std::set<ModelSpecification>;
+
+  /**
+   * A model that was loaded on a worker thread, or null if it failed to load, together
+   * with the messages that were logged while loading it.
+   */
+  struct LoadedModel
+  {
+    std::unique_ptr<EntityModel> model;
+    std::vector<std::pair<LogLevel, std::string>> messages;
+  };
+
+  /**
+   * A model that is being loaded on a worker thread. The first requestedSpecCount
+   * specifications were queued when the load was started and their frames are loaded
+   * together with the model. The remaining ones were queued while the model was loading.
+   */
+  struct ModelLoad
+  {
+    std::future<LoadedModel> result;
+    std::vector<ModelSpecification> specs;
+    size_t requestedSpecCount;
+  };
+
+  using ModelLoads = std::map<IO::Path, ModelLoad>;
+
   Logger& m_logger;
   const IO::EntityModelLoader* m_loader;
 
@@ -77,10 +113,21 @@ private:
   mutable ModelMismatches m_modelMismatches;
   mutable RendererCache m_renderers;
   mutable RendererMismatches m_rendererMismatches;
+  mutable FrameMismatches m_frameMismatches;
+  mutable PendingQueue m_pendingQueue;
+  mutable PendingSpecs m_pendingSpecs;
+  ModelLoads m_modelLoads;
 
   mutable ModelList m_unpreparedModels;
   mutable RendererList m_unpreparedRenderers;
 
+public:
+  /**
+   * Notified when a model specification is queued for loading while no other
+   * specifications are pending.
+   */
+  mutable Notifier<> modelsWereQueuedNotifier;
+
 public:
   EntityModelManager(int magFilter, int minFilter, Logger& logger);
   ~EntityModelManager();
@@ -89,11 +136,56 @@ public:
 
   void setTextureMode(int minFilter, int magFilter);
   void setLoader(const IO::EntityModelLoader* loader);
+
+  /**
+   * Returns the renderer for the given model specification, or null if the model or its
+   * frame has not been loaded yet or if no renderer can be built for it. If the model or
+   * the frame has not been loaded yet, the specification is queued for loading by
+   * loadPendingModels.
+   */
   Renderer::TexturedRenderer* renderer(const ModelSpecification& spec) const;
 
+  /**
+   * Returns the frame for the given model specification, or null if the model or the
+   * frame has not been loaded yet or cannot be loaded. If the model or the frame has not
+   * been loaded yet, the specification is queued for loading by loadPendingModels.
+   *
+   * Callers should use a placeholder, e.g. the entity definition bounds, until the frame
+   * becomes available.
+   */
   const EntityModelFrame* frame(const ModelSpecification& spec) const;
 
+  /**
+   * Indicates whether any model specifications are queued for loading.
+   */
+  bool hasPendingModels() const;
+
+  /**
+   * Indicates whether the given model specification is queued for loading.
+   */
+  bool isPending(const ModelSpecification& spec) const;
+
+  /**
+   * Processes the queued specifications in the order in which they were queued. Models
+   * that are not loaded yet are loaded on worker threads together with the requested
+   * frames. Frames of models that are already loaded are loaded on the calling thread
+   * until the given time budget is exhausted, since the models may be in use. At least
+   * one of these frames is loaded per call.
+   *
+   * Models loaded by worker threads are added once the workers have finished, so callers
+   * must call this function repeatedly while there are pending models. The loaded models
+   * are prepared for rendering by the next call to prepare.
+   *
+   * Returns the processed specifications, including those that failed to load.
+   */
+  std::vector<ModelSpecification> loadPendingModels(std::chrono::milliseconds timeBudget);
+
 private:
+  EntityModel* loadedModel(const IO::Path& path) const;
+  void enqueue(const ModelSpecification& spec) const;
+  void startModelLoad(const IO::Path& path);
+  std::vector<ModelSpecification> finishModelLoads();
+  void loadPendingModel(const ModelSpecification& spec);
   EntityModel* model(const IO::Path& path) const;
   EntityModel* safeGetModel(const IO::Path& path) const;
   std::unique_ptr<EntityModel> loadModel(const IO::Path& path) const;
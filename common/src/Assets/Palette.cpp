@@ -29,6 +29,9 @@
 
 #include <kdl/string_format.h>
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstring>
 #include <string>
 
@@ -39,13 +42,13 @@ namespace Assets
 struct PaletteData
 {
   /**
-   * 1024 bytes, RGBA order.
+   * 256 RGBA colors, each packed into an integer whose bytes are in RGBA order in memory.
    */
-  std::vector<unsigned char> opaqueData;
+  std::array<uint32_t, 256> opaqueColors;
   /**
-   * 1024 bytes, RGBA order.
+   * 256 RGBA colors, each packed into an integer whose bytes are in RGBA order in memory.
    */
-  std::vector<unsigned char> index255TransparentData;
+  std::array<uint32_t, 256> index255TransparentColors;
 };
 
 static std::shared_ptr<PaletteData> makePaletteData(
@@ -58,17 +61,15 @@ static std::shared_ptr<PaletteData> makePaletteData(
       + std::to_string(data.size()));
   }
 
-  PaletteData result;
-
+  auto rgbaData = std::vector<unsigned char>{};
   if (data.size() == 1024)
   {
     // The data is already in RGBA format, don't process it
-    result.opaqueData = data;
-    result.index255TransparentData = data;
+    rgbaData = data;
   }
   else
   {
-    result.opaqueData.reserve(1024);
+    rgbaData.reserve(1024);
 
     for (size_t i = 0; i < 256; ++i)
     {
@@ -76,16 +77,22 @@ static std::shared_ptr<PaletteData> makePaletteData(
       const auto g = data[3 * i + 1];
       const auto b = data[3 * i + 2];
 
-      result.opaqueData.push_back(r);
-      result.opaqueData.push_back(g);
-      result.opaqueData.push_back(b);
-      result.opaqueData.push_back(0xFF);
+      rgbaData.push_back(r);
+      rgbaData.push_back(g);
+      rgbaData.push_back(b);
+      rgbaData.push_back(0xFF);
     }
+  }
+
+  PaletteData result;
+  std::memcpy(result.opaqueColors.data(), rgbaData.data(), rgbaData.size());
 
-    // build index255TransparentData from opaqueData
-    result.index255TransparentData = result.opaqueData;
-    result.index255TransparentData[1023] = 0;
+  if (data.size() == 768)
+  {
+    // build index255TransparentColors from opaqueColors
+    rgbaData[1023] = 0;
   }
+  std::memcpy(result.index255TransparentColors.data(), rgbaData.data(), rgbaData.size());
 
   return std::make_shared<PaletteData>(std::move(result));
 }
@@ -176,26 +183,46 @@ bool Palette::indexedToRgba(
   ensure(rgbaImage.size() == 4 * pixelCount, "incorrect destination buffer size");
   ensure(initialized(), "indexedToRgba called on uninitialized palette");
 
-  const unsigned char* paletteData = (transparency == PaletteTransparency::Opaque)
-                                       ? m_data->opaqueData.data()
-                                       : m_data->index255TransparentData.data();
+  const auto& colors = (transparency == PaletteTransparency::Opaque)
+                        ? m_data->opaqueColors
+                        : m_data->index255TransparentColors;
 
-  // Write rgba pixels
-  unsigned char* const rgbaData = rgbaImage.data();
-  for (size_t i = 0; i < pixelCount; ++i)
+  // Read the indices in chunks instead of byte by byte, write the rgba pixels as whole
+  // words and count how often each index occurs so that the average color and the
+  // transparency can be computed from the palette afterwards
+  auto indices = std::array<unsigned char, 4096>{};
+  auto indexCounts = std::array<size_t, 256>{};
+
+  unsigned char* rgbaData = rgbaImage.data();
+  for (size_t offset = 0; offset < pixelCount; offset += indices.size())
   {
-    const int index = reader.readInt<unsigned char>();
+    const auto count = std::min(indices.size(), pixelCount - offset);
+    reader.read(indices.data(), count);
 
-    std::memcpy(rgbaData + (i * 4), &paletteData[index * 4], 4);
+    for (size_t i = 0; i < count; ++i)
+    {
+      const auto index = indices[i];
+      std::memcpy(rgbaData + 4 * i, &colors[index], 4);
+      ++indexCounts[index];
+    }
+    rgbaData += 4 * count;
   }
 
-  // Check average color
-  uint32_t colorSum[3] = {0, 0, 0};
-  for (size_t i = 0; i < pixelCount; ++i)
+  // Check average color and transparency
+  uint64_t colorSum[3] = {0, 0, 0};
+  unsigned char andAlpha = 0xff;
+  for (size_t i = 0; i < colors.size(); ++i)
   {
-    colorSum[0] += static_cast<uint32_t>(rgbaData[(i * 4) + 0]);
-    colorSum[1] += static_cast<uint32_t>(rgbaData[(i * 4) + 1]);
-    colorSum[2] += static_cast<uint32_t>(rgbaData[(i * 4) + 2]);
+    if (indexCounts[i] > 0)
+    {
+      unsigned char rgba[4];
+      std::memcpy(rgba, &colors[i], 4);
+
+      colorSum[0] += indexCounts[i] * static_cast<uint64_t>(rgba[0]);
+      colorSum[1] += indexCounts[i] * static_cast<uint64_t>(rgba[1]);
+      colorSum[2] += indexCounts[i] * static_cast<uint64_t>(rgba[2]);
+      andAlpha &= rgba[3];
+    }
   }
   averageColor = Color(
     static_cast<float>(colorSum[0]) / (255.0f * static_cast<float>(pixelCount)),
@@ -203,18 +230,10 @@ bool Palette::indexedToRgba(
     static_cast<float>(colorSum[2]) / (255.0f * static_cast<float>(pixelCount)),
     1.0f);
 
-  // Check for transparency
-  bool hasTransparency = false;
-  if (transparency == PaletteTransparency::Index255Transparent)
-  {
-    // Take the bitwise AND of the alpha channel of all pixels
-    unsigned char andAlpha = 0xff;
-    for (size_t i = 0; i < pixelCount; ++i)
-    {
-      andAlpha &= rgbaData[(i * 4) + 3];
-    }
-    hasTransparency = (andAlpha != 0xff);
-  }
+  // The bitwise AND of the alpha channel of all pixels tells us whether any pixel is
+  // transparent
+  const bool hasTransparency =
+    transparency == PaletteTransparency::Index255Transparent && andAlpha != 0xff;
 
   return hasTransparency;
 }
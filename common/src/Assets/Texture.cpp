@@ -27,7 +27,9 @@
 
 #include <algorithm> // for std::max
 #include <cassert>
+#include <exception>
 #include <ostream>
+#include <utility>
 
 namespace TrenchBroom
 {
@@ -55,8 +57,16 @@ Texture::Texture(
   , m_type(type)
   , m_culling(TextureCulling::CullDefault)
   , m_blendFunc{TextureBlendFunc::Enable::UseDefault, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA}
+  , m_prepared{false}
+  , m_minFilter{0}
+  , m_magFilter{0}
   , m_textureId{0}
   , m_gameData{std::move(gameData)}
+  , m_reloadFailed{false}
+  , m_placeholderId{0}
+  , m_lastActivation{}
+  , m_residencyList{nullptr}
+  , m_listed{false}
 {
   assert(m_width > 0);
   assert(m_height > 0);
@@ -83,9 +93,17 @@ Texture::Texture(
   , m_type(type)
   , m_culling(TextureCulling::CullDefault)
   , m_blendFunc{TextureBlendFunc::Enable::UseDefault, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA}
+  , m_prepared{false}
+  , m_minFilter{0}
+  , m_magFilter{0}
   , m_textureId(0)
   , m_buffers{std::move(buffers)}
   , m_gameData{std::move(gameData)}
+  , m_reloadFailed{false}
+  , m_placeholderId{0}
+  , m_lastActivation{}
+  , m_residencyList{nullptr}
+  , m_listed{false}
 {
   assert(m_width > 0);
   assert(m_height > 0);
@@ -117,12 +135,30 @@ Texture::Texture(
   , m_type(type)
   , m_culling(TextureCulling::CullDefault)
   , m_blendFunc{TextureBlendFunc::Enable::UseDefault, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA}
+  , m_prepared{false}
+  , m_minFilter{0}
+  , m_magFilter{0}
   , m_textureId{0}
   , m_gameData{std::move(gameData)}
+  , m_reloadFailed{false}
+  , m_placeholderId{0}
+  , m_lastActivation{}
+  , m_residencyList{nullptr}
+  , m_listed{false}
 {
 }
 
-Texture::~Texture() = default;
+Texture::~Texture()
+{
+  if (m_textureId != 0)
+  {
+    glAssert(glDeleteTextures(1, &m_textureId));
+  }
+  if (m_placeholderId != 0)
+  {
+    glAssert(glDeleteTextures(1, &m_placeholderId));
+  }
+}
 
 Texture::Texture(Texture&& other)
   : m_name{std::move(other.m_name)}
@@ -138,9 +174,19 @@ Texture::Texture(Texture&& other)
   , m_surfaceParms{std::move(other.m_surfaceParms)}
   , m_culling{std::move(other.m_culling)}
   , m_blendFunc{std::move(other.m_blendFunc)}
-  , m_textureId{std::move(other.m_textureId)}
+  , m_prepared{other.m_prepared}
+  , m_minFilter{other.m_minFilter}
+  , m_magFilter{other.m_magFilter}
+  , m_textureId{std::exchange(other.m_textureId, 0)}
   , m_buffers{std::move(other.m_buffers)}
   , m_gameData{std::move(other.m_gameData)}
+  , m_loader{std::move(other.m_loader)}
+  , m_reload{std::move(other.m_reload)}
+  , m_reloadFailed{other.m_reloadFailed}
+  , m_placeholderId{std::exchange(other.m_placeholderId, 0)}
+  , m_lastActivation{other.m_lastActivation}
+  , m_residencyList{nullptr}
+  , m_listed{false}
 {
 }
 
@@ -159,9 +205,21 @@ Texture& Texture::operator=(Texture&& other)
   m_surfaceParms = std::move(other.m_surfaceParms);
   m_culling = std::move(other.m_culling);
   m_blendFunc = std::move(other.m_blendFunc);
-  m_textureId = std::move(other.m_textureId);
+  m_prepared = other.m_prepared;
+  m_minFilter = other.m_minFilter;
+  m_magFilter = other.m_magFilter;
+  // the other texture takes over our texture object and releases it when it's destroyed
+  std::swap(m_textureId, other.m_textureId);
   m_buffers = std::move(other.m_buffers);
   m_gameData = std::move(other.m_gameData);
+  m_loader = std::move(other.m_loader);
+  m_reload = std::move(other.m_reload);
+  m_reloadFailed = other.m_reloadFailed;
+  std::swap(m_placeholderId, other.m_placeholderId);
+  m_lastActivation = other.m_lastActivation;
+  // like a moved texture, the assigned texture is not attached to any residency list
+  m_residencyList = nullptr;
+  m_listed = false;
   return *this;
 }
 
@@ -247,6 +305,11 @@ void Texture::setCulling(const TextureCulling culling)
   m_culling = culling;
 }
 
+const TextureBlendFunc& Texture::blendFunc() const
+{
+  return m_blendFunc;
+}
+
 void Texture::setBlendFunc(GLenum srcFactor, GLenum destFactor)
 {
   m_blendFunc.enable = TextureBlendFunc::Enable::UseFactors;
@@ -291,80 +354,88 @@ void Texture::setOverridden(const bool overridden)
   m_overridden = overridden;
 }
 
-bool Texture::isPrepared() const
+void Texture::setLoader(Loader loader)
 {
-  return m_textureId != 0;
+  m_loader = std::move(loader);
 }
 
-void Texture::prepare(const GLuint textureId, const int minFilter, const int magFilter)
+void Texture::setResidencyList(ResidencyList* residencyList)
 {
-  assert(textureId > 0);
-  assert(m_textureId == 0);
-
-  if (!m_buffers.empty())
+  m_residencyList = residencyList;
+  m_listed = false;
+  if (residencyList != nullptr && residentSize() > 0u)
   {
-    glAssert(glPixelStorei(GL_UNPACK_SWAP_BYTES, false));
-    glAssert(glPixelStorei(GL_UNPACK_LSB_FIRST, false));
-    glAssert(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
-    glAssert(glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0));
-    glAssert(glPixelStorei(GL_UNPACK_SKIP_ROWS, 0));
-    glAssert(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
-
-    glAssert(glBindTexture(GL_TEXTURE_2D, textureId));
-    glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter));
-    glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter));
-    glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
-    glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
+    addToResidencyList();
+  }
+}
 
-    if (m_type == TextureType::Masked)
-    {
-      // masked textures don't work well with automatic mipmaps, so we force GL_NEAREST
-      // filtering and don't generate any
-      glAssert(glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_FALSE));
-      glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
-      glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
-    }
-    else if (m_buffers.size() == 1)
-    {
-      // generate mipmaps if we don't have any
-      glAssert(glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE));
-    }
-    else
+/**
+ * Generates the mipmaps of the given buffers if there are none and compresses them.
+ */
+static TextureBufferList compressBuffers(
+  TextureBufferList buffers, const size_t width, const size_t height, const GLenum format)
+{
+  if (buffers.size() == 1u)
+  {
+    auto mipLevels = size_t(1);
+    while ((std::max(width, height) >> mipLevels) > 0u)
     {
-      glAssert(glTexParameteri(
-        GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(m_buffers.size() - 1)));
+      ++mipLevels;
     }
+    generateMips(buffers, mipLevels, width, height, format);
+  }
+  return compressMips(buffers, width, height, format);
+}
 
-    // Upload only the first mipmap for masked textures.
-    const auto mipmapsToUpload = (m_type == TextureType::Masked) ? 1u : m_buffers.size();
+bool Texture::compress()
+{
+  assert(!m_prepared);
 
-    for (size_t j = 0; j < mipmapsToUpload; ++j)
-    {
-      const auto mipSize = sizeAtMipLevel(m_width, m_height, j);
+  if (
+    m_type != TextureType::Opaque || m_buffers.empty() || isCompressedFormat(m_format)
+    || m_width % 4u != 0u || m_height % 4u != 0u)
+  {
+    return false;
+  }
 
-      const GLvoid* data = reinterpret_cast<const GLvoid*>(m_buffers[j].data());
-      glAssert(glTexImage2D(
-        GL_TEXTURE_2D,
-        static_cast<GLint>(j),
-        GL_RGBA,
-        static_cast<GLsizei>(mipSize.x()),
-        static_cast<GLsizei>(mipSize.y()),
-        0,
-        m_format,
-        GL_UNSIGNED_BYTE,
-        data));
-    }
+  m_buffers = compressBuffers(std::move(m_buffers), m_width, m_height, m_format);
+  m_format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+  return true;
+}
 
-    m_buffers.clear();
-    m_textureId = textureId;
+bool Texture::compressed() const
+{
+  return isCompressedFormat(m_format);
+}
+
+bool Texture::isPrepared() const
+{
+  return m_prepared;
+}
+
+void Texture::prepare(const int minFilter, const int magFilter)
+{
+  assert(!m_prepared);
+
+  m_prepared = true;
+  m_minFilter = minFilter;
+  m_magFilter = magFilter;
+
+  // textures which can be reloaded are only uploaded once they are used
+  if (!m_loader)
+  {
+    upload();
   }
 }
 
 void Texture::setMode(const int minFilter, const int magFilter)
 {
-  if (isPrepared())
+  m_minFilter = minFilter;
+  m_magFilter = magFilter;
+
+  if (m_textureId != 0)
   {
-    activate();
+    glAssert(glBindTexture(GL_TEXTURE_2D, m_textureId));
     if (m_type == TextureType::Masked)
     {
       // Force GL_NEAREST filtering for masked textures.
@@ -376,15 +447,110 @@ void Texture::setMode(const int minFilter, const int magFilter)
       glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter));
       glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter));
     }
-    deactivate();
+    glAssert(glBindTexture(GL_TEXTURE_2D, 0));
+  }
+}
+
+bool Texture::evictable() const
+{
+  return static_cast<bool>(m_loader);
+}
+
+size_t Texture::residentSize() const
+{
+  auto result = size_t(0);
+  for (const auto& buffer : m_buffers)
+  {
+    result += buffer.size();
+  }
+
+  if (m_textureId != 0)
+  {
+    // textures are stored as RGBA unless they are compressed to half a byte per pixel,
+    // and mipmaps add another third
+    const auto bytes = compressed() ? m_width * m_height / 2u : m_width * m_height * 4u;
+    result += bytes * 4u / 3u;
+  }
+
+  return result;
+}
+
+void Texture::evict()
+{
+  if (evictable() && !reloading())
+  {
+    if (m_textureId != 0)
+    {
+      glAssert(glDeleteTextures(1, &m_textureId));
+      m_textureId = 0;
+    }
+    m_buffers.clear();
+    m_listed = false;
+  }
+}
+
+bool Texture::reloading() const
+{
+  return m_reload.valid();
+}
+
+void Texture::finishReload() const
+{
+  if (
+    !m_reload.valid()
+    || m_reload.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+  {
+    return;
+  }
+
+  try
+  {
+    auto data = m_reload.get();
+    if (data.width == m_width && data.height == m_height && !data.buffers.empty())
+    {
+      m_buffers = std::move(data.buffers);
+      m_format = data.format;
+      upload();
+      return;
+    }
   }
+  catch (const std::exception&)
+  {
+  }
+
+  // don't decode the texture again on every activation if its file is broken
+  m_reloadFailed = true;
+}
+
+std::chrono::steady_clock::time_point Texture::lastActivation() const
+{
+  return m_lastActivation;
 }
 
 void Texture::activate() const
 {
-  if (isPrepared())
+  m_lastActivation = std::chrono::steady_clock::now();
+
+  if (m_prepared && m_textureId == 0)
   {
-    glAssert(glBindTexture(GL_TEXTURE_2D, m_textureId));
+    if (!m_buffers.empty())
+    {
+      upload();
+    }
+    else if (m_loader)
+    {
+      finishReload();
+      if (m_textureId == 0)
+      {
+        startReload();
+        uploadPlaceholder();
+      }
+    }
+  }
+
+  if (const auto textureId = boundTextureId(); textureId != 0)
+  {
+    glAssert(glBindTexture(GL_TEXTURE_2D, textureId));
 
     switch (m_culling)
     {
@@ -420,7 +586,7 @@ void Texture::activate() const
 
 void Texture::deactivate() const
 {
-  if (isPrepared())
+  if (boundTextureId() != 0)
   {
     if (m_blendFunc.enable != TextureBlendFunc::Enable::UseDefault)
     {
@@ -447,6 +613,170 @@ void Texture::deactivate() const
   }
 }
 
+void Texture::upload() const
+{
+  if (!m_buffers.empty())
+  {
+    auto textureId = GLuint(0);
+    glAssert(glGenTextures(1, &textureId));
+
+    glAssert(glPixelStorei(GL_UNPACK_SWAP_BYTES, false));
+    glAssert(glPixelStorei(GL_UNPACK_LSB_FIRST, false));
+    glAssert(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+    glAssert(glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0));
+    glAssert(glPixelStorei(GL_UNPACK_SKIP_ROWS, 0));
+    glAssert(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+
+    glAssert(glBindTexture(GL_TEXTURE_2D, textureId));
+    glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_minFilter));
+    glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_magFilter));
+    glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
+    glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
+
+    if (m_type == TextureType::Masked)
+    {
+      // masked textures don't work well with automatic mipmaps, so we force GL_NEAREST
+      // filtering and don't generate any
+      glAssert(glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_FALSE));
+      glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+      glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    }
+    else if (m_buffers.size() == 1)
+    {
+      // generate mipmaps if we don't have any
+      glAssert(glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE));
+    }
+    else
+    {
+      glAssert(glTexParameteri(
+        GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(m_buffers.size() - 1)));
+    }
+
+    // Upload only the first mipmap for masked textures.
+    const auto mipmapsToUpload = (m_type == TextureType::Masked) ? 1u : m_buffers.size();
+
+    // decompress the texture if the driver doesn't support compressed textures, and
+    // account for it as uncompressed from now on, which also keeps later reloads from
+    // compressing it again
+    const auto uploadCompressed = compressed() && GLEW_EXT_texture_compression_s3tc;
+    if (compressed() && !uploadCompressed)
+    {
+      m_buffers = decompressMips(m_buffers, m_width, m_height);
+      m_format = GL_RGBA;
+    }
+
+    for (size_t j = 0; j < mipmapsToUpload; ++j)
+    {
+      const auto mipSize = sizeAtMipLevel(m_width, m_height, j);
+
+      const GLvoid* data = reinterpret_cast<const GLvoid*>(m_buffers[j].data());
+      if (uploadCompressed)
+      {
+        glAssert(glCompressedTexImage2D(
+          GL_TEXTURE_2D,
+          static_cast<GLint>(j),
+          m_format,
+          static_cast<GLsizei>(mipSize.x()),
+          static_cast<GLsizei>(mipSize.y()),
+          0,
+          static_cast<GLsizei>(m_buffers[j].size()),
+          data));
+      }
+      else
+      {
+        glAssert(glTexImage2D(
+          GL_TEXTURE_2D,
+          static_cast<GLint>(j),
+          GL_RGBA,
+          static_cast<GLsizei>(mipSize.x()),
+          static_cast<GLsizei>(mipSize.y()),
+          0,
+          m_format,
+          GL_UNSIGNED_BYTE,
+          data));
+      }
+    }
+
+    m_buffers.clear();
+    m_textureId = textureId;
+
+    if (m_placeholderId != 0)
+    {
+      glAssert(glDeleteTextures(1, &m_placeholderId));
+      m_placeholderId = 0;
+    }
+
+    if (m_loader)
+    {
+      addToResidencyList();
+    }
+  }
+}
+
+void Texture::startReload() const
+{
+  if (m_reload.valid() || m_reloadFailed)
+  {
+    return;
+  }
+
+  // decode and compress the texture on a worker thread so that activating an evicted
+  // texture doesn't stall rendering
+  m_reload = std::async(
+    std::launch::async, [loader = m_loader, compress = compressed()]() {
+      auto texture = loader();
+      if (compress)
+      {
+        texture.compress();
+      }
+      return ReloadedData{
+        texture.m_width, texture.m_height, texture.m_format, std::move(texture.m_buffers)};
+    });
+
+  // the residency list is polled to upload the texture once its data arrives
+  addToResidencyList();
+}
+
+void Texture::uploadPlaceholder() const
+{
+  if (m_placeholderId != 0)
+  {
+    return;
+  }
+
+  const unsigned char pixel[] = {
+    static_cast<unsigned char>(m_averageColor.r() * 255.0f),
+    static_cast<unsigned char>(m_averageColor.g() * 255.0f),
+    static_cast<unsigned char>(m_averageColor.b() * 255.0f),
+    static_cast<unsigned char>(m_averageColor.a() * 255.0f),
+  };
+
+  glAssert(glGenTextures(1, &m_placeholderId));
+  glAssert(glBindTexture(GL_TEXTURE_2D, m_placeholderId));
+  glAssert(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+  glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+  glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+  glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
+  glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
+  glAssert(glTexImage2D(
+    GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel));
+  glAssert(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+GLuint Texture::boundTextureId() const
+{
+  return m_textureId != 0 ? m_textureId : m_placeholderId;
+}
+
+void Texture::addToResidencyList() const
+{
+  if (m_residencyList != nullptr && !m_listed)
+  {
+    m_residencyList->push_back(this);
+    m_listed = true;
+  }
+}
+
 const Texture::BufferList& Texture::buffersIfUnprepared() const
 {
   return m_buffers;
@@ -29,6 +29,9 @@
 #include <kdl/reflection_decl.h>
 
 #include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
 #include <iosfwd>
 #include <set>
 #include <string>
@@ -95,10 +98,33 @@ using GameData = std::variant<std::monostate, Q2Data>;
 
 class Texture
 {
+public:
+  /**
+   * A function that decodes a texture again. Its result must have the same dimensions and
+   * format as the texture it was registered for. It is called on a worker thread.
+   */
+  using Loader = std::function<Texture()>;
+
+  /**
+   * A list of textures that may occupy memory and can be evicted.
+   */
+  using ResidencyList = std::vector<const Texture*>;
+
 private:
   using Buffer = TextureBuffer;
   using BufferList = std::vector<Buffer>;
 
+  /**
+   * The data of a texture that was decoded again.
+   */
+  struct ReloadedData
+  {
+    size_t width;
+    size_t height;
+    GLenum format;
+    BufferList buffers;
+  };
+
 private:
   std::string m_name;
   IO::Path m_absolutePath;
@@ -111,7 +137,7 @@ private:
   std::atomic<size_t> m_usageCount;
   bool m_overridden;
 
-  GLenum m_format;
+  mutable GLenum m_format;
   TextureType m_type;
 
   // TODO: move these to a Q3Data variant case of m_gameData if possible
@@ -125,11 +151,23 @@ private:
   // Quake 3 blend function, move to materials
   TextureBlendFunc m_blendFunc;
 
+  bool m_prepared;
+  int m_minFilter;
+  int m_magFilter;
+
   mutable GLuint m_textureId;
   mutable BufferList m_buffers;
 
   GameData m_gameData;
 
+  Loader m_loader;
+  mutable std::future<ReloadedData> m_reload;
+  mutable bool m_reloadFailed;
+  mutable GLuint m_placeholderId;
+  mutable std::chrono::steady_clock::time_point m_lastActivation;
+  mutable ResidencyList* m_residencyList;
+  mutable bool m_listed;
+
 public:
   Texture(
     const std::string& name,
@@ -198,6 +236,7 @@ public:
   TextureCulling culling() const;
   void setCulling(TextureCulling culling);
 
+  const TextureBlendFunc& blendFunc() const;
   void setBlendFunc(GLenum srcFactor, GLenum destFactor);
   void disableBlend();
 
@@ -209,21 +248,101 @@ public:
   bool overridden() const;
   void setOverridden(bool overridden);
 
+  /**
+   * Sets a function that decodes this texture again. A texture with a loader can be
+   * evicted, and if it has not been uploaded yet, it is only uploaded when it is activated
+   * for the first time.
+   *
+   * An evicted texture is decoded again on a worker thread when it is activated. Until
+   * its data arrives, a placeholder filled with the texture's average color is bound
+   * instead. If decoding fails, the placeholder is kept and decoding is not retried.
+   */
+  void setLoader(Loader loader);
+
+  /**
+   * Sets the list that this texture adds itself to whenever it becomes resident while it
+   * is evictable. If the texture is resident now, it is added to the given list right
+   * away. Pass null to detach this texture from its list.
+   *
+   * The texture must not be moved while it is attached to a list.
+   */
+  void setResidencyList(ResidencyList* residencyList);
+
+  /**
+   * Compresses this texture's data to reduce the amount of video memory it occupies. Only
+   * opaque textures whose width and height are multiples of 4 are compressed. If the
+   * texture has no mipmaps, they are generated before compressing it. A compressed
+   * texture that is reloaded after it was evicted is compressed again on the worker
+   * thread that decodes it. If the driver does not support compressed textures, the
+   * texture is decompressed when it is uploaded and is no longer compressed afterwards.
+   *
+   * Must be called before the texture is prepared. Different textures can be compressed
+   * concurrently.
+   *
+   * @return true if the texture was compressed and false otherwise
+   */
+  bool compress();
+  bool compressed() const;
+
   bool isPrepared() const;
-  void prepare(GLuint textureId, int minFilter, int magFilter);
+  void prepare(int minFilter, int magFilter);
   void setMode(int minFilter, int magFilter);
 
+  /**
+   * Indicates whether this texture's data can be released and reloaded on demand.
+   */
+  bool evictable() const;
+
+  /**
+   * Returns the estimated number of bytes that this texture currently occupies in main
+   * and video memory.
+   */
+  size_t residentSize() const;
+
+  /**
+   * Releases this texture's data and GL texture object if it is evictable and not being
+   * reloaded. The data is decoded and uploaded again when the texture is activated the
+   * next time. The caller must remove the texture from its residency list unless the
+   * texture is still reloading.
+   */
+  void evict();
+
+  /**
+   * Indicates whether this texture is being decoded again on a worker thread or whether
+   * its decoded data has not been uploaded yet.
+   */
+  bool reloading() const;
+
+  /**
+   * Uploads this texture's data if it has been decoded again on a worker thread. Does
+   * nothing if the data has not arrived yet. Must be called with a current GL context.
+   */
+  void finishReload() const;
+
+  /**
+   * Returns the time at which this texture was last activated. Textures that were never
+   * activated return the epoch of the steady clock.
+   */
+  std::chrono::steady_clock::time_point lastActivation() const;
+
   void activate() const;
   void deactivate() const;
 
+private:
+  void upload() const;
+  void startReload() const;
+  void uploadPlaceholder() const;
+  GLuint boundTextureId() const;
+  void addToResidencyList() const;
+
 public: // exposed for tests only
   /**
    * Returns the texture data in the format returned by format().
-   * Once prepare() is called, this will be an empty vector.
+   * Once the texture has been uploaded or evicted, this will be an empty vector.
    */
   const BufferList& buffersIfUnprepared() const;
   /**
-   * Will be one of GL_RGB, GL_BGR, GL_RGBA, GL_BGRA.
+   * Will be one of GL_RGB, GL_BGR, GL_RGBA, GL_BGRA, GL_COMPRESSED_RGB_S3TC_DXT1_EXT.
    */
   GLenum format() const;
   TextureType type() const;
@@ -21,11 +21,14 @@
 
 #include "Ensure.h"
 
+#include <vecmath/scalar.h>
 #include <vecmath/vec.h>
 
-#include <FreeImage.h>
-
 #include <algorithm> // for std::max
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
 
 namespace TrenchBroom
 {
@@ -72,6 +75,11 @@ vm::vec2s sizeAtMipLevel(const size_t width, const size_t height, const size_t l
     std::max(size_t(1), width >> level), std::max(size_t(1), height >> level));
 }
 
+bool isCompressedFormat(const GLenum format)
+{
+  return format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+}
+
 size_t bytesPerPixelForFormat(const GLenum format)
 {
   switch (format)
@@ -105,38 +113,356 @@ void setMipBufferSize(
   }
 }
 
+/**
+ * Resamples the given source image to the given destination size using a box filter.
+ * Every destination pixel is the average of the source pixels it covers, or the nearest
+ * source pixel if the image is being enlarged.
+ */
+static void resizeImage(
+  const unsigned char* srcData,
+  const vm::vec2s& srcSize,
+  unsigned char* dstData,
+  const vm::vec2s& dstSize,
+  const size_t bytesPerPixel)
+{
+  const auto sourceRange = [](const size_t i, const size_t srcLen, const size_t dstLen) {
+    const auto first = i * srcLen / dstLen;
+    const auto last = std::max(first + 1u, (i + 1u) * srcLen / dstLen);
+    return std::make_pair(first, last);
+  };
+
+  auto xRanges = std::vector<std::pair<size_t, size_t>>{};
+  xRanges.reserve(dstSize.x());
+  for (size_t x = 0; x < dstSize.x(); ++x)
+  {
+    xRanges.push_back(sourceRange(x, srcSize.x(), dstSize.x()));
+  }
+
+  const auto srcPitch = srcSize.x() * bytesPerPixel;
+  for (size_t y = 0; y < dstSize.y(); ++y)
+  {
+    const auto [firstY, lastY] = sourceRange(y, srcSize.y(), dstSize.y());
+    for (const auto& [firstX, lastX] : xRanges)
+    {
+      uint32_t sum[4] = {0, 0, 0, 0};
+      for (size_t srcY = firstY; srcY < lastY; ++srcY)
+      {
+        const auto* srcPtr = srcData + srcY * srcPitch + firstX * bytesPerPixel;
+        for (size_t srcX = firstX; srcX < lastX; ++srcX)
+        {
+          for (size_t c = 0; c < bytesPerPixel; ++c)
+          {
+            sum[c] += static_cast<uint32_t>(*srcPtr++);
+          }
+        }
+      }
+
+      const auto count = static_cast<uint32_t>((lastX - firstX) * (lastY - firstY));
+      for (size_t c = 0; c < bytesPerPixel; ++c)
+      {
+        *dstData++ = static_cast<unsigned char>((sum[c] + count / 2u) / count);
+      }
+    }
+  }
+}
+
 void resizeMips(
-  TextureBufferList& buffers, const vm::vec2s& oldSize, const vm::vec2s& newSize)
+  TextureBufferList& buffers,
+  const vm::vec2s& oldSize,
+  const vm::vec2s& newSize,
+  const GLenum format)
 {
   if (oldSize == newSize)
     return;
 
-  for (size_t i = 0; i < buffers.size(); ++i)
+  const auto bytesPerPixel = bytesPerPixelForFormat(format);
+  for (size_t level = 0; level < buffers.size(); ++level)
+  {
+    const auto oldMipSize = sizeAtMipLevel(oldSize.x(), oldSize.y(), level);
+    const auto newMipSize = sizeAtMipLevel(newSize.x(), newSize.y(), level);
+    ensure(
+      buffers[level].size() == bytesPerPixel * oldMipSize.x() * oldMipSize.y(),
+      "buffer size matches old size");
+
+    auto newBuffer = TextureBuffer(bytesPerPixel * newMipSize.x() * newMipSize.y());
+    resizeImage(
+      buffers[level].data(), oldMipSize, newBuffer.data(), newMipSize, bytesPerPixel);
+    buffers[level] = std::move(newBuffer);
+  }
+}
+
+void generateMips(
+  TextureBufferList& buffers,
+  const size_t mipLevels,
+  const size_t width,
+  const size_t height,
+  const GLenum format)
+{
+  assert(!buffers.empty());
+
+  const auto bytesPerPixel = bytesPerPixelForFormat(format);
+  buffers.reserve(mipLevels);
+  for (size_t level = buffers.size(); level < mipLevels; ++level)
+  {
+    const auto srcSize = sizeAtMipLevel(width, height, level - 1u);
+    const auto dstSize = sizeAtMipLevel(width, height, level);
+
+    auto buffer = TextureBuffer(bytesPerPixel * dstSize.x() * dstSize.y());
+    resizeImage(
+      buffers[level - 1u].data(), srcSize, buffer.data(), dstSize, bytesPerPixel);
+    buffers.push_back(std::move(buffer));
+  }
+}
+
+namespace
+{
+constexpr size_t BC1BlockSize = 8u;
+
+using BC1Palette = std::array<std::array<int, 3>, 4>;
+
+uint16_t packRgb565(const vm::vec3f& color)
+{
+  const auto pack = [](const float value, const float max) {
+    return static_cast<uint16_t>(vm::clamp(value / 255.0f * max + 0.5f, 0.0f, max));
+  };
+  return static_cast<uint16_t>(
+    (pack(color.x(), 31.0f) << 11) | (pack(color.y(), 63.0f) << 5)
+    | pack(color.z(), 31.0f));
+}
+
+std::array<int, 3> unpackRgb565(const uint16_t color)
+{
+  const auto r = (color >> 11) & 0x1F;
+  const auto g = (color >> 5) & 0x3F;
+  const auto b = color & 0x1F;
+  return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+}
+
+BC1Palette makeBC1Palette(const uint16_t color0, const uint16_t color1)
+{
+  auto result = BC1Palette{};
+  result[0] = unpackRgb565(color0);
+  result[1] = unpackRgb565(color1);
+  for (size_t c = 0; c < 3; ++c)
+  {
+    if (color0 > color1)
+    {
+      result[2][c] = (2 * result[0][c] + result[1][c]) / 3;
+      result[3][c] = (result[0][c] + 2 * result[1][c]) / 3;
+    }
+    else
+    {
+      // this mode is never produced by compressBlock, and the fourth color is black
+      result[2][c] = (result[0][c] + result[1][c]) / 2;
+      result[3][c] = 0;
+    }
+  }
+  return result;
+}
+
+/**
+ * Compresses a block of 16 pixels by fitting the palette endpoints to the extremes of the
+ * pixels along their principal axis.
+ */
+void compressBlock(const std::array<vm::vec3f, 16>& pixels, unsigned char* out)
+{
+  auto mean = vm::vec3f{0, 0, 0};
+  for (const auto& pixel : pixels)
+  {
+    mean = mean + pixel;
+  }
+  mean = mean / 16.0f;
+
+  // the covariance matrix is symmetric, so we only store the upper triangle
+  auto covariance = std::array<float, 6>{};
+  for (const auto& pixel : pixels)
+  {
+    const auto d = pixel - mean;
+    covariance[0] += d.x() * d.x();
+    covariance[1] += d.x() * d.y();
+    covariance[2] += d.x() * d.z();
+    covariance[3] += d.y() * d.y();
+    covariance[4] += d.y() * d.z();
+    covariance[5] += d.z() * d.z();
+  }
+
+  // find the principal axis using power iteration, starting with the column of the
+  // covariance matrix with the largest variance
+  auto axis = vm::vec3f{covariance[0], covariance[1], covariance[2]};
+  if (covariance[3] > covariance[0] && covariance[3] >= covariance[5])
+  {
+    axis = vm::vec3f{covariance[1], covariance[3], covariance[4]};
+  }
+  else if (covariance[5] > covariance[0] && covariance[5] > covariance[3])
+  {
+    axis = vm::vec3f{covariance[2], covariance[4], covariance[5]};
+  }
+
+  for (size_t i = 0; i < 8; ++i)
+  {
+    const auto next = vm::vec3f{
+      covariance[0] * axis.x() + covariance[1] * axis.y() + covariance[2] * axis.z(),
+      covariance[1] * axis.x() + covariance[3] * axis.y() + covariance[4] * axis.z(),
+      covariance[2] * axis.x() + covariance[4] * axis.y() + covariance[5] * axis.z()};
+    const auto length = vm::length(next);
+    if (length < 1e-6f)
+    {
+      break;
+    }
+    axis = next / length;
+  }
+
+  auto minT = 0.0f;
+  auto maxT = 0.0f;
+  for (const auto& pixel : pixels)
+  {
+    const auto t = vm::dot(pixel - mean, axis);
+    minT = std::min(minT, t);
+    maxT = std::max(maxT, t);
+  }
+
+  auto color0 = packRgb565(mean + maxT * axis);
+  auto color1 = packRgb565(mean + minT * axis);
+  if (color0 < color1)
+  {
+    std::swap(color0, color1);
+  }
+
+  auto indices = uint32_t(0);
+  if (color0 != color1)
+  {
+    const auto palette = makeBC1Palette(color0, color1);
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+      auto bestIndex = uint32_t(0);
+      auto bestDistance = std::numeric_limits<float>::max();
+      for (size_t j = 0; j < palette.size(); ++j)
+      {
+        const auto d = pixels[i]
+                       - vm::vec3f{
+                         static_cast<float>(palette[j][0]),
+                         static_cast<float>(palette[j][1]),
+                         static_cast<float>(palette[j][2])};
+        const auto distance = vm::dot(d, d);
+        if (distance < bestDistance)
+        {
+          bestIndex = static_cast<uint32_t>(j);
+          bestDistance = distance;
+        }
+      }
+      indices |= bestIndex << (2u * i);
+    }
+  }
+
+  out[0] = static_cast<unsigned char>(color0 & 0xFF);
+  out[1] = static_cast<unsigned char>(color0 >> 8);
+  out[2] = static_cast<unsigned char>(color1 & 0xFF);
+  out[3] = static_cast<unsigned char>(color1 >> 8);
+  for (size_t i = 0; i < 4; ++i)
   {
-    const auto div = size_t(1) << i;
-    const auto oldWidth = static_cast<int>(oldSize.x() / div);
-    const auto oldHeight = static_cast<int>(oldSize.y() / div);
-    const auto oldPitch = oldWidth * 3;
-    auto* oldPtr = buffers[i].data();
+    out[4 + i] = static_cast<unsigned char>((indices >> (8u * i)) & 0xFF);
+  }
+}
+
+size_t bc1BufferSize(const vm::vec2s& size)
+{
+  return BC1BlockSize * ((size.x() + 3u) / 4u) * ((size.y() + 3u) / 4u);
+}
+} // namespace
+
+TextureBufferList compressMips(
+  const TextureBufferList& buffers,
+  const size_t width,
+  const size_t height,
+  const GLenum format)
+{
+  const auto bytesPerPixel = bytesPerPixelForFormat(format);
+  const auto swapRedAndBlue = format == GL_BGR || format == GL_BGRA;
+
+  auto result = TextureBufferList{};
+  result.reserve(buffers.size());
+
+  for (size_t level = 0; level < buffers.size(); ++level)
+  {
+    const auto size = sizeAtMipLevel(width, height, level);
+    const auto* data = buffers[level].data();
 
-    auto* oldBitmap = FreeImage_ConvertFromRawBits(
-      oldPtr, oldWidth, oldHeight, oldPitch, 24, 0xFF0000, 0x00FF00, 0x0000FF, true);
-    ensure(oldBitmap != nullptr, "oldBitmap is null");
+    auto compressed = TextureBuffer(bc1BufferSize(size));
+    auto* out = compressed.data();
 
-    const auto newWidth = static_cast<int>(newSize.x() / div);
-    const auto newHeight = static_cast<int>(newSize.y() / div);
-    const auto newPitch = newWidth * 3;
-    auto* newBitmap = FreeImage_Rescale(oldBitmap, newWidth, newHeight, FILTER_BICUBIC);
-    ensure(newBitmap != nullptr, "newBitmap is null");
+    auto pixels = std::array<vm::vec3f, 16>{};
+    for (size_t blockY = 0; blockY < size.y(); blockY += 4u)
+    {
+      for (size_t blockX = 0; blockX < size.x(); blockX += 4u)
+      {
+        // blocks that exceed the image repeat its last row and column
+        for (size_t i = 0; i < pixels.size(); ++i)
+        {
+          const auto x = std::min(blockX + i % 4u, size.x() - 1u);
+          const auto y = std::min(blockY + i / 4u, size.y() - 1u);
+          const auto* pixel = data + (y * size.x() + x) * bytesPerPixel;
+          pixels[i] = vm::vec3f{
+            static_cast<float>(pixel[swapRedAndBlue ? 2 : 0]),
+            static_cast<float>(pixel[1]),
+            static_cast<float>(pixel[swapRedAndBlue ? 0 : 2])};
+        }
 
-    buffers[i] = TextureBuffer(3 * newSize.x() * newSize.y());
-    auto* newPtr = buffers[i].data();
+        compressBlock(pixels, out);
+        out += BC1BlockSize;
+      }
+    }
 
-    FreeImage_ConvertToRawBits(
-      newPtr, newBitmap, newPitch, 24, 0xFF0000, 0x00FF00, 0x0000FF, true);
-    FreeImage_Unload(oldBitmap);
-    FreeImage_Unload(newBitmap);
+    result.push_back(std::move(compressed));
   }
+
+  return result;
+}
+
+TextureBufferList decompressMips(
+  const TextureBufferList& buffers, const size_t width, const size_t height)
+{
+  auto result = TextureBufferList{};
+  result.reserve(buffers.size());
+
+  for (size_t level = 0; level < buffers.size(); ++level)
+  {
+    const auto size = sizeAtMipLevel(width, height, level);
+    assert(buffers[level].size() == bc1BufferSize(size));
+    const auto* in = buffers[level].data();
+
+    auto decompressed = TextureBuffer(4u * size.x() * size.y());
+    auto* data = decompressed.data();
+
+    for (size_t blockY = 0; blockY < size.y(); blockY += 4u)
+    {
+      for (size_t blockX = 0; blockX < size.x(); blockX += 4u)
+      {
+        const auto color0 = static_cast<uint16_t>(in[0] | (in[1] << 8));
+        const auto color1 = static_cast<uint16_t>(in[2] | (in[3] << 8));
+        const auto palette = makeBC1Palette(color0, color1);
+
+        for (size_t i = 0; i < 16; ++i)
+        {
+          const auto x = blockX + i % 4u;
+          const auto y = blockY + i / 4u;
+          if (x < size.x() && y < size.y())
+          {
+            const auto index = (in[4u + i / 4u] >> (2u * (i % 4u))) & 0x3;
+            auto* pixel = data + 4u * (y * size.x() + x);
+            pixel[0] = static_cast<unsigned char>(palette[index][0]);
+            pixel[1] = static_cast<unsigned char>(palette[index][1]);
+            pixel[2] = static_cast<unsigned char>(palette[index][2]);
+            pixel[3] = 0xFF;
+          }
+        }
+        in += BC1BlockSize;
+      }
+    }
+
+    result.push_back(std::move(decompressed));
+  }
+
+  return result;
 }
 } // namespace Assets
 } // namespace TrenchBroom
@@ -49,6 +49,12 @@ using TextureBufferList = std::vector<TextureBuffer>;
 
 vm::vec2s sizeAtMipLevel(size_t width, size_t height, size_t level);
 size_t bytesPerPixelForFormat(GLenum format);
+
+/**
+ * Indicates whether the given format is the block compressed format produced by
+ * compressMips.
+ */
+bool isCompressedFormat(GLenum format);
 void setMipBufferSize(
   TextureBufferList& buffers,
   size_t mipLevels,
@@ -56,7 +62,39 @@ void setMipBufferSize(
   size_t height,
   GLenum format);
 
+/**
+ * Resizes every mip level in the given buffers from the old size to the new size using a
+ * box filter. The buffers must contain pixels of the given format.
+ */
 void resizeMips(
-  TextureBufferList& buffers, const vm::vec2s& oldSize, const vm::vec2s& newSize);
+  TextureBufferList& buffers,
+  const vm::vec2s& oldSize,
+  const vm::vec2s& newSize,
+  GLenum format);
+
+/**
+ * Computes the missing mip levels of the given uncompressed buffers from the first level
+ * using a box filter until the buffers contain the given number of levels.
+ */
+void generateMips(
+  TextureBufferList& buffers,
+  size_t mipLevels,
+  size_t width,
+  size_t height,
+  GLenum format);
+
+/**
+ * Compresses the given uncompressed mip levels to BC1 (S3TC DXT1), which stores every
+ * block of 4x4 pixels in 8 bytes and drops the alpha channel. The compressed buffers have
+ * the format GL_COMPRESSED_RGB_S3TC_DXT1_EXT.
+ */
+TextureBufferList compressMips(
+  const TextureBufferList& buffers, size_t width, size_t height, GLenum format);
+
+/**
+ * Decompresses the given BC1 compressed mip levels to RGBA.
+ */
+TextureBufferList decompressMips(
+  const TextureBufferList& buffers, size_t width, size_t height);
 } // namespace Assets
 } // namespace TrenchBroom
@@ -32,18 +32,21 @@ namespace Assets
 {
 TextureCollection::TextureCollection()
   : m_loaded(false)
+  , m_prepared(false)
 {
 }
 
 TextureCollection::TextureCollection(std::vector<Texture> textures)
   : m_loaded(false)
   , m_textures(std::move(textures))
+  , m_prepared(false)
 {
 }
 
 TextureCollection::TextureCollection(const IO::Path& path)
   : m_loaded(false)
   , m_path(path)
+  , m_prepared(false)
 {
 }
 
@@ -51,19 +54,11 @@ TextureCollection::TextureCollection(const IO::Path& path, std::vector<Texture>
   : m_loaded(true)
   , m_path(path)
   , m_textures(std::move(textures))
+  , m_prepared(false)
 {
 }
 
-TextureCollection::~TextureCollection()
-{
-  if (!m_textureIds.empty())
-  {
-    glAssert(glDeleteTextures(
-      static_cast<GLsizei>(m_textureIds.size()),
-      static_cast<GLuint*>(&m_textureIds.front())));
-    m_textureIds.clear();
-  }
-}
+TextureCollection::~TextureCollection() = default;
 
 bool TextureCollection::loaded() const
 {
@@ -135,25 +130,18 @@ Texture* TextureCollection::textureByName(const std::string& name)
 
 bool TextureCollection::prepared() const
 {
-  return !m_textureIds.empty();
+  return m_prepared;
 }
 
 void TextureCollection::prepare(const int minFilter, const int magFilter)
 {
   assert(!prepared());
 
-  m_textureIds.resize(textureCount());
-  if (textureCount() != 0u)
+  for (auto& texture : m_textures)
   {
-    glAssert(glGenTextures(
-      static_cast<GLsizei>(textureCount()), static_cast<GLuint*>(&m_textureIds.front())));
-
-    for (size_t i = 0; i < textureCount(); ++i)
-    {
-      Texture& texture = m_textures[i];
-      texture.prepare(m_textureIds[i], minFilter, magFilter);
-    }
+    texture.prepare(minFilter, magFilter);
   }
+  m_prepared = true;
 }
 
 void TextureCollection::setTextureMode(const int minFilter, const int magFilter)
@@ -21,7 +21,6 @@
 
 #include "Assets/Texture.h"
 #include "IO/Path.h"
-#include "Renderer/GL.h"
 
 #include <string>
 #include <vector>
@@ -33,13 +32,11 @@ namespace Assets
 class TextureCollection
 {
 private:
-  using TextureIdList = std::vector<GLuint>;
-
   bool m_loaded;
   IO::Path m_path;
   std::vector<Texture> m_textures;
 
-  TextureIdList m_textureIds;
+  bool m_prepared;
 
   friend class Texture;
 
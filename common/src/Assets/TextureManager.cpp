@@ -25,13 +25,15 @@
 #include "IO/TextureLoader.h"
 #include "Logger.h"
 
-#include <kdl/map_utils.h>
+#include <kdl/parallel.h>
 #include <kdl/string_format.h>
 #include <kdl/vector_utils.h>
 
 #include <algorithm>
 #include <chrono>
 #include <iterator>
+#include <limits>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -70,6 +72,8 @@ TextureManager::TextureManager(int magFilter, int minFilter, Logger& logger)
   , m_minFilter(minFilter)
   , m_magFilter(magFilter)
   , m_resetTextureMode(false)
+  , m_cacheSize(std::numeric_limits<size_t>::max())
+  , m_compressTextures(false)
 {
 }
 
@@ -122,6 +126,15 @@ void TextureManager::setTextureCollections(
     }
   }
 
+  // the removed textures are released when changes are committed
+  for (auto& collection : collections)
+  {
+    for (auto& texture : collection.textures())
+    {
+      texture.setResidencyList(nullptr);
+    }
+  }
+
   updateTextures();
   m_toRemove = kdl::vec_concat(std::move(m_toRemove), std::move(collections));
 }
@@ -142,12 +155,50 @@ void TextureManager::addTextureCollection(Assets::TextureCollection collection)
 
   if (m_collections[index].loaded() && !m_collections[index].prepared())
   {
+    if (m_compressTextures)
+    {
+      compressTextures(m_collections[index]);
+    }
     m_toPrepare.push_back(index);
   }
 
   m_logger.debug() << "Added texture collection " << m_collections[index].path();
 }
 
+void TextureManager::compressTextures(Assets::TextureCollection& collection)
+{
+  const auto startTime = std::chrono::high_resolution_clock::now();
+
+  auto& textures = collection.textures();
+  auto compressed = std::vector<size_t>(textures.size(), 0u);
+  kdl::parallel_for(textures.size(), [&](const size_t i) {
+    compressed[i] = textures[i].compress() ? 1u : 0u;
+  });
+
+  const auto endTime = std::chrono::high_resolution_clock::now();
+
+  auto count = size_t(0);
+  auto savedBytes = size_t(0);
+  for (size_t i = 0; i < textures.size(); ++i)
+  {
+    if (compressed[i])
+    {
+      // compressed textures use an eighth of the video memory of uncompressed textures
+      const auto uncompressedBytes = textures[i].width() * textures[i].height() * 4u;
+      savedBytes += (uncompressedBytes - uncompressedBytes / 8u) * 4u / 3u;
+      ++count;
+    }
+  }
+
+  m_logger.info() << "Compressed " << count << " textures of texture collection '"
+                   << collection.path() << "' in "
+                   << std::chrono::duration_cast<std::chrono::milliseconds>(
+                        endTime - startTime)
+                        .count()
+                   << "ms, saving " << savedBytes / 1024u / 1024u
+                   << "MB of video memory";
+}
+
 void TextureManager::clear()
 {
   m_collections.clear();
@@ -155,6 +206,7 @@ void TextureManager::clear()
   m_toPrepare.clear();
   m_texturesByName.clear();
   m_textures.clear();
+  m_residentTextures.clear();
 
   // Remove logging because it might fail when the document is already destroyed.
 }
@@ -166,13 +218,85 @@ void TextureManager::setTextureMode(const int minFilter, const int magFilter)
   m_resetTextureMode = true;
 }
 
+void TextureManager::setCacheSize(const size_t cacheSize)
+{
+  m_cacheSize = cacheSize;
+}
+
+void TextureManager::setCompressTextures(const bool compressTextures)
+{
+  m_compressTextures = compressTextures;
+}
+
 void TextureManager::commitChanges()
 {
   resetTextureMode();
   prepare();
+  finishReloads();
+  evictTextures(std::chrono::steady_clock::now());
   m_toRemove.clear();
 }
 
+// Evictions are spaced out so that views which commit changes in the same frame don't
+// evict the textures that another view has just uploaded.
+static constexpr auto EvictionInterval = std::chrono::seconds{1};
+
+// Textures that were activated recently are likely still visible in some view.
+static constexpr auto RecencyWindow = std::chrono::seconds{5};
+
+void TextureManager::evictTextures(const std::chrono::steady_clock::time_point now)
+{
+  if (m_lastEviction && now - *m_lastEviction < EvictionInterval)
+  {
+    return;
+  }
+  m_lastEviction = now;
+
+  auto residentSize = size_t(0);
+  for (const auto* texture : m_residentTextures)
+  {
+    residentSize += texture->residentSize();
+  }
+
+  if (residentSize <= m_cacheSize)
+  {
+    return;
+  }
+
+  auto candidates = kdl::vec_filter(m_residentTextures, [&](const auto* texture) {
+    return now - texture->lastActivation() >= RecencyWindow;
+  });
+  std::sort(
+    std::begin(candidates), std::end(candidates), [](const auto* lhs, const auto* rhs) {
+      return lhs->lastActivation() < rhs->lastActivation();
+    });
+
+  for (const auto* texture : candidates)
+  {
+    if (residentSize <= m_cacheSize)
+    {
+      break;
+    }
+    residentSize -= texture->residentSize();
+
+    // the manager owns its textures, only the residency list refers to them as const
+    const_cast<Texture*>(texture)->evict();
+  }
+
+  m_residentTextures =
+    kdl::vec_filter(std::move(m_residentTextures), [](const auto* texture) {
+      return texture->residentSize() > 0u || texture->reloading();
+    });
+}
+
+bool TextureManager::hasPendingReloads() const
+{
+  return std::any_of(
+    std::begin(m_residentTextures),
+    std::end(m_residentTextures),
+    [](const auto* texture) { return texture->reloading(); });
+}
+
 const Texture* TextureManager::texture(const std::string& name) const
 {
   auto it = m_texturesByName.find(kdl::str_to_lower(name));
@@ -223,10 +347,27 @@ void TextureManager::prepare()
   m_toPrepare.clear();
 }
 
+void TextureManager::finishReloads()
+{
+  for (const auto* texture : m_residentTextures)
+  {
+    texture->finishReload();
+  }
+}
+
 void TextureManager::updateTextures()
 {
   m_texturesByName.clear();
   m_textures.clear();
+  m_residentTextures.clear();
+
+  m_texturesByName.reserve(std::accumulate(
+    std::begin(m_collections),
+    std::end(m_collections),
+    size_t(0),
+    [](const auto count, const auto& collection) {
+      return count + collection.textureCount();
+    }));
 
   for (auto& collection : m_collections)
   {
@@ -234,6 +375,10 @@ void TextureManager::updateTextures()
     {
       const auto key = kdl::str_to_lower(texture.name());
       texture.setOverridden(false);
+      if (texture.evictable())
+      {
+        texture.setResidencyList(&m_residentTextures);
+      }
 
       auto mIt = m_texturesByName.find(key);
       if (mIt != std::end(m_texturesByName))
@@ -248,9 +393,19 @@ void TextureManager::updateTextures()
     }
   }
 
-  m_textures = kdl::vec_transform(kdl::map_values(m_texturesByName), [](auto* t) {
-    return const_cast<const Texture*>(t);
+  // keep the textures ordered by their lower case names
+  auto entries = std::vector<const TextureMap::value_type*>{};
+  entries.reserve(m_texturesByName.size());
+  for (const auto& entry : m_texturesByName)
+  {
+    entries.push_back(&entry);
+  }
+  std::sort(std::begin(entries), std::end(entries), [](const auto* lhs, const auto* rhs) {
+    return lhs->first < rhs->first;
   });
+
+  m_textures = kdl::vec_transform(
+    entries, [](const auto* entry) { return const_cast<const Texture*>(entry->second); });
 }
 } // namespace Assets
 } // namespace TrenchBroom
@@ -19,10 +19,13 @@
 
 #pragma once
 
+#include "Assets/Texture.h"
 #include "Assets/TextureCollection.h"
 
-#include <map>
+#include <chrono>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace TrenchBroom
@@ -37,13 +40,12 @@ class TextureLoader;
 
 namespace Assets
 {
-class Texture;
 class TextureCollection;
 
 class TextureManager
 {
 private:
-  using TextureMap = std::map<std::string, Texture*>;
+  using TextureMap = std::unordered_map<std::string, Texture*>;
 
   Logger& m_logger;
 
@@ -55,10 +57,21 @@ private:
   TextureMap m_texturesByName;
   std::vector<const Texture*> m_textures;
 
+  /**
+   * The evictable textures that occupy memory. Textures add themselves to this list when
+   * they are uploaded or start to be decoded again after they were evicted.
+   */
+  Texture::ResidencyList m_residentTextures;
+
   int m_minFilter;
   int m_magFilter;
   bool m_resetTextureMode;
 
+  size_t m_cacheSize;
+  std::optional<std::chrono::steady_clock::time_point> m_lastEviction;
+
+  bool m_compressTextures;
+
 public:
   TextureManager(int magFilter, int minFilter, Logger& logger);
   ~TextureManager();
@@ -69,13 +82,49 @@ public:
 
 private:
   void addTextureCollection(Assets::TextureCollection collection);
+  void compressTextures(Assets::TextureCollection& collection);
 
 public:
   void clear();
 
   void setTextureMode(int minFilter, int magFilter);
+
+  /**
+   * Sets the number of bytes that evictable textures may occupy. If they occupy more
+   * memory, the least recently used textures are evicted when changes are committed.
+   */
+  void setCacheSize(size_t cacheSize);
+
+  /**
+   * Sets whether the textures of collections added from now on are compressed. Already
+   * loaded textures are not affected.
+   */
+  void setCompressTextures(bool compressTextures);
+
+  /**
+   * Prepares added textures, uploads textures that were decoded again, releases removed
+   * textures and evicts textures if necessary. Must be called with a current GL context.
+   */
   void commitChanges();
 
+  /**
+   * Evicts the least recently used textures until the evictable textures fit into the
+   * cache. Does nothing if the previous eviction happened less than a second before the
+   * given time, so that several views committing changes in the same frame cause at most
+   * one eviction. Textures that were activated within a few seconds before the given time
+   * are likely still visible and are never evicted.
+   *
+   * Must be called with a current GL context.
+   */
+  void evictTextures(std::chrono::steady_clock::time_point now);
+
+  /**
+   * Indicates whether any evicted texture is being decoded again or waits to be uploaded.
+   * Views that render textures should render again while this is the case, so that the
+   * placeholders of these textures are replaced once their data arrives.
+   */
+  bool hasPendingReloads() const;
+
   const Texture* texture(const std::string& name) const;
   Texture* texture(const std::string& name);
 
@@ -85,6 +134,7 @@ public:
 private:
   void resetTextureMode();
   void prepare();
+  void finishReloads();
 
   void updateTextures();
 };
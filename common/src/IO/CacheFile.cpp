@@ -0,0 +1,94 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CacheFile.h"
+
+#include "Exceptions.h"
+#include "IO/DiskIO.h"
+#include "IO/IOUtils.h"
+#include "IO/Path.h"
+#include "IO/Reader.h"
+#include "IO/ReaderException.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace TrenchBroom
+{
+namespace IO
+{
+uint64_t hashBytes(const std::string_view bytes, uint64_t hash)
+{
+  for (const auto c : bytes)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= HashPrime;
+  }
+  return hash;
+}
+
+size_t readSize(Reader& reader)
+{
+  return reader.readSize<uint64_t>();
+}
+
+size_t readCount(Reader& reader, const size_t minElementSize)
+{
+  const auto count = readSize(reader);
+  if (!reader.canRead(count * minElementSize))
+  {
+    throw ReaderException{"Invalid element count in cache file"};
+  }
+  return count;
+}
+
+std::string readString(Reader& reader)
+{
+  return reader.readString(readCount(reader, 1u));
+}
+
+std::string readCacheFile(const Path& cachePath)
+{
+  auto stream = openPathAsInputStream(cachePath, std::ios::in | std::ios::binary);
+  if (!stream)
+  {
+    throw FileSystemException{"Could not open file '" + cachePath.asString() + "'"};
+  }
+  return std::string{
+    std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+}
+
+void replaceCacheFile(const Path& cachePath, const std::string& contents)
+{
+  Disk::ensureDirectoryExists(cachePath.deleteLastComponent());
+
+  const auto tempPath = cachePath.addExtension("tmp");
+  {
+    auto stream = openPathAsOutputStream(tempPath, std::ios::out | std::ios::binary);
+    stream.write(contents.data(), std::streamsize(contents.size()));
+    if (!stream)
+    {
+      throw FileSystemException{"Could not write file '" + tempPath.asString() + "'"};
+    }
+  }
+  Disk::moveFile(tempPath, cachePath, true);
+}
+} // namespace IO
+} // namespace TrenchBroom
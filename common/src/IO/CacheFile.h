@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace TrenchBroom
+{
+namespace IO
+{
+class Path;
+class Reader;
+
+// 64 bit FNV-1a
+constexpr auto HashBasis = uint64_t(14695981039346656037u);
+constexpr auto HashPrime = uint64_t(1099511628211u);
+
+uint64_t hashBytes(std::string_view bytes, uint64_t hash = HashBasis);
+
+/**
+ * Builds the contents of a binary cache file.
+ */
+class CacheWriter
+{
+private:
+  std::string m_buffer;
+
+public:
+  template <typename T>
+  void write(const T value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    m_buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void writeSize(const size_t value) { write(static_cast<uint64_t>(value)); }
+
+  void writeString(const std::string& str)
+  {
+    writeSize(str.size());
+    m_buffer.append(str);
+  }
+
+  void writeBytes(const unsigned char* bytes, const size_t size)
+  {
+    writeSize(size);
+    m_buffer.append(reinterpret_cast<const char*>(bytes), size);
+  }
+
+  const std::string& buffer() const { return m_buffer; }
+};
+
+size_t readSize(Reader& reader);
+
+/**
+ * Reads a number of elements and checks that the reader contains enough data for them,
+ * so that corrupt files don't cause huge allocations.
+ */
+size_t readCount(Reader& reader, size_t minElementSize);
+
+std::string readString(Reader& reader);
+
+std::string readCacheFile(const Path& cachePath);
+
+/**
+ * Writes the given contents to a temporary file first and then moves it to the given
+ * path, so that other instances never see partial files. The directory that contains the
+ * cache file is created if necessary.
+ */
+void replaceCacheFile(const Path& cachePath, const std::string& contents);
+} // namespace IO
+} // namespace TrenchBroom
@@ -84,6 +84,11 @@ std::shared_ptr<File> DiskFileSystem::doOpenFile(const Path& path) const
   return std::make_shared<FileView>(path, file, 0u, file->size());
 }
 
+Path DiskFileSystem::doGetHostFile(const Path& path) const
+{
+  return doMakeAbsolute(path);
+}
+
 WritableDiskFileSystem::WritableDiskFileSystem(const Path& root, const bool create)
   : WritableDiskFileSystem(nullptr, root, create)
 {
@@ -52,6 +52,7 @@ protected:
 
   std::vector<Path> doGetDirectoryContents(const Path& path) const override;
   std::shared_ptr<File> doOpenFile(const Path& path) const override;
+  Path doGetHostFile(const Path& path) const override;
 };
 
 #ifdef _MSC_VER
@@ -25,11 +25,15 @@
 #include "IO/IOUtils.h"
 #include "IO/PathQt.h"
 
-#include <kdl/string_compare.h>
+#include <kdl/string_format.h>
 
 #include <fstream>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
 
+#include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
 
@@ -39,8 +43,108 @@ namespace IO
 {
 namespace Disk
 {
+namespace
+{
+/**
+ * Caches the entries of directories by their lower case names so that fixing the case of
+ * many paths within the same directories does not list these directories again and again.
+ *
+ * A directory is scanned again if its modification time has changed. Since the
+ * modification time may have a resolution of up to two seconds, a directory is also
+ * scanned again if it was modified shortly before it was last scanned, because a change
+ * within the same time step would otherwise go unnoticed.
+ *
+ * To bound its memory usage, the index forgets all directories once it holds too many of
+ * them. It is also cleared whenever a game file system is initialized or refreshed.
+ */
+class DirectoryIndex
+{
+private:
+  static constexpr qint64 SettleTimeMs = 2000;
+  static constexpr size_t MaxDirectoryCount = 4096u;
+
+  struct Directory
+  {
+    QDateTime modificationTime;
+    QDateTime scanTime;
+    std::unordered_map<std::string, Path> entries;
+  };
+
+  std::mutex m_mutex;
+  std::unordered_map<std::string, Directory> m_directories;
+
+public:
+  /**
+   * Returns the entry of the given directory whose name matches the given name without
+   * regard to case. If the directory has several such entries, the one that is listed
+   * first is returned.
+   *
+   * @throw FileSystemException if the given directory does not exist
+   */
+  std::optional<Path> findEntry(const Path& directoryPath, const Path& name)
+  {
+    const auto fileInfo = QFileInfo{pathAsQString(directoryPath)};
+    if (!fileInfo.isDir())
+    {
+      throw FileSystemException(
+        "Cannot open directory: '" + directoryPath.asString() + "'");
+    }
+
+    const auto modificationTime = fileInfo.lastModified();
+
+    const auto lock = std::lock_guard<std::mutex>{m_mutex};
+    if (
+      m_directories.size() >= MaxDirectoryCount
+      && m_directories.count(directoryPath.asString()) == 0u)
+    {
+      m_directories.clear();
+    }
+
+    auto& directory = m_directories[directoryPath.asString()];
+    if (
+      directory.modificationTime != modificationTime
+      || directory.modificationTime.msecsTo(directory.scanTime) < SettleTimeMs)
+    {
+      directory.modificationTime = modificationTime;
+      directory.scanTime = QDateTime::currentDateTime();
+      directory.entries.clear();
+
+      auto dir = QDir{pathAsQString(directoryPath)};
+      dir.setFilter(QDir::NoDotAndDotDot | QDir::AllEntries);
+      for (const auto& entry : dir.entryList())
+      {
+        auto entryPath = pathFromQString(entry);
+        directory.entries.try_emplace(
+          kdl::str_to_lower(entryPath.asString()), std::move(entryPath));
+      }
+    }
+
+    const auto it = directory.entries.find(kdl::str_to_lower(name.asString()));
+    if (it == std::end(directory.entries))
+    {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  /**
+   * Forgets all cached directories.
+   */
+  void clear()
+  {
+    const auto lock = std::lock_guard<std::mutex>{m_mutex};
+    m_directories.clear();
+  }
+};
+
+DirectoryIndex& directoryIndex()
+{
+  static auto index = DirectoryIndex{};
+  return index;
+}
+} // namespace
+
 bool doCheckCaseSensitive();
-Path findCaseSensitivePath(const std::vector<Path>& list, const Path& path);
 Path fixCase(const Path& path);
 
 bool doCheckCaseSensitive()
@@ -59,16 +163,6 @@ bool isCaseSensitive()
   return caseSensitive;
 }
 
-Path findCaseSensitivePath(const std::vector<Path>& list, const Path& path)
-{
-  for (const Path& entry : list)
-  {
-    if (kdl::ci::str_is_equal(entry.asString(), path.asString()))
-      return entry;
-  }
-  return Path("");
-}
-
 Path fixCase(const Path& path)
 {
   try
@@ -92,11 +186,10 @@ Path fixCase(const Path& path)
       const QString nextPathStr = pathAsQString(result + remainder.firstComponent());
       if (!QFileInfo::exists(nextPathStr))
       {
-        const std::vector<Path> content = getDirectoryContents(result);
-        const Path part = findCaseSensitivePath(content, remainder.firstComponent());
-        if (part.isEmpty())
+        const auto part = directoryIndex().findEntry(result, remainder.firstComponent());
+        if (!part)
           return path;
-        result = result + part;
+        result = result + *part;
       }
       else
       {
@@ -126,6 +219,11 @@ Path fixPath(const Path& path)
   }
 }
 
+void clearDirectoryCache()
+{
+  directoryIndex().clear();
+}
+
 bool directoryExists(const Path& path)
 {
   const Path fixedPath = fixPath(path);
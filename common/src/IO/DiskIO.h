@@ -36,6 +36,11 @@ bool isCaseSensitive();
 
 Path fixPath(const Path& path);
 
+/**
+ * Forgets the directory entries that fixPath has cached to fix the case of paths.
+ */
+void clearDirectoryCache();
+
 bool directoryExists(const Path& path);
 bool fileExists(const Path& path);
 
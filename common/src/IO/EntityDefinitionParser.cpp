@@ -387,17 +387,22 @@ std::vector<EntityDefinitionClassInfo> resolveInheritance(
   ParserStatus& status, const std::vector<EntityDefinitionClassInfo>& classInfos)
 {
   const auto filteredClassInfos = filterRedundantClasses(status, classInfos);
+
+  // index the classes by name so that super classes can be found without scanning all
+  // classes, the classes of each name remain in the order of their declaration
+  auto classInfosByName =
+    std::unordered_map<std::string, std::vector<const EntityDefinitionClassInfo*>>{};
+  classInfosByName.reserve(filteredClassInfos.size());
+  for (const auto& classInfo : filteredClassInfos)
+  {
+    classInfosByName[classInfo.name].push_back(&classInfo);
+  }
+
+  const auto noClassInfos = std::vector<const EntityDefinitionClassInfo*>{};
   const auto findClassInfos =
-    [&](const auto& name) -> std::vector<const EntityDefinitionClassInfo*> {
-    std::vector<const EntityDefinitionClassInfo*> result;
-    for (const auto& classInfo : filteredClassInfos)
-    {
-      if (classInfo.name == name)
-      {
-        result.push_back(&classInfo);
-      }
-    }
-    return result;
+    [&](const auto& name) -> const std::vector<const EntityDefinitionClassInfo*>& {
+    const auto it = classInfosByName.find(name);
+    return it != std::end(classInfosByName) ? it->second : noClassInfos;
   };
 
   std::vector<EntityDefinitionClassInfo> result;
@@ -443,8 +448,8 @@ std::unique_ptr<Assets::EntityDefinition> EntityDefinitionParser::createDefiniti
 std::vector<Assets::EntityDefinition*> EntityDefinitionParser::createDefinitions(
   ParserStatus& status, const std::vector<EntityDefinitionClassInfo>& classInfos) const
 {
-  const auto resolvedClasses =
-    resolveInheritance(status, filterRedundantClasses(status, classInfos));
+  // redundant classes are filtered out when resolving the inheritance
+  const auto resolvedClasses = resolveInheritance(status, classInfos);
 
   std::vector<Assets::EntityDefinition*> result;
   for (const auto& classInfo : resolvedClasses)
@@ -0,0 +1,707 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntityModelCache.h"
+
+#include "Assets/EntityModel.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureBuffer.h"
+#include "Color.h"
+#include "Exceptions.h"
+#include "IO/CacheFile.h"
+#include "IO/DiskIO.h"
+#include "IO/File.h"
+#include "IO/FileSystem.h"
+#include "IO/PathQt.h"
+#include "IO/Reader.h"
+#include "IO/ReaderException.h"
+#include "Logger.h"
+#include "Renderer/IndexRangeMap.h"
+#include "Renderer/PrimType.h"
+#include "Renderer/TexturedIndexRangeMap.h"
+
+#include <kdl/vector_utils.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace TrenchBroom
+{
+namespace IO
+{
+namespace
+{
+// Increment whenever the cache format or the output of a model parser changes.
+constexpr auto CacheVersion = uint32_t(1);
+constexpr auto ModelMagic = uint32_t(0x4d454254); // "TBEM"
+constexpr auto FrameMagic = uint32_t(0x46454254); // "TBEF"
+constexpr auto NoTexture = std::numeric_limits<uint64_t>::max();
+
+enum class MeshType : uint8_t
+{
+  None,
+  Indexed,
+  Textured
+};
+
+template <typename T>
+uint64_t hashValue(const T& value, const uint64_t hash)
+{
+  return hashBytes(
+    std::string_view{reinterpret_cast<const char*>(&value), sizeof(T)}, hash);
+}
+
+uint64_t hashFile(const FileSystem& fs, const Path& path)
+{
+  const auto file = fs.openFile(path);
+  const auto reader = file->reader().buffer();
+  return hashBytes(reader.stringView());
+}
+
+struct Source
+{
+  Path path;
+  uint64_t hash;
+};
+
+uint64_t combineSourceHashes(const std::vector<Source>& sources)
+{
+  auto result = hashValue(CacheVersion, HashBasis);
+  for (const auto& source : sources)
+  {
+    result = hashBytes(source.path.asString(), result);
+    result = hashValue(source.hash, result);
+  }
+  return result;
+}
+
+void writeHeader(CacheWriter& writer, const uint32_t magic, const Path& path)
+{
+  writer.write(magic);
+  writer.write(CacheVersion);
+  writer.writeString(path.asString());
+}
+
+bool readHeader(Reader& reader, const uint32_t magic, const Path& path)
+{
+  return reader.readUnsignedInt<uint32_t>() == magic
+         && reader.readUnsignedInt<uint32_t>() == CacheVersion
+         && readString(reader) == path.asString();
+}
+
+void writeTexture(CacheWriter& writer, const Assets::Texture& texture)
+{
+  const auto& buffers = texture.buffersIfUnprepared();
+  if (buffers.empty())
+  {
+    throw AssetException{"Texture data of skin '" + texture.name() + "' is not available"};
+  }
+
+  writer.writeString(texture.name());
+  writer.writeSize(texture.width());
+  writer.writeSize(texture.height());
+  writer.write(texture.averageColor().r());
+  writer.write(texture.averageColor().g());
+  writer.write(texture.averageColor().b());
+  writer.write(texture.averageColor().a());
+  writer.write(static_cast<uint32_t>(texture.format()));
+  writer.write(static_cast<uint32_t>(texture.type()));
+  writer.writeSize(buffers.size());
+  for (const auto& buffer : buffers)
+  {
+    writer.writeBytes(buffer.data(), buffer.size());
+  }
+}
+
+Assets::Texture readTexture(Reader& reader)
+{
+  const auto name = readString(reader);
+  const auto width = readSize(reader);
+  const auto height = readSize(reader);
+  const auto r = reader.readFloat<float>();
+  const auto g = reader.readFloat<float>();
+  const auto b = reader.readFloat<float>();
+  const auto a = reader.readFloat<float>();
+  const auto format = static_cast<GLenum>(reader.readUnsignedInt<uint32_t>());
+  const auto type = static_cast<Assets::TextureType>(reader.readUnsignedInt<uint32_t>());
+
+  const auto bufferCount = readCount(reader, sizeof(uint64_t));
+  auto buffers = std::vector<Assets::TextureBuffer>{};
+  buffers.reserve(bufferCount);
+  for (size_t i = 0u; i < bufferCount; ++i)
+  {
+    const auto size = readCount(reader, 1u);
+    auto& buffer = buffers.emplace_back(size);
+    reader.read(buffer.data(), size);
+  }
+
+  return Assets::Texture{
+    name, width, height, Color{r, g, b, a}, std::move(buffers), format, type};
+}
+
+struct Primitive
+{
+  uint64_t texture;
+  Renderer::PrimType primType;
+  size_t index;
+  size_t count;
+};
+
+struct MeshData
+{
+  MeshType type = MeshType::None;
+  std::vector<Assets::EntityModelVertex> vertices;
+  std::vector<Primitive> primitives;
+};
+
+struct FrameData
+{
+  std::string name;
+  vm::bbox3f bounds;
+  std::vector<MeshData> meshes;
+};
+
+uint64_t skinIndex(const Assets::EntityModelSurface& surface, const Assets::Texture* skin)
+{
+  for (size_t i = 0u; i < surface.skinCount(); ++i)
+  {
+    if (surface.skin(i) == skin)
+    {
+      return uint64_t(i);
+    }
+  }
+  return NoTexture;
+}
+
+void writeVertices(
+  CacheWriter& writer, const std::vector<Assets::EntityModelVertex>& vertices)
+{
+  writer.writeSize(vertices.size());
+  for (const auto& vertex : vertices)
+  {
+    const auto& position = Renderer::getVertexComponent<0>(vertex);
+    const auto& texCoords = Renderer::getVertexComponent<1>(vertex);
+    writer.write(position.x());
+    writer.write(position.y());
+    writer.write(position.z());
+    writer.write(texCoords.x());
+    writer.write(texCoords.y());
+  }
+}
+
+void writePrimitives(CacheWriter& writer, const std::vector<Primitive>& primitives)
+{
+  writer.writeSize(primitives.size());
+  for (const auto& primitive : primitives)
+  {
+    writer.write(primitive.texture);
+    writer.write(static_cast<uint32_t>(primitive.primType));
+    writer.writeSize(primitive.index);
+    writer.writeSize(primitive.count);
+  }
+}
+
+void writeFrame(
+  CacheWriter& writer,
+  const Assets::EntityModel& model,
+  const Assets::EntityModelFrame& frame)
+{
+  writer.writeString(frame.name());
+  writer.write(frame.bounds().min.x());
+  writer.write(frame.bounds().min.y());
+  writer.write(frame.bounds().min.z());
+  writer.write(frame.bounds().max.x());
+  writer.write(frame.bounds().max.y());
+  writer.write(frame.bounds().max.z());
+
+  for (const auto* surface : model.surfaces())
+  {
+    auto meshType = MeshType::None;
+    surface->visitMesh(
+      frame.index(),
+      [&](const auto& vertices, const Assets::EntityModelIndices& indices) {
+        meshType = MeshType::Indexed;
+        writer.write(meshType);
+        writeVertices(writer, vertices);
+
+        auto primitives = std::vector<Primitive>{};
+        indices.forEachPrimitive([&](const auto primType, const auto index, const auto count) {
+          primitives.push_back(Primitive{NoTexture, primType, index, count});
+        });
+        writePrimitives(writer, primitives);
+      },
+      [&](const auto& vertices, const Assets::EntityModelTexturedIndices& indices) {
+        meshType = MeshType::Textured;
+        writer.write(meshType);
+        writeVertices(writer, vertices);
+
+        auto primitives = std::vector<Primitive>{};
+        indices.forEachPrimitive(
+          [&](const auto* texture, const auto primType, const auto index, const auto count) {
+            primitives.push_back(
+              Primitive{skinIndex(*surface, texture), primType, index, count});
+          });
+        writePrimitives(writer, primitives);
+      });
+
+    if (meshType == MeshType::None)
+    {
+      writer.write(meshType);
+    }
+  }
+}
+
+FrameData readFrame(Reader& reader, const size_t surfaceCount)
+{
+  auto result = FrameData{};
+  result.name = readString(reader);
+
+  const auto minX = reader.readFloat<float>();
+  const auto minY = reader.readFloat<float>();
+  const auto minZ = reader.readFloat<float>();
+  const auto maxX = reader.readFloat<float>();
+  const auto maxY = reader.readFloat<float>();
+  const auto maxZ = reader.readFloat<float>();
+  result.bounds = vm::bbox3f{vm::vec3f{minX, minY, minZ}, vm::vec3f{maxX, maxY, maxZ}};
+
+  result.meshes.resize(surfaceCount);
+  for (auto& mesh : result.meshes)
+  {
+    mesh.type = static_cast<MeshType>(reader.readUnsignedChar<uint8_t>());
+    if (mesh.type == MeshType::None)
+    {
+      continue;
+    }
+    if (mesh.type != MeshType::Indexed && mesh.type != MeshType::Textured)
+    {
+      throw ReaderException{"Invalid mesh type in entity model cache file"};
+    }
+
+    const auto vertexCount = readCount(reader, 5u * sizeof(float));
+    mesh.vertices.reserve(vertexCount);
+    for (size_t i = 0u; i < vertexCount; ++i)
+    {
+      const auto position = reader.readVec<float, 3>();
+      const auto texCoords = reader.readVec<float, 2>();
+      mesh.vertices.emplace_back(position, texCoords);
+    }
+
+    const auto primitiveCount =
+      readCount(reader, 3u * sizeof(uint64_t) + sizeof(uint32_t));
+    mesh.primitives.reserve(primitiveCount);
+    for (size_t i = 0u; i < primitiveCount; ++i)
+    {
+      const auto texture = reader.read<uint64_t, uint64_t>();
+      const auto primType =
+        static_cast<Renderer::PrimType>(reader.readUnsignedInt<uint32_t>());
+      const auto index = readSize(reader);
+      const auto count = readSize(reader);
+      mesh.primitives.push_back(Primitive{texture, primType, index, count});
+    }
+  }
+
+  return result;
+}
+
+void addFrame(
+  Assets::EntityModel& model, const size_t frameIndex, const FrameData& frameData)
+{
+  auto& frame = model.loadFrame(frameIndex, frameData.name, frameData.bounds);
+  for (size_t i = 0u; i < frameData.meshes.size(); ++i)
+  {
+    const auto& mesh = frameData.meshes[i];
+    auto& surface = model.surface(i);
+
+    if (mesh.type == MeshType::Indexed)
+    {
+      auto size = Renderer::IndexRangeMap::Size{};
+      for (const auto& primitive : mesh.primitives)
+      {
+        size.inc(primitive.primType);
+      }
+
+      auto indices = Assets::EntityModelIndices{size};
+      for (const auto& primitive : mesh.primitives)
+      {
+        indices.add(primitive.primType, primitive.index, primitive.count);
+      }
+      surface.addIndexedMesh(frame, mesh.vertices, std::move(indices));
+    }
+    else if (mesh.type == MeshType::Textured)
+    {
+      const auto getSkin = [&](const uint64_t index) {
+        return index != NoTexture ? surface.skin(size_t(index)) : nullptr;
+      };
+
+      auto size = Renderer::TexturedIndexRangeMap::Size{};
+      for (const auto& primitive : mesh.primitives)
+      {
+        size.inc(getSkin(primitive.texture), primitive.primType);
+      }
+
+      auto indices = Assets::EntityModelTexturedIndices{size};
+      for (const auto& primitive : mesh.primitives)
+      {
+        indices.add(
+          getSkin(primitive.texture), primitive.primType, primitive.index, primitive.count);
+      }
+      surface.addTexturedMesh(frame, mesh.vertices, std::move(indices));
+    }
+  }
+}
+
+std::unique_ptr<Assets::EntityModel> readModel(Reader& reader)
+{
+  const auto name = readString(reader);
+  const auto pitchType = static_cast<Assets::PitchType>(reader.readUnsignedInt<uint32_t>());
+  const auto orientation =
+    static_cast<Assets::Orientation>(reader.readUnsignedInt<uint32_t>());
+
+  auto model = std::make_unique<Assets::EntityModel>(name, pitchType, orientation);
+
+  const auto frameCount = readCount(reader, sizeof(uint64_t));
+  for (size_t i = 0u; i < frameCount; ++i)
+  {
+    model->addFrame().setSkinOffset(readSize(reader));
+  }
+
+  const auto surfaceCount = readCount(reader, sizeof(uint64_t));
+  for (size_t i = 0u; i < surfaceCount; ++i)
+  {
+    auto& surface = model->addSurface(readString(reader));
+
+    const auto skinCount = readCount(reader, sizeof(uint64_t));
+    auto skins = std::vector<Assets::Texture>{};
+    skins.reserve(skinCount);
+    for (size_t j = 0u; j < skinCount; ++j)
+    {
+      skins.push_back(readTexture(reader));
+    }
+    surface.setSkins(std::move(skins));
+  }
+
+  const auto loadedFrameCount = readCount(reader, sizeof(uint64_t));
+  for (size_t i = 0u; i < loadedFrameCount; ++i)
+  {
+    const auto frameIndex = readSize(reader);
+    addFrame(*model, frameIndex, readFrame(reader, surfaceCount));
+  }
+
+  return model;
+}
+
+void writeModel(CacheWriter& writer, const Assets::EntityModel& model)
+{
+  writer.writeString(model.name());
+  writer.write(static_cast<uint32_t>(model.pitchType()));
+  writer.write(static_cast<uint32_t>(model.orientation()));
+
+  const auto frames = model.frames();
+  writer.writeSize(frames.size());
+  for (const auto* frame : frames)
+  {
+    writer.writeSize(frame->skinOffset());
+  }
+
+  const auto surfaces = model.surfaces();
+  writer.writeSize(surfaces.size());
+  for (const auto* surface : surfaces)
+  {
+    writer.writeString(surface->name());
+    writer.writeSize(surface->skinCount());
+    for (size_t i = 0u; i < surface->skinCount(); ++i)
+    {
+      writeTexture(writer, *surface->skin(i));
+    }
+  }
+
+  auto loadedFrameCount = size_t(0);
+  for (const auto* frame : frames)
+  {
+    if (frame->loaded())
+    {
+      ++loadedFrameCount;
+    }
+  }
+
+  writer.writeSize(loadedFrameCount);
+  for (const auto* frame : frames)
+  {
+    if (frame->loaded())
+    {
+      writer.writeSize(frame->index());
+      writeFrame(writer, model, *frame);
+    }
+  }
+}
+
+/**
+ * Deletes the least recently written files in the given directory until the total size of
+ * the remaining files does not exceed the given maximum size.
+ */
+void pruneCacheDirectory(const Path& directory, const size_t maxSize)
+{
+  const auto dir = QDir{pathAsQString(directory)};
+  auto totalSize = size_t(0);
+  for (const auto& fileInfo : dir.entryInfoList(QDir::Files, QDir::Time))
+  {
+    totalSize += static_cast<size_t>(fileInfo.size());
+    if (totalSize > maxSize)
+    {
+      QFile::remove(fileInfo.absoluteFilePath());
+    }
+  }
+}
+} // namespace
+
+EntityModelCache::EntityModelCache(Path directory, const size_t maxSize)
+  : m_directory{std::move(directory)}
+{
+  pruneCacheDirectory(m_directory, maxSize);
+}
+
+std::unique_ptr<Assets::EntityModel> EntityModelCache::readModel(
+  const FileSystem& fs, const Path& path, FileHashes& hashes, Logger& logger)
+{
+  // frames must not be validated against a previously cached version of the model
+  setSourceHash(path, std::nullopt);
+
+  const auto cachePath = modelCachePath(path);
+  if (!cacheFileExists(cachePath))
+  {
+    return nullptr;
+  }
+
+  try
+  {
+    const auto contents = readCacheFile(cachePath);
+    auto reader = Reader::from(contents.data(), contents.data() + contents.size());
+    if (!readHeader(reader, ModelMagic, path))
+    {
+      return nullptr;
+    }
+
+    auto sources = std::vector<Source>{};
+    const auto sourceCount = readCount(reader, 2u * sizeof(uint64_t));
+    for (size_t i = 0u; i < sourceCount; ++i)
+    {
+      auto sourcePath = Path{readString(reader)};
+      const auto hash = reader.read<uint64_t, uint64_t>();
+      const auto exists = fs.fileExists(sourcePath);
+      if (exists)
+      {
+        hashes[sourcePath] = hashFile(fs, sourcePath);
+      }
+      if (!exists || hashes[sourcePath] != hash)
+      {
+        logger.debug() << "Entity model cache for " << path << " is out of date";
+        return nullptr;
+      }
+      sources.push_back(Source{std::move(sourcePath), hash});
+    }
+
+    auto model = IO::readModel(reader);
+    setSourceHash(path, combineSourceHashes(sources));
+
+    logger.debug() << "Loaded entity model " << path << " from cache";
+    return model;
+  }
+  catch (const std::exception& e)
+  {
+    logger.debug() << "Could not read entity model cache for " << path << ": "
+                   << e.what();
+    return nullptr;
+  }
+}
+
+void EntityModelCache::writeModel(
+  const FileSystem& fs,
+  const Path& path,
+  const std::vector<Path>& sourcePaths,
+  const FileHashes& hashes,
+  const Assets::EntityModel& model,
+  Logger& logger)
+{
+  setSourceHash(path, std::nullopt);
+
+  try
+  {
+    const auto sources = kdl::vec_transform(sourcePaths, [&](const auto& sourcePath) {
+      const auto it = hashes.find(sourcePath);
+      return Source{
+        sourcePath, it != std::end(hashes) ? it->second : hashFile(fs, sourcePath)};
+    });
+
+    auto writer = CacheWriter{};
+    writeHeader(writer, ModelMagic, path);
+    writer.writeSize(sources.size());
+    for (const auto& source : sources)
+    {
+      writer.writeString(source.path.asString());
+      writer.write(source.hash);
+    }
+    IO::writeModel(writer, model);
+
+    writeCacheFile(modelCachePath(path), writer.buffer());
+    setSourceHash(path, combineSourceHashes(sources));
+  }
+  catch (const std::exception& e)
+  {
+    logger.debug() << "Could not write entity model cache for " << path << ": "
+                   << e.what();
+  }
+}
+
+bool EntityModelCache::readFrame(
+  const Path& path, const size_t frameIndex, Assets::EntityModel& model, Logger& logger)
+{
+  const auto hash = sourceHash(path);
+  const auto cachePath = frameCachePath(path, frameIndex);
+  if (!hash || !cacheFileExists(cachePath))
+  {
+    return false;
+  }
+
+  try
+  {
+    const auto contents = readCacheFile(cachePath);
+    auto reader = Reader::from(contents.data(), contents.data() + contents.size());
+    if (
+      !readHeader(reader, FrameMagic, path)
+      || reader.read<uint64_t, uint64_t>() != *hash || readSize(reader) != frameIndex)
+    {
+      return false;
+    }
+
+    const auto frameData = IO::readFrame(reader, model.surfaceCount());
+    addFrame(model, frameIndex, frameData);
+    return true;
+  }
+  catch (const std::exception& e)
+  {
+    logger.debug() << "Could not read entity model frame cache for " << path << ": "
+                   << e.what();
+    return false;
+  }
+}
+
+void EntityModelCache::writeFrame(
+  const Path& path,
+  const size_t frameIndex,
+  const Assets::EntityModel& model,
+  Logger& logger)
+{
+  const auto hash = sourceHash(path);
+  const auto* frame = model.frame(frameIndex);
+  if (!hash || frame == nullptr || !frame->loaded())
+  {
+    return;
+  }
+
+  try
+  {
+    auto writer = CacheWriter{};
+    writeHeader(writer, FrameMagic, path);
+    writer.write(*hash);
+    writer.writeSize(frameIndex);
+    IO::writeFrame(writer, model, *frame);
+
+    writeCacheFile(frameCachePath(path, frameIndex), writer.buffer());
+  }
+  catch (const std::exception& e)
+  {
+    logger.debug() << "Could not write entity model frame cache for " << path << ": "
+                   << e.what();
+  }
+}
+
+Path EntityModelCache::modelCachePath(const Path& path) const
+{
+  auto str = std::stringstream{};
+  str << std::hex << hashBytes(path.asString()) << ".model";
+  return m_directory + Path{str.str()};
+}
+
+Path EntityModelCache::frameCachePath(const Path& path, const size_t frameIndex) const
+{
+  auto str = std::stringstream{};
+  str << std::hex << hashBytes(path.asString()) << "_" << std::dec << frameIndex
+      << ".frame";
+  return m_directory + Path{str.str()};
+}
+
+std::optional<uint64_t> EntityModelCache::sourceHash(const Path& path) const
+{
+  const auto lock = std::lock_guard<std::mutex>{m_mutex};
+  const auto it = m_sourceHashes.find(path);
+  return it != std::end(m_sourceHashes) ? std::optional<uint64_t>{it->second}
+                                        : std::nullopt;
+}
+
+void EntityModelCache::setSourceHash(const Path& path, std::optional<uint64_t> hash)
+{
+  const auto lock = std::lock_guard<std::mutex>{m_mutex};
+  if (hash)
+  {
+    m_sourceHashes[path] = *hash;
+  }
+  else
+  {
+    m_sourceHashes.erase(path);
+  }
+}
+
+bool EntityModelCache::cacheFileExists(const Path& cachePath)
+{
+  // remember missing files so that models which are not cached are only probed once
+  {
+    const auto lock = std::lock_guard<std::mutex>{m_mutex};
+    if (m_missingCacheFiles.count(cachePath) > 0u)
+    {
+      return false;
+    }
+  }
+  if (!Disk::fileExists(cachePath))
+  {
+    const auto lock = std::lock_guard<std::mutex>{m_mutex};
+    m_missingCacheFiles.insert(cachePath);
+    return false;
+  }
+  return true;
+}
+
+void EntityModelCache::writeCacheFile(const Path& cachePath, const std::string& contents)
+{
+  replaceCacheFile(cachePath, contents);
+
+  const auto lock = std::lock_guard<std::mutex>{m_mutex};
+  m_missingCacheFiles.erase(cachePath);
+}
+} // namespace IO
+} // namespace TrenchBroom
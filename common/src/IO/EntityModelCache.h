@@ -0,0 +1,135 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "IO/Path.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace TrenchBroom
+{
+class Logger;
+
+namespace Assets
+{
+class EntityModel;
+}
+
+namespace IO
+{
+class FileSystem;
+
+/**
+ * Stores parsed entity models, including their decoded skins and loaded frames, in a
+ * directory on disk.
+ *
+ * Every cached model records the files that were read while parsing it, e.g. the model
+ * file itself, its skins and the palette, together with a hash of their contents. A
+ * cached model is only used if all of these files are unchanged and the cache format
+ * version matches. Frames that are loaded after a model was initialized are stored in
+ * separate files and are only used for models that were read from or written to the
+ * cache in the current session.
+ *
+ * When the cache is created, the least recently written cache files are deleted until the
+ * total size of the cache directory does not exceed the given maximum size.
+ *
+ * All errors are logged and otherwise ignored, so callers can always fall back to parsing
+ * the model.
+ *
+ * Models with different paths can be read and written concurrently.
+ */
+class EntityModelCache
+{
+public:
+  static constexpr auto DefaultMaxSize = size_t(256u * 1024u * 1024u);
+
+  /**
+   * Maps source files to the hashes of their contents.
+   */
+  using FileHashes = std::map<Path, uint64_t>;
+
+private:
+  Path m_directory;
+
+  mutable std::mutex m_mutex;
+  std::map<Path, uint64_t> m_sourceHashes;
+  std::set<Path> m_missingCacheFiles;
+
+public:
+  explicit EntityModelCache(Path directory, size_t maxSize = DefaultMaxSize);
+
+  /**
+   * Returns the cached model for the given path, or null if the model is not cached or if
+   * any of the files it was created from have changed.
+   *
+   * The hashes of all source files that were checked are added to the given map so that
+   * they can be passed to writeModel if the model must be parsed.
+   */
+  std::unique_ptr<Assets::EntityModel> readModel(
+    const FileSystem& fs, const Path& path, FileHashes& hashes, Logger& logger);
+
+  /**
+   * Stores the given model and all of its loaded frames in the cache.
+   *
+   * @param fs the file system from which the model was loaded
+   * @param path the path of the model
+   * @param sourcePaths the paths of all files that were read while parsing the model
+   * @param hashes already known hashes of source files, other files are hashed here
+   * @param model the model to store
+   * @param logger the logger
+   */
+  void writeModel(
+    const FileSystem& fs,
+    const Path& path,
+    const std::vector<Path>& sourcePaths,
+    const FileHashes& hashes,
+    const Assets::EntityModel& model,
+    Logger& logger);
+
+  /**
+   * Loads the frame with the given index into the given model from the cache.
+   *
+   * Returns true if the frame was loaded and false otherwise.
+   */
+  bool readFrame(
+    const Path& path, size_t frameIndex, Assets::EntityModel& model, Logger& logger);
+
+  /**
+   * Stores the loaded frame with the given index of the given model in the cache.
+   */
+  void writeFrame(
+    const Path& path, size_t frameIndex, const Assets::EntityModel& model, Logger& logger);
+
+private:
+  Path modelCachePath(const Path& path) const;
+  Path frameCachePath(const Path& path, size_t frameIndex) const;
+  std::optional<uint64_t> sourceHash(const Path& path) const;
+  void setSourceHash(const Path& path, std::optional<uint64_t> hash);
+  bool cacheFileExists(const Path& cachePath);
+  void writeCacheFile(const Path& cachePath, const std::string& contents);
+};
+} // namespace IO
+} // namespace TrenchBroom
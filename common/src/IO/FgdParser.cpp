@@ -27,14 +27,22 @@
 #include "IO/File.h"
 #include "IO/LegacyModelDefinitionParser.h"
 #include "IO/ParserStatus.h"
+#include "Logger.h"
 
+#include <kdl/overload.h>
+#include <kdl/parallel.h>
 #include <kdl/string_compare.h>
 #include <kdl/string_format.h>
 #include <kdl/string_utils.h>
+#include <kdl/vector_set.h>
 #include <kdl/vector_utils.h>
 
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
 
 namespace TrenchBroom
@@ -145,6 +153,136 @@ FgdTokenizer::Token FgdTokenizer::emitToken()
   return Token(FgdToken::Eof, nullptr, nullptr, length(), line(), column());
 }
 
+/**
+ * An @include directive of an FGD file.
+ */
+struct FgdInclude
+{
+  Path path;
+  size_t line;
+};
+
+/**
+ * The class infos and includes of a single FGD file in the order of their declaration,
+ * and the messages that were logged while parsing it. Included files are not expanded.
+ */
+struct ParsedFgdFile
+{
+  std::vector<std::variant<EntityDefinitionClassInfo, FgdInclude>> items;
+  std::vector<std::pair<LogLevel, std::string>> messages;
+};
+
+/**
+ * An included file, or the error that occurred when opening or parsing it.
+ */
+struct IncludedFgdFile
+{
+  Path path;
+  std::shared_ptr<const ParsedFgdFile> file;
+  std::string error;
+};
+
+namespace
+{
+/**
+ * Collects the messages of a parser so that they can be replayed whenever the parsed
+ * file is used. Progress is forwarded to the given host status, if any.
+ */
+class CollectingParserStatus : public ParserStatus
+{
+private:
+  static NullLogger _logger;
+  ParserStatus* m_hostStatus;
+  std::vector<std::pair<LogLevel, std::string>> m_messages;
+
+public:
+  explicit CollectingParserStatus(ParserStatus* hostStatus)
+    : ParserStatus(_logger, "")
+    , m_hostStatus(hostStatus)
+  {
+  }
+
+  std::vector<std::pair<LogLevel, std::string>>& messages() { return m_messages; }
+
+private:
+  void doProgress(const double progress) override
+  {
+    if (m_hostStatus != nullptr)
+    {
+      m_hostStatus->progress(progress);
+    }
+  }
+
+  void doLog(const LogLevel level, const std::string& str) override
+  {
+    m_messages.emplace_back(level, str);
+  }
+};
+
+NullLogger CollectingParserStatus::_logger;
+
+void logMessages(
+  ParserStatus& status, const std::vector<std::pair<LogLevel, std::string>>& messages)
+{
+  for (const auto& [level, message] : messages)
+  {
+    switch (level)
+    {
+    case LogLevel::Debug:
+      status.debug(message);
+      break;
+    case LogLevel::Info:
+      status.info(message);
+      break;
+    case LogLevel::Warn:
+      status.warn(message);
+      break;
+    case LogLevel::Error:
+      status.error(message);
+      break;
+    }
+  }
+}
+
+/**
+ * Caches parsed FGD files by their contents, so that switching back to a definition file
+ * does not parse it and its included files again. The parsed files are shared and must
+ * not be modified.
+ */
+class ParsedFgdFileCache
+{
+private:
+  static constexpr size_t MaxCachedFiles = 64u;
+
+  std::mutex m_mutex;
+  std::unordered_map<std::string, std::shared_ptr<const ParsedFgdFile>> m_files;
+
+public:
+  std::shared_ptr<const ParsedFgdFile> get(const std::string_view contents)
+  {
+    const auto lock = std::lock_guard<std::mutex>{m_mutex};
+    const auto it = m_files.find(std::string{contents});
+    return it != std::end(m_files) ? it->second : nullptr;
+  }
+
+  void put(const std::string_view contents, std::shared_ptr<const ParsedFgdFile> file)
+  {
+    const auto lock = std::lock_guard<std::mutex>{m_mutex};
+    if (m_files.size() >= MaxCachedFiles)
+    {
+      m_files.clear();
+    }
+    m_files.emplace(std::string{contents}, std::move(file));
+  }
+};
+
+ParsedFgdFileCache& parsedFileCache()
+{
+  static auto cache = ParsedFgdFileCache{};
+  return cache;
+}
+} // namespace
+
 FgdParser::FgdParser(
   std::string_view str, const Color& defaultEntityColor, const Path& path)
   : EntityDefinitionParser(defaultEntityColor)
@@ -237,18 +375,205 @@ bool FgdParser::isRecursiveInclude(const Path& path) const
 
 std::vector<EntityDefinitionClassInfo> FgdParser::parseClassInfos(ParserStatus& status)
 {
-  std::vector<EntityDefinitionClassInfo> classInfos;
-  auto token = m_tokenizer.peekToken();
-  while (!token.hasType(FgdToken::Eof))
+  const auto source = m_tokenizer.snapshotStateAndSource();
+  const auto hostFile = parseFile(
+    std::string_view(source.begin, size_t(source.end - source.begin)), &status);
+  const auto includedFiles = parseIncludedFiles(*hostFile);
+
+  auto classInfos = std::vector<EntityDefinitionClassInfo>{};
+  expandIncludes(status, *hostFile, includedFiles, classInfos);
+  return classInfos;
+}
+
+/**
+ * Parses the class infos and includes of the given FGD source, or returns the cached
+ * result if a file with the same contents was parsed before.
+ *
+ * If a host status is given, it receives the progress, and the messages if parsing
+ * fails.
+ */
+std::shared_ptr<const ParsedFgdFile> FgdParser::parseFile(
+  const std::string_view str, ParserStatus* hostStatus)
+{
+  auto& cache = parsedFileCache();
+  if (auto file = cache.get(str))
   {
-    parseClassInfoOrInclude(status, classInfos);
-    token = m_tokenizer.peekToken();
+    return file;
   }
-  return classInfos;
+
+  auto parser = FgdParser{str, Color{}};
+  auto status = CollectingParserStatus{hostStatus};
+  auto file = std::make_shared<ParsedFgdFile>();
+  try
+  {
+    while (!parser.m_tokenizer.peekToken().hasType(FgdToken::Eof))
+    {
+      parser.parseClassInfoOrInclude(status, *file);
+    }
+  }
+  catch (...)
+  {
+    if (hostStatus != nullptr)
+    {
+      logMessages(*hostStatus, status.messages());
+    }
+    throw;
+  }
+
+  file->messages = std::move(status.messages());
+  cache.put(str, file);
+  return file;
 }
 
-void FgdParser::parseClassInfoOrInclude(
-  ParserStatus& status, std::vector<EntityDefinitionClassInfo>& classInfos)
+/**
+ * Opens and parses the files included by the given host file and, recursively, the files
+ * included by them. The files of each level of the include hierarchy are parsed
+ * concurrently.
+ *
+ * The returned map is keyed by the include paths relative to the host file's directory.
+ */
+FgdParser::IncludedFiles FgdParser::parseIncludedFiles(
+  const ParsedFgdFile& hostFile) const
+{
+  auto result = IncludedFiles{};
+  if (m_fs == nullptr)
+  {
+    return result;
+  }
+
+  const auto collectIncludePaths =
+    [&](const Path& root, const ParsedFgdFile& file, std::vector<Path>& paths) {
+      for (const auto& item : file.items)
+      {
+        if (const auto* include = std::get_if<FgdInclude>(&item))
+        {
+          const auto path = root + include->path;
+          if (result.count(path) == 0u)
+          {
+            paths.push_back(path);
+          }
+        }
+      }
+    };
+
+  auto visitedPaths = kdl::vector_set<Path>{};
+  auto paths = std::vector<Path>{};
+  collectIncludePaths(currentRoot(), hostFile, paths);
+
+  while (!paths.empty())
+  {
+    paths = kdl::vec_sort_and_remove_duplicates(std::move(paths));
+    auto includedFiles = kdl::vec_parallel_transform(
+      paths, [&](const Path& path) { return parseIncludedFile(path); });
+
+    auto nextPaths = std::vector<Path>{};
+    for (size_t i = 0u; i < paths.size(); ++i)
+    {
+      auto& includedFile = includedFiles[i];
+      const auto file = includedFile.file;
+      const auto root = includedFile.path.deleteLastComponent();
+      const auto visited = !visitedPaths.insert(includedFile.path).second;
+      result.emplace(paths[i], std::move(includedFile));
+
+      // recursive includes are reported when the includes are expanded
+      if (file != nullptr && !visited)
+      {
+        collectIncludePaths(root, *file, nextPaths);
+      }
+    }
+    paths = std::move(nextPaths);
+  }
+
+  return result;
+}
+
+IncludedFgdFile FgdParser::parseIncludedFile(const Path& path) const
+{
+  try
+  {
+    const auto file = m_fs->openFile(path);
+    auto reader = file->reader().buffer();
+    return IncludedFgdFile{file->path(), parseFile(reader.stringView(), nullptr), ""};
+  }
+  catch (const std::exception& e)
+  {
+    return IncludedFgdFile{Path{}, nullptr, e.what()};
+  }
+}
+
+void FgdParser::expandIncludes(
+  ParserStatus& status,
+  const ParsedFgdFile& file,
+  const IncludedFiles& includedFiles,
+  std::vector<EntityDefinitionClassInfo>& classInfos)
+{
+  logMessages(status, file.messages);
+
+  for (const auto& item : file.items)
+  {
+    std::visit(
+      kdl::overload(
+        [&](const EntityDefinitionClassInfo& classInfo) {
+          classInfos.push_back(classInfo);
+        },
+        [&](const FgdInclude& include) {
+          expandInclude(status, include, includedFiles, classInfos);
+        }),
+      item);
+  }
+}
+
+void FgdParser::expandInclude(
+  ParserStatus& status,
+  const FgdInclude& include,
+  const IncludedFiles& includedFiles,
+  std::vector<EntityDefinitionClassInfo>& classInfos)
+{
+  if (m_fs == nullptr)
+  {
+    status.error(
+      include.line, kdl::str_to_string("Cannot include file without host file path"));
+    return;
+  }
+
+  status.debug(include.line, "Parsing included file '" + include.path.asString() + "'");
+
+  const auto it = includedFiles.find(currentRoot() + include.path);
+  assert(it != std::end(includedFiles));
+
+  const auto& includedFile = it->second;
+  if (includedFile.file == nullptr)
+  {
+    status.error(
+      include.line,
+      kdl::str_to_string("Failed to parse included file: ", includedFile.error));
+    return;
+  }
+
+  status.debug(
+    include.line,
+    "Resolved '" + include.path.asString() + "' to '" + includedFile.path.asString()
+      + "'");
+
+  if (!isRecursiveInclude(includedFile.path))
+  {
+    const PushIncludePath pushIncludePath(this, includedFile.path);
+    expandIncludes(status, *includedFile.file, includedFiles, classInfos);
+  }
+  else
+  {
+    status.error(
+      include.line,
+      kdl::str_to_string(
+        "Skipping recursively included file: ",
+        include.path.asString(),
+        " (",
+        includedFile.path,
+        ")"));
+  }
+}
+
+void FgdParser::parseClassInfoOrInclude(ParserStatus& status, ParsedFgdFile& file)
 {
   auto token = expect(status, FgdToken::Eof | FgdToken::Word, m_tokenizer.peekToken());
   if (token.hasType(FgdToken::Eof))
@@ -258,14 +583,13 @@ void FgdParser::parseClassInfoOrInclude(
 
   if (kdl::ci::str_is_equal(token.data(), "@include"))
   {
-    auto includedClassInfos = parseInclude(status);
-    classInfos = kdl::vec_concat(classInfos, std::move(includedClassInfos));
+    file.items.emplace_back(parseInclude(status));
   }
   else
   {
     if (auto classInfo = parseClassInfo(status))
     {
-      classInfos.push_back(std::move(*classInfo));
+      file.items.emplace_back(std::move(*classInfo));
     }
     status.progress(m_tokenizer.progress());
   }
@@ -960,62 +1284,13 @@ std::string FgdParser::parseString(ParserStatus& status)
   }
 }
 
-std::vector<EntityDefinitionClassInfo> FgdParser::parseInclude(ParserStatus& status)
+FgdInclude FgdParser::parseInclude(ParserStatus& status)
 {
   auto token = expect(status, FgdToken::Word, m_tokenizer.nextToken());
   assert(kdl::ci::str_is_equal(token.data(), "@include"));
 
   expect(status, FgdToken::String, token = m_tokenizer.nextToken());
-  const auto path = Path(token.data());
-  return handleInclude(status, path);
-}
-
-std::vector<EntityDefinitionClassInfo> FgdParser::handleInclude(
-  ParserStatus& status, const Path& path)
-{
-  if (m_fs == nullptr)
-  {
-    status.error(
-      m_tokenizer.line(),
-      kdl::str_to_string("Cannot include file without host file path"));
-    return {};
-  }
-
-  const auto snapshot = m_tokenizer.snapshotStateAndSource();
-  auto result = std::vector<EntityDefinitionClassInfo>();
-  try
-  {
-    status.debug(m_tokenizer.line(), "Parsing included file '" + path.asString() + "'");
-    const auto file = m_fs->openFile(currentRoot() + path);
-    const auto filePath = file->path();
-    status.debug(
-      m_tokenizer.line(),
-      "Resolved '" + path.asString() + "' to '" + filePath.asString() + "'");
-
-    if (!isRecursiveInclude(filePath))
-    {
-      const PushIncludePath pushIncludePath(this, filePath);
-      auto reader = file->reader().buffer();
-      m_tokenizer.replaceState(reader.stringView());
-      result = parseClassInfos(status);
-    }
-    else
-    {
-      status.error(
-        m_tokenizer.line(),
-        kdl::str_to_string(
-          "Skipping recursively included file: ", path.asString(), " (", filePath, ")"));
-    }
-  }
-  catch (const Exception& e)
-  {
-    status.error(
-      m_tokenizer.line(),
-      kdl::str_to_string("Failed to parse included file: ", e.what()));
-  }
-
-  m_tokenizer.restoreStateAndSource(snapshot);
-  return result;
+  return FgdInclude{Path(token.data()), token.line()};
 }
 } // namespace IO
 } // namespace TrenchBroom
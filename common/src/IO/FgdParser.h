@@ -25,9 +25,11 @@
 #include "IO/Parser.h"
 #include "IO/Tokenizer.h"
 
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace TrenchBroom
@@ -42,6 +44,9 @@ namespace IO
 struct EntityDefinitionClassInfo;
 enum class EntityDefinitionClassType;
 class FileSystem;
+struct FgdInclude;
+struct IncludedFgdFile;
+struct ParsedFgdFile;
 class ParserStatus;
 class Path;
 
@@ -77,6 +82,7 @@ class FgdParser : public EntityDefinitionParser, public Parser<FgdToken::Type>
 {
 private:
   using Token = FgdTokenizer::Token;
+  using IncludedFiles = std::map<Path, IncludedFgdFile>;
 
   std::vector<Path> m_paths;
   std::shared_ptr<FileSystem> m_fs;
@@ -100,8 +106,23 @@ private:
 
   std::vector<EntityDefinitionClassInfo> parseClassInfos(ParserStatus& status) override;
 
-  void parseClassInfoOrInclude(
-    ParserStatus& status, std::vector<EntityDefinitionClassInfo>& classInfos);
+  static std::shared_ptr<const ParsedFgdFile> parseFile(
+    std::string_view str, ParserStatus* hostStatus);
+  IncludedFiles parseIncludedFiles(const ParsedFgdFile& hostFile) const;
+  IncludedFgdFile parseIncludedFile(const Path& path) const;
+
+  void expandIncludes(
+    ParserStatus& status,
+    const ParsedFgdFile& file,
+    const IncludedFiles& includedFiles,
+    std::vector<EntityDefinitionClassInfo>& classInfos);
+  void expandInclude(
+    ParserStatus& status,
+    const FgdInclude& include,
+    const IncludedFiles& includedFiles,
+    std::vector<EntityDefinitionClassInfo>& classInfos);
+
+  void parseClassInfoOrInclude(ParserStatus& status, ParsedFgdFile& file);
 
   std::optional<EntityDefinitionClassInfo> parseClassInfo(ParserStatus& status);
   EntityDefinitionClassInfo parseSolidClassInfo(ParserStatus& status);
@@ -146,9 +167,7 @@ private:
   Color parseColor(ParserStatus& status);
   std::string parseString(ParserStatus& status);
 
-  std::vector<EntityDefinitionClassInfo> parseInclude(ParserStatus& status);
-  std::vector<EntityDefinitionClassInfo> handleInclude(
-    ParserStatus& status, const Path& path);
+  FgdInclude parseInclude(ParserStatus& status);
 };
 } // namespace IO
 } // namespace TrenchBroom
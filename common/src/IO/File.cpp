@@ -21,6 +21,9 @@
 
 #include "Exceptions.h"
 #include "IO/IOUtils.h"
+#include "IO/PathQt.h"
+
+#include <QFile>
 
 namespace TrenchBroom
 {
@@ -38,6 +41,11 @@ const Path& File::path() const
   return m_path;
 }
 
+bool File::loadContents() const
+{
+  return false;
+}
+
 OwningBufferFile::OwningBufferFile(
   const Path& path, std::unique_ptr<char[]> buffer, const size_t size)
   : File(path)
@@ -56,6 +64,11 @@ size_t OwningBufferFile::size() const
   return m_size;
 }
 
+bool OwningBufferFile::loadContents() const
+{
+  return true;
+}
+
 NonOwningBufferFile::NonOwningBufferFile(
   const Path& path, const char* begin, const char* end)
   : File(path)
@@ -112,6 +125,60 @@ std::FILE* CFile::file() const
   return m_file;
 }
 
+MappedFile::MappedFile(const Path& path)
+  : File(path)
+  , m_file(std::make_unique<QFile>(pathAsQString(path)))
+  , m_begin(nullptr)
+  , m_end(nullptr)
+{
+  if (!m_file->open(QIODevice::ReadOnly))
+  {
+    throw FileSystemException("Cannot open file " + path.asString());
+  }
+
+  // empty files cannot be mapped
+  const auto size = m_file->size();
+  if (size > 0)
+  {
+    const auto* data = m_file->map(0, size);
+    if (data == nullptr)
+    {
+      throw FileSystemException("Cannot map file " + path.asString());
+    }
+
+    m_begin = reinterpret_cast<const char*>(data);
+    m_end = m_begin + size;
+  }
+}
+
+MappedFile::~MappedFile()
+{
+  if (m_begin != nullptr)
+  {
+    m_file->unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_begin)));
+  }
+}
+
+Reader MappedFile::reader() const
+{
+  return Reader::from(m_begin, m_end);
+}
+
+size_t MappedFile::size() const
+{
+  return static_cast<size_t>(m_end - m_begin);
+}
+
+const char* MappedFile::begin() const
+{
+  return m_begin;
+}
+
+const char* MappedFile::end() const
+{
+  return m_end;
+}
+
 FileView::FileView(
   const Path& path, std::shared_ptr<File> file, const size_t offset, const size_t length)
   : File(path)
@@ -25,6 +25,8 @@
 #include <cstdio>
 #include <memory>
 
+class QFile;
+
 namespace TrenchBroom
 {
 namespace IO
@@ -65,6 +67,17 @@ public:
    * Returns the size of this file in bytes.
    */
   virtual size_t size() const = 0;
+
+  /**
+   * Loads the contents of this file into memory that this file owns, if this file
+   * supports it. Afterwards, the contents remain valid independently of any other file,
+   * e.g. of an archive that this file is an entry of.
+   *
+   * The default implementation does nothing.
+   *
+   * @return true if this file owns its contents and false otherwise
+   */
+  virtual bool loadContents() const;
 };
 
 /**
@@ -88,6 +101,7 @@ public:
 
   Reader reader() const override;
   size_t size() const override;
+  bool loadContents() const override;
 };
 
 /**
@@ -146,6 +160,49 @@ public:
   std::FILE* file() const;
 };
 
+/**
+ * A file that is backed by a physical file on the disk which is mapped into memory. The
+ * file is opened and mapped in the constructor, and it is unmapped and closed in the
+ * destructor. Readers of this file and of file views into this file read the mapped
+ * memory directly, so reading does not copy the file contents or perform any system
+ * calls.
+ *
+ * The mapping stays valid only as long as the file on the disk is not truncated, and it
+ * may prevent other programs from writing the file. Callers that keep entries of a
+ * mapped archive beyond loading them should copy their contents.
+ */
+class MappedFile : public File
+{
+private:
+  std::unique_ptr<QFile> m_file;
+  const char* m_begin;
+  const char* m_end;
+
+public:
+  /**
+   * Creates a new file with the given path and maps the file into memory.
+   *
+   * @param path the path of the file
+   *
+   * @throw FileSystemException if the file cannot be opened or mapped
+   */
+  explicit MappedFile(const Path& path);
+  ~MappedFile() override;
+
+  Reader reader() const override;
+  size_t size() const override;
+
+  /**
+   * Returns the start of the mapped memory.
+   */
+  const char* begin() const;
+
+  /**
+   * Returns the end of the mapped memory (position after the last byte).
+   */
+  const char* end() const;
+};
+
 /**
  * A file that is backed by a portion of a physical file.
  */
@@ -209,6 +266,8 @@ public:
 
   size_t size() const override { return sizeof(m_object); }
 
+  bool loadContents() const override { return true; }
+
   /**
    * Returns the object that backs this file.
    */
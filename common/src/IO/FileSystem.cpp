@@ -115,7 +115,7 @@ bool FileSystem::fileExists(const Path& path) const
     {
       throw FileSystemException("Path is absolute: '" + path.asString() + "'");
     }
-    return _fileExists(path);
+    return doFindFileOwner(path) != nullptr;
   }
   catch (const PathException& e)
   {
@@ -182,7 +182,34 @@ std::shared_ptr<File> FileSystem::openFile(const Path& path) const
       throw FileSystemException("Path is absolute: '" + path.asString() + "'");
     }
 
-    return _openFile(path);
+    if (const auto* owner = doFindFileOwner(path))
+    {
+      return owner->doOpenFile(path);
+    }
+
+    throw FileSystemException("File not found: '" + path.asString() + "'");
+  }
+  catch (const PathException& e)
+  {
+    throw FileSystemException("Invalid path: '" + path.asString() + "'", e);
+  }
+}
+
+Path FileSystem::findHostFile(const Path& path) const
+{
+  try
+  {
+    if (path.isAbsolute())
+    {
+      throw FileSystemException("Path is absolute: '" + path.asString() + "'");
+    }
+
+    if (const auto* owner = doFindFileOwner(path))
+    {
+      return owner->doGetHostFile(path);
+    }
+
+    return Path();
   }
   catch (const PathException& e)
   {
@@ -215,9 +242,13 @@ bool FileSystem::_directoryExists(const Path& path) const
   return doDirectoryExists(path) || (m_next && m_next->_directoryExists(path));
 }
 
-bool FileSystem::_fileExists(const Path& path) const
+const FileSystem* FileSystem::_findFileOwner(const Path& path) const
 {
-  return doFileExists(path) || (m_next && m_next->_fileExists(path));
+  if (doFileExists(path))
+  {
+    return this;
+  }
+  return m_next ? m_next->_findFileOwner(path) : nullptr;
 }
 
 std::vector<Path> FileSystem::_getDirectoryContents(const Path& directoryPath) const
@@ -232,22 +263,6 @@ std::vector<Path> FileSystem::_getDirectoryContents(const Path& directoryPath) c
   return kdl::vec_sort_and_remove_duplicates(std::move(result));
 }
 
-std::shared_ptr<File> FileSystem::_openFile(const Path& path) const
-{
-  if (doFileExists(path))
-  {
-    return doOpenFile(path);
-  }
-  else if (m_next)
-  {
-    return m_next->_openFile(path);
-  }
-  else
-  {
-    throw FileSystemException("File not found: '" + path.asString() + "'");
-  }
-}
-
 bool FileSystem::doCanMakeAbsolute(const Path& /* path */) const
 {
   return false;
@@ -258,6 +273,16 @@ Path FileSystem::doMakeAbsolute(const Path& path) const
   throw FileSystemException("Cannot make absolute path of '" + path.asString() + "'");
 }
 
+Path FileSystem::doGetHostFile(const Path& /* path */) const
+{
+  return Path();
+}
+
+const FileSystem* FileSystem::doFindFileOwner(const Path& path) const
+{
+  return _findFileOwner(path);
+}
+
 WritableFileSystem::WritableFileSystem() = default;
 WritableFileSystem::~WritableFileSystem() = default;
 
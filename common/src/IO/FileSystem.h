@@ -127,13 +127,23 @@ public: // public API
   std::vector<Path> getDirectoryContents(const Path& directoryPath) const;
   std::shared_ptr<File> openFile(const Path& path) const;
 
+  /**
+   * Returns the absolute path of the file on disk that stores the file with the given
+   * path. This is the file itself if it is stored in a directory on disk, or the package
+   * that contains it.
+   *
+   * @param path the file path
+   * @return the path of the host file, or an empty path if the file does not exist or is
+   * not stored in a file on disk
+   */
+  Path findHostFile(const Path& path) const;
+
 private: // private API to be used for chaining, avoids multiple checks of parameters
   bool _canMakeAbsolute(const Path& path) const;
   Path _makeAbsolute(const Path& path) const;
   bool _directoryExists(const Path& path) const;
-  bool _fileExists(const Path& path) const;
+  const FileSystem* _findFileOwner(const Path& path) const;
   std::vector<Path> _getDirectoryContents(const Path& directoryPath) const;
-  std::shared_ptr<File> _openFile(const Path& path) const;
 
   /**
    * Finds all items matching the given matcher at the given search path, optionally
@@ -243,6 +253,17 @@ private: // subclassing API
   virtual std::vector<Path> doGetDirectoryContents(const Path& path) const = 0;
 
   virtual std::shared_ptr<File> doOpenFile(const Path& path) const = 0;
+  virtual Path doGetHostFile(const Path& path) const;
+
+protected:
+  /**
+   * Returns the first file system in the chain starting at this file system that
+   * contains a file with the given path, or nullptr if no such file system exists.
+   *
+   * The default implementation searches the chain. Subclasses may override this to
+   * avoid searching the chain, e.g. by caching the results of the search.
+   */
+  virtual const FileSystem* doFindFileOwner(const Path& path) const;
 };
 
 class WritableFileSystem
@@ -23,8 +23,11 @@
 #include "IO/DiskFileSystem.h"
 #include "IO/File.h"
 
+#include <kdl/string_format.h>
+
 #include <cassert>
 #include <memory>
+#include <string>
 
 namespace TrenchBroom
 {
@@ -61,9 +64,15 @@ std::shared_ptr<File> ImageFileSystemBase::CompressedFileEntry::doOpen() const
     m_file->path(), std::move(data), m_uncompressedSize);
 }
 
-ImageFileSystemBase::Directory::Directory(const Path& path)
-  : m_path(path)
+static std::string makeKey(const Path& path)
+{
+  return kdl::str_to_lower(path.asString("/"));
+}
+
+ImageFileSystemBase::Directory::Directory()
 {
+  // the root directory
+  m_entries.push_back(Entry{Path(), nullptr, {}});
 }
 
 void ImageFileSystemBase::Directory::addFile(const Path& path, std::shared_ptr<File> file)
@@ -75,147 +84,93 @@ void ImageFileSystemBase::Directory::addFile(
   const Path& path, std::unique_ptr<FileEntry> file)
 {
   ensure(file != nullptr, "file is null");
-  const auto filename = path.lastComponent();
-  if (path.length() == 1)
+  auto key = makeKey(path);
+  if (const auto it = m_files.find(key); it != std::end(m_files))
   {
     // silently overwrite duplicates, the latest entries win
-    m_files[filename] = std::move(file);
-  }
-  else
-  {
-    auto& dir = findOrCreateDirectory(path.deleteLastComponent());
-    dir.addFile(filename, std::move(file));
+    m_entries[it->second].file = std::move(file);
+    return;
   }
+
+  const auto parentIndex = findOrCreateDirectory(path.deleteLastComponent());
+  const auto index = m_entries.size();
+  m_entries.push_back(Entry{path.lastComponent(), std::move(file), {}});
+  m_entries[parentIndex].children.push_back(index);
+  m_files.emplace(std::move(key), index);
 }
 
 bool ImageFileSystemBase::Directory::directoryExists(const Path& path) const
 {
-  if (path.isEmpty())
-  {
-    return true;
-  }
-
-  auto it = m_directories.find(path.firstComponent());
-  if (it == std::end(m_directories))
-  {
-    return false;
-  }
-  else
-  {
-    return it->second->directoryExists(path.deleteFirstComponent());
-  }
+  return path.isEmpty() || m_directories.count(makeKey(path)) > 0u;
 }
 
 bool ImageFileSystemBase::Directory::fileExists(const Path& path) const
 {
-  if (path.length() == 1)
-  {
-    return m_files.count(path) > 0;
-  }
-
-  auto it = m_directories.find(path.firstComponent());
-  if (it == std::end(m_directories))
-  {
-    return false;
-  }
-  else
-  {
-    return it->second->fileExists(path.deleteFirstComponent());
-  }
+  return m_files.count(makeKey(path)) > 0u;
 }
 
-const ImageFileSystemBase::Directory& ImageFileSystemBase::Directory::findDirectory(
+const ImageFileSystemBase::FileEntry& ImageFileSystemBase::Directory::findFile(
   const Path& path) const
 {
-  if (path.isEmpty())
-  {
-    return *this;
-  }
+  assert(!path.isEmpty());
 
-  auto it = m_directories.find(path.firstComponent());
-  if (it == std::end(m_directories))
-  {
-    throw FileSystemException(
-      "Path does not exist: '" + (m_path + path).asString() + "'");
-  }
-  else
+  const auto it = m_files.find(makeKey(path));
+  if (it == std::end(m_files))
   {
-    return it->second->findDirectory(path.deleteFirstComponent());
+    throw FileSystemException("File not found: '" + path.asString() + "'");
   }
+  return *m_entries[it->second].file;
 }
 
-const ImageFileSystemBase::FileEntry& ImageFileSystemBase::Directory::findFile(
-  const Path& path) const
+std::vector<Path> ImageFileSystemBase::Directory::contents(const Path& path) const
 {
-  assert(!path.isEmpty());
-
-  const auto name = path.firstComponent();
-  if (path.length() == 1)
-  {
-    auto it = m_files.find(name);
-    if (it == std::end(m_files))
-    {
-      throw FileSystemException("File not found: '" + (m_path + path).asString() + "'");
-    }
-    else
-    {
-      return *it->second;
-    }
-  }
-  else
+  auto index = size_t(0);
+  if (!path.isEmpty())
   {
-    auto it = m_directories.find(name);
+    const auto it = m_directories.find(makeKey(path));
     if (it == std::end(m_directories))
     {
-      throw FileSystemException("File not found: '" + (m_path + path).asString() + "'");
-    }
-    else
-    {
-      return it->second->findFile(path.deleteFirstComponent());
+      throw FileSystemException("Path does not exist: '" + path.asString() + "'");
     }
+    index = it->second;
   }
-}
 
-std::vector<Path> ImageFileSystemBase::Directory::contents() const
-{
-  std::vector<Path> contents;
+  const auto& children = m_entries[index].children;
 
-  for (const auto& [path, directory] : m_directories)
+  auto result = std::vector<Path>();
+  result.reserve(children.size());
+  for (const auto childIndex : children)
   {
-    contents.push_back(Path(path));
+    result.push_back(m_entries[childIndex].name);
   }
-
-  for (const auto& [path, file] : m_files)
-  {
-    contents.push_back(Path(path));
-  }
-
-  return contents;
+  return result;
 }
 
-ImageFileSystemBase::Directory& ImageFileSystemBase::Directory::findOrCreateDirectory(
-  const Path& path)
+size_t ImageFileSystemBase::Directory::findOrCreateDirectory(const Path& path)
 {
   if (path.isEmpty())
   {
-    return *this;
+    return 0u;
   }
 
-  const auto name = path.firstComponent();
-  auto it = m_directories.lower_bound(name);
-  if (it == std::end(m_directories) || name != it->first)
+  auto key = makeKey(path);
+  if (const auto it = m_directories.find(key); it != std::end(m_directories))
   {
-    it =
-      m_directories.insert(it, std::make_pair(name, new Directory(m_path + Path(name))));
+    return it->second;
   }
-  return it->second->findOrCreateDirectory(path.deleteFirstComponent());
+
+  const auto parentIndex = findOrCreateDirectory(path.deleteLastComponent());
+  const auto index = m_entries.size();
+  m_entries.push_back(Entry{path.lastComponent(), nullptr, {}});
+  m_entries[parentIndex].children.push_back(index);
+  m_directories.emplace(std::move(key), index);
+  return index;
 }
 
 ImageFileSystemBase::ImageFileSystemBase(
   std::shared_ptr<FileSystem> next, const Path& path)
   : FileSystem(std::move(next))
   , m_path(path)
-  , m_root(Path())
 {
 }
 
@@ -236,38 +191,39 @@ void ImageFileSystemBase::initialize()
 
 void ImageFileSystemBase::reload()
 {
-  m_root = Directory(Path());
+  m_root = Directory();
   initialize();
 }
 
 bool ImageFileSystemBase::doDirectoryExists(const Path& path) const
 {
-  const auto searchPath = path.makeLowerCase().makeCanonical();
-  return m_root.directoryExists(searchPath);
+  return m_root.directoryExists(path.makeCanonical());
 }
 
 bool ImageFileSystemBase::doFileExists(const Path& path) const
 {
-  const auto searchPath = path.makeLowerCase().makeCanonical();
-  return m_root.fileExists(searchPath);
+  return m_root.fileExists(path.makeCanonical());
 }
 
 std::vector<Path> ImageFileSystemBase::doGetDirectoryContents(const Path& path) const
 {
-  const auto searchPath = path.makeLowerCase().makeCanonical();
-  const auto& directory = m_root.findDirectory(path);
-  return directory.contents();
+  return m_root.contents(path.makeCanonical());
 }
 
 std::shared_ptr<File> ImageFileSystemBase::doOpenFile(const Path& path) const
 {
-  const auto searchPath = path.makeLowerCase().makeCanonical();
-  return m_root.findFile(path).open();
+  return m_root.findFile(path.makeCanonical()).open();
+}
+
+Path ImageFileSystemBase::doGetHostFile(const Path& /* path */) const
+{
+  // virtual file systems such as the shader file system have no package on disk
+  return m_path.isAbsolute() ? m_path : Path();
 }
 
 ImageFileSystem::ImageFileSystem(std::shared_ptr<FileSystem> next, const Path& path)
   : ImageFileSystemBase(std::move(next), path)
-  , m_file(std::make_shared<CFile>(path))
+  , m_file(std::make_shared<MappedFile>(path))
 {
   ensure(m_path.isAbsolute(), "path must be absolute");
 }
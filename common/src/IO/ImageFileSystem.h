@@ -22,17 +22,17 @@
 #include "IO/FileSystem.h"
 #include "IO/Path.h"
 
-#include <kdl/string_compare.h>
-
-#include <map>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace TrenchBroom
 {
 namespace IO
 {
-class CFile;
 class File;
+class MappedFile;
 
 class ImageFileSystemBase : public FileSystem
 {
@@ -76,20 +76,39 @@ protected:
       std::shared_ptr<File> file, size_t uncompressedSize) const = 0;
   };
 
+  /**
+   * The directory tree of an image file system.
+   *
+   * The files and directories are stored in a flat table, and each directory refers to
+   * its children by their indices in that table. Files and directories are found by
+   * looking up their lower case paths in hash maps, so a lookup does not depend on the
+   * depth of the path or the number of entries.
+   */
   class Directory
   {
   private:
-    using DirMap =
-      std::map<Path, std::unique_ptr<Directory>, Path::Less<kdl::ci::string_less>>;
-    using FileMap =
-      std::map<Path, std::unique_ptr<FileEntry>, Path::Less<kdl::ci::string_less>>;
-
-    Path m_path;
-    DirMap m_directories;
-    FileMap m_files;
+    struct Entry
+    {
+      /**
+       * The name of this entry with the case it was first added with.
+       */
+      Path name;
+      /**
+       * The file of this entry, or null if this entry is a directory.
+       */
+      std::unique_ptr<FileEntry> file;
+      /**
+       * The indices of the children of this entry if it is a directory.
+       */
+      std::vector<size_t> children;
+    };
+
+    std::vector<Entry> m_entries;
+    std::unordered_map<std::string, size_t> m_directories;
+    std::unordered_map<std::string, size_t> m_files;
 
   public:
-    explicit Directory(const Path& path);
+    Directory();
 
     void addFile(const Path& path, std::shared_ptr<File> file);
     void addFile(const Path& path, std::unique_ptr<FileEntry> file);
@@ -97,12 +116,11 @@ protected:
     bool directoryExists(const Path& path) const;
     bool fileExists(const Path& path) const;
 
-    const Directory& findDirectory(const Path& path) const;
     const FileEntry& findFile(const Path& path) const;
-    std::vector<Path> contents() const;
+    std::vector<Path> contents(const Path& path) const;
 
   private:
-    Directory& findOrCreateDirectory(const Path& path);
+    size_t findOrCreateDirectory(const Path& path);
   };
 
 protected:
@@ -130,6 +148,7 @@ private:
 
   std::vector<Path> doGetDirectoryContents(const Path& path) const override;
   std::shared_ptr<File> doOpenFile(const Path& path) const override;
+  Path doGetHostFile(const Path& path) const override;
 
 private:
   virtual void doReadDirectory() = 0;
@@ -138,7 +157,7 @@ private:
 class ImageFileSystem : public ImageFileSystemBase
 {
 protected:
-  std::shared_ptr<CFile> m_file;
+  std::shared_ptr<MappedFile> m_file;
 
 protected:
   ImageFileSystem(std::shared_ptr<FileSystem> next, const Path& path);
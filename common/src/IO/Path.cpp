@@ -24,10 +24,7 @@
 
 #include <kdl/string_compare.h>
 #include <kdl/string_format.h>
-#include <kdl/string_utils.h>
-#include <kdl/vector_utils.h>
 
-#include <iterator>
 #include <ostream>
 #include <string>
 
@@ -40,19 +37,49 @@ static constexpr std::string_view separators()
   return std::string_view("/\\");
 }
 
-Path::Path(bool absolute, const std::vector<std::string>& components)
-  : m_components(components)
+static std::string_view trim(const std::string_view str)
+{
+  const auto first = str.find_first_not_of(kdl::Whitespace);
+  if (first == std::string_view::npos)
+  {
+    return std::string_view();
+  }
+
+  const auto last = str.find_last_not_of(kdl::Whitespace);
+  return str.substr(first, last - first + 1u);
+}
+
+Path::Path(bool absolute, std::string path)
+  : m_path(std::move(path))
   , m_absolute(absolute)
 {
 }
 
 Path::Path(const std::string& path)
 {
-  const auto trimmed = kdl::str_trim(path);
-  m_components = kdl::str_split(trimmed, separators());
+  const auto trimmed = trim(path);
+  m_path.reserve(trimmed.size());
+
+  auto position = size_t(0);
+  while (position < trimmed.size())
+  {
+    const auto end =
+      std::min(trimmed.find_first_of(separators(), position), trimmed.size());
+    const auto component = trim(trimmed.substr(position, end - position));
+    if (!component.empty())
+    {
+      if (!m_path.empty())
+      {
+        m_path.push_back(ComponentSeparator);
+      }
+      m_path.append(component);
+    }
+    position = end + 1u;
+  }
+
 #ifdef _WIN32
   m_absolute =
-    (hasDriveSpec(m_components) || (!trimmed.empty() && trimmed[0] == '/')
+    (hasDriveSpec(firstComponentView()) || (!trimmed.empty() && trimmed[0] == '/')
      || (!trimmed.empty() && trimmed[0] == '\\'));
 #else
   m_absolute = !trimmed.empty() && kdl::cs::str_is_prefix(trimmed, separator());
@@ -65,10 +92,21 @@ Path Path::operator+(const Path& rhs) const
   {
     throw PathException("Cannot concatenate absolute path");
   }
-  auto components = m_components;
-  components.insert(
-    std::end(components), std::begin(rhs.m_components), std::end(rhs.m_components));
-  return Path(m_absolute, components);
+  if (rhs.m_path.empty())
+  {
+    return *this;
+  }
+  if (m_path.empty())
+  {
+    return Path(m_absolute, rhs.m_path);
+  }
+
+  auto path = std::string();
+  path.reserve(m_path.size() + 1u + rhs.m_path.size());
+  path.append(m_path);
+  path.push_back(ComponentSeparator);
+  path.append(rhs.m_path);
+  return Path(m_absolute, std::move(path));
 }
 
 int Path::compare(const Path& rhs, const bool caseSensitive) const
@@ -82,17 +120,14 @@ int Path::compare(const Path& rhs, const bool caseSensitive) const
     return 1;
   }
 
-  const auto& rcomps = rhs.m_components;
-
-  size_t i = 0;
-  const auto max =
-    m_components.size() < rcomps.size() ? m_components.size() : rcomps.size();
-  while (i < max)
+  auto lhsPosition = size_t(0);
+  auto rhsPosition = size_t(0);
+  while (lhsPosition < m_path.size() && rhsPosition < rhs.m_path.size())
   {
-    const auto& mcomp = m_components[i];
-    const auto& rcomp = rcomps[i];
-    const auto result = caseSensitive ? kdl::cs::str_compare(mcomp, rcomp)
-                                      : kdl::ci::str_compare(mcomp, rcomp);
+    const auto lhsComponent = nextComponent(m_path, lhsPosition);
+    const auto rhsComponent = nextComponent(rhs.m_path, rhsPosition);
+    const auto result = caseSensitive ? kdl::cs::str_compare(lhsComponent, rhsComponent)
+                                      : kdl::ci::str_compare(lhsComponent, rhsComponent);
     if (result < 0)
     {
       return -1;
@@ -101,15 +136,15 @@ int Path::compare(const Path& rhs, const bool caseSensitive) const
     {
       return 1;
     }
-    ++i;
   }
-  if (m_components.size() < rcomps.size())
+
+  if (lhsPosition < m_path.size())
   {
-    return -1;
+    return 1;
   }
-  else if (m_components.size() > rcomps.size())
+  else if (rhsPosition < rhs.m_path.size())
   {
-    return 1;
+    return -1;
   }
   else
   {
@@ -119,7 +154,9 @@ int Path::compare(const Path& rhs, const bool caseSensitive) const
 
 bool Path::operator==(const Path& rhs) const
 {
-  return compare(rhs) == 0;
+  // components are never empty, so two paths have the same components if and only if
+  // their joined components are equal
+  return m_absolute == rhs.m_absolute && m_path == rhs.m_path;
 }
 
 bool Path::operator!=(const Path& rhs) const
@@ -139,22 +176,24 @@ bool Path::operator>(const Path& rhs) const
 
 std::string Path::asString(const std::string_view separator) const
 {
-  if (m_absolute)
+  auto result = std::string();
+  result.reserve(separator.size() + m_path.size());
+
+  if (m_absolute && !hasDriveSpec(firstComponentView()))
   {
-#ifdef _WIN32
-    if (hasDriveSpec(m_components))
-    {
-      return kdl::str_join(m_components, separator);
-    }
-    else
+    result.append(separator);
+  }
+
+  auto position = size_t(0);
+  while (position < m_path.size())
+  {
+    if (position > 0u)
     {
-      return std::string(separator) + kdl::str_join(m_components, separator);
+      result.append(separator);
     }
-#else
-    return std::string(separator) + kdl::str_join(m_components, separator);
-#endif
+    result.append(nextComponent(m_path, position));
   }
-  return kdl::str_join(m_components, separator);
+  return result;
 }
 
 std::vector<std::string> Path::asStrings(
@@ -182,12 +221,17 @@ std::vector<Path> Path::asPaths(const std::vector<std::string>& strs)
 
 size_t Path::length() const
 {
-  return m_components.size();
+  if (m_path.empty())
+  {
+    return 0u;
+  }
+  return size_t(std::count(std::begin(m_path), std::end(m_path), ComponentSeparator))
+         + 1u;
 }
 
 bool Path::isEmpty() const
 {
-  return !m_absolute && m_components.empty();
+  return !m_absolute && m_path.empty();
 }
 
 Path Path::firstComponent() const
@@ -199,13 +243,13 @@ Path Path::firstComponent() const
 
   if (!m_absolute)
   {
-    return Path(m_components.front());
+    return Path(std::string(firstComponentView()));
   }
 
 #ifdef _WIN32
-  if (hasDriveSpec(m_components))
+  if (hasDriveSpec(firstComponentView()))
   {
-    return Path(m_components.front());
+    return Path(std::string(firstComponentView()));
   }
 
   return Path("\\");
@@ -220,36 +264,35 @@ Path Path::deleteFirstComponent() const
   {
     throw PathException("Cannot delete first component of empty path");
   }
+
+  const auto deleteFirst = [&]() {
+    const auto separatorIndex = m_path.find(ComponentSeparator);
+    return Path(
+      false,
+      separatorIndex != std::string::npos ? m_path.substr(separatorIndex + 1u)
+                                          : std::string());
+  };
+
   if (!m_absolute)
   {
-    auto components = std::vector<std::string>();
-    components.reserve(m_components.size() - 1);
-    components.insert(
-      std::begin(components), std::begin(m_components) + 1, std::end(m_components));
-    return Path(false, components);
+    return deleteFirst();
   }
 #ifdef _WIN32
-  if (!m_components.empty() && hasDriveSpec(m_components[0]))
+  if (hasDriveSpec(firstComponentView()))
   {
-    std::vector<std::string> components;
-    components.reserve(m_components.size() - 1);
-    components.insert(
-      std::begin(components), std::begin(m_components) + 1, std::end(m_components));
-    return Path(false, components);
+    return deleteFirst();
   }
-  return Path(false, m_components);
-#else
-  return Path(false, m_components);
 #endif
+  return Path(false, m_path);
 }
 
 Path Path::lastComponent() const
 {
   if (isEmpty())
     throw PathException("Cannot return last component of empty path");
-  if (!m_components.empty())
+  if (!m_path.empty())
   {
-    return Path(m_components.back());
+    return Path(std::string(lastComponentView()));
   }
   else
   {
@@ -264,17 +307,14 @@ Path Path::deleteLastComponent() const
     throw PathException("Cannot delete last component of empty path");
   }
 
-  if (!m_components.empty())
+  const auto separatorIndex = m_path.rfind(ComponentSeparator);
+  if (separatorIndex != std::string::npos)
   {
-    auto components = std::vector<std::string>();
-    components.reserve(m_components.size() - 1);
-    components.insert(
-      std::begin(components), std::begin(m_components), std::end(m_components) - 1);
-    return Path(m_absolute, components);
+    return Path(m_absolute, m_path.substr(0u, separatorIndex));
   }
   else
   {
-    return Path(m_absolute, m_components);
+    return Path(m_absolute, std::string());
   }
 }
 
@@ -285,12 +325,13 @@ Path Path::prefix(const size_t count) const
 
 Path Path::suffix(const size_t count) const
 {
-  return subPath(m_components.size() - count, count);
+  return subPath(length() - count, count);
 }
 
 Path Path::subPath(const size_t index, const size_t count) const
 {
-  if (index + count > m_components.size())
+  const auto length = this->length();
+  if (index + count > length)
   {
     throw PathException("Sub path out of bounds");
   }
@@ -300,18 +341,21 @@ Path Path::subPath(const size_t index, const size_t count) const
     return Path("");
   }
 
-  auto newComponents = std::vector<std::string>();
-  newComponents.reserve(count);
-  for (size_t i = 0u; i < count; ++i)
-  {
-    newComponents.push_back(m_components[index + i]);
-  }
-  return Path(m_absolute && index == 0, newComponents);
+  const auto begin = componentOffset(index);
+  const auto end =
+    index + count < length ? componentOffset(index + count) - 1u : m_path.size();
+  return Path(m_absolute && index == 0, m_path.substr(begin, end - begin));
 }
 
-const std::vector<std::string>& Path::components() const
+std::vector<std::string> Path::components() const
 {
-  return m_components;
+  auto result = std::vector<std::string>();
+  auto position = size_t(0);
+  while (position < m_path.size())
+  {
+    result.emplace_back(nextComponent(m_path, position));
+  }
+  return result;
 }
 
 std::string Path::filename() const
@@ -321,14 +365,7 @@ std::string Path::filename() const
     throw PathException("Cannot get filename of empty path");
   }
 
-  if (m_components.empty())
-  {
-    return "";
-  }
-  else
-  {
-    return m_components.back();
-  }
+  return std::string(lastComponentView());
 }
 
 std::string Path::basename() const
@@ -470,21 +507,20 @@ Path Path::addExtension(const std::string& extension) const
     throw PathException("Cannot add extension to empty path");
   }
 
-  auto components = m_components;
-  if (
-    components.empty()
-#ifdef _WIN32
-    || hasDriveSpec(m_components.back())
-#endif
-  )
+  auto path = m_path;
+  if (path.empty() || hasDriveSpec(lastComponentView()))
   {
-    components.push_back("." + extension);
+    if (!path.empty())
+    {
+      path.push_back(ComponentSeparator);
+    }
+    path.append("." + extension);
   }
   else
   {
-    components.back() += "." + extension;
+    path.append("." + extension);
   }
-  return Path(m_absolute, components);
+  return Path(m_absolute, std::move(path));
 }
 
 Path Path::replaceExtension(const std::string& extension) const
@@ -511,8 +547,8 @@ bool Path::canMakeRelative(const Path& absolutePath) const
   return (
     !isEmpty() && !absolutePath.isEmpty() && isAbsolute() && absolutePath.isAbsolute()
 #ifdef _WIN32
-    && !m_components.empty() && !absolutePath.m_components.empty()
-    && m_components[0] == absolutePath.m_components[0]
+    && !m_path.empty() && !absolutePath.m_path.empty()
+    && firstComponentView() == absolutePath.firstComponentView()
 #endif
   );
 }
@@ -545,15 +581,15 @@ Path Path::makeRelative() const
   }
 
 #ifdef _WIN32
-  if (m_components.empty())
+  if (m_path.empty())
   {
     throw PathException(
       "Cannot make relative path from an reference path with no drive spec");
   }
 
-  return Path(false, kdl::vec_slice_suffix(m_components, m_components.size() - 1u));
+  return Path(false, m_path).deleteFirstComponent();
 #else
-  return Path(false, m_components);
+  return Path(false, m_path);
 #endif
 }
 
@@ -580,24 +616,24 @@ Path Path::makeRelative(const Path& absolutePath) const
   }
 
 #ifdef _WIN32
-  if (m_components.empty())
+  if (m_path.empty())
   {
     throw PathException(
       "Cannot make relative path from an reference path with no drive spec");
   }
-  if (absolutePath.m_components.empty())
+  if (absolutePath.m_path.empty())
   {
     throw PathException("Cannot make relative path with sub path with no drive spec");
   }
-  if (m_components[0] != absolutePath.m_components[0])
+  if (firstComponentView() != absolutePath.firstComponentView())
   {
     throw PathException(
       "Cannot make relative path if reference path has different drive spec");
   }
 #endif
 
-  const auto myResolved = resolvePath(true, m_components);
-  const auto theirResolved = resolvePath(true, absolutePath.m_components);
+  const auto myResolved = resolvePath(true, m_path);
+  const auto theirResolved = resolvePath(true, absolutePath.m_path);
 
   // cross off all common prefixes
   size_t p = 0;
@@ -612,7 +648,7 @@ Path Path::makeRelative(const Path& absolutePath) const
     ++p;
   }
 
-  auto components = std::vector<std::string>();
+  auto components = std::vector<std::string_view>();
   for (size_t i = p; i < myResolved.size(); ++i)
   {
     components.push_back("..");
@@ -622,23 +658,23 @@ Path Path::makeRelative(const Path& absolutePath) const
     components.push_back(theirResolved[i]);
   }
 
-  return Path(false, components);
+  return Path(false, joinComponents(components));
 }
 
 Path Path::makeCanonical() const
 {
-  return Path(m_absolute, resolvePath(m_absolute, m_components));
+  const auto resolved = resolvePath(m_absolute, m_path);
+  if (resolved.size() == length())
+  {
+    // there were no "." or ".." components
+    return *this;
+  }
+  return Path(m_absolute, joinComponents(resolved));
 }
 
 Path Path::makeLowerCase() const
 {
-  auto lcComponents = std::vector<std::string>();
-  lcComponents.reserve(m_components.size());
-  for (const auto& component : m_components)
-  {
-    lcComponents.push_back(kdl::str_to_lower(component));
-  }
-  return Path(m_absolute, lcComponents);
+  return Path(m_absolute, kdl::str_to_lower(m_path));
 }
 
 std::vector<Path> Path::makeAbsoluteAndCanonical(
@@ -653,27 +689,31 @@ std::vector<Path> Path::makeAbsoluteAndCanonical(
   return result;
 }
 
-#ifdef _WIN32
-bool Path::hasDriveSpec(const std::vector<std::string>& components)
+std::string_view Path::firstComponentView() const
 {
-  if (components.empty())
-  {
-    return false;
-  }
-  else
-  {
-    return hasDriveSpec(components[0]);
-  }
+  return std::string_view(m_path).substr(0u, m_path.find(ComponentSeparator));
 }
-#else
-bool Path::hasDriveSpec(const std::vector<std::string>& /* components */)
+
+std::string_view Path::lastComponentView() const
 {
-  return false;
+  const auto separatorIndex = m_path.rfind(ComponentSeparator);
+  return separatorIndex != std::string::npos
+           ? std::string_view(m_path).substr(separatorIndex + 1u)
+           : std::string_view(m_path);
+}
+
+size_t Path::componentOffset(const size_t index) const
+{
+  auto position = size_t(0);
+  for (size_t i = 0u; i < index; ++i)
+  {
+    position = m_path.find(ComponentSeparator, position) + 1u;
+  }
+  return position;
 }
-#endif
 
 #ifdef _WIN32
-bool Path::hasDriveSpec(const std::string& component)
+bool Path::hasDriveSpec(const std::string_view component)
 {
   if (component.size() <= 1)
   {
@@ -685,18 +725,34 @@ bool Path::hasDriveSpec(const std::string& component)
   }
 }
 #else
-bool Path::hasDriveSpec(const std::string& /* component */)
+bool Path::hasDriveSpec(const std::string_view /* component */)
 {
   return false;
 }
 #endif
 
-std::vector<std::string> Path::resolvePath(
-  const bool absolute, const std::vector<std::string>& components) const
+std::string Path::joinComponents(const std::vector<std::string_view>& components)
+{
+  auto result = std::string();
+  for (const auto& component : components)
+  {
+    if (!result.empty())
+    {
+      result.push_back(ComponentSeparator);
+    }
+    result.append(component);
+  }
+  return result;
+}
+
+std::vector<std::string_view> Path::resolvePath(
+  const bool absolute, const std::string_view path)
 {
-  auto resolved = std::vector<std::string>();
-  for (const auto& comp : components)
+  auto resolved = std::vector<std::string_view>();
+  auto position = size_t(0);
+  while (position < path.size())
   {
+    const auto comp = nextComponent(path, position);
     if (comp == ".")
     {
       continue;
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <iosfwd>
 #include <string>
 #include <string_view>
@@ -49,20 +50,36 @@ public:
   public:
     bool operator()(const Path& lhs, const Path& rhs) const
     {
-      return std::lexicographical_compare(
-        std::begin(lhs.m_components),
-        std::end(lhs.m_components),
-        std::begin(rhs.m_components),
-        std::end(rhs.m_components),
-        m_less);
+      auto lhsPosition = size_t(0);
+      auto rhsPosition = size_t(0);
+      while (lhsPosition < lhs.m_path.size() && rhsPosition < rhs.m_path.size())
+      {
+        const auto lhsComponent = nextComponent(lhs.m_path, lhsPosition);
+        const auto rhsComponent = nextComponent(rhs.m_path, rhsPosition);
+        if (m_less(lhsComponent, rhsComponent))
+        {
+          return true;
+        }
+        if (m_less(rhsComponent, lhsComponent))
+        {
+          return false;
+        }
+      }
+      return lhsPosition >= lhs.m_path.size() && rhsPosition < rhs.m_path.size();
     }
   };
 
 private:
-  std::vector<std::string> m_components;
+  /**
+   * The components of this path, joined by a forward slash. Components are never empty
+   * and never contain a separator, so that the components can be recovered from this
+   * string. Storing a path in a single string makes copying and concatenating paths
+   * cheap.
+   */
+  std::string m_path;
   bool m_absolute;
 
-  Path(bool absolute, const std::vector<std::string>& components);
+  Path(bool absolute, std::string path);
 
 public:
   explicit Path(const std::string& path = "");
@@ -88,7 +105,7 @@ public:
   Path prefix(size_t count) const;
   Path suffix(size_t count) const;
   Path subPath(size_t index, size_t count) const;
-  const std::vector<std::string>& components() const;
+  std::vector<std::string> components() const;
 
   std::string filename() const;
   std::string basename() const;
@@ -128,10 +145,27 @@ public:
     const std::vector<Path>& paths, const Path& relativePath);
 
 private:
-  static bool hasDriveSpec(const std::vector<std::string>& components);
-  static bool hasDriveSpec(const std::string& component);
-  std::vector<std::string> resolvePath(
-    bool absolute, const std::vector<std::string>& components) const;
+  static constexpr char ComponentSeparator = '/';
+
+  /**
+   * Returns the component of the given joined path that starts at the given position and
+   * advances the position to the start of the next component.
+   */
+  static std::string_view nextComponent(const std::string_view path, size_t& position)
+  {
+    const auto end = std::min(path.find(ComponentSeparator, position), path.size());
+    const auto result = path.substr(position, end - position);
+    position = end + 1u;
+    return result;
+  }
+
+  std::string_view firstComponentView() const;
+  std::string_view lastComponentView() const;
+  size_t componentOffset(size_t index) const;
+
+  static bool hasDriveSpec(std::string_view component);
+  static std::string joinComponents(const std::vector<std::string_view>& components);
+  static std::vector<std::string_view> resolvePath(bool absolute, std::string_view path);
 };
 
 std::ostream& operator<<(std::ostream& stream, const Path& path);
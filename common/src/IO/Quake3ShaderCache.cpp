@@ -0,0 +1,313 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Quake3ShaderCache.h"
+
+#include "Exceptions.h"
+#include "IO/CacheFile.h"
+#include "IO/DiskIO.h"
+#include "IO/FileSystem.h"
+#include "IO/PathQt.h"
+#include "IO/Reader.h"
+#include "Logger.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+
+#include <optional>
+#include <sstream>
+
+namespace TrenchBroom
+{
+namespace IO
+{
+namespace
+{
+// Increment whenever the cache format or the output of the shader parser changes.
+constexpr auto CacheVersion = uint32_t(1);
+constexpr auto ShaderMagic = uint32_t(0x33514254); // "TBQ3"
+
+bool operator==(
+  const Quake3ShaderCache::HostFile& lhs, const Quake3ShaderCache::HostFile& rhs)
+{
+  return lhs.path == rhs.path && lhs.modificationTime == rhs.modificationTime
+         && lhs.size == rhs.size;
+}
+
+std::optional<Quake3ShaderCache::HostFile> statHostFile(const Path& path)
+{
+  const auto fileInfo = QFileInfo{pathAsQString(Disk::fixPath(path))};
+  if (!fileInfo.isFile())
+  {
+    return std::nullopt;
+  }
+  return Quake3ShaderCache::HostFile{
+    path,
+    int64_t(fileInfo.lastModified().toMSecsSinceEpoch()),
+    uint64_t(fileInfo.size())};
+}
+
+void writePath(CacheWriter& writer, const Path& path)
+{
+  writer.writeString(path.asString());
+}
+
+Path readPath(Reader& reader)
+{
+  return Path{readString(reader)};
+}
+
+void writeShader(CacheWriter& writer, const Assets::Quake3Shader& shader)
+{
+  writePath(writer, shader.shaderPath);
+  writePath(writer, shader.editorImage);
+  writePath(writer, shader.lightImage);
+  writer.write(static_cast<uint32_t>(shader.culling));
+
+  writer.writeSize(shader.surfaceParms.size());
+  for (const auto& surfaceParm : shader.surfaceParms)
+  {
+    writer.writeString(surfaceParm);
+  }
+
+  writer.writeSize(shader.stages.size());
+  for (const auto& stage : shader.stages)
+  {
+    writePath(writer, stage.map);
+    writer.writeString(stage.blendFunc.srcFactor);
+    writer.writeString(stage.blendFunc.destFactor);
+  }
+}
+
+Assets::Quake3Shader readShader(Reader& reader)
+{
+  auto shader = Assets::Quake3Shader();
+  shader.shaderPath = readPath(reader);
+  shader.editorImage = readPath(reader);
+  shader.lightImage = readPath(reader);
+  shader.culling =
+    static_cast<Assets::Quake3Shader::Culling>(reader.readUnsignedInt<uint32_t>());
+
+  const auto surfaceParmCount = readCount(reader, sizeof(uint64_t));
+  for (size_t i = 0u; i < surfaceParmCount; ++i)
+  {
+    shader.surfaceParms.insert(readString(reader));
+  }
+
+  const auto stageCount = readCount(reader, 3u * sizeof(uint64_t));
+  for (size_t i = 0u; i < stageCount; ++i)
+  {
+    auto& stage = shader.addStage();
+    stage.map = readPath(reader);
+    stage.blendFunc.srcFactor = readString(reader);
+    stage.blendFunc.destFactor = readString(reader);
+  }
+
+  return shader;
+}
+
+void writeScript(
+  CacheWriter& writer,
+  const Quake3ShaderScript& script,
+  const Quake3ShaderCache::HostFile& hostFile)
+{
+  writePath(writer, script.path);
+  writePath(writer, hostFile.path);
+  writer.write(hostFile.modificationTime);
+  writer.write(hostFile.size);
+  writer.writeString(script.error);
+
+  writer.writeSize(script.messages.size());
+  for (const auto& [level, message] : script.messages)
+  {
+    writer.write(static_cast<uint32_t>(level));
+    writer.writeString(message);
+  }
+
+  writer.writeSize(script.shaders.size());
+  for (const auto& shader : script.shaders)
+  {
+    writeShader(writer, shader);
+  }
+}
+
+std::pair<Quake3ShaderScript, Quake3ShaderCache::HostFile> readScript(Reader& reader)
+{
+  auto script = Quake3ShaderScript();
+  script.path = readPath(reader);
+
+  auto hostPath = readPath(reader);
+  const auto modificationTime = reader.read<int64_t, int64_t>();
+  const auto size = reader.read<uint64_t, uint64_t>();
+  auto hostFile =
+    Quake3ShaderCache::HostFile{std::move(hostPath), modificationTime, size};
+
+  script.error = readString(reader);
+
+  const auto messageCount = readCount(reader, sizeof(uint32_t) + sizeof(uint64_t));
+  for (size_t i = 0u; i < messageCount; ++i)
+  {
+    const auto level = static_cast<LogLevel>(reader.readUnsignedInt<uint32_t>());
+    script.messages.emplace_back(level, readString(reader));
+  }
+
+  const auto shaderCount = readCount(reader, 3u * sizeof(uint64_t));
+  script.shaders.reserve(shaderCount);
+  for (size_t i = 0u; i < shaderCount; ++i)
+  {
+    script.shaders.push_back(readShader(reader));
+  }
+
+  return {std::move(script), std::move(hostFile)};
+}
+} // namespace
+
+Quake3ShaderCache::Quake3ShaderCache(Path directory)
+  : m_directory(std::move(directory))
+{
+}
+
+Quake3ShaderCache::HostFiles Quake3ShaderCache::findHostFiles(
+  const FileSystem& fs, const std::vector<Path>& paths)
+{
+  // most scripts are stored in a few packages, so every host file is only checked once
+  auto checkedHostFiles = std::map<Path, std::optional<HostFile>>{};
+
+  auto result = HostFiles{};
+  for (const auto& path : paths)
+  {
+    try
+    {
+      const auto hostPath = fs.findHostFile(path);
+      if (hostPath.isEmpty())
+      {
+        continue;
+      }
+
+      auto it = checkedHostFiles.find(hostPath);
+      if (it == std::end(checkedHostFiles))
+      {
+        it = checkedHostFiles.emplace(hostPath, statHostFile(hostPath)).first;
+      }
+
+      if (it->second)
+      {
+        result.emplace(path, *it->second);
+      }
+    }
+    catch (const Exception&)
+    {
+      // the script cannot be cached
+    }
+  }
+  return result;
+}
+
+std::map<Path, Quake3ShaderScript> Quake3ShaderCache::readScripts(
+  const Path& shaderSearchPath, const HostFiles& hostFiles, Logger& logger) const
+{
+  auto result = std::map<Path, Quake3ShaderScript>{};
+
+  const auto path = cachePath(shaderSearchPath);
+  if (!Disk::fileExists(path))
+  {
+    return result;
+  }
+
+  try
+  {
+    const auto contents = readCacheFile(path);
+    auto reader = Reader::from(contents.data(), contents.data() + contents.size());
+    if (
+      reader.readUnsignedInt<uint32_t>() != ShaderMagic
+      || reader.readUnsignedInt<uint32_t>() != CacheVersion
+      || readString(reader) != shaderSearchPath.asString())
+    {
+      return result;
+    }
+
+    const auto scriptCount = readCount(reader, 5u * sizeof(uint64_t));
+    for (size_t i = 0u; i < scriptCount; ++i)
+    {
+      auto [script, hostFile] = readScript(reader);
+
+      const auto it = hostFiles.find(script.path);
+      if (it != std::end(hostFiles) && it->second == hostFile)
+      {
+        auto scriptPath = script.path;
+        result.emplace(std::move(scriptPath), std::move(script));
+      }
+    }
+  }
+  catch (const std::exception& e)
+  {
+    logger.debug() << "Could not read shader cache for " << shaderSearchPath << ": "
+                   << e.what();
+    result.clear();
+  }
+
+  return result;
+}
+
+void Quake3ShaderCache::writeScripts(
+  const Path& shaderSearchPath,
+  const std::vector<Quake3ShaderScript>& scripts,
+  const HostFiles& hostFiles,
+  Logger& logger) const
+{
+  try
+  {
+    auto cachedScripts =
+      std::vector<std::pair<const Quake3ShaderScript*, const HostFile*>>{};
+    for (const auto& script : scripts)
+    {
+      const auto it = hostFiles.find(script.path);
+      if (it != std::end(hostFiles))
+      {
+        cachedScripts.emplace_back(&script, &it->second);
+      }
+    }
+
+    auto writer = CacheWriter{};
+    writer.write(ShaderMagic);
+    writer.write(CacheVersion);
+    writer.writeString(shaderSearchPath.asString());
+    writer.writeSize(cachedScripts.size());
+    for (const auto& [script, hostFile] : cachedScripts)
+    {
+      writeScript(writer, *script, *hostFile);
+    }
+
+    replaceCacheFile(cachePath(shaderSearchPath), writer.buffer());
+  }
+  catch (const std::exception& e)
+  {
+    logger.debug() << "Could not write shader cache for " << shaderSearchPath << ": "
+                   << e.what();
+  }
+}
+
+Path Quake3ShaderCache::cachePath(const Path& shaderSearchPath) const
+{
+  auto str = std::stringstream{};
+  str << std::hex << hashBytes(shaderSearchPath.asString()) << ".shaders";
+  return m_directory + Path{str.str()};
+}
+} // namespace IO
+} // namespace TrenchBroom
@@ -0,0 +1,113 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Assets/Quake3Shader.h"
+#include "IO/Path.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace TrenchBroom
+{
+class Logger;
+enum class LogLevel;
+
+namespace IO
+{
+class FileSystem;
+
+/**
+ * The shaders parsed from a shader script and the messages logged while parsing it.
+ */
+struct Quake3ShaderScript
+{
+  Path path;
+  std::vector<Assets::Quake3Shader> shaders;
+  std::vector<std::pair<LogLevel, std::string>> messages;
+  /**
+   * The parse error, or an empty string if the script was parsed successfully.
+   */
+  std::string error;
+};
+
+/**
+ * Stores parsed Quake 3 shader scripts in a directory on disk.
+ *
+ * Every cached script records the file on disk that stores it, i.e. the script itself or
+ * the package that contains it, together with the modification time and size of that
+ * file. A cached script is only used if its host file is unchanged, so the scripts don't
+ * need to be read to validate the cache.
+ *
+ * All errors are logged and otherwise ignored, so callers can always fall back to parsing
+ * the scripts.
+ */
+class Quake3ShaderCache
+{
+public:
+  struct HostFile
+  {
+    Path path;
+    int64_t modificationTime;
+    uint64_t size;
+  };
+
+  /**
+   * Maps shader script paths to the files on disk that store them.
+   */
+  using HostFiles = std::map<Path, HostFile>;
+
+private:
+  Path m_directory;
+
+public:
+  explicit Quake3ShaderCache(Path directory);
+
+  /**
+   * Finds the host files of the given shader scripts. Scripts that are not stored on disk
+   * are omitted, they are never cached.
+   */
+  static HostFiles findHostFiles(const FileSystem& fs, const std::vector<Path>& paths);
+
+  /**
+   * Returns the cached scripts for the given shader search path whose host files match
+   * the given host files, keyed by their paths.
+   */
+  std::map<Path, Quake3ShaderScript> readScripts(
+    const Path& shaderSearchPath, const HostFiles& hostFiles, Logger& logger) const;
+
+  /**
+   * Replaces the cached scripts for the given shader search path with the given scripts.
+   * Only scripts that have a host file are stored.
+   */
+  void writeScripts(
+    const Path& shaderSearchPath,
+    const std::vector<Quake3ShaderScript>& scripts,
+    const HostFiles& hostFiles,
+    Logger& logger) const;
+
+private:
+  Path cachePath(const Path& shaderSearchPath) const;
+};
+} // namespace IO
+} // namespace TrenchBroom
@@ -20,16 +20,23 @@
 #include "Quake3ShaderFileSystem.h"
 
 #include "Assets/Quake3Shader.h"
+#include "Exceptions.h"
 #include "IO/File.h"
 #include "IO/FileMatcher.h"
+#include "IO/ParserStatus.h"
+#include "IO/Quake3ShaderCache.h"
 #include "IO/Quake3ShaderParser.h"
-#include "IO/SimpleParserStatus.h"
+#include "IO/Reader.h"
 #include "Logger.h"
 
+#include <kdl/parallel.h>
 #include <kdl/vector_utils.h>
 
+#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom
@@ -40,11 +47,13 @@ Quake3ShaderFileSystem::Quake3ShaderFileSystem(
   std::shared_ptr<FileSystem> fs,
   Path shaderSearchPath,
   std::vector<Path> textureSearchPaths,
-  Logger& logger)
+  Logger& logger,
+  std::shared_ptr<Quake3ShaderCache> cache)
   : ImageFileSystemBase(std::move(fs), Path())
   , m_shaderSearchPath(std::move(shaderSearchPath))
   , m_textureSearchPaths(std::move(textureSearchPaths))
   , m_logger(logger)
+  , m_cache(std::move(cache))
 {
   initialize();
 }
@@ -58,6 +67,44 @@ void Quake3ShaderFileSystem::doReadDirectory()
   }
 }
 
+namespace
+{
+/**
+ * Collects the messages of a parser so that they can be logged after parsing, because
+ * the logger must only be used on the main thread.
+ */
+class CollectingParserStatus : public ParserStatus
+{
+private:
+  std::vector<std::pair<LogLevel, std::string>> m_messages;
+
+public:
+  CollectingParserStatus(Logger& logger, const std::string& prefix)
+    : ParserStatus(logger, prefix)
+  {
+  }
+
+  const std::vector<std::pair<LogLevel, std::string>>& messages() const
+  {
+    return m_messages;
+  }
+
+private:
+  void doProgress(double) override {}
+
+  void doLog(const LogLevel level, const std::string& str) override
+  {
+    m_messages.emplace_back(level, str);
+  }
+};
+
+struct ShaderScript
+{
+  Path path;
+  std::shared_ptr<File> file;
+};
+} // namespace
+
 std::vector<Assets::Quake3Shader> Quake3ShaderFileSystem::loadShaders() const
 {
   auto result = std::vector<Assets::Quake3Shader>();
@@ -66,20 +113,80 @@ std::vector<Assets::Quake3Shader> Quake3ShaderFileSystem::loadShaders() const
   {
     const auto paths =
       next().findItems(m_shaderSearchPath, FileExtensionMatcher("shader"));
+
+    // cached scripts are used if the files that store them are unchanged
+    const auto hostFiles = m_cache ? Quake3ShaderCache::findHostFiles(next(), paths)
+                                   : Quake3ShaderCache::HostFiles{};
+    auto cachedScripts =
+      m_cache ? m_cache->readScripts(m_shaderSearchPath, hostFiles, m_logger)
+              : std::map<Path, Quake3ShaderScript>{};
+
+    // the file system is not thread safe, so the scripts are opened before parsing them,
+    // but the contents of files in archives are only decompressed when they are read
+    auto scripts = std::vector<ShaderScript>{};
     for (const auto& path : paths)
     {
-      const auto file = next().openFile(path);
-      auto bufferedReader = file->reader().buffer();
+      if (cachedScripts.count(path) == 0u)
+      {
+        scripts.push_back(ShaderScript{path, next().openFile(path)});
+      }
+    }
+
+    auto parsedScripts =
+      kdl::vec_parallel_transform(std::move(scripts), [&](ShaderScript script) {
+        auto status = CollectingParserStatus{m_logger, script.path.asString()};
+        auto parsedScript = Quake3ShaderScript{script.path, {}, {}, {}};
+        try
+        {
+          auto bufferedReader = script.file->reader().buffer();
+          Quake3ShaderParser parser(bufferedReader.stringView());
+          parsedScript.shaders = parser.parse(status);
+        }
+        catch (const Exception& e)
+        {
+          parsedScript.error = e.what();
+        }
+        parsedScript.messages = status.messages();
+        return parsedScript;
+      });
 
-      try
+    // merge the cached and the parsed scripts in the original file order
+    auto allScripts = std::vector<Quake3ShaderScript>{};
+    allScripts.reserve(paths.size());
+    auto parsedScriptIt = std::begin(parsedScripts);
+    for (const auto& path : paths)
+    {
+      if (auto cachedScriptIt = cachedScripts.find(path);
+          cachedScriptIt != std::end(cachedScripts))
       {
-        Quake3ShaderParser parser(bufferedReader.stringView());
-        SimpleParserStatus status(m_logger, file->path().asString());
-        result = kdl::vec_concat(std::move(result), parser.parse(status));
+        allScripts.push_back(std::move(cachedScriptIt->second));
       }
-      catch (const ParserException& e)
+      else
       {
-        m_logger.warn() << "Skipping malformed shader file " << path << ": " << e.what();
+        allScripts.push_back(std::move(*parsedScriptIt++));
+      }
+    }
+
+    if (m_cache && !parsedScripts.empty())
+    {
+      m_cache->writeScripts(m_shaderSearchPath, allScripts, hostFiles, m_logger);
+    }
+
+    for (auto& script : allScripts)
+    {
+      for (const auto& [level, message] : script.messages)
+      {
+        m_logger.log(level, message);
+      }
+
+      if (script.error.empty())
+      {
+        result = kdl::vec_concat(std::move(result), std::move(script.shaders));
+      }
+      else
+      {
+        m_logger.warn() << "Skipping malformed shader file " << script.path << ": "
+                        << script.error;
       }
     }
   }
@@ -112,6 +219,16 @@ void Quake3ShaderFileSystem::linkTextures(
   const std::vector<Path>& textures, std::vector<Assets::Quake3Shader>& shaders)
 {
   m_logger.debug() << "Linking textures...";
+
+  // maps every shader path to the index of the first shader with that path
+  auto shaderIndices = std::unordered_map<std::string, size_t>{};
+  shaderIndices.reserve(shaders.size());
+  for (size_t i = 0; i < shaders.size(); ++i)
+  {
+    shaderIndices.emplace(shaders[i].shaderPath.asString("/"), i);
+  }
+
+  auto linked = std::vector<bool>(shaders.size(), false);
   for (const auto& texture : textures)
   {
     const auto shaderPath = texture.deleteExtension();
@@ -119,22 +236,18 @@ void Quake3ShaderFileSystem::linkTextures(
     // Only link a shader if it has not been linked yet.
     if (!fileExists(shaderPath))
     {
-      const auto shaderIt = std::find_if(
-        std::begin(shaders), std::end(shaders), [&shaderPath](const auto& shader) {
-          return shaderPath == shader.shaderPath;
-        });
-
-      if (shaderIt != std::end(shaders))
+      const auto shaderIt = shaderIndices.find(shaderPath.asString("/"));
+      if (shaderIt != std::end(shaderIndices))
       {
         // Found a matching shader.
-        auto& shader = *shaderIt;
+        const auto& shader = shaders[shaderIt->second];
 
         auto shaderFile =
           std::make_shared<ObjectFile<Assets::Quake3Shader>>(shaderPath, shader);
         m_root.addFile(shaderPath, shaderFile);
 
-        // Remove the shader so that we don't revisit it when linking standalone shaders.
-        shaders.erase(shaderIt);
+        // Mark the shader so that we don't revisit it when linking standalone shaders.
+        linked[shaderIt->second] = true;
       }
       else
       {
@@ -149,6 +262,17 @@ void Quake3ShaderFileSystem::linkTextures(
       }
     }
   }
+
+  auto unlinked = std::vector<Assets::Quake3Shader>{};
+  unlinked.reserve(shaders.size());
+  for (size_t i = 0; i < shaders.size(); ++i)
+  {
+    if (!linked[i])
+    {
+      unlinked.push_back(std::move(shaders[i]));
+    }
+  }
+  shaders = std::move(unlinked);
 }
 
 void Quake3ShaderFileSystem::linkStandaloneShaders(
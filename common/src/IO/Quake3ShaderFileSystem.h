@@ -21,6 +21,7 @@
 
 #include "IO/ImageFileSystem.h"
 
+#include <memory>
 #include <vector>
 
 namespace TrenchBroom
@@ -34,6 +35,8 @@ class Quake3Shader;
 
 namespace IO
 {
+class Quake3ShaderCache;
+
 /**
  * Parses Quake 3 shader scripts found in a file system and makes the shader objects
  * available as virtual files in the file system.
@@ -47,6 +50,7 @@ private:
   Path m_shaderSearchPath;
   std::vector<Path> m_textureSearchPaths;
   Logger& m_logger;
+  std::shared_ptr<Quake3ShaderCache> m_cache;
 
 public:
   /**
@@ -61,12 +65,15 @@ public:
    * @param shaderSearchPath the path at which to search for shader scripts
    * @param textureSearchPaths the paths at which to search for texture images
    * @param logger the logger to use
+   * @param cache the cache for parsed shader scripts, or null if they should not be
+   * cached
    */
   Quake3ShaderFileSystem(
     std::shared_ptr<FileSystem> fs,
     Path shaderSearchPath,
     std::vector<Path> textureSearchPaths,
-    Logger& logger);
+    Logger& logger,
+    std::shared_ptr<Quake3ShaderCache> cache = nullptr);
 
 private:
   void doReadDirectory() override;
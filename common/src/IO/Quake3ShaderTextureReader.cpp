@@ -27,6 +27,7 @@
 #include "IO/ResourceUtils.h"
 #include "Renderer/GL.h"
 
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -49,14 +50,7 @@ Assets::Texture Quake3ShaderTextureReader::doReadTexture(std::shared_ptr<File> f
   }
 
   const auto& shader = shaderFile->object();
-  const auto texturePath = findTexturePath(shader);
-  if (texturePath.isEmpty())
-  {
-    throw AssetException(
-      "Could not find texture path for shader '" + shader.shaderPath.asString() + "'");
-  }
-
-  auto texture = loadTextureImage(shader.shaderPath, texturePath);
+  auto texture = loadTextureImage(shader);
   texture.setSurfaceParms(shader.surfaceParms);
   texture.setOpaque();
 
@@ -93,16 +87,31 @@ Assets::Texture Quake3ShaderTextureReader::doReadTexture(std::shared_ptr<File> f
 }
 
 Assets::Texture Quake3ShaderTextureReader::loadTextureImage(
-  const Path& shaderPath, const Path& imagePath) const
+  const Assets::Quake3Shader& shader) const
 {
-  const auto name = textureName(shaderPath);
+  // the file system must not be accessed concurrently, but the image can be decoded in
+  // parallel once its contents have been read into memory
+  auto lock = std::unique_lock<std::mutex>{m_fsMutex};
+
+  const auto imagePath = findTexturePath(shader);
+  if (imagePath.isEmpty())
+  {
+    throw AssetException(
+      "Could not find texture path for shader '" + shader.shaderPath.asString() + "'");
+  }
   if (!m_fs.fileExists(imagePath))
   {
     throw AssetException("Image file '" + imagePath.asString() + "' does not exist");
   }
 
-  FreeImageTextureReader imageReader(StaticNameStrategy(name), m_fs, m_logger);
-  return imageReader.readTexture(m_fs.openFile(imagePath));
+  const auto imageFile = m_fs.openFile(imagePath);
+  auto reader = imageFile->reader().buffer();
+  lock.unlock();
+
+  const auto* begin = reinterpret_cast<const uint8_t*>(reader.begin());
+  const auto size = static_cast<size_t>(reader.end() - reader.begin());
+  return FreeImageTextureReader::readTextureFromMemory(
+    textureName(shader.shaderPath), begin, size);
 }
 
 Path Quake3ShaderTextureReader::findTexturePath(const Assets::Quake3Shader& shader) const
@@ -22,6 +22,7 @@
 #include "IO/TextureReader.h"
 
 #include <memory>
+#include <mutex>
 
 namespace TrenchBroom
 {
@@ -43,6 +44,9 @@ class Path;
  */
 class Quake3ShaderTextureReader : public TextureReader
 {
+private:
+  mutable std::mutex m_fsMutex;
+
 public:
   /**
    * Creates a texture reader using the given name strategy and file system to locate the
@@ -57,7 +61,7 @@ public:
 
 private:
   Assets::Texture doReadTexture(std::shared_ptr<File> file) const override;
-  Assets::Texture loadTextureImage(const Path& shaderPath, const Path& imagePath) const;
+  Assets::Texture loadTextureImage(const Assets::Quake3Shader& shader) const;
   Path findTexturePath(const Assets::Quake3Shader& shader) const;
   Path findTexture(const Path& texturePath) const;
 };
@@ -0,0 +1,73 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RecordingFileSystem.h"
+
+#include <kdl/vector_utils.h>
+
+namespace TrenchBroom
+{
+namespace IO
+{
+RecordingFileSystem::RecordingFileSystem(const FileSystem& fs)
+  : m_fs{fs}
+{
+}
+
+const std::vector<Path>& RecordingFileSystem::openedFiles() const
+{
+  return m_openedFiles;
+}
+
+bool RecordingFileSystem::doCanMakeAbsolute(const Path& path) const
+{
+  return m_fs.canMakeAbsolute(path);
+}
+
+Path RecordingFileSystem::doMakeAbsolute(const Path& path) const
+{
+  return m_fs.makeAbsolute(path);
+}
+
+bool RecordingFileSystem::doDirectoryExists(const Path& path) const
+{
+  return m_fs.directoryExists(path);
+}
+
+bool RecordingFileSystem::doFileExists(const Path& path) const
+{
+  return m_fs.fileExists(path);
+}
+
+std::vector<Path> RecordingFileSystem::doGetDirectoryContents(const Path& path) const
+{
+  return m_fs.getDirectoryContents(path);
+}
+
+std::shared_ptr<File> RecordingFileSystem::doOpenFile(const Path& path) const
+{
+  auto file = m_fs.openFile(path);
+  if (!kdl::vec_contains(m_openedFiles, path))
+  {
+    m_openedFiles.push_back(path);
+  }
+  return file;
+}
+} // namespace IO
+} // namespace TrenchBroom
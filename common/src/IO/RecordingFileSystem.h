@@ -0,0 +1,62 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "IO/FileSystem.h"
+#include "IO/Path.h"
+
+#include <memory>
+#include <vector>
+
+namespace TrenchBroom
+{
+namespace IO
+{
+/**
+ * Forwards all requests to another file system and records the paths of all files that
+ * were opened through it. This can be used to find the files that a parser depends on.
+ */
+class RecordingFileSystem : public FileSystem
+{
+private:
+  const FileSystem& m_fs;
+  mutable std::vector<Path> m_openedFiles;
+
+public:
+  explicit RecordingFileSystem(const FileSystem& fs);
+
+  /**
+   * Returns the paths of the files opened through this file system, in the order in which
+   * they were first opened.
+   */
+  const std::vector<Path>& openedFiles() const;
+
+private:
+  bool doCanMakeAbsolute(const Path& path) const override;
+  Path doMakeAbsolute(const Path& path) const override;
+
+  bool doDirectoryExists(const Path& path) const override;
+  bool doFileExists(const Path& path) const override;
+
+  std::vector<Path> doGetDirectoryContents(const Path& path) const override;
+  std::shared_ptr<File> doOpenFile(const Path& path) const override;
+};
+} // namespace IO
+} // namespace TrenchBroom
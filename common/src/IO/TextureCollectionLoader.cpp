@@ -19,6 +19,7 @@
 
 #include "TextureCollectionLoader.h"
 
+#include "Assets/Texture.h"
 #include "Assets/TextureCollection.h"
 #include "IO/DiskIO.h"
 #include "IO/File.h"
@@ -28,7 +29,11 @@
 #include "IO/WadFileSystem.h"
 #include "Logger.h"
 
+#include <kdl/parallel.h>
+#include <kdl/string_compare.h>
+
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace TrenchBroom
@@ -56,6 +61,90 @@ bool TextureCollectionLoader::shouldExclude(const std::string& textureName)
   return false;
 }
 
+/**
+ * The loaders of evictable textures keep their files until the texture collection is
+ * unloaded. Files that refer to an archive which is mapped into memory would keep the
+ * archive mapped, and decoding such a file again after the archive was rewritten or
+ * truncated would access invalid memory. Therefore every file that cannot load its
+ * contents into memory it owns is copied.
+ */
+static std::shared_ptr<File> readIntoMemory(std::shared_ptr<File> file)
+{
+  if (file->loadContents())
+  {
+    return file;
+  }
+
+  auto reader = file->reader();
+  const auto size = reader.size();
+  auto buffer = std::make_unique<char[]>(size);
+  reader.read(buffer.get(), size);
+  return std::make_shared<OwningBufferFile>(file->path(), std::move(buffer), size);
+}
+
+std::vector<std::optional<Assets::Texture>> TextureCollectionLoader::readTextures(
+  FileList files, const std::shared_ptr<const TextureReader>& textureReader)
+{
+  struct DecodedTexture
+  {
+    std::shared_ptr<File> file;
+    std::optional<Assets::Texture> texture;
+  };
+
+  // read and decode the textures in parallel, every file is only accessed by one thread,
+  // but leave error handling to the calling thread since reporting errors requires the
+  // logger and the file system
+  auto decodedTextures =
+    kdl::vec_parallel_transform(std::move(files), [&](std::shared_ptr<File> file) {
+      try
+      {
+        auto ownedFile = readIntoMemory(file);
+        auto texture = textureReader->decodeTexture(ownedFile);
+        return DecodedTexture{std::move(ownedFile), std::move(texture)};
+      }
+      catch (const std::exception&)
+      {
+        return DecodedTexture{std::move(file), std::nullopt};
+      }
+    });
+
+  auto textures = std::vector<std::optional<Assets::Texture>>{};
+  textures.reserve(decodedTextures.size());
+
+  for (auto& [file, texture] : decodedTextures)
+  {
+    if (texture)
+    {
+      texture->setLoader([textureReader, file = file]() {
+        try
+        {
+          return textureReader->decodeTexture(file);
+        }
+        catch (const std::exception&)
+        {
+          // an empty texture is not uploaded
+          return Assets::Texture{file->path().asString(), 0, 0};
+        }
+      });
+    }
+    else
+    {
+      try
+      {
+        // read the texture again to log the error and fall back to the default texture
+        texture = textureReader->readTexture(file);
+      }
+      catch (const std::exception& e)
+      {
+        m_logger.warn() << e.what();
+      }
+    }
+    textures.push_back(std::move(texture));
+  }
+
+  return textures;
+}
+
 FileTextureCollectionLoader::FileTextureCollectionLoader(
   Logger& logger,
   const std::vector<IO::Path>& searchPaths,
@@ -68,15 +157,15 @@ FileTextureCollectionLoader::FileTextureCollectionLoader(
 Assets::TextureCollection FileTextureCollectionLoader::loadTextureCollection(
   const Path& path,
   const std::vector<std::string>& textureExtensions,
-  const TextureReader& textureReader)
+  std::shared_ptr<const TextureReader> textureReader)
 {
   const auto wadPath = Disk::resolvePath(m_searchPaths, path);
   WadFileSystem wadFS(wadPath, m_logger);
 
   const auto texturePaths =
     wadFS.findItems(Path(""), FileExtensionMatcher(textureExtensions));
-  auto textures = std::vector<Assets::Texture>();
-  textures.reserve(texturePaths.size());
+  auto files = FileList();
+  files.reserve(texturePaths.size());
 
   for (const auto& texturePath : texturePaths)
   {
@@ -88,7 +177,7 @@ Assets::TextureCollection FileTextureCollectionLoader::loadTextureCollection(
       {
         continue;
       }
-      textures.push_back(textureReader.readTexture(file));
+      files.push_back(std::move(file));
     }
     catch (const std::exception& e)
     {
@@ -96,6 +185,17 @@ Assets::TextureCollection FileTextureCollectionLoader::loadTextureCollection(
     }
   }
 
+  auto textures = std::vector<Assets::Texture>();
+  textures.reserve(files.size());
+
+  for (auto& texture : readTextures(std::move(files), textureReader))
+  {
+    if (texture)
+    {
+      textures.push_back(std::move(*texture));
+    }
+  }
+
   return Assets::TextureCollection(path, std::move(textures));
 }
 
@@ -109,12 +209,16 @@ DirectoryTextureCollectionLoader::DirectoryTextureCollectionLoader(
 Assets::TextureCollection DirectoryTextureCollectionLoader::loadTextureCollection(
   const Path& path,
   const std::vector<std::string>& textureExtensions,
-  const TextureReader& textureReader)
+  std::shared_ptr<const TextureReader> textureReader)
 {
   const auto texturePaths =
     m_gameFS.findItems(path, FileExtensionMatcher(textureExtensions));
-  auto textures = std::vector<Assets::Texture>();
-  textures.reserve(texturePaths.size());
+  auto files = FileList();
+  auto relativePaths = std::vector<Path>();
+  auto absolutePaths = std::vector<Path>();
+  files.reserve(texturePaths.size());
+  relativePaths.reserve(texturePaths.size());
+  absolutePaths.reserve(texturePaths.size());
 
   for (const auto& texturePath : texturePaths)
   {
@@ -138,10 +242,9 @@ Assets::TextureCollection DirectoryTextureCollectionLoader::loadTextureCollectio
       {
         continue;
       }
-      auto texture = textureReader.readTexture(file);
-      texture.setAbsolutePath(absolutePath);
-      texture.setRelativePath(texturePath);
-      textures.push_back(std::move(texture));
+      files.push_back(std::move(file));
+      relativePaths.push_back(texturePath);
+      absolutePaths.push_back(std::move(absolutePath));
     }
     catch (const std::exception& e)
     {
@@ -149,6 +252,20 @@ Assets::TextureCollection DirectoryTextureCollectionLoader::loadTextureCollectio
     }
   }
 
+  auto decodedTextures = readTextures(std::move(files), textureReader);
+  auto textures = std::vector<Assets::Texture>();
+  textures.reserve(decodedTextures.size());
+
+  for (size_t i = 0u; i < decodedTextures.size(); ++i)
+  {
+    if (auto& texture = decodedTextures[i])
+    {
+      texture->setAbsolutePath(absolutePaths[i]);
+      texture->setRelativePath(relativePaths[i]);
+      textures.push_back(std::move(*texture));
+    }
+  }
+
   return Assets::TextureCollection(path, std::move(textures));
 }
 } // namespace IO
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -29,6 +30,7 @@ class Logger;
 
 namespace Assets
 {
+class Texture;
 class TextureCollection;
 }
 
@@ -59,10 +61,24 @@ public:
   virtual Assets::TextureCollection loadTextureCollection(
     const Path& path,
     const std::vector<std::string>& textureExtensions,
-    const TextureReader& textureReader) = 0;
+    std::shared_ptr<const TextureReader> textureReader) = 0;
 
 protected:
   bool shouldExclude(const std::string& textureName);
+
+  /**
+   * Reads the textures from the given files. The textures are decoded in parallel, so the
+   * given files must not share any state such as file handles.
+   *
+   * If a texture cannot be decoded, the error is logged and the texture reader's fallback
+   * texture is returned instead. If that fails too, the corresponding element of the
+   * returned vector is empty.
+   *
+   * Every texture that was decoded successfully keeps its file and the texture reader so
+   * that it can be decoded again after it was evicted.
+   */
+  std::vector<std::optional<Assets::Texture>> readTextures(
+    FileList files, const std::shared_ptr<const TextureReader>& textureReader);
 };
 
 class FileTextureCollectionLoader : public TextureCollectionLoader
@@ -80,7 +96,7 @@ private:
   Assets::TextureCollection loadTextureCollection(
     const Path& path,
     const std::vector<std::string>& textureExtensions,
-    const TextureReader& textureReader);
+    std::shared_ptr<const TextureReader> textureReader);
 };
 
 class DirectoryTextureCollectionLoader : public TextureCollectionLoader
@@ -96,7 +112,7 @@ private:
   Assets::TextureCollection loadTextureCollection(
     const Path& path,
     const std::vector<std::string>& textureExtensions,
-    const TextureReader& textureReader);
+    std::shared_ptr<const TextureReader> textureReader);
 };
 } // namespace IO
 } // namespace TrenchBroom
@@ -150,7 +150,7 @@ std::unique_ptr<TextureCollectionLoader> TextureLoader::createTextureCollectionL
 Assets::TextureCollection TextureLoader::loadTextureCollection(const Path& path)
 {
   return m_textureCollectionLoader->loadTextureCollection(
-    path, m_textureExtensions, *m_textureReader);
+    path, m_textureExtensions, m_textureReader);
 }
 
 void TextureLoader::loadTextures(
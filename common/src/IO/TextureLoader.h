@@ -52,7 +52,7 @@ class TextureLoader
 {
 private:
   std::vector<std::string> m_textureExtensions;
-  std::unique_ptr<TextureReader> m_textureReader;
+  std::shared_ptr<const TextureReader> m_textureReader;
   std::unique_ptr<TextureCollectionLoader> m_textureCollectionLoader;
 
 public:
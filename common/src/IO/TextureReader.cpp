@@ -27,6 +27,7 @@
 #include "Logger.h"
 
 #include <algorithm>
+#include <utility>
 
 namespace TrenchBroom
 {
@@ -126,6 +127,11 @@ Assets::Texture TextureReader::readTexture(std::shared_ptr<File> file) const
   }
 }
 
+Assets::Texture TextureReader::decodeTexture(std::shared_ptr<File> file) const
+{
+  return doReadTexture(std::move(file));
+}
+
 std::string TextureReader::textureName(
   const std::string& textureName, const Path& path) const
 {
@@ -143,6 +143,17 @@ public:
    */
   Assets::Texture readTexture(std::shared_ptr<File> file) const;
 
+  /**
+   * Loads a texture from the given file and returns it. Unlike readTexture, this function
+   * neither logs errors nor falls back to the default texture, which makes it safe to
+   * call concurrently for different files.
+   *
+   * @param file the file containing the texture
+   * @return an Assets::Texture object
+   * @throw AssetException if the texture cannot be loaded
+   */
+  Assets::Texture decodeTexture(std::shared_ptr<File> file) const;
+
 protected:
   std::string textureName(const std::string& textureName, const Path& path) const;
   std::string textureName(const Path& path) const;
@@ -153,6 +164,8 @@ private:
    * throw exceptions to report errors loading textures except for unrecoverable errors
    * (out of memory, bugs, etc.).
    *
+   * Implementations must be safe to call concurrently for different files.
+   *
    * @param file the file containing the texture
    * @return an Assets::Texture object
    */
@@ -77,9 +77,9 @@ Assets::Texture WalTextureReader::readQ2Wal(
   BufferedReader& reader, const Path& path) const
 {
   static const size_t MaxMipLevels = 4;
-  static Color averageColor;
-  static Assets::TextureBufferList buffers(MaxMipLevels);
-  static size_t offsets[MaxMipLevels];
+  auto averageColor = Color{};
+  auto buffers = Assets::TextureBufferList(MaxMipLevels);
+  size_t offsets[MaxMipLevels];
 
   // https://github.com/id-Software/Quake-2-Tools/blob/master/qe4/qfiles.h#L142
 
@@ -137,9 +137,9 @@ Assets::Texture WalTextureReader::readDkWal(
   BufferedReader& reader, const Path& path) const
 {
   static const size_t MaxMipLevels = 9;
-  static Color averageColor;
-  static Assets::TextureBufferList buffers(MaxMipLevels);
-  static size_t offsets[MaxMipLevels];
+  auto averageColor = Color{};
+  auto buffers = Assets::TextureBufferList(MaxMipLevels);
+  size_t offsets[MaxMipLevels];
 
   // https://gist.github.com/DanielGibson/a53c74b10ddd0a1f3d6ab42909d5b7e1
 
@@ -228,7 +228,7 @@ bool WalTextureReader::readMips(
   Color& averageColor,
   const Assets::PaletteTransparency transparency)
 {
-  static Color tempColor;
+  auto tempColor = Color{};
 
   auto hasTransparency = false;
   for (size_t i = 0; i < mipLevels; ++i)
@@ -19,102 +19,264 @@
 
 #include "ZipFileSystem.h"
 
-#include "IO/DiskFileSystem.h"
+#include "Exceptions.h"
 #include "IO/File.h"
+#include "IO/Reader.h"
 
+#include <kdl/invoke.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <miniz/miniz.h>
 
 namespace TrenchBroom
 {
 namespace IO
 {
-// ZipFileSystem::ZipCompressedFile
-
-ZipFileSystem::ZipCompressedFile::ZipCompressedFile(
-  ZipFileSystem* owner, const mz_uint fileIndex)
-  : m_owner(owner)
-  , m_fileIndex(fileIndex)
+namespace
 {
-}
+using Data = std::shared_ptr<const std::vector<char>>;
 
-std::shared_ptr<File> ZipFileSystem::ZipCompressedFile::doOpen() const
+/**
+ * A cache of decompressed zip entries which is shared by all zip file systems. Entries
+ * are evicted in least recently used order once the total size of the cached entries
+ * exceeds the maximum size. The cache is thread safe.
+ */
+class DecompressedEntryCache
 {
-  const auto path = Path(m_owner->filename(m_fileIndex));
+private:
+  static constexpr size_t MaxSize = 64u * 1024u * 1024u;
 
-  mz_zip_archive_file_stat stat;
-  if (!mz_zip_reader_file_stat(&m_owner->m_archive, m_fileIndex, &stat))
-  {
-    throw FileSystemException("mz_zip_reader_file_stat failed for " + path.asString());
-  }
+  using Entry = std::pair<std::string, Data>;
 
-  const auto uncompressedSize = static_cast<size_t>(stat.m_uncomp_size);
-  auto data = std::make_unique<char[]>(uncompressedSize);
-  auto* begin = data.get();
+  std::mutex m_mutex;
+  std::list<Entry> m_entries;
+  std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+  size_t m_size = 0u;
 
-  if (!mz_zip_reader_extract_to_mem(
-        &m_owner->m_archive, m_fileIndex, begin, uncompressedSize, 0))
+public:
+  Data get(const std::string& key)
   {
-    throw FileSystemException(
-      "mz_zip_reader_extract_to_mem failed for " + path.asString());
+    const auto lock = std::lock_guard<std::mutex>{m_mutex};
+    const auto it = m_index.find(key);
+    if (it == m_index.end())
+    {
+      return nullptr;
+    }
+
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->second;
   }
 
-  return std::make_shared<OwningBufferFile>(path, std::move(data), uncompressedSize);
-}
+  void put(const std::string& key, Data data)
+  {
+    const auto size = data->size();
+    if (size > MaxSize)
+    {
+      return;
+    }
 
-// ZipFileSystem
+    const auto lock = std::lock_guard<std::mutex>{m_mutex};
+    if (m_index.count(key) != 0u)
+    {
+      // another thread has decompressed the same entry in the meantime
+      return;
+    }
 
-ZipFileSystem::ZipFileSystem(const Path& path)
-  : ZipFileSystem(nullptr, path)
-{
-}
+    m_entries.emplace_front(key, std::move(data));
+    m_index.emplace(key, m_entries.begin());
+    m_size += size;
 
-ZipFileSystem::ZipFileSystem(std::shared_ptr<FileSystem> next, const Path& path)
-  : ImageFileSystem(std::move(next), path)
-{
-  initialize();
-}
+    while (m_size > MaxSize)
+    {
+      const auto& [lruKey, lruData] = m_entries.back();
+      m_size -= lruData->size();
+      m_index.erase(lruKey);
+      m_entries.pop_back();
+    }
+  }
+};
 
-ZipFileSystem::~ZipFileSystem()
+DecompressedEntryCache& decompressedEntryCache()
 {
-  mz_zip_reader_end(&m_archive);
+  static auto cache = DecompressedEntryCache{};
+  return cache;
 }
 
-void ZipFileSystem::doReadDirectory()
+constexpr auto LocalHeaderSignature = 0x04034b50u;
+constexpr auto LocalHeaderSize = size_t(30);
+
+/**
+ * Decompresses the given entry of the given archive. This only reads the memory of the
+ * archive and does not use a miniz archive reader, so it can be called concurrently.
+ */
+std::vector<char> decompress(
+  const Path& path,
+  const MappedFile& archiveFile,
+  const size_t localHeaderOffset,
+  const size_t compressedSize,
+  const size_t uncompressedSize,
+  const std::uint32_t crc32,
+  const std::uint16_t method)
 {
-  mz_zip_zero_struct(&m_archive);
+  // the central directory does not contain the size of the local header's extra field,
+  // so the local header must be read to find the start of the compressed data
+  auto reader = archiveFile.reader();
+  reader.seekFromBegin(localHeaderOffset);
+  if (reader.readUnsignedInt<std::uint32_t>() != LocalHeaderSignature)
+  {
+    throw FileSystemException("Invalid local header for " + path.asString());
+  }
+
+  reader.seekFromBegin(localHeaderOffset + 26u);
+  const auto nameLength = reader.readSize<std::uint16_t>();
+  const auto extraLength = reader.readSize<std::uint16_t>();
 
-  if (mz_zip_reader_init_cfile(&m_archive, m_file->file(), m_file->size(), 0) != MZ_TRUE)
+  const auto dataOffset = localHeaderOffset + LocalHeaderSize + nameLength + extraLength;
+  if (dataOffset > archiveFile.size() || compressedSize > archiveFile.size() - dataOffset)
   {
-    throw FileSystemException("Error calling mz_zip_reader_init_cfile");
+    throw FileSystemException("Invalid compressed size for " + path.asString());
   }
 
-  const mz_uint numFiles = mz_zip_reader_get_num_files(&m_archive);
-  for (mz_uint i = 0; i < numFiles; ++i)
+  const auto* compressedData = archiveFile.begin() + dataOffset;
+  auto result = std::vector<char>(uncompressedSize);
+
+  if (method == 0u)
+  {
+    if (compressedSize != uncompressedSize)
+    {
+      throw FileSystemException("Invalid uncompressed size for " + path.asString());
+    }
+    std::copy_n(compressedData, uncompressedSize, result.data());
+  }
+  else if (method == MZ_DEFLATED)
   {
-    if (!mz_zip_reader_is_file_a_directory(&m_archive, i))
+    const auto decompressedSize = tinfl_decompress_mem_to_mem(
+      result.data(), uncompressedSize, compressedData, compressedSize, 0);
+    if (decompressedSize != uncompressedSize)
     {
-      const auto path = Path(filename(i));
-      m_root.addFile(path, std::make_unique<ZipCompressedFile>(this, i));
+      throw FileSystemException("Error decompressing " + path.asString());
     }
   }
+  else
+  {
+    throw FileSystemException("Unsupported compression method for " + path.asString());
+  }
 
-  const auto err = mz_zip_get_last_error(&m_archive);
-  if (err != MZ_ZIP_NO_ERROR)
+  const auto actualCrc32 = mz_crc32(
+    MZ_CRC32_INIT, reinterpret_cast<const unsigned char*>(result.data()), result.size());
+  if (actualCrc32 != crc32)
   {
-    throw FileSystemException(
-      std::string("Error while reading compressed file: ")
-      + mz_zip_get_error_string(err));
+    throw FileSystemException("CRC mismatch for " + path.asString());
   }
+
+  return result;
 }
 
+/**
+ * A file that decompresses a zip entry when it is read for the first time. The
+ * decompressed data is shared with the decompressed entry cache, so reopening the same
+ * entry does not decompress it again as long as it remains in the cache. Once the entry
+ * is decompressed, the file no longer refers to the archive.
+ */
+class ZipEntryFile : public File
+{
+private:
+  mutable std::shared_ptr<MappedFile> m_archiveFile;
+  size_t m_localHeaderOffset;
+  size_t m_compressedSize;
+  size_t m_uncompressedSize;
+  std::uint32_t m_crc32;
+  std::uint16_t m_method;
+
+  mutable std::once_flag m_once;
+  mutable Data m_data;
+
+public:
+  ZipEntryFile(
+    const Path& path,
+    std::shared_ptr<MappedFile> archiveFile,
+    const size_t localHeaderOffset,
+    const size_t compressedSize,
+    const size_t uncompressedSize,
+    const std::uint32_t crc32,
+    const std::uint16_t method)
+    : File(path)
+    , m_archiveFile(std::move(archiveFile))
+    , m_localHeaderOffset(localHeaderOffset)
+    , m_compressedSize(compressedSize)
+    , m_uncompressedSize(uncompressedSize)
+    , m_crc32(crc32)
+    , m_method(method)
+  {
+  }
+
+  Reader reader() const override
+  {
+    load(true);
+    return Reader::from(m_data->data(), m_data->data() + m_data->size());
+  }
+
+  size_t size() const override { return m_uncompressedSize; }
+
+  bool loadContents() const override
+  {
+    // callers that keep the contents don't need the cache, so don't evict other entries
+    load(false);
+    return true;
+  }
+
+private:
+  void load(const bool cacheData) const
+  {
+    std::call_once(m_once, [&]() {
+      const auto key = m_archiveFile->path().asString() + ":"
+                       + std::to_string(m_localHeaderOffset) + ":"
+                       + std::to_string(m_crc32) + ":" + std::to_string(m_compressedSize);
+
+      auto& cache = decompressedEntryCache();
+      if (auto data = cache.get(key))
+      {
+        m_data = std::move(data);
+      }
+      else
+      {
+        m_data = std::make_shared<const std::vector<char>>(decompress(
+          path(),
+          *m_archiveFile,
+          m_localHeaderOffset,
+          m_compressedSize,
+          m_uncompressedSize,
+          m_crc32,
+          m_method));
+        if (cacheData)
+        {
+          cache.put(key, m_data);
+        }
+      }
+
+      // the decompressed data does not refer to the archive
+      m_archiveFile = nullptr;
+    });
+  }
+};
+
 /**
  * Helper to get the filename of a file in the zip archive
  */
-std::string ZipFileSystem::filename(const mz_uint fileIndex)
+std::string filename(mz_zip_archive& archive, const mz_uint fileIndex)
 {
   // nameLen includes space for the null-terminator byte
-  const mz_uint nameLen = mz_zip_reader_get_filename(&m_archive, fileIndex, nullptr, 0);
+  const mz_uint nameLen = mz_zip_reader_get_filename(&archive, fileIndex, nullptr, 0);
   if (nameLen == 0)
   {
     return "";
@@ -125,9 +287,104 @@ std::string ZipFileSystem::filename(const mz_uint fileIndex)
 
   // NOTE: this will overwrite the std::string's null terminator, which is permitted in
   // C++17 and later
-  mz_zip_reader_get_filename(&m_archive, fileIndex, result.data(), nameLen);
+  mz_zip_reader_get_filename(&archive, fileIndex, result.data(), nameLen);
 
   return result;
 }
+} // namespace
+
+// ZipFileSystem::ZipCompressedFile
+
+ZipFileSystem::ZipCompressedFile::ZipCompressedFile(
+  Path path,
+  std::shared_ptr<MappedFile> archiveFile,
+  const std::uint64_t localHeaderOffset,
+  const std::uint64_t compressedSize,
+  const std::uint64_t uncompressedSize,
+  const std::uint32_t crc32,
+  const std::uint16_t method)
+  : m_path(std::move(path))
+  , m_archiveFile(std::move(archiveFile))
+  , m_localHeaderOffset(localHeaderOffset)
+  , m_compressedSize(compressedSize)
+  , m_uncompressedSize(uncompressedSize)
+  , m_crc32(crc32)
+  , m_method(method)
+{
+}
+
+std::shared_ptr<File> ZipFileSystem::ZipCompressedFile::doOpen() const
+{
+  return std::make_shared<ZipEntryFile>(
+    m_path,
+    m_archiveFile,
+    static_cast<size_t>(m_localHeaderOffset),
+    static_cast<size_t>(m_compressedSize),
+    static_cast<size_t>(m_uncompressedSize),
+    m_crc32,
+    m_method);
+}
+
+// ZipFileSystem
+
+ZipFileSystem::ZipFileSystem(const Path& path)
+  : ZipFileSystem(nullptr, path)
+{
+}
+
+ZipFileSystem::ZipFileSystem(std::shared_ptr<FileSystem> next, const Path& path)
+  : ImageFileSystem(std::move(next), path)
+{
+  initialize();
+}
+
+void ZipFileSystem::doReadDirectory()
+{
+  auto archive = mz_zip_archive{};
+  mz_zip_zero_struct(&archive);
+
+  if (mz_zip_reader_init_mem(&archive, m_file->begin(), m_file->size(), 0) != MZ_TRUE)
+  {
+    throw FileSystemException("Error calling mz_zip_reader_init_mem");
+  }
+
+  // the archive reader is only needed to read the central directory
+  auto endArchive = kdl::invoke_later{[&]() { mz_zip_reader_end(&archive); }};
+
+  const mz_uint numFiles = mz_zip_reader_get_num_files(&archive);
+  for (mz_uint i = 0; i < numFiles; ++i)
+  {
+    if (!mz_zip_reader_is_file_a_directory(&archive, i))
+    {
+      const auto path = Path(filename(archive, i));
+
+      auto stat = mz_zip_archive_file_stat{};
+      if (!mz_zip_reader_file_stat(&archive, i, &stat))
+      {
+        throw FileSystemException(
+          "mz_zip_reader_file_stat failed for " + path.asString());
+      }
+
+      m_root.addFile(
+        path,
+        std::make_unique<ZipCompressedFile>(
+          path,
+          m_file,
+          stat.m_local_header_ofs,
+          stat.m_comp_size,
+          stat.m_uncomp_size,
+          stat.m_crc32,
+          stat.m_method));
+    }
+  }
+
+  const auto err = mz_zip_get_last_error(&archive);
+  if (err != MZ_ZIP_NO_ERROR)
+  {
+    throw FileSystemException(
+      std::string("Error while reading compressed file: ")
+      + mz_zip_get_error_string(err));
+  }
+}
 } // namespace IO
 } // namespace TrenchBroom
@@ -20,47 +20,59 @@
 #pragma once
 
 #include "IO/ImageFileSystem.h"
+#include "IO/Path.h"
 
+#include <cstdint>
 #include <memory>
 
-#include <miniz/miniz.h>
-
 namespace TrenchBroom
 {
 namespace IO
 {
-class Path;
+class MappedFile;
 
 class ZipFileSystem : public ImageFileSystem
 {
 private:
-  mz_zip_archive m_archive;
-
-private:
+  /**
+   * An entry of a zip archive. The entry stores everything that is necessary to
+   * decompress it, so opening it does not access the archive's central directory.
+   * Opening an entry does not decompress it. Instead, the returned file decompresses
+   * its contents when it is read for the first time, and since decompressing an entry
+   * only reads the mapped archive, any number of entries can be decompressed
+   * concurrently.
+   */
   class ZipCompressedFile : public FileEntry
   {
   private:
-    ZipFileSystem* m_owner;
-    mz_uint m_fileIndex;
+    Path m_path;
+    std::shared_ptr<MappedFile> m_archiveFile;
+    std::uint64_t m_localHeaderOffset;
+    std::uint64_t m_compressedSize;
+    std::uint64_t m_uncompressedSize;
+    std::uint32_t m_crc32;
+    std::uint16_t m_method;
 
   public:
-    ZipCompressedFile(ZipFileSystem* owner, mz_uint fileIndex);
+    ZipCompressedFile(
+      Path path,
+      std::shared_ptr<MappedFile> archiveFile,
+      std::uint64_t localHeaderOffset,
+      std::uint64_t compressedSize,
+      std::uint64_t uncompressedSize,
+      std::uint32_t crc32,
+      std::uint16_t method);
 
   private:
     std::shared_ptr<File> doOpen() const override;
   };
-  friend class ZipCompressedFile;
 
 public:
   explicit ZipFileSystem(const Path& path);
   ZipFileSystem(std::shared_ptr<FileSystem> next, const Path& path);
-  ~ZipFileSystem() override;
 
 private:
   void doReadDirectory() override;
-
-private:
-  std::string filename(mz_uint fileIndex);
 };
 } // namespace IO
 } // namespace TrenchBroom
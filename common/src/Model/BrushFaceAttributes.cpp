@@ -90,7 +90,7 @@ void swap(BrushFaceAttributes& lhs, BrushFaceAttributes& rhs)
 
 const std::string& BrushFaceAttributes::textureName() const
 {
-  return m_textureName;
+  return m_textureName.str();
 }
 
 const vm::vec2f& BrushFaceAttributes::offset() const
@@ -178,7 +178,7 @@ bool BrushFaceAttributes::setTextureName(const std::string& textureName)
   }
   else
   {
-    m_textureName = textureName;
+    m_textureName = kdl::interned_string{textureName};
     return true;
   }
 }
@@ -23,6 +23,7 @@
 
 #include <vecmath/forward.h>
 
+#include <kdl/interned_string.h>
 #include <kdl/reflection_decl.h>
 
 #include <optional>
@@ -45,7 +46,8 @@ public:
   static const std::string NoTextureName;
 
 private:
-  std::string m_textureName;
+  // texture names are shared by many faces, so they are interned
+  kdl::interned_string m_textureName;
 
   vm::vec2f m_offset;
   vm::vec2f m_scale;
@@ -22,13 +22,11 @@
 #include "Macros.h"
 #include "Model/Entity.h"
 #include "Model/EntityNodeBase.h"
+#include "Model/EntityNodeStringIndex.h"
 #include "Model/EntityProperties.h"
 
-#include <kdl/compact_trie.h>
 #include <kdl/vector_utils.h>
 
-#include <iterator>
-#include <list>
 #include <string>
 #include <vector>
 
@@ -56,26 +54,21 @@ EntityNodeIndexQuery EntityNodeIndexQuery::any()
   return EntityNodeIndexQuery(Type_Any);
 }
 
-std::set<EntityNodeBase*> EntityNodeIndexQuery::execute(
+std::vector<EntityNodeBase*> EntityNodeIndexQuery::execute(
   const EntityNodeStringIndex& index) const
 {
-  std::set<EntityNodeBase*> result;
   switch (m_type)
   {
   case Type_Exact:
-    index.find_matches(m_pattern, std::inserter(result, std::end(result)));
-    break;
+    return index.findExact(m_pattern);
   case Type_Prefix:
-    index.find_matches(m_pattern + "*", std::inserter(result, std::end(result)));
-    break;
+    return index.findPrefix(m_pattern);
   case Type_Numbered:
-    index.find_matches(m_pattern + "%*", std::inserter(result, std::end(result)));
-    break;
+    return index.findNumbered(m_pattern);
   case Type_Any:
-    break;
+    return {};
     switchDefault();
   }
-  return result;
 }
 
 bool EntityNodeIndexQuery::execute(
@@ -156,35 +149,16 @@ void EntityNodeIndex::removeProperty(
 std::vector<EntityNodeBase*> EntityNodeIndex::findEntityNodes(
   const EntityNodeIndexQuery& keyQuery, const std::string& value) const
 {
-  // first, find Nodes which have `value` as the value for any key
-  std::vector<EntityNodeBase*> result;
-  m_valueIndex->find_matches(value, std::back_inserter(result));
-  if (result.empty())
-  {
-    return {};
-  }
-
-  result = kdl::vec_sort_and_remove_duplicates(std::move(result));
-
-  // next, remove results from the result set that don't match `keyQuery`
-  auto it = std::begin(result);
-  while (it != std::end(result))
-  {
-    const EntityNodeBase* node = *it;
-    if (!keyQuery.execute(node, value))
-      it = result.erase(it);
-    else
-      ++it;
-  }
-
-  return result;
+  // first, find Nodes which have `value` as the value for any key, then keep only those
+  // that also match `keyQuery`
+  return kdl::vec_filter(m_valueIndex->findExact(value), [&](const auto* node) {
+    return keyQuery.execute(node, value);
+  });
 }
 
 std::vector<std::string> EntityNodeIndex::allKeys() const
 {
-  std::vector<std::string> result;
-  m_keyIndex->get_keys(std::back_inserter(result));
-  return result;
+  return m_keyIndex->keys();
 }
 
 std::vector<std::string> EntityNodeIndex::allValuesForKeys(
@@ -192,7 +166,7 @@ std::vector<std::string> EntityNodeIndex::allValuesForKeys(
 {
   std::vector<std::string> result;
 
-  const std::set<EntityNodeBase*> nameResult = keyQuery.execute(*m_keyIndex);
+  const std::vector<EntityNodeBase*> nameResult = keyQuery.execute(*m_keyIndex);
   for (const auto node : nameResult)
   {
     const auto matchingProperties = keyQuery.execute(node);
@@ -19,10 +19,7 @@
 
 #pragma once
 
-#include <kdl/compact_trie_forward.h>
-
 #include <memory>
-#include <set>
 #include <string>
 #include <vector>
 
@@ -31,10 +28,9 @@ namespace TrenchBroom
 namespace Model
 {
 class EntityNodeBase;
+class EntityNodeStringIndex;
 class EntityProperty;
 
-using EntityNodeStringIndex = kdl::compact_trie<EntityNodeBase*>;
-
 class EntityNodeIndexQuery
 {
 public:
@@ -56,7 +52,7 @@ public:
   static EntityNodeIndexQuery numbered(const std::string& pattern);
   static EntityNodeIndexQuery any();
 
-  std::set<EntityNodeBase*> execute(const EntityNodeStringIndex& index) const;
+  std::vector<EntityNodeBase*> execute(const EntityNodeStringIndex& index) const;
   bool execute(const EntityNodeBase* node, const std::string& value) const;
   std::vector<Model::EntityProperty> execute(const EntityNodeBase* node) const;
 
@@ -0,0 +1,450 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntityNodeStringIndex.h"
+
+#include <kdl/vector_utils.h>
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iterator>
+#include <limits>
+
+namespace TrenchBroom
+{
+namespace Model
+{
+static constexpr auto NoStringId = std::numeric_limits<std::uint32_t>::max();
+static constexpr auto NoSlot = std::numeric_limits<std::size_t>::max();
+static constexpr std::size_t MinSlotCount = 16u;
+
+// compact the index once this many entries have become empty and they make up more than
+// half of all entries
+static constexpr std::size_t MinEmptyEntriesForCompaction = 64u;
+
+static const std::vector<EntityNodeBase*> EmptyNodes;
+
+static std::size_t hashString(const std::string_view string)
+{
+  return std::hash<std::string_view>{}(string);
+}
+
+static std::size_t hashPosting(const std::uint32_t stringId, const EntityNodeBase* node)
+{
+  // splitmix64 finalizer, pointers are aligned so their low bits carry no information
+  auto x = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(node))
+           ^ (static_cast<std::uint64_t>(stringId) << 32u);
+  x = (x ^ (x >> 30u)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27u)) * 0x94d049bb133111ebull;
+  x = x ^ (x >> 31u);
+  return static_cast<std::size_t>(x);
+}
+
+static std::size_t slotCountFor(const std::size_t count)
+{
+  // keep the load factor at or below 1/2
+  auto slotCount = MinSlotCount;
+  while (slotCount < 2u * count)
+  {
+    slotCount *= 2u;
+  }
+  return slotCount;
+}
+
+static bool isNumberedSuffix(const std::string_view suffix)
+{
+  return std::all_of(
+    std::begin(suffix), std::end(suffix), [](const char c) { return c >= '0' && c <= '9'; });
+}
+
+EntityNodeStringIndex::EntityNodeStringIndex()
+  : m_stringSlots(MinSlotCount, NoStringId)
+  , m_postingSlots(MinSlotCount, Posting{NoStringId, nullptr, 0u})
+{
+}
+
+void EntityNodeStringIndex::insert(const std::string_view string, EntityNodeBase* node)
+{
+  assert(node != nullptr);
+
+  const auto stringId = findOrInsertStringId(string);
+  auto& entry = m_entries[stringId];
+
+  if (const auto slot = findPostingSlot(stringId, node); slot != NoSlot)
+  {
+    ++entry.counts[m_postingSlots[slot].position];
+    return;
+  }
+
+  if (entry.nodes.empty())
+  {
+    --m_emptyEntryCount;
+  }
+
+  const auto position = static_cast<std::uint32_t>(entry.nodes.size());
+  entry.nodes.push_back(node);
+  entry.counts.push_back(1u);
+  insertPosting(stringId, node, position);
+}
+
+void EntityNodeStringIndex::remove(const std::string_view string, EntityNodeBase* node)
+{
+  const auto stringId = findStringId(string, hashString(string));
+  if (stringId == NoStringId)
+  {
+    return;
+  }
+
+  const auto slot = findPostingSlot(stringId, node);
+  if (slot == NoSlot)
+  {
+    return;
+  }
+
+  auto& entry = m_entries[stringId];
+  const auto position = m_postingSlots[slot].position;
+  if (--entry.counts[position] > 0u)
+  {
+    return;
+  }
+
+  erasePostingSlot(slot);
+
+  // move the last node into the vacated position to keep the node array contiguous
+  const auto last = entry.nodes.size() - 1u;
+  if (position != last)
+  {
+    entry.nodes[position] = entry.nodes[last];
+    entry.counts[position] = entry.counts[last];
+
+    const auto movedSlot = findPostingSlot(stringId, entry.nodes[position]);
+    assert(movedSlot != NoSlot);
+    m_postingSlots[movedSlot].position = position;
+  }
+  entry.nodes.pop_back();
+  entry.counts.pop_back();
+
+  if (entry.nodes.empty())
+  {
+    ++m_emptyEntryCount;
+    if (
+      m_emptyEntryCount >= MinEmptyEntriesForCompaction
+      && 2u * m_emptyEntryCount > m_entries.size())
+    {
+      compact();
+    }
+  }
+}
+
+const std::vector<EntityNodeBase*>& EntityNodeStringIndex::findExact(
+  const std::string_view string) const
+{
+  const auto stringId = findStringId(string, hashString(string));
+  return stringId != NoStringId ? m_entries[stringId].nodes : EmptyNodes;
+}
+
+std::vector<EntityNodeBase*> EntityNodeStringIndex::findPrefix(
+  const std::string_view prefix) const
+{
+  auto result = std::vector<EntityNodeBase*>{};
+
+  const auto [first, last] = findPrefixRange(prefix);
+  for (auto it = first; it != last; ++it)
+  {
+    const auto& nodes = m_entries[*it].nodes;
+    result.insert(std::end(result), std::begin(nodes), std::end(nodes));
+  }
+
+  return kdl::vec_sort_and_remove_duplicates(std::move(result));
+}
+
+std::vector<EntityNodeBase*> EntityNodeStringIndex::findNumbered(
+  const std::string_view prefix) const
+{
+  auto result = std::vector<EntityNodeBase*>{};
+
+  const auto [first, last] = findPrefixRange(prefix);
+  for (auto it = first; it != last; ++it)
+  {
+    const auto& entry = m_entries[*it];
+    if (isNumberedSuffix(std::string_view{entry.string}.substr(prefix.size())))
+    {
+      result.insert(std::end(result), std::begin(entry.nodes), std::end(entry.nodes));
+    }
+  }
+
+  return kdl::vec_sort_and_remove_duplicates(std::move(result));
+}
+
+std::vector<std::string> EntityNodeStringIndex::keys() const
+{
+  auto result = std::vector<std::string>{};
+  result.reserve(m_entries.size() - m_emptyEntryCount);
+
+  for (const auto& entry : m_entries)
+  {
+    if (!entry.nodes.empty())
+    {
+      result.push_back(entry.string);
+    }
+  }
+
+  return result;
+}
+
+bool EntityNodeStringIndex::empty() const
+{
+  return m_postingCount == 0u;
+}
+
+EntityNodeStringIndex::StringId EntityNodeStringIndex::findStringId(
+  const std::string_view string, const std::size_t hash) const
+{
+  const auto mask = m_stringSlots.size() - 1u;
+  for (auto slot = hash & mask;; slot = (slot + 1u) & mask)
+  {
+    const auto stringId = m_stringSlots[slot];
+    if (stringId == NoStringId)
+    {
+      return NoStringId;
+    }
+
+    const auto& entry = m_entries[stringId];
+    if (entry.hash == hash && entry.string == string)
+    {
+      return stringId;
+    }
+  }
+}
+
+EntityNodeStringIndex::StringId EntityNodeStringIndex::findOrInsertStringId(
+  const std::string_view string)
+{
+  const auto hash = hashString(string);
+  if (const auto stringId = findStringId(string, hash); stringId != NoStringId)
+  {
+    return stringId;
+  }
+
+  if (2u * (m_entries.size() + 1u) > m_stringSlots.size())
+  {
+    growStringSlots(2u * m_stringSlots.size());
+  }
+
+  const auto stringId = static_cast<StringId>(m_entries.size());
+  m_entries.push_back(Entry{std::string{string}, hash, {}, {}});
+  ++m_emptyEntryCount;
+
+  insertStringSlot(stringId);
+  m_sortedIds.push_back(stringId);
+  return stringId;
+}
+
+void EntityNodeStringIndex::insertStringSlot(const StringId stringId)
+{
+  const auto mask = m_stringSlots.size() - 1u;
+  auto slot = m_entries[stringId].hash & mask;
+  while (m_stringSlots[slot] != NoStringId)
+  {
+    slot = (slot + 1u) & mask;
+  }
+  m_stringSlots[slot] = stringId;
+}
+
+void EntityNodeStringIndex::growStringSlots(const std::size_t capacity)
+{
+  m_stringSlots.assign(capacity, NoStringId);
+  for (StringId stringId = 0u; stringId < m_entries.size(); ++stringId)
+  {
+    insertStringSlot(stringId);
+  }
+}
+
+std::size_t EntityNodeStringIndex::findPostingSlot(
+  const StringId stringId, const EntityNodeBase* node) const
+{
+  const auto mask = m_postingSlots.size() - 1u;
+  for (auto slot = hashPosting(stringId, node) & mask;; slot = (slot + 1u) & mask)
+  {
+    const auto& posting = m_postingSlots[slot];
+    if (posting.node == nullptr)
+    {
+      return NoSlot;
+    }
+    if (posting.stringId == stringId && posting.node == node)
+    {
+      return slot;
+    }
+  }
+}
+
+void EntityNodeStringIndex::insertPosting(
+  const StringId stringId, EntityNodeBase* node, const std::uint32_t position)
+{
+  if (2u * (m_postingCount + 1u) > m_postingSlots.size())
+  {
+    growPostingSlots(2u * m_postingSlots.size());
+  }
+
+  const auto mask = m_postingSlots.size() - 1u;
+  auto slot = hashPosting(stringId, node) & mask;
+  while (m_postingSlots[slot].node != nullptr)
+  {
+    slot = (slot + 1u) & mask;
+  }
+
+  m_postingSlots[slot] = Posting{stringId, node, position};
+  ++m_postingCount;
+}
+
+void EntityNodeStringIndex::erasePostingSlot(std::size_t slot)
+{
+  // backward shift deletion: move subsequent postings of the probe sequence into the gap
+  // so that lookups never need tombstones
+  const auto mask = m_postingSlots.size() - 1u;
+  for (auto next = (slot + 1u) & mask; m_postingSlots[next].node != nullptr;
+       next = (next + 1u) & mask)
+  {
+    const auto& posting = m_postingSlots[next];
+    const auto ideal = hashPosting(posting.stringId, posting.node) & mask;
+
+    // the posting may fill the gap unless its ideal slot lies cyclically in (slot, next]
+    const auto distanceToGap = (next - slot) & mask;
+    const auto distanceToIdeal = (next - ideal) & mask;
+    if (distanceToIdeal >= distanceToGap)
+    {
+      m_postingSlots[slot] = posting;
+      slot = next;
+    }
+  }
+
+  m_postingSlots[slot] = Posting{NoStringId, nullptr, 0u};
+  --m_postingCount;
+}
+
+void EntityNodeStringIndex::growPostingSlots(const std::size_t capacity)
+{
+  auto oldSlots = std::exchange(
+    m_postingSlots, std::vector<Posting>(capacity, Posting{NoStringId, nullptr, 0u}));
+  m_postingCount = 0u;
+
+  for (const auto& posting : oldSlots)
+  {
+    if (posting.node != nullptr)
+    {
+      insertPosting(posting.stringId, posting.node, posting.position);
+    }
+  }
+}
+
+void EntityNodeStringIndex::updateSortedIds() const
+{
+  const auto lock = std::lock_guard<std::mutex>{m_sortMutex};
+  if (m_sortedCount == m_sortedIds.size())
+  {
+    return;
+  }
+
+  const auto cmp = [&](const auto lhs, const auto rhs) {
+    return m_entries[lhs].string < m_entries[rhs].string;
+  };
+
+  // sort only the newly added ids and merge them into the already sorted ones
+  const auto middle =
+    std::next(std::begin(m_sortedIds), static_cast<std::ptrdiff_t>(m_sortedCount));
+  std::sort(middle, std::end(m_sortedIds), cmp);
+  std::inplace_merge(std::begin(m_sortedIds), middle, std::end(m_sortedIds), cmp);
+  m_sortedCount = m_sortedIds.size();
+}
+
+std::pair<
+  std::vector<EntityNodeStringIndex::StringId>::const_iterator,
+  std::vector<EntityNodeStringIndex::StringId>::const_iterator>
+EntityNodeStringIndex::findPrefixRange(const std::string_view prefix) const
+{
+  updateSortedIds();
+
+  const auto first = std::lower_bound(
+    std::begin(m_sortedIds),
+    std::end(m_sortedIds),
+    prefix,
+    [&](const auto stringId, const auto& p) { return m_entries[stringId].string < p; });
+  const auto last =
+    std::partition_point(first, std::end(m_sortedIds), [&](const auto stringId) {
+      return std::string_view{m_entries[stringId].string}.substr(0, prefix.size())
+             == prefix;
+    });
+
+  return {first, last};
+}
+
+void EntityNodeStringIndex::compact()
+{
+  auto entries = std::vector<Entry>{};
+  entries.reserve(m_entries.size() - m_emptyEntryCount);
+  auto newIds = std::vector<StringId>(m_entries.size(), NoStringId);
+
+  for (StringId stringId = 0u; stringId < m_entries.size(); ++stringId)
+  {
+    auto& entry = m_entries[stringId];
+    if (!entry.nodes.empty())
+    {
+      newIds[stringId] = static_cast<StringId>(entries.size());
+      entries.push_back(std::move(entry));
+    }
+  }
+
+  m_entries = std::move(entries);
+  m_emptyEntryCount = 0u;
+
+  // the remaining ids keep their relative order, so the sorted part of the array only
+  // needs to be renumbered
+  auto sortedIds = std::vector<StringId>{};
+  sortedIds.reserve(m_entries.size());
+  auto sortedCount = std::size_t(0);
+  for (std::size_t i = 0u; i < m_sortedIds.size(); ++i)
+  {
+    if (const auto newId = newIds[m_sortedIds[i]]; newId != NoStringId)
+    {
+      sortedIds.push_back(newId);
+      if (i < m_sortedCount)
+      {
+        ++sortedCount;
+      }
+    }
+  }
+  m_sortedIds = std::move(sortedIds);
+  m_sortedCount = sortedCount;
+
+  growStringSlots(slotCountFor(m_entries.size()));
+
+  m_postingSlots.assign(slotCountFor(m_postingCount), Posting{NoStringId, nullptr, 0u});
+  m_postingCount = 0u;
+  for (StringId stringId = 0u; stringId < m_entries.size(); ++stringId)
+  {
+    const auto& nodes = m_entries[stringId].nodes;
+    for (std::uint32_t position = 0u; position < nodes.size(); ++position)
+    {
+      insertPosting(stringId, nodes[position], position);
+    }
+  }
+}
+} // namespace Model
+} // namespace TrenchBroom
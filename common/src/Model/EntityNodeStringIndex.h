@@ -0,0 +1,142 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace TrenchBroom
+{
+namespace Model
+{
+class EntityNodeBase;
+
+/**
+ * Maps strings to the entity nodes that were inserted with them.
+ *
+ * Every distinct string is interned once and identified by a dense id. Exact lookups go
+ * through an open addressing hash table of string ids, while prefix and numbered lookups
+ * binary search an array of string ids. New ids are appended to this array unsorted and
+ * are merged into it by the next such lookup, which is guarded by a mutex so that
+ * concurrent lookups are safe. For each string, the nodes are kept in a contiguous array
+ * that can be returned without copying.
+ *
+ * A node can be inserted multiple times with the same string, e.g. if an entity has the
+ * same value for two different keys. The index counts these insertions and only removes
+ * the node once it has been removed as many times as it was inserted.
+ */
+class EntityNodeStringIndex
+{
+private:
+  using StringId = std::uint32_t;
+
+  struct Entry
+  {
+    std::string string;
+    std::size_t hash;
+    std::vector<EntityNodeBase*> nodes;
+    std::vector<std::size_t> counts;
+  };
+
+  struct Posting
+  {
+    StringId stringId;
+    EntityNodeBase* node;
+    std::uint32_t position;
+  };
+
+  std::vector<Entry> m_entries;
+  std::vector<StringId> m_stringSlots;
+  std::vector<Posting> m_postingSlots;
+  std::size_t m_postingCount = 0u;
+  std::size_t m_emptyEntryCount = 0u;
+
+  // ids of all entries, the first m_sortedCount of which are ordered by their strings
+  mutable std::mutex m_sortMutex;
+  mutable std::vector<StringId> m_sortedIds;
+  mutable std::size_t m_sortedCount = 0u;
+
+public:
+  EntityNodeStringIndex();
+
+  /**
+   * Inserts the given node with the given string.
+   */
+  void insert(std::string_view string, EntityNodeBase* node);
+
+  /**
+   * Removes one insertion of the given node with the given string. Does nothing if the
+   * node was never inserted with the string.
+   */
+  void remove(std::string_view string, EntityNodeBase* node);
+
+  /**
+   * Returns the nodes that were inserted with exactly the given string. The returned
+   * reference is invalidated by any subsequent modification of this index.
+   */
+  const std::vector<EntityNodeBase*>& findExact(std::string_view string) const;
+
+  /**
+   * Returns the nodes that were inserted with any string starting with the given prefix.
+   * The result is sorted and contains no duplicates.
+   */
+  std::vector<EntityNodeBase*> findPrefix(std::string_view prefix) const;
+
+  /**
+   * Returns the nodes that were inserted with any string that consists of the given
+   * prefix followed by zero or more digits. The result is sorted and contains no
+   * duplicates.
+   */
+  std::vector<EntityNodeBase*> findNumbered(std::string_view prefix) const;
+
+  /**
+   * Returns every string with which at least one node is currently inserted.
+   */
+  std::vector<std::string> keys() const;
+
+  /**
+   * Indicates whether no node is currently inserted.
+   */
+  bool empty() const;
+
+private:
+  StringId findStringId(std::string_view string, std::size_t hash) const;
+  StringId findOrInsertStringId(std::string_view string);
+  void insertStringSlot(StringId stringId);
+  void growStringSlots(std::size_t capacity);
+
+  std::size_t findPostingSlot(StringId stringId, const EntityNodeBase* node) const;
+  void insertPosting(StringId stringId, EntityNodeBase* node, std::uint32_t position);
+  void erasePostingSlot(std::size_t slot);
+  void growPostingSlots(std::size_t capacity);
+
+  void updateSortedIds() const;
+  std::pair<std::vector<StringId>::const_iterator, std::vector<StringId>::const_iterator>
+  findPrefixRange(std::string_view prefix) const;
+
+  void compact();
+};
+} // namespace Model
+} // namespace TrenchBroom
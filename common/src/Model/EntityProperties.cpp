@@ -94,8 +94,8 @@ bool isNumberedProperty(std::string_view prefix, std::string_view key)
 EntityProperty::EntityProperty() = default;
 
 EntityProperty::EntityProperty(std::string key, std::string value)
-  : m_key{std::move(key)}
-  , m_value{std::move(value)}
+  : m_key{key}
+  , m_value{value}
 {
 }
 
@@ -103,22 +103,22 @@ kdl_reflect_impl(EntityProperty);
 
 const std::string& EntityProperty::key() const
 {
-  return m_key;
+  return m_key.str();
 }
 
 const std::string& EntityProperty::value() const
 {
-  return m_value;
+  return m_value.str();
 }
 
 bool EntityProperty::hasKey(std::string_view key) const
 {
-  return kdl::cs::str_is_equal(m_key, key);
+  return m_key == key;
 }
 
 bool EntityProperty::hasValue(const std::string_view value) const
 {
-  return kdl::cs::str_is_equal(m_value, value);
+  return m_value == value;
 }
 
 bool EntityProperty::hasKeyAndValue(std::string_view key, std::string_view value) const
@@ -128,7 +128,7 @@ bool EntityProperty::hasKeyAndValue(std::string_view key, std::string_view value
 
 bool EntityProperty::hasPrefix(const std::string_view prefix) const
 {
-  return kdl::cs::str_is_prefix(m_key, prefix);
+  return kdl::cs::str_is_prefix(m_key.view(), prefix);
 }
 
 bool EntityProperty::hasPrefixAndValue(
@@ -139,7 +139,7 @@ bool EntityProperty::hasPrefixAndValue(
 
 bool EntityProperty::hasNumberedPrefix(const std::string_view prefix) const
 {
-  return isNumberedProperty(prefix, m_key);
+  return isNumberedProperty(prefix, m_key.view());
 }
 
 bool EntityProperty::hasNumberedPrefixAndValue(
@@ -150,12 +150,12 @@ bool EntityProperty::hasNumberedPrefixAndValue(
 
 void EntityProperty::setKey(std::string key)
 {
-  m_key = std::move(key);
+  m_key = kdl::interned_string{key};
 }
 
 void EntityProperty::setValue(std::string value)
 {
-  m_value = std::move(value);
+  m_value = kdl::interned_string{value};
 }
 
 bool isLayer(const std::string& classname, const std::vector<EntityProperty>& properties)
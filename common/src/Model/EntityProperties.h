@@ -21,6 +21,7 @@
 
 #include "EL/Expression.h"
 
+#include <kdl/interned_string.h>
 #include <kdl/reflection_decl.h>
 
 #include <optional>
@@ -90,11 +91,15 @@ struct EntityPropertyConfig
 
 bool isNumberedProperty(std::string_view prefix, std::string_view key);
 
+/**
+ * An entity property. Keys and values are interned because the same keys and many of the
+ * same values are stored by a great number of entities.
+ */
 class EntityProperty
 {
 private:
-  std::string m_key;
-  std::string m_value;
+  kdl::interned_string m_key;
+  kdl::interned_string m_value;
 
 public:
   EntityProperty();
@@ -59,6 +59,11 @@ void Game::setAdditionalSearchPaths(
   doSetAdditionalSearchPaths(searchPaths, logger);
 }
 
+void Game::refreshFileSystem()
+{
+  doRefreshFileSystem();
+}
+
 Game::PathErrors Game::checkAdditionalSearchPaths(
   const std::vector<IO::Path>& searchPaths) const
 {
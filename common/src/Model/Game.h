@@ -75,6 +75,12 @@ public:
   void setGamePath(const IO::Path& gamePath, Logger& logger);
   void setAdditionalSearchPaths(const std::vector<IO::Path>& searchPaths, Logger& logger);
 
+  /**
+   * Discards cached file system lookups so that files which were added to or removed
+   * from the game's search paths are picked up when assets are reloaded.
+   */
+  void refreshFileSystem();
+
   using PathErrors = std::map<IO::Path, std::string>;
   PathErrors checkAdditionalSearchPaths(const std::vector<IO::Path>& searchPaths) const;
 
@@ -178,6 +184,7 @@ private: // subclassing interface
   virtual void doSetGamePath(const IO::Path& gamePath, Logger& logger) = 0;
   virtual void doSetAdditionalSearchPaths(
     const std::vector<IO::Path>& searchPaths, Logger& logger) = 0;
+  virtual void doRefreshFileSystem() = 0;
   virtual PathErrors doCheckAdditionalSearchPaths(
     const std::vector<IO::Path>& searchPaths) const = 0;
 
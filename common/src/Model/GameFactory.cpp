@@ -23,6 +23,8 @@
 #include "IO/CompilationConfigParser.h"
 #include "IO/CompilationConfigWriter.h"
 #include "IO/DiskFileSystem.h"
+#include "IO/EntityModelCache.h"
+#include "IO/Quake3ShaderCache.h"
 #include "IO/File.h"
 #include "IO/FileMatcher.h"
 #include "IO/GameConfigParser.h"
@@ -60,6 +62,8 @@ GameFactory& GameFactory::instance()
 
 void GameFactory::initialize(const GamePathConfig& gamePathConfig)
 {
+  m_entityModelCacheDir = gamePathConfig.entityModelCacheDir;
+  m_shaderCacheDir = gamePathConfig.shaderCacheDir;
   initializeFileSystem(gamePathConfig);
   loadGameConfigs();
 }
@@ -90,7 +94,20 @@ size_t GameFactory::gameCount() const
 
 std::shared_ptr<Game> GameFactory::createGame(const std::string& gameName, Logger& logger)
 {
-  return std::make_shared<GameImpl>(gameConfig(gameName), gamePath(gameName), logger);
+  auto entityModelCache =
+    !m_entityModelCacheDir.isEmpty()
+      ? std::make_shared<IO::EntityModelCache>(m_entityModelCacheDir + IO::Path{gameName})
+      : nullptr;
+  auto shaderCache =
+    !m_shaderCacheDir.isEmpty()
+      ? std::make_shared<IO::Quake3ShaderCache>(m_shaderCacheDir + IO::Path{gameName})
+      : nullptr;
+  return std::make_shared<GameImpl>(
+    gameConfig(gameName),
+    gamePath(gameName),
+    logger,
+    std::move(entityModelCache),
+    std::move(shaderCache));
 }
 
 std::vector<std::string> GameFactory::fileFormats(const std::string& gameName) const
@@ -51,6 +51,16 @@ struct GamePathConfig
 {
   std::vector<IO::Path> gameConfigSearchDirs;
   IO::Path userGameDir;
+  /**
+   * The directory in which parsed entity models are cached, or an empty path to disable
+   * the cache.
+   */
+  IO::Path entityModelCacheDir;
+  /**
+   * The directory in which parsed Quake 3 shader scripts are cached, or an empty path to
+   * disable the cache.
+   */
+  IO::Path shaderCacheDir;
 };
 
 class GameFactory
@@ -60,6 +70,8 @@ private:
   using GamePathMap = std::map<std::string, Preference<IO::Path>>;
 
   IO::Path m_userGameDir;
+  IO::Path m_entityModelCacheDir;
+  IO::Path m_shaderCacheDir;
   std::unique_ptr<IO::WritableDiskFileSystem> m_configFS;
 
   std::vector<std::string> m_names;
@@ -32,9 +32,12 @@
 #include "Model/GameConfig.h"
 
 #include <kdl/string_compare.h>
+#include <kdl/string_format.h>
 #include <kdl/vector_utils.h>
 
 #include <memory>
+#include <mutex>
+#include <string>
 
 namespace TrenchBroom
 {
@@ -50,18 +53,20 @@ void GameFileSystem::initialize(
   const GameConfig& config,
   const IO::Path& gamePath,
   const std::vector<IO::Path>& additionalSearchPaths,
+  std::shared_ptr<IO::Quake3ShaderCache> shaderCache,
   Logger& logger)
 {
   // delete the existing file system
   releaseNext();
   m_shaderFS = nullptr;
+  clearFileOwners();
 
   addDefaultAssetPaths(config, logger);
 
   if (!gamePath.isEmpty() && IO::Disk::directoryExists(gamePath))
   {
     addGameFileSystems(config, gamePath, additionalSearchPaths, logger);
-    addShaderFileSystem(config, logger);
+    addShaderFileSystem(config, std::move(shaderCache), logger);
   }
 }
 
@@ -71,6 +76,7 @@ void GameFileSystem::reloadShaders()
   {
     m_shaderFS->reload();
   }
+  clearFileOwners();
 }
 
 void GameFileSystem::addDefaultAssetPaths(const GameConfig& config, Logger& logger)
@@ -185,7 +191,10 @@ void GameFileSystem::addFileSystemPackages(
   }
 }
 
-void GameFileSystem::addShaderFileSystem(const GameConfig& config, Logger& logger)
+void GameFileSystem::addShaderFileSystem(
+  const GameConfig& config,
+  std::shared_ptr<IO::Quake3ShaderCache> shaderCache,
+  Logger& logger)
 {
   // To support Quake 3 shaders, we add a shader file system that loads the shaders
   // and makes them available as virtual files.
@@ -198,12 +207,25 @@ void GameFileSystem::addShaderFileSystem(const GameConfig& config, Logger& logge
     auto textureSearchPaths =
       std::vector<IO::Path>{getRootDirectory(textureConfig.package), IO::Path("models")};
     auto shaderFS = std::make_shared<IO::Quake3ShaderFileSystem>(
-      m_next, std::move(shaderSearchPath), std::move(textureSearchPaths), logger);
+      m_next,
+      std::move(shaderSearchPath),
+      std::move(textureSearchPaths),
+      logger,
+      std::move(shaderCache));
     m_shaderFS = shaderFS.get();
     m_next = std::move(shaderFS);
   }
 }
 
+void GameFileSystem::clearFileOwners()
+{
+  {
+    const auto lock = std::lock_guard<std::mutex>{m_fileOwnersMutex};
+    m_fileOwners.clear();
+  }
+  IO::Disk::clearDirectoryCache();
+}
+
 bool GameFileSystem::doDirectoryExists(const IO::Path& /* path */) const
 {
   return false;
@@ -224,5 +246,23 @@ std::shared_ptr<IO::File> GameFileSystem::doOpenFile(const IO::Path& path) const
 {
   throw FileSystemException("File not found: '" + path.asString() + "'");
 }
+
+const IO::FileSystem* GameFileSystem::doFindFileOwner(const IO::Path& path) const
+{
+  const auto key = kdl::str_to_lower(path.makeCanonical().asString("/"));
+  {
+    const auto lock = std::lock_guard<std::mutex>{m_fileOwnersMutex};
+    if (const auto it = m_fileOwners.find(key); it != m_fileOwners.end())
+    {
+      return it->second;
+    }
+  }
+
+  const auto* owner = FileSystem::doFindFileOwner(path);
+
+  const auto lock = std::lock_guard<std::mutex>{m_fileOwnersMutex};
+  m_fileOwners.emplace(key, owner);
+  return owner;
+}
 } // namespace Model
 } // namespace TrenchBroom
@@ -22,6 +22,9 @@
 #include "IO/FileSystem.h"
 
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace TrenchBroom
@@ -31,6 +34,7 @@ class Logger;
 namespace IO
 {
 class Path;
+class Quake3ShaderCache;
 class Quake3ShaderFileSystem;
 } // namespace IO
 
@@ -43,15 +47,33 @@ class GameFileSystem : public IO::FileSystem
 private:
   IO::Quake3ShaderFileSystem* m_shaderFS;
 
+  /**
+   * Caches which file system of the chain contains a file, keyed by the lower case
+   * canonical path of the file. Files that were not found in any file system are cached
+   * with a null owner, so that repeated lookups of missing files do not search the
+   * entire chain again. The cache is cleared whenever the chain is initialized, the
+   * shaders are reloaded or clearFileOwners is called.
+   */
+  mutable std::mutex m_fileOwnersMutex;
+  mutable std::unordered_map<std::string, const IO::FileSystem*> m_fileOwners;
+
 public:
   GameFileSystem();
   void initialize(
     const GameConfig& config,
     const IO::Path& gamePath,
     const std::vector<IO::Path>& additionalSearchPaths,
+    std::shared_ptr<IO::Quake3ShaderCache> shaderCache,
     Logger& logger);
   void reloadShaders();
 
+  /**
+   * Clears the cached file lookups and the cached directory entries used to fix the case
+   * of paths, so that files which were added to or removed from the search paths since
+   * they were last looked up are found or not found again.
+   */
+  void clearFileOwners();
+
 private:
   void addDefaultAssetPaths(const GameConfig& config, Logger& logger);
   void addGameFileSystems(
@@ -59,7 +81,10 @@ private:
     const IO::Path& gamePath,
     const std::vector<IO::Path>& additionalSearchPaths,
     Logger& logger);
-  void addShaderFileSystem(const GameConfig& config, Logger& logger);
+  void addShaderFileSystem(
+    const GameConfig& config,
+    std::shared_ptr<IO::Quake3ShaderCache> shaderCache,
+    Logger& logger);
   void addFileSystemPath(const IO::Path& path, Logger& logger);
   void addFileSystemPackages(
     const GameConfig& config, const IO::Path& searchPath, Logger& logger);
@@ -69,6 +94,7 @@ private:
   bool doFileExists(const IO::Path& path) const override;
   std::vector<IO::Path> doGetDirectoryContents(const IO::Path& path) const override;
   std::shared_ptr<IO::File> doOpenFile(const IO::Path& path) const override;
+  const IO::FileSystem* doFindFileOwner(const IO::Path& path) const override;
 };
 } // namespace Model
 } // namespace TrenchBroom
@@ -33,6 +33,7 @@
 #include "IO/DiskIO.h"
 #include "IO/DkmParser.h"
 #include "IO/EntParser.h"
+#include "IO/EntityModelCache.h"
 #include "IO/ExportOptions.h"
 #include "IO/FgdParser.h"
 #include "IO/File.h"
@@ -48,6 +49,7 @@
 #include "IO/NodeWriter.h"
 #include "IO/ObjParser.h"
 #include "IO/ObjSerializer.h"
+#include "IO/RecordingFileSystem.h"
 #include "IO/SimpleParserStatus.h"
 #include "IO/SprParser.h"
 #include "IO/SystemPaths.h"
@@ -81,16 +83,24 @@ namespace TrenchBroom
 {
 namespace Model
 {
-GameImpl::GameImpl(GameConfig& config, const IO::Path& gamePath, Logger& logger)
+GameImpl::GameImpl(
+  GameConfig& config,
+  const IO::Path& gamePath,
+  Logger& logger,
+  std::shared_ptr<IO::EntityModelCache> entityModelCache,
+  std::shared_ptr<IO::Quake3ShaderCache> shaderCache)
   : m_config(config)
   , m_gamePath(gamePath)
+  , m_entityModelCache(std::move(entityModelCache))
+  , m_shaderCache(std::move(shaderCache))
 {
   initializeFileSystem(logger);
 }
 
 void GameImpl::initializeFileSystem(Logger& logger)
 {
-  m_fs.initialize(m_config, m_gamePath, m_additionalSearchPaths, logger);
+  m_fs.initialize(
+    m_config, m_gamePath, m_additionalSearchPaths, m_shaderCache, logger);
 }
 
 const std::string& GameImpl::doGameName() const
@@ -122,6 +132,11 @@ void GameImpl::doSetAdditionalSearchPaths(
   }
 }
 
+void GameImpl::doRefreshFileSystem()
+{
+  m_fs.clearFileOwners();
+}
+
 Game::PathErrors GameImpl::doCheckAdditionalSearchPaths(
   const std::vector<IO::Path>& searchPaths) const
 {
@@ -578,7 +593,7 @@ IO::Path GameImpl::doFindEntityDefinitionFile(
 
 template <typename GetPalette, typename Function>
 static auto withEntityParser(
-  const GameFileSystem& fs,
+  const IO::FileSystem& fs,
   const IO::Path& path,
   const GetPalette& getPalette,
   const Function& fun)
@@ -657,13 +672,30 @@ std::unique_ptr<Assets::EntityModel> GameImpl::doInitializeModel(
 {
   try
   {
-    const auto getPalette = [&]() { return loadTexturePalette(); };
+    auto hashes = IO::EntityModelCache::FileHashes{};
+    if (m_entityModelCache)
+    {
+      if (auto model = m_entityModelCache->readModel(m_fs, path, hashes, logger))
+      {
+        return model;
+      }
+    }
+
+    // record the files read by the parser so that the cache can detect changes to them
+    const auto fs = IO::RecordingFileSystem{m_fs};
+    const auto getPalette = [&]() { return loadTexturePalette(fs); };
 
     const auto initializeModel = [&](auto& parser) {
       return parser.initializeModel(logger);
     };
 
-    return withEntityParser(m_fs, path, getPalette, initializeModel);
+    auto model = withEntityParser(fs, path, getPalette, initializeModel);
+    if (m_entityModelCache)
+    {
+      m_entityModelCache->writeModel(
+        m_fs, path, fs.openedFiles(), hashes, *model, logger);
+    }
+    return model;
   }
   catch (const FileSystemException& e)
   {
@@ -693,19 +725,30 @@ void GameImpl::doLoadFrame(
     ensure(model.frame(frameIndex) != nullptr, "invalid frame index");
     ensure(!model.frame(frameIndex)->loaded(), "frame already loaded");
 
+    if (
+      m_entityModelCache
+      && m_entityModelCache->readFrame(path, frameIndex, model, logger))
+    {
+      return;
+    }
+
     const auto file = m_fs.openFile(path);
     ensure(file != nullptr, "file is null");
 
     const auto modelName = path.lastComponent().asString();
     const auto extension = kdl::str_to_lower(path.extension());
 
-    const auto getPalette = [&]() { return loadTexturePalette(); };
+    const auto getPalette = [&]() { return loadTexturePalette(m_fs); };
 
     const auto loadFrame = [&](auto& parser) {
       return parser.loadFrame(frameIndex, model, logger);
     };
 
-    return withEntityParser(m_fs, path, getPalette, loadFrame);
+    withEntityParser(m_fs, path, getPalette, loadFrame);
+    if (m_entityModelCache)
+    {
+      m_entityModelCache->writeFrame(path, frameIndex, model, logger);
+    }
   }
   catch (FileSystemException& e)
   {
@@ -719,10 +762,10 @@ void GameImpl::doLoadFrame(
   }
 }
 
-Assets::Palette GameImpl::loadTexturePalette() const
+Assets::Palette GameImpl::loadTexturePalette(const IO::FileSystem& fs) const
 {
   const auto& path = m_config.textureConfig.palette;
-  return Assets::Palette::loadFile(m_fs, path);
+  return Assets::Palette::loadFile(fs, path);
 }
 
 std::vector<std::string> GameImpl::doAvailableMods() const
@@ -38,6 +38,13 @@ namespace Assets
 class Palette;
 }
 
+namespace IO
+{
+class EntityModelCache;
+class FileSystem;
+class Quake3ShaderCache;
+} // namespace IO
+
 namespace Model
 {
 struct EntityPropertyConfig;
@@ -49,9 +56,16 @@ private:
   GameFileSystem m_fs;
   IO::Path m_gamePath;
   std::vector<IO::Path> m_additionalSearchPaths;
+  std::shared_ptr<IO::EntityModelCache> m_entityModelCache;
+  std::shared_ptr<IO::Quake3ShaderCache> m_shaderCache;
 
 public:
-  GameImpl(GameConfig& config, const IO::Path& gamePath, Logger& logger);
+  GameImpl(
+    GameConfig& config,
+    const IO::Path& gamePath,
+    Logger& logger,
+    std::shared_ptr<IO::EntityModelCache> entityModelCache = nullptr,
+    std::shared_ptr<IO::Quake3ShaderCache> shaderCache = nullptr);
 
 private:
   void initializeFileSystem(Logger& logger);
@@ -62,6 +76,7 @@ private:
   void doSetGamePath(const IO::Path& gamePath, Logger& logger) override;
   void doSetAdditionalSearchPaths(
     const std::vector<IO::Path>& searchPaths, Logger& logger) override;
+  void doRefreshFileSystem() override;
   PathErrors doCheckAdditionalSearchPaths(
     const std::vector<IO::Path>& searchPaths) const override;
 
@@ -141,7 +156,7 @@ private:
     Assets::EntityModel& model,
     Logger& logger) const override;
 
-  Assets::Palette loadTexturePalette() const;
+  Assets::Palette loadTexturePalette(const IO::FileSystem& fs) const;
 
   std::vector<std::string> doAvailableMods() const override;
   std::vector<std::string> doExtractEnabledMods(const Entity& entity) const override;
@@ -1347,6 +1347,12 @@ public: // Accessors
    */
   const vm::bbox<T, 3>& bounds() const;
 
+  /**
+   * Returns the volume of this polyhedron, or 0 if this polyhedron is not a closed convex
+   * volume.
+   */
+  T volume() const;
+
   /**
    * Indicates whether this polyhedron is empty.
    *
@@ -52,6 +52,12 @@ template <typename T, typename FP, typename VP>
 std::vector<Polyhedron<T, FP, VP>> Polyhedron<T, FP, VP>::subtract(
   const Polyhedron& subtrahend) const
 {
+  if (!bounds().intersects(subtrahend.bounds()))
+  {
+    // the polyhedra are disjoint, skip copying and clipping the subtrahend
+    return {*this};
+  }
+
   Subtract subtract(*this, subtrahend);
   return subtract.result();
 }
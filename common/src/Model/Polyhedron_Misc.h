@@ -546,6 +546,36 @@ const vm::bbox<T, 3>& Polyhedron<T, FP, VP>::bounds() const
   return m_bounds;
 }
 
+template <typename T, typename FP, typename VP>
+T Polyhedron<T, FP, VP>::volume() const
+{
+  if (!polyhedron() || !closed())
+  {
+    return static_cast<T>(0.0);
+  }
+
+  // sum up the signed volumes of the tetrahedra spanned by an arbitrary vertex and a fan
+  // triangulation of each face
+  const auto& origin = m_vertices.front()->position();
+
+  auto result = static_cast<T>(0.0);
+  for (const Face* face : m_faces)
+  {
+    const HalfEdge* first = face->boundary().front();
+    const auto p0 = first->origin()->position() - origin;
+
+    for (const HalfEdge* current = first->next(); current->next() != first;
+         current = current->next())
+    {
+      const auto p1 = current->origin()->position() - origin;
+      const auto p2 = current->next()->origin()->position() - origin;
+      result += vm::dot(p0, vm::cross(p1, p2));
+    }
+  }
+
+  return result / static_cast<T>(6.0);
+}
+
 template <typename T, typename FP, typename VP>
 bool Polyhedron<T, FP, VP>::empty() const
 {
@@ -709,8 +709,8 @@ static bool matches(const IO::Path& path, const IO::Path& glob)
     return false;
   }
 
-  const std::vector<std::string>& pathComps = path.components();
-  const std::vector<std::string>& globComps = glob.components();
+  const std::vector<std::string> pathComps = path.components();
+  const std::vector<std::string> globComps = glob.components();
 
   for (size_t i = 0; i < globLen; ++i)
   {
@@ -198,6 +198,8 @@ Preference<Color> GridColor2D(
 
 Preference<int> TextureMinFilter(IO::Path("Renderer/Texture mode min filter"), 0x2700);
 Preference<int> TextureMagFilter(IO::Path("Renderer/Texture mode mag filter"), 0x2600);
+Preference<int> TextureCacheSize(IO::Path("Renderer/Texture cache size"), 512);
+Preference<bool> CompressTextures(IO::Path("Renderer/Compress textures"), false);
 Preference<bool> EnableMSAA(IO::Path("Renderer/Enable multisampling"), true);
 
 Preference<bool> TextureLock(IO::Path("Editor/Texture lock"), true);
@@ -407,6 +409,8 @@ const std::vector<PreferenceBase*>& staticPreferences()
     &GridColor2D,
     &TextureMinFilter,
     &TextureMagFilter,
+    &TextureCacheSize,
+    &CompressTextures,
     &TextureLock,
     &UVLock,
     &RendererFontPath(),
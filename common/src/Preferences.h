@@ -127,6 +127,14 @@ extern Preference<Color> GridColor2D;
 
 extern Preference<int> TextureMinFilter;
 extern Preference<int> TextureMagFilter;
+/**
+ * The amount of memory in MB that textures which can be reloaded may occupy.
+ */
+extern Preference<int> TextureCacheSize;
+/**
+ * Whether opaque textures are compressed when they are loaded.
+ */
+extern Preference<bool> CompressTextures;
 extern Preference<bool> EnableMSAA;
 
 extern Preference<bool> TextureLock;
@@ -37,7 +37,6 @@
 #include "Renderer/ShaderManager.h"
 #include "Renderer/Shaders.h"
 #include "Renderer/TexturedIndexRangeRenderer.h"
-#include "Renderer/Transformation.h"
 
 #include <vecmath/mat.h>
 
@@ -72,15 +71,20 @@ void EntityModelRenderer::addEntity(const Model::EntityNode* entityNode)
     });
 
   auto* renderer = m_entityModelManager.renderer(modelSpec);
-  if (renderer != nullptr)
+  if (renderer != nullptr && m_entities.emplace(entityNode, renderer).second)
   {
-    m_entities.emplace(entityNode, renderer);
+    addInstance(renderer, entityNode);
   }
 }
 
 void EntityModelRenderer::removeEntity(const Model::EntityNode* entityNode)
 {
-  m_entities.erase(entityNode);
+  auto it = m_entities.find(entityNode);
+  if (it != std::end(m_entities))
+  {
+    removeInstance(it->second, entityNode);
+    m_entities.erase(it);
+  }
 }
 
 void EntityModelRenderer::updateEntity(const Model::EntityNode* entityNode)
@@ -101,15 +105,19 @@ void EntityModelRenderer::updateEntity(const Model::EntityNode* entityNode)
   if (it == std::end(m_entities))
   {
     m_entities.emplace(entityNode, renderer);
+    addInstance(renderer, entityNode);
   }
   else
   {
     if (renderer == nullptr)
     {
+      removeInstance(it->second, entityNode);
       m_entities.erase(it);
     }
     else if (it->second != renderer)
     {
+      removeInstance(it->second, entityNode);
+      addInstance(renderer, entityNode);
       it->second = renderer;
     }
   }
@@ -118,6 +126,7 @@ void EntityModelRenderer::updateEntity(const Model::EntityNode* entityNode)
 void EntityModelRenderer::clear()
 {
   m_entities.clear();
+  m_instances.clear();
 }
 
 bool EntityModelRenderer::applyTinting() const
@@ -155,6 +164,26 @@ void EntityModelRenderer::render(RenderBatch& renderBatch)
   renderBatch.add(this);
 }
 
+void EntityModelRenderer::addInstance(
+  TexturedRenderer* renderer, const Model::EntityNode* entityNode)
+{
+  m_instances[renderer].insert(entityNode);
+}
+
+void EntityModelRenderer::removeInstance(
+  TexturedRenderer* renderer, const Model::EntityNode* entityNode)
+{
+  auto it = m_instances.find(renderer);
+  if (it != std::end(m_instances))
+  {
+    it->second.erase(entityNode);
+    if (it->second.empty())
+    {
+      m_instances.erase(it);
+    }
+  }
+}
+
 void EntityModelRenderer::doPrepareVertices(VboManager& vboManager)
 {
   m_entityModelManager.prepare(vboManager);
@@ -190,28 +219,39 @@ void EntityModelRenderer::doRender(RenderContext& renderContext)
   shader.set("CameraUp", renderContext.camera().up());
   shader.set("ViewMatrix", renderContext.camera().viewMatrix());
 
-  for (const auto& [entityNode, renderer] : m_entities)
+  // The shader computes the model matrix from the ModelMatrix uniform, so only that
+  // uniform needs to change between the instances of a model.
+  auto transformations = std::vector<vm::mat4x4f>{};
+  for (const auto& [renderer, entityNodes] : m_instances)
   {
-    if (!m_showHiddenEntities && !m_editorContext.visible(entityNode))
+    transformations.clear();
+
+    // all instances share the same model frame, and therefore the same orientation
+    auto orientation = Assets::Orientation::Oriented;
+    for (const auto* entityNode : entityNodes)
     {
-      continue;
+      if (!m_showHiddenEntities && !m_editorContext.visible(entityNode))
+      {
+        continue;
+      }
+
+      const auto* model = entityNode->entity().model();
+      if (!model)
+      {
+        continue;
+      }
+
+      orientation = model->orientation();
+      transformations.emplace_back(entityNode->entity().modelTransformation());
     }
 
-    const auto* model = entityNode->entity().model();
-    if (!model)
+    if (!transformations.empty())
     {
-      continue;
+      shader.set("Orientation", static_cast<int>(orientation));
+      renderer->renderInstances(transformations.size(), [&](const size_t i) {
+        shader.set("ModelMatrix", transformations[i]);
+      });
     }
-
-    shader.set("Orientation", static_cast<int>(model->orientation()));
-
-    const auto transformation = vm::mat4x4f{entityNode->entity().modelTransformation()};
-    const auto multMatrix =
-      MultiplyModelMatrix{renderContext.transformation(), transformation};
-
-    shader.set("ModelMatrix", transformation);
-
-    renderer->render();
   }
 }
 } // namespace Renderer
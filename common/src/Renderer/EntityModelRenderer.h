@@ -23,6 +23,7 @@
 #include "Renderer/Renderable.h"
 
 #include <unordered_map>
+#include <unordered_set>
 
 namespace TrenchBroom
 {
@@ -55,6 +56,10 @@ private:
 
   std::unordered_map<const Model::EntityNode*, TexturedRenderer*> m_entities;
 
+  // the entities grouped by their renderers, so that each model is set up only once
+  std::unordered_map<TexturedRenderer*, std::unordered_set<const Model::EntityNode*>>
+    m_instances;
+
   bool m_applyTinting;
   Color m_tintColor;
 
@@ -110,6 +115,9 @@ public:
   void render(RenderBatch& renderBatch);
 
 private:
+  void addInstance(TexturedRenderer* renderer, const Model::EntityNode* entityNode);
+  void removeInstance(TexturedRenderer* renderer, const Model::EntityNode* entityNode);
+
   void doPrepareVertices(VboManager& vboManager) override;
   void doRender(RenderContext& renderContext) override;
 };
@@ -0,0 +1,396 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TextureThumbnailAtlas.h"
+
+#include "Assets/Texture.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace TrenchBroom
+{
+namespace Renderer
+{
+namespace
+{
+struct ThumbnailImage
+{
+  size_t width;
+  size_t height;
+  std::vector<unsigned char> pixels;
+};
+
+vm::vec2s levelSize(const GLint level)
+{
+  auto width = GLint(0);
+  auto height = GLint(0);
+  glAssert(glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width));
+  glAssert(glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height));
+  return vm::vec2s{size_t(std::max(width, 0)), size_t(std::max(height, 0))};
+}
+
+/**
+ * Reads the smallest mip level of the given texture which is at least as large as the
+ * given size. The texture is uploaded if necessary.
+ */
+std::optional<ThumbnailImage> readMipLevel(
+  const Assets::Texture& texture, const size_t thumbnailSize)
+{
+  // unbind the current texture in case the given texture has no GL texture object
+  glAssert(glBindTexture(GL_TEXTURE_2D, 0));
+  texture.activate();
+
+  // a texture that is being decoded again is bound as a placeholder, which must not be
+  // stored in the atlas
+  auto level = GLint(0);
+  auto size = levelSize(level);
+  if (size.x() == 0u || size.y() == 0u || texture.reloading())
+  {
+    texture.deactivate();
+    return std::nullopt;
+  }
+
+  while (vm::max(size.x(), size.y()) > thumbnailSize)
+  {
+    // levels that were not uploaded have a size of 0
+    const auto nextSize = levelSize(level + 1);
+    if (vm::max(nextSize.x(), nextSize.y()) < thumbnailSize || nextSize.x() == 0u)
+    {
+      break;
+    }
+    ++level;
+    size = nextSize;
+  }
+
+  auto image = ThumbnailImage{size.x(), size.y(), {}};
+  image.pixels.resize(size.x() * size.y() * 4u);
+
+  glAssert(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+  glAssert(glGetTexImage(
+    GL_TEXTURE_2D, level, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data()));
+  texture.deactivate();
+
+  return image;
+}
+
+/**
+ * Scales the given image down so that it fits into a square of the given size. Nearest
+ * neighbour sampling is used so that masked textures keep their mask.
+ */
+ThumbnailImage fitImage(ThumbnailImage image, const size_t maxSize)
+{
+  const auto size = std::max(image.width, image.height);
+  if (size <= maxSize)
+  {
+    return image;
+  }
+
+  const auto width = std::max(size_t(1), image.width * maxSize / size);
+  const auto height = std::max(size_t(1), image.height * maxSize / size);
+
+  auto result =
+    ThumbnailImage{width, height, std::vector<unsigned char>(width * height * 4u)};
+  for (size_t y = 0u; y < height; ++y)
+  {
+    const auto sourceY = y * image.height / height;
+    for (size_t x = 0u; x < width; ++x)
+    {
+      const auto sourceX = x * image.width / width;
+      std::copy_n(
+        image.pixels.data() + (sourceY * image.width + sourceX) * 4u,
+        4u,
+        result.pixels.data() + (y * width + x) * 4u);
+    }
+  }
+  return result;
+}
+
+/**
+ * Surrounds the given image with a border of the given width that repeats its edge
+ * pixels.
+ */
+ThumbnailImage padImage(const ThumbnailImage& image, const size_t border)
+{
+  const auto width = image.width + 2u * border;
+  const auto height = image.height + 2u * border;
+
+  auto result =
+    ThumbnailImage{width, height, std::vector<unsigned char>(width * height * 4u)};
+  for (size_t y = 0u; y < height; ++y)
+  {
+    const auto sourceY = std::min(std::max(y, border) - border, image.height - 1u);
+    for (size_t x = 0u; x < width; ++x)
+    {
+      const auto sourceX = std::min(std::max(x, border) - border, image.width - 1u);
+      std::copy_n(
+        image.pixels.data() + (sourceY * image.width + sourceX) * 4u,
+        4u,
+        result.pixels.data() + (y * width + x) * 4u);
+    }
+  }
+  return result;
+}
+
+constexpr auto SlotBorder = size_t(1);
+} // namespace
+
+TextureThumbnailAtlas::TextureThumbnailAtlas(
+  const size_t pageSize,
+  const size_t slotSize,
+  const size_t maxPageCount,
+  const int minFilter,
+  const int magFilter)
+  : m_pageSize{pageSize}
+  , m_slotSize{slotSize}
+  , m_maxPageCount{maxPageCount}
+  , m_minFilter{minFilter}
+  , m_magFilter{magFilter}
+  , m_currentUse{1u}
+{
+  assert(m_slotSize > 0u);
+  assert(slotPitch() <= m_pageSize);
+}
+
+TextureThumbnailAtlas::~TextureThumbnailAtlas()
+{
+  deletePages();
+}
+
+size_t TextureThumbnailAtlas::slotSize() const
+{
+  return m_slotSize;
+}
+
+void TextureThumbnailAtlas::setTextureMode(const int minFilter, const int magFilter)
+{
+  if (minFilter == m_minFilter && magFilter == m_magFilter)
+  {
+    return;
+  }
+
+  m_minFilter = minFilter;
+  m_magFilter = magFilter;
+
+  for (const auto page : m_pages)
+  {
+    glAssert(glBindTexture(GL_TEXTURE_2D, page));
+    applyTextureMode();
+  }
+  glAssert(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+void TextureThumbnailAtlas::beginFrame()
+{
+  ++m_currentUse;
+}
+
+std::optional<TextureThumbnailAtlas::Thumbnail> TextureThumbnailAtlas::find(
+  const Assets::Texture& texture, const size_t thumbnailSize)
+{
+  const auto it = m_slotIndices.find(&texture);
+  if (it != m_slotIndices.end())
+  {
+    auto& slot = m_slots[it->second];
+    if (slot.thumbnailSize == thumbnailSize && slot.textureName == texture.name())
+    {
+      slot.lastUse = m_currentUse;
+      return slot.thumbnail;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<TextureThumbnailAtlas::Thumbnail> TextureThumbnailAtlas::insert(
+  const Assets::Texture& texture, const size_t thumbnailSize)
+{
+  assert(thumbnailSize <= m_slotSize);
+
+  const auto it = m_slotIndices.find(&texture);
+  const auto slotIndex = it != m_slotIndices.end() ? it->second : allocateSlot();
+  if (!slotIndex)
+  {
+    return std::nullopt;
+  }
+
+  auto& slot = m_slots[*slotIndex];
+  m_slotIndices.erase(slot.texture);
+  slot.texture = nullptr;
+  slot.lastUse = 0u;
+
+  auto image = readMipLevel(texture, thumbnailSize);
+  if (!image)
+  {
+    releaseSlot(*slotIndex);
+    return std::nullopt;
+  }
+  image = fitImage(std::move(*image), thumbnailSize);
+  const auto paddedImage = padImage(*image, SlotBorder);
+
+  const auto page = *slotIndex / slotsPerPage();
+  const auto position = slotPosition(*slotIndex);
+
+  glAssert(glBindTexture(GL_TEXTURE_2D, m_pages[page]));
+  glAssert(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+  glAssert(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+  glAssert(glTexSubImage2D(
+    GL_TEXTURE_2D,
+    0,
+    static_cast<GLint>(position.x()),
+    static_cast<GLint>(position.y()),
+    static_cast<GLsizei>(paddedImage.width),
+    static_cast<GLsizei>(paddedImage.height),
+    GL_RGBA,
+    GL_UNSIGNED_BYTE,
+    paddedImage.pixels.data()));
+  glAssert(glBindTexture(GL_TEXTURE_2D, 0));
+
+  const auto pageSize = static_cast<float>(m_pageSize);
+  const auto min = vm::vec2f{position + vm::vec2s::fill(SlotBorder)};
+  const auto max = min + vm::vec2f{vm::vec2s{image->width, image->height}};
+
+  slot.texture = &texture;
+  slot.textureName = texture.name();
+  slot.thumbnailSize = thumbnailSize;
+  slot.lastUse = m_currentUse;
+  slot.thumbnail = Thumbnail{page, min / pageSize, max / pageSize};
+  m_slotIndices[&texture] = *slotIndex;
+
+  return slot.thumbnail;
+}
+
+void TextureThumbnailAtlas::clear()
+{
+  // the pages are kept and overwritten when new thumbnails are added
+  m_slots.clear();
+  m_freeSlots.clear();
+  m_slotIndices.clear();
+}
+
+void TextureThumbnailAtlas::activate(const size_t page) const
+{
+  assert(page < m_pages.size());
+  glAssert(glBindTexture(GL_TEXTURE_2D, m_pages[page]));
+}
+
+void TextureThumbnailAtlas::deactivate() const
+{
+  glAssert(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+std::optional<size_t> TextureThumbnailAtlas::allocateSlot()
+{
+  if (!m_freeSlots.empty())
+  {
+    const auto slotIndex = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    return slotIndex;
+  }
+
+  if (m_slots.size() == m_pages.size() * slotsPerPage())
+  {
+    if (m_pages.size() < m_maxPageCount)
+    {
+      m_pages.push_back(createPage());
+    }
+    else
+    {
+      // reuse the least recently used slot unless all slots are used in this frame
+      const auto it = std::min_element(
+        m_slots.begin(), m_slots.end(), [](const auto& lhs, const auto& rhs) {
+          return lhs.lastUse < rhs.lastUse;
+        });
+      if (it == m_slots.end() || it->lastUse == m_currentUse)
+      {
+        return std::nullopt;
+      }
+      return static_cast<size_t>(std::distance(m_slots.begin(), it));
+    }
+  }
+
+  m_slots.push_back(Slot{nullptr, "", 0u, 0u, Thumbnail{0u, {}, {}}});
+  return m_slots.size() - 1u;
+}
+
+void TextureThumbnailAtlas::releaseSlot(const size_t slotIndex)
+{
+  auto& slot = m_slots[slotIndex];
+  m_slotIndices.erase(slot.texture);
+  slot.texture = nullptr;
+  slot.lastUse = 0u;
+  m_freeSlots.push_back(slotIndex);
+}
+
+vm::vec2s TextureThumbnailAtlas::slotPosition(const size_t slotIndex) const
+{
+  const auto slotsPerRow = m_pageSize / slotPitch();
+  const auto indexInPage = slotIndex % slotsPerPage();
+  return vm::vec2s{indexInPage % slotsPerRow, indexInPage / slotsPerRow} * slotPitch();
+}
+
+size_t TextureThumbnailAtlas::slotPitch() const
+{
+  return m_slotSize + 2u * SlotBorder;
+}
+
+size_t TextureThumbnailAtlas::slotsPerPage() const
+{
+  const auto slotsPerRow = m_pageSize / slotPitch();
+  return slotsPerRow * slotsPerRow;
+}
+
+GLuint TextureThumbnailAtlas::createPage() const
+{
+  auto textureId = GLuint(0);
+  glAssert(glGenTextures(1, &textureId));
+  glAssert(glBindTexture(GL_TEXTURE_2D, textureId));
+  applyTextureMode();
+  glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+  glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+  glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+  glAssert(glTexImage2D(
+    GL_TEXTURE_2D,
+    0,
+    GL_RGBA,
+    static_cast<GLsizei>(m_pageSize),
+    static_cast<GLsizei>(m_pageSize),
+    0,
+    GL_RGBA,
+    GL_UNSIGNED_BYTE,
+    nullptr));
+  glAssert(glBindTexture(GL_TEXTURE_2D, 0));
+  return textureId;
+}
+
+void TextureThumbnailAtlas::applyTextureMode() const
+{
+  glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_minFilter));
+  glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_magFilter));
+}
+
+void TextureThumbnailAtlas::deletePages()
+{
+  if (!m_pages.empty())
+  {
+    glAssert(glDeleteTextures(static_cast<GLsizei>(m_pages.size()), m_pages.data()));
+    m_pages.clear();
+  }
+}
+} // namespace Renderer
+} // namespace TrenchBroom
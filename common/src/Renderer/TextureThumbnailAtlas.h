@@ -0,0 +1,153 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Renderer/GL.h"
+
+#include <vecmath/forward.h>
+#include <vecmath/vec.h>
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TrenchBroom
+{
+namespace Assets
+{
+class Texture;
+}
+
+namespace Renderer
+{
+/**
+ * Stores downscaled copies of textures in a few large GL textures so that many texture
+ * thumbnails can be rendered with a single texture binding.
+ *
+ * The atlas is divided into pages, and each page is divided into square slots. Each
+ * thumbnail occupies one slot and is surrounded by a border of one texel that repeats its
+ * edge texels, so that filtering does not bleed neighbouring thumbnails into it.
+ * Thumbnails are read back from the GL texture of the original texture, using the
+ * smallest mip level that is not smaller than the requested thumbnail size. Once all
+ * pages are full, the slot which has not been used for the longest time is reused.
+ *
+ * Textures are identified by their address and name, so the atlas must be cleared when
+ * the textures it refers to are destroyed.
+ */
+class TextureThumbnailAtlas
+{
+public:
+  struct Thumbnail
+  {
+    size_t page;
+    vm::vec2f minTexCoords;
+    vm::vec2f maxTexCoords;
+  };
+
+private:
+  struct Slot
+  {
+    const Assets::Texture* texture;
+    std::string textureName;
+    size_t thumbnailSize;
+    size_t lastUse;
+    Thumbnail thumbnail;
+  };
+
+  size_t m_pageSize;
+  size_t m_slotSize;
+  size_t m_maxPageCount;
+  int m_minFilter;
+  int m_magFilter;
+
+  std::vector<GLuint> m_pages;
+  std::vector<Slot> m_slots;
+  std::vector<size_t> m_freeSlots;
+  std::unordered_map<const Assets::Texture*, size_t> m_slotIndices;
+  size_t m_currentUse;
+
+public:
+  /**
+   * Creates a new atlas.
+   *
+   * @param pageSize the width and height of each page in pixels
+   * @param slotSize the maximum width and height of a thumbnail in pixels, each slot is
+   * two pixels larger to hold the border
+   * @param maxPageCount the maximum number of pages
+   * @param minFilter the minification filter of the pages
+   * @param magFilter the magnification filter of the pages
+   */
+  TextureThumbnailAtlas(
+    size_t pageSize, size_t slotSize, size_t maxPageCount, int minFilter, int magFilter);
+  ~TextureThumbnailAtlas();
+
+  TextureThumbnailAtlas(const TextureThumbnailAtlas&) = delete;
+  TextureThumbnailAtlas& operator=(const TextureThumbnailAtlas&) = delete;
+
+  size_t slotSize() const;
+
+  /**
+   * Sets the filters with which the pages are sampled. The pages have no mipmaps, so
+   * mipmap filters sample the base level only.
+   */
+  void setTextureMode(int minFilter, int magFilter);
+
+  /**
+   * Starts a new frame. Slots that are used after this call are not reused until the next
+   * frame begins.
+   */
+  void beginFrame();
+
+  /**
+   * Returns the thumbnail of the given texture if the atlas contains one whose size
+   * matches the given size.
+   */
+  std::optional<Thumbnail> find(const Assets::Texture& texture, size_t thumbnailSize);
+
+  /**
+   * Adds a thumbnail of the given texture with the given maximum width and height. The
+   * thumbnail size must not exceed the slot size.
+   *
+   * Returns nothing if the texture has no GL texture or if every slot has been used in
+   * the current frame.
+   */
+  std::optional<Thumbnail> insert(const Assets::Texture& texture, size_t thumbnailSize);
+
+  /**
+   * Removes all thumbnails from this atlas.
+   */
+  void clear();
+
+  void activate(size_t page) const;
+  void deactivate() const;
+
+private:
+  std::optional<size_t> allocateSlot();
+  void releaseSlot(size_t slotIndex);
+  vm::vec2s slotPosition(size_t slotIndex) const;
+  size_t slotPitch() const;
+  size_t slotsPerPage() const;
+  GLuint createPage() const;
+  void applyTextureMode() const;
+  void deletePages();
+};
+} // namespace Renderer
+} // namespace TrenchBroom
@@ -150,6 +150,24 @@ void TexturedIndexRangeMap::render(VertexArray& vertexArray, TextureRenderFunc&
   }
 }
 
+void TexturedIndexRangeMap::renderInstances(
+  VertexArray& vertexArray,
+  const size_t instanceCount,
+  const std::function<void(size_t)>& setupInstance)
+{
+  auto func = DefaultTextureRenderFunc{};
+  for (const auto& [texture, indexArray] : *m_data)
+  {
+    func.before(texture);
+    for (size_t i = 0u; i < instanceCount; ++i)
+    {
+      setupInstance(i);
+      indexArray.render(vertexArray);
+    }
+    func.after(texture);
+  }
+}
+
 void TexturedIndexRangeMap::forEachPrimitive(
   std::function<void(const Texture*, PrimType, size_t, size_t)> func) const
 {
@@ -184,6 +184,22 @@ public:
    */
   void render(VertexArray& vertexArray, TextureRenderFunc& func);
 
+  /**
+   * Renders the primitives stored in this index range map once for each of the given
+   * number of instances using the vertices in the given vertex array. Each texture is
+   * activated only once for all instances. The given function is called with the index of
+   * each instance before its primitives are rendered and can be used to set per instance
+   * shader uniforms.
+   *
+   * @param vertexArray the vertex array to render with
+   * @param instanceCount the number of instances to render
+   * @param setupInstance the function to call before rendering an instance
+   */
+  void renderInstances(
+    VertexArray& vertexArray,
+    size_t instanceCount,
+    const std::function<void(size_t)>& setupInstance);
+
   /**
    * Invokes the given function for each primitive stored in this map.
    *
@@ -22,6 +22,7 @@
 #include "Renderer/TexturedIndexRangeMap.h"
 #include "Renderer/VertexArray.h"
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -47,6 +48,15 @@ public:
   virtual void prepare(VboManager& vboManager) = 0;
   virtual void render() = 0;
   virtual void render(TextureRenderFunc& func) = 0;
+
+  /**
+   * Renders this renderer's primitives once for each of the given number of instances.
+   * The vertices are set up and each texture is activated only once for all instances.
+   * The given function is called with the index of each instance before its primitives
+   * are rendered.
+   */
+  virtual void renderInstances(
+    size_t instanceCount, const std::function<void(size_t)>& setupInstance) = 0;
 };
 
 class TexturedIndexRangeRenderer : public TexturedRenderer
@@ -70,6 +80,8 @@ public:
   void prepare(VboManager& vboManager) override;
   void render() override;
   void render(TextureRenderFunc& func) override;
+  void renderInstances(
+    size_t instanceCount, const std::function<void(size_t)>& setupInstance) override;
 };
 
 class MultiTexturedIndexRangeRenderer : public TexturedRenderer
@@ -87,6 +99,8 @@ public:
   void prepare(VboManager& vboManager) override;
   void render() override;
   void render(TextureRenderFunc& func) override;
+  void renderInstances(
+    size_t instanceCount, const std::function<void(size_t)>& setupInstance) override;
 };
 } // namespace Renderer
 } // namespace TrenchBroom
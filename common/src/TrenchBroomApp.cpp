@@ -464,6 +464,8 @@ bool TrenchBroomApp::initializeGameFactory()
     const auto gamePathConfig = Model::GamePathConfig{
       IO::SystemPaths::findResourceDirectories(IO::Path{"games"}),
       IO::SystemPaths::userDataDirectory() + IO::Path{"games"},
+      IO::SystemPaths::userDataDirectory() + IO::Path{"cache/models"},
+      IO::SystemPaths::userDataDirectory() + IO::Path{"cache/shaders"},
     };
     auto& gameFactory = Model::GameFactory::instance();
     gameFactory.initialize(gamePathConfig);
@@ -98,6 +98,23 @@ void LayoutCell::setItem(std::any item)
   m_item = std::move(item);
 }
 
+void LayoutCell::setItem(std::any item, const float itemWidth, const float itemHeight)
+{
+  m_item = std::move(item);
+  m_itemWidth = itemWidth;
+  m_itemHeight = itemHeight;
+}
+
+float LayoutCell::itemWidth() const
+{
+  return m_itemWidth;
+}
+
+float LayoutCell::itemHeight() const
+{
+  return m_itemHeight;
+}
+
 float LayoutCell::scale() const
 {
   return m_scale;
@@ -210,24 +227,20 @@ const std::vector<LayoutCell>& LayoutRow::cells() const
   return m_cells;
 }
 
+std::vector<LayoutCell>& LayoutRow::cells()
+{
+  return m_cells;
+}
+
 const LayoutCell* LayoutRow::cellAt(const float x, const float y) const
 {
-  for (size_t i = 0; i < m_cells.size(); ++i)
+  const auto it = std::partition_point(
+    m_cells.begin(), m_cells.end(), [&](const LayoutCell& cell) {
+      return x > cell.cellBounds().right();
+    });
+  if (it != m_cells.end() && it->hitTest(x, y))
   {
-    const LayoutCell& cell = m_cells[i];
-    const LayoutBounds& cellBounds = cell.cellBounds();
-    if (x > cellBounds.right())
-    {
-      continue;
-    }
-    else if (x < cellBounds.left())
-    {
-      break;
-    }
-    if (cell.hitTest(x, y))
-    {
-      return &cell;
-    }
+    return &*it;
   }
   return nullptr;
 }
@@ -445,41 +458,46 @@ const std::vector<LayoutRow>& LayoutGroup::rows() const
   return m_rows;
 }
 
-size_t LayoutGroup::indexOfRowAt(const float y) const
+std::vector<LayoutRow>& LayoutGroup::rows()
+{
+  return m_rows;
+}
+
+std::vector<const LayoutRow*> LayoutGroup::rowsIntersectingY(
+  const float y, const float height) const
 {
-  for (size_t i = 0; i < m_rows.size(); ++i)
+  auto result = std::vector<const LayoutRow*>{};
+
+  auto it = std::partition_point(m_rows.begin(), m_rows.end(), [&](const LayoutRow& row) {
+    return row.bounds().bottom() < y;
+  });
+  while (it != m_rows.end() && it->intersectsY(y, height))
   {
-    const LayoutRow& row = m_rows[i];
-    const LayoutBounds& rowBounds = row.bounds();
-    if (y < rowBounds.bottom())
-    {
-      return i;
-    }
+    result.push_back(&*it++);
   }
 
-  return m_rows.size();
+  return result;
+}
+
+size_t LayoutGroup::indexOfRowAt(const float y) const
+{
+  const auto it = std::partition_point(
+    m_rows.begin(), m_rows.end(), [&](const LayoutRow& row) {
+      return y >= row.bounds().bottom();
+    });
+  return static_cast<size_t>(std::distance(m_rows.begin(), it));
 }
 
 const LayoutCell* LayoutGroup::cellAt(const float x, const float y) const
 {
-  for (size_t i = 0; i < m_rows.size(); ++i)
+  const auto it = std::partition_point(
+    m_rows.begin(), m_rows.end(), [&](const LayoutRow& row) {
+      return y > row.bounds().bottom();
+    });
+  if (it != m_rows.end() && y >= it->bounds().top())
   {
-    const LayoutRow& row = m_rows[i];
-    const LayoutBounds& rowBounds = row.bounds();
-    if (y > rowBounds.bottom())
-    {
-      continue;
-    }
-    else if (y < rowBounds.top())
-    {
-      break;
-    }
-    if (const LayoutCell* cell = row.cellAt(x, y))
-    {
-      return cell;
-    }
+    return it->cellAt(x, y);
   }
-
   return nullptr;
 }
 
@@ -931,25 +949,21 @@ void CellLayout::validate()
   m_valid = true;
   if (!m_groups.empty())
   {
-    auto copy = m_groups;
+    auto groups = std::move(m_groups);
     m_groups.clear();
 
-    for (LayoutGroup& group : copy)
+    for (LayoutGroup& group : groups)
     {
       addGroup(group.item(), group.titleBounds().height);
-      for (const LayoutRow& row : group.rows())
+      for (LayoutRow& row : group.rows())
       {
-        for (const LayoutCell& cell : row.cells())
+        for (LayoutCell& cell : row.cells())
         {
-          const LayoutBounds& itemBounds = cell.itemBounds();
           const LayoutBounds& titleBounds = cell.titleBounds();
-          float scale = cell.scale();
-          float itemWidth = itemBounds.width / scale;
-          float itemHeight = itemBounds.height / scale;
           addItem(
             std::move(cell.item()),
-            itemWidth,
-            itemHeight,
+            cell.itemWidth(),
+            cell.itemHeight(),
             titleBounds.width,
             titleBounds.height);
         }
@@ -81,6 +81,15 @@ public:
   const std::any& item() const;
   void setItem(std::any item);
 
+  /**
+   * Replaces the item and its unscaled size. The bounds of this cell are updated when the
+   * layout that contains it is validated again.
+   */
+  void setItem(std::any item, float itemWidth, float itemHeight);
+
+  float itemWidth() const;
+  float itemHeight() const;
+
   template <typename T>
   const T& itemAs() const
   {
@@ -142,6 +151,7 @@ public:
   const LayoutBounds& bounds() const;
 
   const std::vector<LayoutCell>& cells() const;
+  std::vector<LayoutCell>& cells();
   const LayoutCell* cellAt(float x, float y) const;
 
   bool intersectsY(float y, float height) const;
@@ -216,6 +226,14 @@ public:
   LayoutBounds bounds() const;
 
   const std::vector<LayoutRow>& rows() const;
+  std::vector<LayoutRow>& rows();
+
+  /**
+   * Returns the rows of this group which intersect the given vertical range. Since the
+   * rows are sorted by their vertical position, this is done by binary search.
+   */
+  std::vector<const LayoutRow*> rowsIntersectingY(float y, float height) const;
+
   size_t indexOfRowAt(float y) const;
   const LayoutCell* cellAt(float x, float y) const;
 
@@ -293,6 +311,29 @@ public:
   const std::vector<LayoutGroup>& groups();
   const LayoutCell* cellAt(float x, float y);
 
+  /**
+   * Passes every cell to the given function, which may replace the cell's item and size
+   * by calling LayoutCell::setItem. If it returns true for any cell, the layout is
+   * updated when it is accessed the next time.
+   */
+  template <typename F>
+  void updateCells(F&& updateCell)
+  {
+    for (auto& group : m_groups)
+    {
+      for (auto& row : group.rows())
+      {
+        for (auto& cell : row.cells())
+        {
+          if (updateCell(cell))
+          {
+            invalidate();
+          }
+        }
+      }
+    }
+  }
+
   void addGroup(std::string groupItem, float titleHeight);
   void addItem(
     std::any item,
@@ -24,6 +24,8 @@
 
 #include <QPoint>
 
+#include <utility>
+
 class QScrollBar;
 class QDrag;
 class QMimeData;
@@ -93,6 +95,19 @@ public:
 private:
   void scrollToCellInternal(const Cell& cell);
 
+protected:
+  /**
+   * Passes every cell to the given function, which may replace the cell's item and size
+   * and return true to have the layout updated without reloading it.
+   */
+  template <class L>
+  void updateCells(L&& updateCell)
+  {
+    m_layout.updateCells(std::forward<L>(updateCell));
+    updateScrollBar();
+    update();
+  }
+
 private:
   void onScrollBarValueChanged();
   void onScrollBarActionTriggered(int action);
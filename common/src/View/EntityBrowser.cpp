@@ -160,6 +160,8 @@ void EntityBrowser::connectObservers()
     document->modsDidChangeNotifier.connect(this, &EntityBrowser::modsDidChange);
   m_notifierConnection += document->entityDefinitionsDidChangeNotifier.connect(
     this, &EntityBrowser::entityDefinitionsDidChange);
+  m_notifierConnection += document->entityModelsDidChangeNotifier.connect(
+    this, &EntityBrowser::entityModelsDidChange);
   m_notifierConnection +=
     document->nodesDidChangeNotifier.connect(this, &EntityBrowser::nodesDidChange);
 
@@ -194,6 +196,13 @@ void EntityBrowser::entityDefinitionsDidChange()
   reload();
 }
 
+void EntityBrowser::entityModelsDidChange(
+  const std::vector<Assets::ModelSpecification>& specs)
+{
+  // replace the placeholders of models that have finished loading
+  m_view->updateModels(specs);
+}
+
 void EntityBrowser::preferenceDidChange(const IO::Path& path)
 {
   auto document = kdl::mem_lock(m_document);
@@ -33,6 +33,10 @@ class QScrollBar;
 
 namespace TrenchBroom
 {
+namespace Assets
+{
+struct ModelSpecification;
+}
 namespace IO
 {
 class Path;
@@ -81,6 +85,7 @@ private:
   void modsDidChange();
   void nodesDidChange(const std::vector<Model::Node*>& nodes);
   void entityDefinitionsDidChange();
+  void entityModelsDidChange(const std::vector<Assets::ModelSpecification>& specs);
   void preferenceDidChange(const IO::Path& path);
 };
 } // namespace View
@@ -47,6 +47,7 @@
 #include <kdl/overload.h>
 #include <kdl/skip_iterator.h>
 #include <kdl/string_compare.h>
+#include <kdl/vector_set.h>
 #include <kdl/vector_utils.h>
 
 #include <vecmath/forward.h>
@@ -137,6 +138,26 @@ void EntityBrowserView::setFilterText(const std::string& filterText)
   update();
 }
 
+void EntityBrowserView::updateModels(const std::vector<Assets::ModelSpecification>& specs)
+{
+  const auto loadedSpecs = kdl::vector_set<Assets::ModelSpecification>{specs};
+  updateCells([&](Cell& cell) {
+    const auto& oldCellData = cellData(cell);
+    if (
+      oldCellData.modelRenderer != nullptr
+      || loadedSpecs.count(oldCellData.modelSpec) == 0)
+    {
+      return false;
+    }
+
+    auto newCellData = makeCellData(
+      oldCellData.entityDefinition, oldCellData.modelSpec, oldCellData.fontDescriptor);
+    const auto boundsSize = newCellData.bounds.size();
+    cell.setItem(std::move(newCellData), boundsSize.y(), boundsSize.z());
+    return true;
+  });
+}
+
 void EntityBrowserView::doInitLayout(Layout& layout)
 {
   layout.setOuterMargin(5.0f);
@@ -221,46 +242,10 @@ void EntityBrowserView::addEntityToLayout(
         return definition->modelDefinition().defaultModelSpecification();
       });
 
-    const auto* frame = m_entityModelManager.frame(spec);
-    const auto modelScale = vm::vec3f{Assets::safeGetModelScale(
-      definition->modelDefinition(),
-      EL::NullVariableStore{},
-      m_defaultScaleModelExpression)};
-
-    Renderer::TexturedRenderer* modelRenderer = nullptr;
-    vm::bbox3f rotatedBounds;
-    auto modelOrientation = Assets::Orientation::Oriented;
-
-    if (frame != nullptr)
-    {
-      const auto bounds = frame->bounds();
-      const auto center = bounds.center();
-      const auto transform =
-        vm::translation_matrix(center) * vm::rotation_matrix(m_rotation)
-        * vm::scaling_matrix(modelScale) * vm::translation_matrix(-center);
-      rotatedBounds = bounds.transform(transform);
-      modelRenderer = m_entityModelManager.renderer(spec);
-      modelOrientation = frame->orientation();
-    }
-    else
-    {
-      rotatedBounds = vm::bbox3f(definition->bounds());
-      const auto center = rotatedBounds.center();
-      const auto transform = vm::translation_matrix(-center)
-                             * vm::rotation_matrix(m_rotation)
-                             * vm::translation_matrix(center);
-      rotatedBounds = rotatedBounds.transform(transform);
-    }
-
-    const auto boundsSize = rotatedBounds.size();
+    auto cellData = makeCellData(definition, spec, actualFont);
+    const auto boundsSize = cellData.bounds.size();
     layout.addItem(
-      EntityCellData{
-        definition,
-        modelRenderer,
-        modelOrientation,
-        actualFont,
-        rotatedBounds,
-        modelScale},
+      std::move(cellData),
       boundsSize.y(),
       boundsSize.z(),
       actualSize.x(),
@@ -268,6 +253,50 @@ void EntityBrowserView::addEntityToLayout(
   }
 }
 
+/**
+ * Creates the cell data for the given definition. If the model is not loaded yet, the
+ * cell shows the definition's bounds instead.
+ */
+EntityCellData EntityBrowserView::makeCellData(
+  const Assets::PointEntityDefinition* definition,
+  const Assets::ModelSpecification& spec,
+  const Renderer::FontDescriptor& font) const
+{
+  const auto* frame = m_entityModelManager.frame(spec);
+  const auto modelScale = vm::vec3f{Assets::safeGetModelScale(
+    definition->modelDefinition(),
+    EL::NullVariableStore{},
+    m_defaultScaleModelExpression)};
+
+  Renderer::TexturedRenderer* modelRenderer = nullptr;
+  vm::bbox3f rotatedBounds;
+  auto modelOrientation = Assets::Orientation::Oriented;
+
+  if (frame != nullptr)
+  {
+    const auto bounds = frame->bounds();
+    const auto center = bounds.center();
+    const auto transform =
+      vm::translation_matrix(center) * vm::rotation_matrix(m_rotation)
+      * vm::scaling_matrix(modelScale) * vm::translation_matrix(-center);
+    rotatedBounds = bounds.transform(transform);
+    modelRenderer = m_entityModelManager.renderer(spec);
+    modelOrientation = frame->orientation();
+  }
+  else
+  {
+    rotatedBounds = vm::bbox3f(definition->bounds());
+    const auto center = rotatedBounds.center();
+    const auto transform = vm::translation_matrix(-center)
+                           * vm::rotation_matrix(m_rotation)
+                           * vm::translation_matrix(center);
+    rotatedBounds = rotatedBounds.transform(transform);
+  }
+
+  return EntityCellData{
+    definition, spec, modelRenderer, modelOrientation, font, rotatedBounds, modelScale};
+}
+
 void EntityBrowserView::doClear() {}
 
 void EntityBrowserView::doRender(Layout& layout, const float y, const float height)
@@ -331,22 +360,19 @@ void EntityBrowserView::renderBounds(Layout& layout, const float y, const float
   {
     if (group.intersectsY(y, height))
     {
-      for (const auto& row : group.rows())
+      for (const auto* row : group.rowsIntersectingY(y, height))
       {
-        if (row.intersectsY(y, height))
+        for (const auto& cell : row->cells())
         {
-          for (const auto& cell : row.cells())
+          const auto* definition = cellData(cell).entityDefinition;
+          auto* modelRenderer = cellData(cell).modelRenderer;
+
+          if (modelRenderer == nullptr)
           {
-            const auto* definition = cellData(cell).entityDefinition;
-            auto* modelRenderer = cellData(cell).modelRenderer;
-
-            if (modelRenderer == nullptr)
-            {
-              const auto itemTrans = itemTransformation(cell, y, height, false);
-              const auto& color = definition->color();
-              CollectBoundsVertices<BoundsVertex> collect(itemTrans, color, vertices);
-              vm::bbox3f(definition->bounds()).for_each_edge(collect);
-            }
+            const auto itemTrans = itemTransformation(cell, y, height, false);
+            const auto& color = definition->color();
+            CollectBoundsVertices<BoundsVertex> collect(itemTrans, color, vertices);
+            vm::bbox3f(definition->bounds()).for_each_edge(collect);
           }
         }
       }
@@ -386,25 +412,21 @@ void EntityBrowserView::renderModels(
   {
     if (group.intersectsY(y, height))
     {
-      for (const auto& row : group.rows())
+      for (const auto* row : group.rowsIntersectingY(y, height))
       {
-        if (row.intersectsY(y, height))
+        for (const auto& cell : row->cells())
         {
-          for (const auto& cell : row.cells())
-          {
-            auto* modelRenderer = cellData(cell).modelRenderer;
+          auto* modelRenderer = cellData(cell).modelRenderer;
 
-            if (modelRenderer != nullptr)
-            {
-              shader.set(
-                "Orientation", static_cast<int>(cellData(cell).modelOrientation));
+          if (modelRenderer != nullptr)
+          {
+            shader.set("Orientation", static_cast<int>(cellData(cell).modelOrientation));
 
-              const auto itemTrans = itemTransformation(cell, y, height, true);
-              shader.set("ModelMatrix", itemTrans);
+            const auto itemTrans = itemTransformation(cell, y, height, true);
+            shader.set("ModelMatrix", itemTrans);
 
-              Renderer::MultiplyModelMatrix multMatrix(transformation, itemTrans);
-              modelRenderer->render();
-            }
+            Renderer::MultiplyModelMatrix multMatrix(transformation, itemTrans);
+            modelRenderer->render();
           }
         }
       }
@@ -520,29 +542,24 @@ EntityBrowserView::StringMap EntityBrowserView::collectStringVertices(
         allTitleVertices = kdl::vec_concat(std::move(allTitleVertices), titleVertices);
       }
 
-      for (const auto& row : group.rows())
+      for (const auto* row : group.rowsIntersectingY(y, height))
       {
-        if (row.intersectsY(y, height))
+        for (const auto& cell : row->cells())
         {
-          for (const auto& cell : row.cells())
-          {
-            const auto titleBounds = cell.titleBounds();
-            const auto offset = vm::vec2f(
-              titleBounds.left(), height - (titleBounds.top() - y) - titleBounds.height);
-
-            Renderer::TextureFont& font =
-              fontManager().font(cellData(cell).fontDescriptor);
-            const auto quads =
-              font.quads(cellData(cell).entityDefinition->name(), false, offset);
-            const auto titleVertices = TextVertex::toList(
-              quads.size() / 2,
-              kdl::skip_iterator(std::begin(quads), std::end(quads), 0, 2),
-              kdl::skip_iterator(std::begin(quads), std::end(quads), 1, 2),
-              kdl::skip_iterator(std::begin(textColor), std::end(textColor), 0, 0));
-            auto& allTitleVertices = stringVertices[cellData(cell).fontDescriptor];
-            allTitleVertices =
-              kdl::vec_concat(std::move(allTitleVertices), titleVertices);
-          }
+          const auto titleBounds = cell.titleBounds();
+          const auto offset = vm::vec2f(
+            titleBounds.left(), height - (titleBounds.top() - y) - titleBounds.height);
+
+          Renderer::TextureFont& font = fontManager().font(cellData(cell).fontDescriptor);
+          const auto quads =
+            font.quads(cellData(cell).entityDefinition->name(), false, offset);
+          const auto titleVertices = TextVertex::toList(
+            quads.size() / 2,
+            kdl::skip_iterator(std::begin(quads), std::end(quads), 0, 2),
+            kdl::skip_iterator(std::begin(quads), std::end(quads), 1, 2),
+            kdl::skip_iterator(std::begin(textColor), std::end(textColor), 0, 0));
+          auto& allTitleVertices = stringVertices[cellData(cell).fontDescriptor];
+          allTitleVertices = kdl::vec_concat(std::move(allTitleVertices), titleVertices);
         }
       }
     }
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include "Assets/ModelDefinition.h"
 #include "EL/Expression.h"
 #include "NotifierConnection.h"
 #include "Renderer/FontDescriptor.h"
@@ -61,6 +62,7 @@ struct EntityCellData
 {
   using EntityRenderer = Renderer::TexturedRenderer;
   const Assets::PointEntityDefinition* entityDefinition;
+  Assets::ModelSpecification modelSpec;
   EntityRenderer* modelRenderer;
   Assets::Orientation modelOrientation;
   Renderer::FontDescriptor fontDescriptor;
@@ -112,6 +114,12 @@ public:
   void setHideUnused(bool hideUnused);
   void setFilterText(const std::string& filterText);
 
+  /**
+   * Replaces the placeholders of the cells whose models have finished loading with the
+   * models, without reloading the layout.
+   */
+  void updateModels(const std::vector<Assets::ModelSpecification>& specs);
+
 private:
   void doInitLayout(Layout& layout) override;
   void doReloadLayout(Layout& layout) override;
@@ -123,6 +131,10 @@ private:
     Layout& layout,
     const Assets::PointEntityDefinition* definition,
     const Renderer::FontDescriptor& font);
+  EntityCellData makeCellData(
+    const Assets::PointEntityDefinition* definition,
+    const Assets::ModelSpecification& spec,
+    const Renderer::FontDescriptor& font) const;
 
   void doClear() override;
   void doRender(Layout& layout, float y, float height) override;
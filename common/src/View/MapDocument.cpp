@@ -36,6 +36,7 @@
 #include "IO/IOUtils.h"
 #include "IO/SimpleParserStatus.h"
 #include "IO/SystemPaths.h"
+#include "Logger.h"
 #include "Model/BezierPatch.h"
 #include "Model/Brush.h"
 #include "Model/BrushBuilder.h"
@@ -98,6 +99,7 @@
 #include "View/SetCurrentLayerCommand.h"
 #include "View/SetLockStateCommand.h"
 #include "View/SetVisibilityCommand.h"
+#include "View/SpeculativeTransformer.h"
 #include "View/SwapNodeContentsCommand.h"
 #include "View/TransactionScope.h"
 #include "View/UpdateLinkedGroupsCommand.h"
@@ -121,16 +123,24 @@
 #include <vecmath/vec_io.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdlib> // for std::abs
 #include <map>
 #include <mutex>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <unordered_map>
 #include <vector>
 
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QTimer>
+
 namespace TrenchBroom
 {
 namespace View
@@ -246,6 +256,131 @@ applyToNodeContents(const std::vector<N*>& nodes, L lambda)
   return success ? std::make_optional(newNodes) : std::nullopt;
 }
 
+// below this number of nodes, the overhead of spawning threads outweighs the gain
+static constexpr size_t MinNodeCountForParallelHandleMove = 16u;
+
+/**
+ * The result of moving handles of a single brush. Contains the new positions of the moved
+ * handles, or an empty optional if the brush does not permit the handles to be moved.
+ */
+template <typename H>
+using MoveBrushHandlesResult =
+  kdl::result<std::optional<std::vector<H>>, Model::BrushError>;
+
+/**
+ * Applies the given lambda to a copy of the brush of each given brush node and returns a
+ * vector of pairs of each given node and its modified contents, together with the new
+ * positions of all moved handles, sorted and without duplicates. The contents of all
+ * other nodes are copied unchanged.
+ *
+ * The lambda must accept a brush and return a MoveBrushHandlesResult. For large
+ * selections, it is called in parallel, so it must not modify any shared state.
+ *
+ * The results are merged in the order of the given nodes, so the outcome does not depend
+ * on the order in which the brushes were processed. If the lambda fails for any brush,
+ * the first such failure is logged with the given error message and an empty optional is
+ * returned.
+ */
+template <typename H, typename N, typename L>
+static std::optional<
+  std::pair<std::vector<std::pair<Model::Node*, Model::NodeContents>>, std::vector<H>>>
+moveBrushHandles(
+  Logger& logger, const std::string& errorMessage, const std::vector<N*>& nodes, L lambda)
+{
+  using NodeResult = std::pair<Model::NodeContents, MoveBrushHandlesResult<H>>;
+
+  auto nodeResults = std::vector<std::optional<NodeResult>>(nodes.size());
+
+  // nodes after the first failed node need not be processed, but all nodes before it must
+  // be processed so that the same failure is reported regardless of scheduling
+  auto firstFailedIndex = std::atomic<size_t>{nodes.size()};
+
+  const auto moveHandles = [&](const size_t index) {
+    if (index > firstFailedIndex.load(std::memory_order_relaxed))
+    {
+      return;
+    }
+
+    auto moveResult = MoveBrushHandlesResult<H>{std::vector<H>{}};
+    auto contents = nodes[index]->accept(kdl::overload(
+      [](const Model::WorldNode* worldNode) {
+        return Model::NodeContents{worldNode->entity()};
+      },
+      [](const Model::LayerNode* layerNode) {
+        return Model::NodeContents{layerNode->layer()};
+      },
+      [](const Model::GroupNode* groupNode) {
+        return Model::NodeContents{groupNode->group()};
+      },
+      [](const Model::EntityNode* entityNode) {
+        return Model::NodeContents{entityNode->entity()};
+      },
+      [&](const Model::BrushNode* brushNode) {
+        auto brush = brushNode->brush();
+        moveResult = lambda(brush);
+        return Model::NodeContents{std::move(brush)};
+      },
+      [](const Model::PatchNode* patchNode) {
+        return Model::NodeContents{patchNode->patch()};
+      }));
+
+    const auto failed = moveResult.visit(kdl::overload(
+      [](const std::optional<std::vector<H>>& newPositions) { return !newPositions; },
+      [](const Model::BrushError) { return true; }));
+    if (failed)
+    {
+      auto expected = firstFailedIndex.load();
+      while (index < expected && !firstFailedIndex.compare_exchange_weak(expected, index))
+      {
+      }
+    }
+
+    nodeResults[index] = NodeResult{std::move(contents), std::move(moveResult)};
+  };
+
+  if (nodes.size() >= MinNodeCountForParallelHandleMove)
+  {
+    kdl::parallel_for(nodes.size(), moveHandles);
+  }
+  else
+  {
+    for (size_t i = 0u; i < nodes.size() && firstFailedIndex == nodes.size(); ++i)
+    {
+      moveHandles(i);
+    }
+  }
+
+  auto newNodes = std::vector<std::pair<Model::Node*, Model::NodeContents>>{};
+  newNodes.reserve(nodes.size());
+
+  auto newHandlePositions = std::vector<H>{};
+  for (size_t i = 0u; i < nodes.size(); ++i)
+  {
+    auto& [contents, moveResult] = *nodeResults[i];
+    auto newPositions = std::move(moveResult)
+                          .visit(kdl::overload(
+                            [](std::optional<std::vector<H>>&& positions) {
+                              return std::move(positions);
+                            },
+                            [&](const Model::BrushError e) {
+                              logger.error() << errorMessage << ": " << e;
+                              return std::optional<std::vector<H>>{};
+                            }));
+    if (!newPositions)
+    {
+      return std::nullopt;
+    }
+
+    newHandlePositions =
+      kdl::vec_concat(std::move(newHandlePositions), std::move(*newPositions));
+    newNodes.emplace_back(nodes[i], std::move(contents));
+  }
+
+  return std::make_pair(
+    std::move(newNodes),
+    kdl::vec_sort_and_remove_duplicates(std::move(newHandlePositions)));
+}
+
 /**
  * Applies the given lambda to a copy of the contents of each of the given nodes and swaps
  * the node contents if the given lambda succeeds for all node contents.
@@ -357,6 +492,16 @@ static bool applyAndSwap(
 const vm::bbox3 MapDocument::DefaultWorldBounds(-32768.0, 32768.0);
 const std::string MapDocument::DefaultDocumentName("unnamed.map");
 
+static size_t textureCacheSize()
+{
+  const auto megabytes = std::max(0, pref(Preferences::TextureCacheSize));
+  return static_cast<size_t>(megabytes) * 1024u * 1024u;
+}
+
+// How often the document checks for entity models that worker threads have finished
+// loading while models are pending.
+static constexpr auto EntityModelLoadInterval = std::chrono::milliseconds{16};
+
 MapDocument::MapDocument()
   : m_worldBounds(DefaultWorldBounds)
   , m_world(nullptr)
@@ -364,6 +509,7 @@ MapDocument::MapDocument()
   , m_entityDefinitionManager(std::make_unique<Assets::EntityDefinitionManager>())
   , m_entityModelManager(std::make_unique<Assets::EntityModelManager>(
       pref(Preferences::TextureMagFilter), pref(Preferences::TextureMinFilter), logger()))
+  , m_entityModelLoadTimer(std::make_unique<QTimer>())
   , m_textureManager(std::make_unique<Assets::TextureManager>(
       pref(Preferences::TextureMagFilter), pref(Preferences::TextureMinFilter), logger()))
   , m_tagManager(std::make_unique<Model::TagManager>())
@@ -379,11 +525,21 @@ MapDocument::MapDocument()
   , m_viewEffectsService(nullptr)
   , m_repeatStack(std::make_unique<RepeatStack>())
 {
+  m_textureManager->setCacheSize(textureCacheSize());
+  m_textureManager->setCompressTextures(pref(Preferences::CompressTextures));
+
+  // entity models are loaded on worker threads, the timer adds the finished ones
+  m_entityModelLoadTimer->setInterval(EntityModelLoadInterval);
+  QObject::connect(m_entityModelLoadTimer.get(), &QTimer::timeout, [this]() {
+    loadPendingEntityModels();
+  });
+
   connectObservers();
 }
 
 MapDocument::~MapDocument()
 {
+  cancelSpeculativeTransformation();
   if (isPointFileLoaded())
   {
     unloadPointFile();
@@ -2742,8 +2898,13 @@ bool MapDocument::swapNodeContents(
     commandName, std::move(nodesToSwap), std::move(changedLinkedGroups));
 }
 
-bool MapDocument::transformObjects(
-  const std::string& commandName, const vm::mat4x4& transformation)
+struct MapDocument::SpeculativeTransformation
+{
+  std::string commandName;
+  std::unique_ptr<SpeculativeTransformer> transformer;
+};
+
+std::vector<Model::Node*> MapDocument::collectNodesToTransform() const
 {
   auto nodesToTransform = std::vector<Model::Node*>{};
 
@@ -2789,46 +2950,20 @@ bool MapDocument::transformObjects(
   }
 
   // brush entites can be added many times
-  nodesToTransform = kdl::vec_sort_and_remove_duplicates(std::move(nodesToTransform));
-
-  using TransformResult =
-    kdl::result<std::pair<Model::Node*, Model::NodeContents>, Model::BrushError>;
+  return kdl::vec_sort_and_remove_duplicates(std::move(nodesToTransform));
+}
 
+bool MapDocument::transformObjects(
+  const std::string& commandName, const vm::mat4x4& transformation)
+{
   const bool lockTexturesPref = pref(Preferences::TextureLock);
-  auto transformResults = kdl::vec_parallel_transform(
-    nodesToTransform, [&](Model::Node* node) -> TransformResult {
-      return node->accept(kdl::overload(
-        [&](Model::WorldNode*) -> TransformResult {
-          ensure(false, "Unexpected world node");
-        },
-        [&](Model::LayerNode*) -> TransformResult {
-          ensure(false, "Unexpected layer node");
-        },
-        [&](Model::GroupNode* groupNode) -> TransformResult {
-          auto group = groupNode->group();
-          group.transform(transformation);
-          return std::make_pair(groupNode, Model::NodeContents{std::move(group)});
-        },
-        [&](Model::EntityNode* entityNode) -> TransformResult {
-          auto entity = entityNode->entity();
-          entity.transform(m_world->entityPropertyConfig(), transformation);
-          return std::make_pair(entityNode, Model::NodeContents{std::move(entity)});
-        },
-        [&](Model::BrushNode* brushNode) -> TransformResult {
-          const bool lockTextures =
-            lockTexturesPref || (Model::findContainingLinkedGroup(*brushNode) != nullptr);
-
-          auto brush = brushNode->brush();
-          return brush.transform(m_worldBounds, transformation, lockTextures)
-            .and_then([&]() -> TransformResult {
-              return std::make_pair(brushNode, Model::NodeContents{std::move(brush)});
-            });
-        },
-        [&](Model::PatchNode* patchNode) -> TransformResult {
-          auto patch = patchNode->patch();
-          patch.transform(transformation);
-          return std::make_pair(patchNode, Model::NodeContents{std::move(patch)});
-        }));
+  auto transformResults =
+    kdl::vec_parallel_transform(collectNodesToTransform(), [&](Model::Node* node) {
+      return transformNode(
+        snapshotNode(*node, lockTexturesPref),
+        transformation,
+        m_worldBounds,
+        m_world->entityPropertyConfig());
     });
 
   bool transformFailed = false;
@@ -2856,6 +2991,91 @@ bool MapDocument::transformObjects(
   return false;
 }
 
+void MapDocument::transformObjectsSpeculatively(
+  const std::string& commandName, const vm::mat4x4& transformation)
+{
+  if (!m_speculativeTransformation)
+  {
+    const bool lockTexturesPref = pref(Preferences::TextureLock);
+    auto snapshots =
+      kdl::vec_parallel_transform(collectNodesToTransform(), [&](Model::Node* node) {
+        return snapshotNode(*node, lockTexturesPref);
+      });
+
+    m_speculativeTransformation = std::make_shared<SpeculativeTransformation>();
+    m_speculativeTransformation->commandName = commandName;
+
+    // the worker thread must not touch the document, so the evaluation is applied by the
+    // event loop; the weak pointer expires if the transformation is finished or cancelled
+    // (or the document is destroyed) in the meantime
+    auto speculativeTransformation =
+      std::weak_ptr<SpeculativeTransformation>{m_speculativeTransformation};
+    m_speculativeTransformation->transformer = std::make_unique<SpeculativeTransformer>(
+      m_worldBounds,
+      m_world->entityPropertyConfig(),
+      std::move(snapshots),
+      [this, speculativeTransformation]() {
+        QMetaObject::invokeMethod(
+          qApp,
+          [this, speculativeTransformation]() {
+            if (!speculativeTransformation.expired())
+            {
+              applySpeculativeTransformation(false);
+            }
+          },
+          Qt::QueuedConnection);
+      });
+  }
+
+  m_speculativeTransformation->transformer->request(transformation);
+}
+
+void MapDocument::finishSpeculativeTransformation()
+{
+  if (m_speculativeTransformation)
+  {
+    applySpeculativeTransformation(true);
+    m_speculativeTransformation.reset();
+  }
+}
+
+void MapDocument::cancelSpeculativeTransformation()
+{
+  m_speculativeTransformation.reset();
+}
+
+void MapDocument::applySpeculativeTransformation(const bool wait)
+{
+  assert(m_speculativeTransformation);
+
+  auto& transformer = *m_speculativeTransformation->transformer;
+  auto evaluation = wait ? transformer.finish() : transformer.takeEvaluation();
+  if (!evaluation)
+  {
+    return;
+  }
+
+  const auto& commandName = m_speculativeTransformation->commandName;
+  const auto transformation = evaluation->transformation;
+  std::move(evaluation->result)
+    .visit(kdl::overload(
+      [&](std::vector<std::pair<Model::Node*, Model::NodeContents>>&& nodesToUpdate) {
+        rollbackTransaction();
+        if (swapNodeContents(
+              commandName,
+              std::move(nodesToUpdate),
+              findContainingLinkedGroups(*m_world, m_selectedNodes.nodes())))
+        {
+          m_repeatStack->push(
+            [=]() { this->transformObjects(commandName, transformation); });
+        }
+      },
+      [&](const Model::BrushError& e) {
+        // keep showing the last transformation that succeeded
+        error() << "Could not transform brush: " << e;
+      }));
+}
+
 bool MapDocument::translateObjects(const vm::vec3& delta)
 {
   return transformObjects("Translate Objects", vm::translation_matrix(delta));
@@ -3018,6 +3238,82 @@ bool MapDocument::csgConvexMerge()
       [&](const Model::BrushError e) { error() << "Could not create brush: " << e; });
 }
 
+/**
+ * Returns a brush covering the given fragments if their union is convex.
+ *
+ * The fragments must not overlap, so their union is convex exactly if the volume of their
+ * convex hull equals the sum of their volumes.
+ */
+static std::optional<Model::Brush> mergeIfConvex(
+  const Model::Brush& lhs,
+  const FloatType lhsVolume,
+  const Model::Brush& rhs,
+  const FloatType rhsVolume,
+  const Model::BrushBuilder& builder,
+  const std::string& textureName)
+{
+  if (!lhs.bounds().intersects(rhs.bounds()))
+  {
+    return std::nullopt;
+  }
+
+  const auto hull =
+    Model::Polyhedron3{kdl::vec_concat(lhs.vertexPositions(), rhs.vertexPositions())};
+  if (!vm::is_equal(hull.volume(), lhsVolume + rhsVolume, vm::C::almost_zero()))
+  {
+    return std::nullopt;
+  }
+
+  auto merged = builder.createBrush(hull, textureName);
+  if (!merged.is_success())
+  {
+    return std::nullopt;
+  }
+
+  auto brush = std::move(merged).value();
+  brush.cloneFaceAttributesFrom(std::vector<const Model::Brush*>{&lhs, &rhs});
+  return brush;
+}
+
+/**
+ * Repeatedly merges pairs of the given fragments whose union is convex to reduce the
+ * number of brushes created by a subtraction.
+ */
+static std::vector<Model::Brush> mergeConvexFragments(
+  std::vector<Model::Brush> fragments,
+  const Model::BrushBuilder& builder,
+  const std::string& textureName)
+{
+  auto volumes = kdl::vec_transform(fragments, [](const auto& fragment) {
+    return Model::Polyhedron3{fragment.vertexPositions()}.volume();
+  });
+
+  for (size_t i = 0u; i < fragments.size(); ++i)
+  {
+    for (size_t j = i + 1u; j < fragments.size();)
+    {
+      if (
+        auto merged = mergeIfConvex(
+          fragments[i], volumes[i], fragments[j], volumes[j], builder, textureName))
+      {
+        fragments[i] = std::move(*merged);
+        volumes[i] = volumes[i] + volumes[j];
+        fragments.erase(std::next(fragments.begin(), static_cast<std::ptrdiff_t>(j)));
+        volumes.erase(std::next(volumes.begin(), static_cast<std::ptrdiff_t>(j)));
+
+        // the merged fragment might now be mergeable with a fragment we have skipped
+        j = i + 1u;
+      }
+      else
+      {
+        ++j;
+      }
+    }
+  }
+
+  return fragments;
+}
+
 bool MapDocument::csgSubtract()
 {
   const auto subtrahendNodes = std::vector<Model::BrushNode*>{selectedNodes().brushes()};
@@ -3034,18 +3330,45 @@ bool MapDocument::csgSubtract()
   const auto subtrahends = kdl::vec_transform(
     subtrahendNodes, [](const auto* subtrahendNode) { return &subtrahendNode->brush(); });
 
+  const auto mapFormat = m_world->mapFormat();
+  const auto textureName = currentTextureName();
+  const auto builder =
+    Model::BrushBuilder{mapFormat, m_worldBounds, m_game->defaultFaceAttribs()};
+
+  // the minuends are independent of each other, but errors must be logged on this thread
+  auto subtractionResults =
+    kdl::vec_parallel_transform(minuendNodes, [&](const Model::BrushNode* minuendNode) {
+      const auto& minuend = minuendNode->brush();
+
+      // subtrahends that don't overlap the minuend cannot change it
+      const auto overlappingSubtrahends =
+        kdl::vec_filter(subtrahends, [&](const Model::Brush* subtrahend) {
+          return subtrahend->bounds().intersects(minuend.bounds());
+        });
+
+      auto errors = std::vector<Model::BrushError>{};
+      auto fragments = kdl::collect_values(
+        minuend.subtract(mapFormat, m_worldBounds, textureName, overlappingSubtrahends),
+        [&](const Model::BrushError& e) { errors.push_back(e); });
+
+      return std::make_pair(
+        mergeConvexFragments(std::move(fragments), builder, textureName),
+        std::move(errors));
+    });
+
   auto toAdd = std::map<Model::Node*, std::vector<Model::Node*>>{};
   auto toRemove =
     std::vector<Model::Node*>{std::begin(subtrahendNodes), std::end(subtrahendNodes)};
 
-  for (auto* minuendNode : minuendNodes)
+  for (size_t i = 0u; i < minuendNodes.size(); ++i)
   {
-    const auto& minuend = minuendNode->brush();
-    auto currentSubtractionResults = minuend.subtract(
-      m_world->mapFormat(), m_worldBounds, currentTextureName(), subtrahends);
-    auto currentBrushes = kdl::collect_values(
-      std::move(currentSubtractionResults),
-      [&](const Model::BrushError& e) { error() << "Could not create brush: " << e; });
+    auto* minuendNode = minuendNodes[i];
+    auto& [currentBrushes, errors] = subtractionResults[i];
+
+    for (const auto& e : errors)
+    {
+      error() << "Could not create brush: " << e;
+    }
 
     if (!currentBrushes.empty())
     {
@@ -3122,33 +3445,58 @@ bool MapDocument::csgHollow()
     return false;
   }
 
-  bool didHollowAnything = false;
-  auto fragmentsAndSourceNodes =
-    kdl::vec_transform(brushNodes, [&](Model::BrushNode* brushNode) {
+  struct HollowResult
+  {
+    Model::BrushNode* brushNode;
+    std::vector<Model::Brush> fragments;
+    std::vector<Model::BrushError> fragmentErrors;
+    std::optional<Model::BrushError> hollowError;
+  };
+
+  const auto mapFormat = m_world->mapFormat();
+  const auto textureName = currentTextureName();
+  const auto thickness = static_cast<FloatType>(m_grid->actualSize());
+
+  // the brushes are independent of each other, but errors must be logged on this thread
+  auto hollowResults =
+    kdl::vec_parallel_transform(brushNodes, [&](Model::BrushNode* brushNode) {
       const auto& originalBrush = brushNode->brush();
 
+      auto result = HollowResult{brushNode, {}, {}, std::nullopt};
       auto shrunkenBrush = originalBrush;
-      auto fragments = std::vector<Model::Brush>{};
-      shrunkenBrush
-        .expand(m_worldBounds, -1.0 * static_cast<FloatType>(m_grid->actualSize()), true)
+      shrunkenBrush.expand(m_worldBounds, -1.0 * thickness, true)
         .and_then([&]() {
-          didHollowAnything = true;
-
           auto subtractionResults = originalBrush.subtract(
-            m_world->mapFormat(), m_worldBounds, currentTextureName(), shrunkenBrush);
-          fragments = kdl::collect_values(
-            std::move(subtractionResults), [&](const Model::BrushError& e) {
-              error() << "Could not create brush: " << e;
-            });
+            mapFormat, m_worldBounds, textureName, shrunkenBrush);
+          result.fragments = kdl::collect_values(
+            std::move(subtractionResults),
+            [&](const Model::BrushError& e) { result.fragmentErrors.push_back(e); });
         })
         .handle_errors([&](const Model::BrushError& e) {
-          error() << "Could not hollow brush: " << e;
-          fragments = {originalBrush};
+          result.hollowError = e;
+          result.fragments = {originalBrush};
         });
 
-      return std::make_pair(brushNode, std::move(fragments));
+      return result;
     });
 
+  bool didHollowAnything = false;
+  for (const auto& result : hollowResults)
+  {
+    for (const auto& e : result.fragmentErrors)
+    {
+      error() << "Could not create brush: " << e;
+    }
+    if (result.hollowError)
+    {
+      error() << "Could not hollow brush: " << *result.hollowError;
+    }
+    else
+    {
+      didHollowAnything = true;
+    }
+  }
+
   if (!didHollowAnything)
   {
     return false;
@@ -3157,14 +3505,15 @@ bool MapDocument::csgHollow()
   auto toAdd = std::map<Model::Node*, std::vector<Model::Node*>>{};
   auto toRemove = std::vector<Model::Node*>{};
 
-  for (auto& [sourceNode, fragments] : fragmentsAndSourceNodes)
+  for (auto& result : hollowResults)
   {
-    auto fragmentNodes = kdl::vec_transform(
-      std::move(fragments), [](auto&& b) { return new Model::BrushNode{std::move(b)}; });
+    auto fragmentNodes = kdl::vec_transform(std::move(result.fragments), [](auto&& b) {
+      return new Model::BrushNode{std::move(b)};
+    });
 
-    auto& toAddForParent = toAdd[sourceNode->parent()];
+    auto& toAddForParent = toAdd[result.brushNode->parent()];
     toAddForParent = kdl::vec_concat(std::move(toAddForParent), fragmentNodes);
-    toRemove.push_back(sourceNode);
+    toRemove.push_back(result.brushNode);
   }
 
   auto transaction = Transaction{*this, "CSG Hollow"};
@@ -3687,53 +4036,44 @@ bool MapDocument::snapVertices(const FloatType snapTo)
 MapDocument::MoveVerticesResult MapDocument::moveVertices(
   std::vector<vm::vec3> vertexPositions, const vm::vec3& delta)
 {
-  auto newVertexPositions = std::vector<vm::vec3>{};
-  auto newNodes = applyToNodeContents(
+  const auto uvLock = pref(Preferences::UVLock);
+  auto moveResult = moveBrushHandles<vm::vec3>(
+    *this,
+    "Could not move brush vertices",
     m_selectedNodes.nodes(),
-    kdl::overload(
-      [](Model::Layer&) { return true; },
-      [](Model::Group&) { return true; },
-      [](Model::Entity&) { return true; },
-      [&](Model::Brush& brush) {
-        const auto verticesToMove = kdl::vec_filter(
-          vertexPositions, [&](const auto& vertex) { return brush.hasVertex(vertex); });
-        if (verticesToMove.empty())
-        {
-          return true;
-        }
+    [&](Model::Brush& brush) -> MoveBrushHandlesResult<vm::vec3> {
+      const auto verticesToMove = kdl::vec_filter(
+        vertexPositions, [&](const auto& vertex) { return brush.hasVertex(vertex); });
+      if (verticesToMove.empty())
+      {
+        return std::vector<vm::vec3>{};
+      }
 
-        if (!brush.canMoveVertices(m_worldBounds, verticesToMove, delta))
-        {
-          return false;
-        }
+      if (!brush.canMoveVertices(m_worldBounds, verticesToMove, delta))
+      {
+        return std::nullopt;
+      }
 
-        return brush
-          .moveVertices(m_worldBounds, verticesToMove, delta, pref(Preferences::UVLock))
-          .and_then([&]() {
-            auto newPositions = brush.findClosestVertexPositions(verticesToMove + delta);
-            newVertexPositions =
-              kdl::vec_concat(std::move(newVertexPositions), std::move(newPositions));
-          })
-          .handle_errors([&](const Model::BrushError e) {
-            error() << "Could not move brush vertices: " << e;
-          });
-      },
-      [](Model::BezierPatch&) { return true; }));
+      return brush.moveVertices(m_worldBounds, verticesToMove, delta, uvLock)
+        .and_then([&]() -> std::optional<std::vector<vm::vec3>> {
+          return brush.findClosestVertexPositions(verticesToMove + delta);
+        });
+    });
 
-  if (newNodes)
+  if (moveResult)
   {
-    kdl::vec_sort_and_remove_duplicates(newVertexPositions);
+    auto& [newNodes, newVertexPositions] = *moveResult;
 
     const auto commandName =
       kdl::str_plural(vertexPositions.size(), "Move Brush Vertex", "Move Brush Vertices");
     auto transaction = Transaction{*this, commandName};
 
     const auto changedLinkedGroups = findContainingLinkedGroups(
-      *m_world, kdl::vec_transform(*newNodes, [](const auto& p) { return p.first; }));
+      *m_world, kdl::vec_transform(newNodes, [](const auto& p) { return p.first; }));
 
     const auto result = executeAndStore(std::make_unique<BrushVertexCommand>(
       commandName,
-      std::move(*newNodes),
+      std::move(newNodes),
       std::move(vertexPositions),
       std::move(newVertexPositions)));
 
@@ -3766,54 +4106,45 @@ MapDocument::MoveVerticesResult MapDocument::moveVertices(
 bool MapDocument::moveEdges(
   std::vector<vm::segment3> edgePositions, const vm::vec3& delta)
 {
-  auto newEdgePositions = std::vector<vm::segment3>{};
-  auto newNodes = applyToNodeContents(
+  const auto uvLock = pref(Preferences::UVLock);
+  auto moveResult = moveBrushHandles<vm::segment3>(
+    *this,
+    "Could not move brush edges",
     m_selectedNodes.nodes(),
-    kdl::overload(
-      [](Model::Layer&) { return true; },
-      [](Model::Group&) { return true; },
-      [](Model::Entity&) { return true; },
-      [&](Model::Brush& brush) {
-        const auto edgesToMove = kdl::vec_filter(
-          edgePositions, [&](const auto& edge) { return brush.hasEdge(edge); });
-        if (edgesToMove.empty())
-        {
-          return true;
-        }
+    [&](Model::Brush& brush) -> MoveBrushHandlesResult<vm::segment3> {
+      const auto edgesToMove = kdl::vec_filter(
+        edgePositions, [&](const auto& edge) { return brush.hasEdge(edge); });
+      if (edgesToMove.empty())
+      {
+        return std::vector<vm::segment3>{};
+      }
 
-        if (!brush.canMoveEdges(m_worldBounds, edgesToMove, delta))
-        {
-          return false;
-        }
+      if (!brush.canMoveEdges(m_worldBounds, edgesToMove, delta))
+      {
+        return std::nullopt;
+      }
 
-        return brush
-          .moveEdges(m_worldBounds, edgesToMove, delta, pref(Preferences::UVLock))
-          .and_then([&]() {
-            auto newPositions = brush.findClosestEdgePositions(kdl::vec_transform(
-              edgesToMove, [&](const auto& edge) { return edge.translate(delta); }));
-            newEdgePositions =
-              kdl::vec_concat(std::move(newEdgePositions), std::move(newPositions));
-          })
-          .handle_errors([&](const Model::BrushError e) {
-            error() << "Could not move brush edges: " << e;
-          });
-      },
-      [](Model::BezierPatch&) { return true; }));
+      return brush.moveEdges(m_worldBounds, edgesToMove, delta, uvLock)
+        .and_then([&]() -> std::optional<std::vector<vm::segment3>> {
+          return brush.findClosestEdgePositions(kdl::vec_transform(
+            edgesToMove, [&](const auto& edge) { return edge.translate(delta); }));
+        });
+    });
 
-  if (newNodes)
+  if (moveResult)
   {
-    kdl::vec_sort_and_remove_duplicates(newEdgePositions);
+    auto& [newNodes, newEdgePositions] = *moveResult;
 
     const auto commandName =
       kdl::str_plural(edgePositions.size(), "Move Brush Edge", "Move Brush Edges");
     auto transaction = Transaction{*this, commandName};
 
     const auto changedLinkedGroups = findContainingLinkedGroups(
-      *m_world, kdl::vec_transform(*newNodes, [](const auto& p) { return p.first; }));
+      *m_world, kdl::vec_transform(newNodes, [](const auto& p) { return p.first; }));
 
     const auto result = executeAndStore(std::make_unique<BrushEdgeCommand>(
       commandName,
-      std::move(*newNodes),
+      std::move(newNodes),
       std::move(edgePositions),
       std::move(newEdgePositions)));
 
@@ -3833,54 +4164,45 @@ bool MapDocument::moveEdges(
 bool MapDocument::moveFaces(
   std::vector<vm::polygon3> facePositions, const vm::vec3& delta)
 {
-  auto newFacePositions = std::vector<vm::polygon3>{};
-  auto newNodes = applyToNodeContents(
+  const auto uvLock = pref(Preferences::UVLock);
+  auto moveResult = moveBrushHandles<vm::polygon3>(
+    *this,
+    "Could not move brush faces",
     m_selectedNodes.nodes(),
-    kdl::overload(
-      [](Model::Layer&) { return true; },
-      [](Model::Group&) { return true; },
-      [](Model::Entity&) { return true; },
-      [&](Model::Brush& brush) {
-        const auto facesToMove = kdl::vec_filter(
-          facePositions, [&](const auto& face) { return brush.hasFace(face); });
-        if (facesToMove.empty())
-        {
-          return true;
-        }
+    [&](Model::Brush& brush) -> MoveBrushHandlesResult<vm::polygon3> {
+      const auto facesToMove = kdl::vec_filter(
+        facePositions, [&](const auto& face) { return brush.hasFace(face); });
+      if (facesToMove.empty())
+      {
+        return std::vector<vm::polygon3>{};
+      }
 
-        if (!brush.canMoveFaces(m_worldBounds, facesToMove, delta))
-        {
-          return false;
-        }
+      if (!brush.canMoveFaces(m_worldBounds, facesToMove, delta))
+      {
+        return std::nullopt;
+      }
 
-        return brush
-          .moveFaces(m_worldBounds, facesToMove, delta, pref(Preferences::UVLock))
-          .and_then([&]() {
-            auto newPositions = brush.findClosestFacePositions(kdl::vec_transform(
-              facesToMove, [&](const auto& face) { return face.translate(delta); }));
-            newFacePositions =
-              kdl::vec_concat(std::move(newFacePositions), std::move(newPositions));
-          })
-          .handle_errors([&](const Model::BrushError e) {
-            error() << "Could not move brush faces: " << e;
-          });
-      },
-      [](Model::BezierPatch&) { return true; }));
+      return brush.moveFaces(m_worldBounds, facesToMove, delta, uvLock)
+        .and_then([&]() -> std::optional<std::vector<vm::polygon3>> {
+          return brush.findClosestFacePositions(kdl::vec_transform(
+            facesToMove, [&](const auto& face) { return face.translate(delta); }));
+        });
+    });
 
-  if (newNodes)
+  if (moveResult)
   {
-    kdl::vec_sort_and_remove_duplicates(newFacePositions);
+    auto& [newNodes, newFacePositions] = *moveResult;
 
     const auto commandName =
       kdl::str_plural(facePositions.size(), "Move Brush Face", "Move Brush Faces");
     auto transaction = Transaction{*this, commandName};
 
     auto changedLinkedGroups = findContainingLinkedGroups(
-      *m_world, kdl::vec_transform(*newNodes, [](const auto& p) { return p.first; }));
+      *m_world, kdl::vec_transform(newNodes, [](const auto& p) { return p.first; }));
 
     const auto result = executeAndStore(std::make_unique<BrushFaceCommand>(
       commandName,
-      std::move(*newNodes),
+      std::move(newNodes),
       std::move(facePositions),
       std::move(newFacePositions)));
 
@@ -4367,6 +4689,7 @@ void MapDocument::reloadTextures()
 
 void MapDocument::loadTextures()
 {
+  m_game->refreshFileSystem();
   try
   {
     const IO::Path docDir = m_path.isEmpty() ? IO::Path() : m_path.deleteLastComponent();
@@ -4385,7 +4708,16 @@ void MapDocument::unloadTextures()
   m_textureManager->clear();
 }
 
-static auto makeSetTexturesVisitor(Assets::TextureManager& manager)
+namespace
+{
+struct TexturedNodes
+{
+  std::vector<Model::BrushNode*> brushNodes;
+  std::vector<Model::PatchNode*> patchNodes;
+};
+} // namespace
+
+static auto makeCollectTexturedNodesVisitor(TexturedNodes& texturedNodes)
 {
   return kdl::overload(
     [](auto&& thisLambda, Model::WorldNode* world) { world->visitChildren(thisLambda); },
@@ -4394,19 +4726,65 @@ static auto makeSetTexturesVisitor(Assets::TextureManager& manager)
     [](auto&& thisLambda, Model::EntityNode* entity) {
       entity->visitChildren(thisLambda);
     },
-    [&](Model::BrushNode* brushNode) {
-      const Model::Brush& brush = brushNode->brush();
-      for (size_t i = 0u; i < brush.faceCount(); ++i)
-      {
-        const Model::BrushFace& face = brush.face(i);
-        Assets::Texture* texture = manager.texture(face.attributes().textureName());
-        brushNode->setFaceTexture(i, texture);
-      }
-    },
-    [&](Model::PatchNode* patchNode) {
-      auto* texture = manager.texture(patchNode->patch().textureName());
-      patchNode->setTexture(texture);
-    });
+    [&](Model::BrushNode* brushNode) { texturedNodes.brushNodes.push_back(brushNode); },
+    [&](Model::PatchNode* patchNode) { texturedNodes.patchNodes.push_back(patchNode); });
+}
+
+// below this number of brushes, the overhead of spawning threads outweighs the gain
+static constexpr size_t MinBrushCountForParallelTextureBinding = 1024u;
+
+static void bindTextures(TexturedNodes texturedNodes, Assets::TextureManager& manager)
+{
+  // a node must not be updated by two threads at once
+  texturedNodes.brushNodes =
+    kdl::vec_sort_and_remove_duplicates(std::move(texturedNodes.brushNodes));
+
+  // resolve every distinct texture name only once
+  auto texturesByName = std::unordered_map<std::string_view, Assets::Texture*>{};
+  for (const auto* brushNode : texturedNodes.brushNodes)
+  {
+    for (const auto& face : brushNode->brush().faces())
+    {
+      texturesByName.emplace(face.attributes().textureName(), nullptr);
+    }
+  }
+  for (const auto* patchNode : texturedNodes.patchNodes)
+  {
+    texturesByName.emplace(patchNode->patch().textureName(), nullptr);
+  }
+  for (auto& [textureName, texture] : texturesByName)
+  {
+    texture = manager.texture(std::string{textureName});
+  }
+
+  // the texture map is only read from here on, so the brushes can be updated in parallel
+  const auto setBrushTextures = [&](const size_t index) {
+    auto* brushNode = texturedNodes.brushNodes[index];
+    const auto& brush = brushNode->brush();
+    for (size_t i = 0u; i < brush.faceCount(); ++i)
+    {
+      const auto& textureName = brush.face(i).attributes().textureName();
+      brushNode->setFaceTexture(i, texturesByName.at(textureName));
+    }
+  };
+
+  const auto brushCount = texturedNodes.brushNodes.size();
+  if (brushCount >= MinBrushCountForParallelTextureBinding)
+  {
+    kdl::parallel_for(brushCount, setBrushTextures);
+  }
+  else
+  {
+    for (size_t i = 0u; i < brushCount; ++i)
+    {
+      setBrushTextures(i);
+    }
+  }
+
+  for (auto* patchNode : texturedNodes.patchNodes)
+  {
+    patchNode->setTexture(texturesByName.at(patchNode->patch().textureName()));
+  }
 }
 
 static auto makeUnsetTexturesVisitor()
@@ -4430,13 +4808,17 @@ static auto makeUnsetTexturesVisitor()
 
 void MapDocument::setTextures()
 {
-  m_world->accept(makeSetTexturesVisitor(*m_textureManager));
+  auto texturedNodes = TexturedNodes{};
+  m_world->accept(makeCollectTexturedNodesVisitor(texturedNodes));
+  bindTextures(std::move(texturedNodes), *m_textureManager);
   textureUsageCountsDidChangeNotifier();
 }
 
 void MapDocument::setTextures(const std::vector<Model::Node*>& nodes)
 {
-  Model::Node::visitAll(nodes, makeSetTexturesVisitor(*m_textureManager));
+  auto texturedNodes = TexturedNodes{};
+  Model::Node::visitAll(nodes, makeCollectTexturedNodesVisitor(texturedNodes));
+  bindTextures(std::move(texturedNodes), *m_textureManager);
   textureUsageCountsDidChangeNotifier();
 }
 
@@ -4532,10 +4914,14 @@ void MapDocument::clearEntityModels()
 {
   unsetEntityModels();
   m_entityModelManager->clear();
+  m_game->refreshFileSystem();
+  m_entityModelLoadTimer->stop();
 }
 
 static auto makeSetEntityModelsVisitor(
-  Logger& logger, Assets::EntityModelManager& manager)
+  Logger& logger,
+  Assets::EntityModelManager& manager,
+  std::map<Model::EntityNode*, Assets::ModelSpecification>& nodesWithPendingModels)
 {
   return kdl::overload(
     [](auto&& thisLambda, Model::WorldNode* world) { world->visitChildren(thisLambda); },
@@ -4548,40 +4934,112 @@ static auto makeSetEntityModelsVisitor(
         });
       const auto* frame = manager.frame(modelSpec);
       entityNode->setModelFrame(frame);
+
+      if (frame == nullptr && manager.isPending(modelSpec))
+      {
+        nodesWithPendingModels[entityNode] = modelSpec;
+      }
+      else
+      {
+        nodesWithPendingModels.erase(entityNode);
+      }
     },
     [](Model::BrushNode*) {},
     [](Model::PatchNode*) {});
 }
 
-static auto makeUnsetEntityModelsVisitor()
+static auto makeUnsetEntityModelsVisitor(
+  std::map<Model::EntityNode*, Assets::ModelSpecification>& nodesWithPendingModels)
 {
   return kdl::overload(
     [](auto&& thisLambda, Model::WorldNode* world) { world->visitChildren(thisLambda); },
     [](auto&& thisLambda, Model::LayerNode* layer) { layer->visitChildren(thisLambda); },
     [](auto&& thisLambda, Model::GroupNode* group) { group->visitChildren(thisLambda); },
-    [](Model::EntityNode* entity) { entity->setModelFrame(nullptr); },
+    [&](Model::EntityNode* entity) {
+      entity->setModelFrame(nullptr);
+      nodesWithPendingModels.erase(entity);
+    },
     [](Model::BrushNode*) {},
     [](Model::PatchNode*) {});
 }
 
 void MapDocument::setEntityModels()
 {
-  m_world->accept(makeSetEntityModelsVisitor(*this, *m_entityModelManager));
+  m_world->accept(makeSetEntityModelsVisitor(
+    *this, *m_entityModelManager, m_entityNodesWithPendingModels));
 }
 
 void MapDocument::setEntityModels(const std::vector<Model::Node*>& nodes)
 {
-  Model::Node::visitAll(nodes, makeSetEntityModelsVisitor(*this, *m_entityModelManager));
+  Model::Node::visitAll(
+    nodes,
+    makeSetEntityModelsVisitor(
+      *this, *m_entityModelManager, m_entityNodesWithPendingModels));
+}
+
+// Time spent loading frames of already loaded entity models per timer tick. Frames that
+// don't fit into the budget are loaded in later ticks so that the UI remains responsive.
+static constexpr auto EntityModelLoadTimeBudget = std::chrono::milliseconds{20};
+
+void MapDocument::loadPendingEntityModels()
+{
+  const auto specs = m_entityModelManager->loadPendingModels(EntityModelLoadTimeBudget);
+  if (!m_entityModelManager->hasPendingModels())
+  {
+    m_entityModelLoadTimer->stop();
+  }
+
+  if (!specs.empty())
+  {
+    updatePendingEntityModels(specs);
+    entityModelsDidChangeNotifier(specs);
+  }
+}
+
+/**
+ * Sets the model frames of the entities that are waiting for one of the given model
+ * specifications to be loaded.
+ */
+void MapDocument::updatePendingEntityModels(
+  const std::vector<Assets::ModelSpecification>& specs)
+{
+  const auto loadedSpecs = kdl::vector_set<Assets::ModelSpecification>{specs};
+
+  auto changedNodes = std::vector<Model::Node*>{};
+  for (auto it = std::begin(m_entityNodesWithPendingModels);
+       it != std::end(m_entityNodesWithPendingModels);)
+  {
+    auto& [entityNode, modelSpec] = *it;
+    if (loadedSpecs.count(modelSpec) == 0)
+    {
+      ++it;
+      continue;
+    }
+
+    // a model that failed to load is not queued again, so the entity stops waiting
+    if (const auto* frame = m_entityModelManager->frame(modelSpec))
+    {
+      entityNode->setModelFrame(frame);
+      changedNodes.push_back(entityNode);
+    }
+    it = m_entityNodesWithPendingModels.erase(it);
+  }
+
+  if (!changedNodes.empty())
+  {
+    nodesDidChangeNotifier(changedNodes);
+  }
 }
 
 void MapDocument::unsetEntityModels()
 {
-  m_world->accept(makeUnsetEntityModelsVisitor());
+  m_world->accept(makeUnsetEntityModelsVisitor(m_entityNodesWithPendingModels));
 }
 
 void MapDocument::unsetEntityModels(const std::vector<Model::Node*>& nodes)
 {
-  Model::Node::visitAll(nodes, makeUnsetEntityModelsVisitor());
+  Model::Node::visitAll(
+    nodes, makeUnsetEntityModelsVisitor(m_entityNodesWithPendingModels));
 }
 
 std::vector<IO::Path> MapDocument::externalSearchPaths() const
@@ -4908,6 +5366,9 @@ void MapDocument::connectObservers()
   m_notifierConnection +=
     modsDidChangeNotifier.connect(this, &MapDocument::modsDidChange);
 
+  m_notifierConnection += m_entityModelManager->modelsWereQueuedNotifier.connect(
+    this, &MapDocument::entityModelsWereQueued);
+
   PreferenceManager& prefs = PreferenceManager::instance();
   m_notifierConnection +=
     prefs.preferenceDidChangeNotifier.connect(this, &MapDocument::preferenceDidChange);
@@ -4978,6 +5439,14 @@ void MapDocument::modsDidChange()
   setEntityModels();
 }
 
+void MapDocument::entityModelsWereQueued()
+{
+  if (!m_entityModelLoadTimer->isActive())
+  {
+    m_entityModelLoadTimer->start();
+  }
+}
+
 void MapDocument::preferenceDidChange(const IO::Path& path)
 {
   if (isGamePathPreference(path))
@@ -5001,6 +5470,20 @@ void MapDocument::preferenceDidChange(const IO::Path& path)
     m_textureManager->setTextureMode(
       pref(Preferences::TextureMinFilter), pref(Preferences::TextureMagFilter));
   }
+  else if (path == Preferences::TextureCacheSize.path())
+  {
+    m_textureManager->setCacheSize(textureCacheSize());
+  }
+  else if (path == Preferences::CompressTextures.path())
+  {
+    m_textureManager->setCompressTextures(pref(Preferences::CompressTextures));
+
+    if (m_game.get() != nullptr)
+    {
+      // observers such as the texture browser hold on to the textures being replaced
+      reloadTextureCollections();
+    }
+  }
 }
 
 void MapDocument::commandDone(Command& command)
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include "Assets/ModelDefinition.h"
 #include "FloatType.h"
 #include "IO/Path.h"
 #include "Model/Game.h"
@@ -41,6 +42,8 @@
 #include <variant>
 #include <vector>
 
+class QTimer;
+
 namespace TrenchBroom
 {
 class Color;
@@ -63,6 +66,7 @@ class BrushFaceHandle;
 class BrushFaceAttributes;
 class EditorContext;
 class Entity;
+class EntityNode;
 class Game;
 class Issue;
 enum class MapFormat;
@@ -113,6 +117,8 @@ protected:
 
   std::unique_ptr<Assets::EntityDefinitionManager> m_entityDefinitionManager;
   std::unique_ptr<Assets::EntityModelManager> m_entityModelManager;
+  std::unique_ptr<QTimer> m_entityModelLoadTimer;
+  std::map<Model::EntityNode*, Assets::ModelSpecification> m_entityNodesWithPendingModels;
   std::unique_ptr<Assets::TextureManager> m_textureManager;
   std::unique_ptr<Model::TagManager> m_tagManager;
 
@@ -133,6 +139,9 @@ protected:
   Model::LayerNode* m_currentLayer;
   std::string m_currentTextureName;
   vm::bbox3 m_lastSelectionBounds;
+
+  struct SpeculativeTransformation;
+  std::shared_ptr<SpeculativeTransformation> m_speculativeTransformation;
   mutable vm::bbox3 m_selectionBounds;
   mutable bool m_selectionBoundsValid;
 
@@ -193,6 +202,12 @@ public: // notification
   Notifier<> entityDefinitionsWillChangeNotifier;
   Notifier<> entityDefinitionsDidChangeNotifier;
 
+  /**
+   * Notified with the model specifications that were processed when entity models have
+   * finished loading.
+   */
+  Notifier<const std::vector<Assets::ModelSpecification>&> entityModelsDidChangeNotifier;
+
   Notifier<> modsWillChangeNotifier;
   Notifier<> modsDidChangeNotifier;
 
@@ -550,6 +565,29 @@ public: // modifying objects, declared in MapFacade interface
     std::vector<std::pair<Model::Node*, Model::NodeContents>> nodesToSwap);
   bool transformObjects(const std::string& commandName, const vm::mat4x4& transformation);
 
+  /**
+   * Previews the given transformation of the selected objects while a tool is dragging.
+   *
+   * The transformation is computed on a worker thread, and the objects are updated as
+   * soon as the result is available. Each call replaces the transformation requested by
+   * the previous call, so the given transformation must be relative to the objects' state
+   * at the start of the drag. Must be called from within a transaction; the
+   * transformation is applied by rolling back the transaction and swapping in the
+   * transformed objects.
+   */
+  void transformObjectsSpeculatively(
+    const std::string& commandName, const vm::mat4x4& transformation);
+
+  /**
+   * Waits for the most recently requested speculative transformation and applies it.
+   */
+  void finishSpeculativeTransformation();
+
+  /**
+   * Discards any pending speculative transformation without applying it.
+   */
+  void cancelSpeculativeTransformation();
+
   bool translateObjects(const vm::vec3& delta) override;
   bool rotateObjects(
     const vm::vec3& center, const vm::vec3& axis, FloatType angle) override;
@@ -559,6 +597,10 @@ public: // modifying objects, declared in MapFacade interface
     const vm::bbox3& box, const vm::vec3& sideToShear, const vm::vec3& delta) override;
   bool flipObjects(const vm::vec3& center, vm::axis::type axis) override;
 
+private:
+  std::vector<Model::Node*> collectNodesToTransform() const;
+  void applySpeculativeTransformation(bool wait);
+
 public: // CSG operations, declared in MapFacade interface
   bool createBrush(const std::vector<vm::vec3>& points);
   bool csgConvexMerge();
@@ -732,6 +774,8 @@ protected:
 
   void setEntityModels();
   void setEntityModels(const std::vector<Model::Node*>& nodes);
+  void loadPendingEntityModels();
+  void updatePendingEntityModels(const std::vector<Assets::ModelSpecification>& specs);
   void unsetEntityModels();
   void unsetEntityModels(const std::vector<Model::Node*>& nodes);
 
@@ -798,6 +842,7 @@ private: // observers
   void entityDefinitionsDidChange();
   void modsWillChange();
   void modsDidChange();
+  void entityModelsWereQueued();
   void preferenceDidChange(const IO::Path& path);
   void commandDone(Command& command);
   void commandUndone(UndoableCommand& command);
@@ -22,6 +22,7 @@
 #include "Assets/EntityDefinition.h"
 #include "Assets/EntityDefinitionGroup.h"
 #include "Assets/EntityDefinitionManager.h"
+#include "Assets/TextureManager.h"
 #include "FloatType.h"
 #include "Logger.h"
 #include "Model/BezierPatch.h"
@@ -168,6 +169,8 @@ void MapViewBase::connectObservers()
     this, &MapViewBase::textureCollectionsDidChange);
   m_notifierConnection += document->entityDefinitionsDidChangeNotifier.connect(
     this, &MapViewBase::entityDefinitionsDidChange);
+  m_notifierConnection += document->entityModelsDidChangeNotifier.connect(
+    this, &MapViewBase::entityModelsDidChange);
   m_notifierConnection +=
     document->modsDidChangeNotifier.connect(this, &MapViewBase::modsDidChange);
   m_notifierConnection += document->editorContextDidChangeNotifier.connect(
@@ -255,6 +258,11 @@ void MapViewBase::entityDefinitionsDidChange()
   update();
 }
 
+void MapViewBase::entityModelsDidChange(const std::vector<Assets::ModelSpecification>&)
+{
+  update();
+}
+
 void MapViewBase::modsDidChange()
 {
   update();
@@ -1040,6 +1048,12 @@ void MapViewBase::doRender()
   renderFPS(renderContext, renderBatch);
 
   renderBatch.render(renderContext);
+
+  // render again until the evicted textures which were just activated are uploaded
+  if (document->textureManager().hasPendingReloads())
+  {
+    update();
+  }
 }
 
 void MapViewBase::setupGL(Renderer::RenderContext& context)
@@ -45,6 +45,7 @@ class BrushEntityDefinition;
 class EntityDefinition;
 enum class EntityDefinitionType;
 class PointEntityDefinition;
+struct ModelSpecification;
 } // namespace Assets
 
 namespace IO
@@ -159,6 +160,7 @@ private:
   void selectionDidChange(const Selection& selection);
   void textureCollectionsDidChange();
   void entityDefinitionsDidChange();
+  void entityModelsDidChange(const std::vector<Assets::ModelSpecification>& specs);
   void modsDidChange();
   void editorContextDidChange();
   void gridDidChange();
@@ -29,6 +29,7 @@
 #include <kdl/memory_utils.h>
 #include <kdl/vector_utils.h>
 
+#include <vecmath/mat_ext.h>
 #include <vecmath/scalar.h>
 
 namespace TrenchBroom
@@ -120,6 +121,7 @@ void RotateObjectsTool::beginRotation()
 void RotateObjectsTool::commitRotation()
 {
   auto document = kdl::mem_lock(m_document);
+  document->finishSpeculativeTransformation();
   document->commitTransaction();
   updateRecentlyUsedCenters(rotationCenter());
 }
@@ -127,6 +129,7 @@ void RotateObjectsTool::commitRotation()
 void RotateObjectsTool::cancelRotation()
 {
   auto document = kdl::mem_lock(m_document);
+  document->cancelSpeculativeTransformation();
   document->cancelTransaction();
 }
 
@@ -139,9 +142,12 @@ FloatType RotateObjectsTool::snapRotationAngle(const FloatType angle) const
 void RotateObjectsTool::applyRotation(
   const vm::vec3& center, const vm::vec3& axis, const FloatType angle)
 {
+  const auto transformation = vm::translation_matrix(center)
+                              * vm::rotation_matrix(axis, angle)
+                              * vm::translation_matrix(-center);
+
   auto document = kdl::mem_lock(m_document);
-  document->rollbackTransaction();
-  document->rotateObjects(center, axis, angle);
+  document->transformObjectsSpeculatively("Rotate Objects", transformation);
 }
 
 Model::Hit RotateObjectsTool::pick2D(
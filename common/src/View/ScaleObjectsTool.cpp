@@ -39,6 +39,7 @@
 #include <vecmath/distance.h>
 #include <vecmath/intersection.h>
 #include <vecmath/line.h>
+#include <vecmath/mat_ext.h>
 #include <vecmath/vec.h>
 #include <vecmath/vec_io.h>
 
@@ -1132,7 +1133,8 @@ void ScaleObjectsTool::scaleByDelta(const vm::vec3& delta)
 
   if (!newBox.is_empty())
   {
-    document->scaleObjects(bounds(), newBox);
+    document->transformObjectsSpeculatively(
+      "Scale Objects", vm::scale_bbox_matrix(m_bboxAtDragStart, newBox));
   }
 }
 
@@ -1141,10 +1143,12 @@ void ScaleObjectsTool::commitScale()
   auto document = kdl::mem_lock(m_document);
   if (vm::is_zero(m_dragCumulativeDelta, vm::C::almost_zero()))
   {
+    document->cancelSpeculativeTransformation();
     document->cancelTransaction();
   }
   else
   {
+    document->finishSpeculativeTransformation();
     document->commitTransaction();
   }
   m_resizing = false;
@@ -1153,6 +1157,7 @@ void ScaleObjectsTool::commitScale()
 void ScaleObjectsTool::cancelScale()
 {
   auto document = kdl::mem_lock(m_document);
+  document->cancelSpeculativeTransformation();
   document->cancelTransaction();
   m_resizing = false;
 }
@@ -40,6 +40,7 @@
 #include <vecmath/bbox.h>
 #include <vecmath/forward.h>
 #include <vecmath/intersection.h>
+#include <vecmath/mat_ext.h>
 #include <vecmath/polygon.h>
 #include <vecmath/vec.h>
 
@@ -214,10 +215,12 @@ void ShearObjectsTool::commitShear()
   auto document = kdl::mem_lock(m_document);
   if (vm::is_zero(m_dragCumulativeDelta, vm::C::almost_zero()))
   {
+    document->cancelSpeculativeTransformation();
     document->cancelTransaction();
   }
   else
   {
+    document->finishSpeculativeTransformation();
     document->commitTransaction();
   }
   m_resizing = false;
@@ -228,6 +231,7 @@ void ShearObjectsTool::cancelShear()
   ensure(m_resizing, "must be resizing already");
 
   auto document = kdl::mem_lock(m_document);
+  document->cancelSpeculativeTransformation();
   document->cancelTransaction();
 
   m_resizing = false;
@@ -244,7 +248,9 @@ void ShearObjectsTool::shearByDelta(const vm::vec3& delta)
   if (!vm::is_zero(delta, vm::C::almost_zero()))
   {
     const BBoxSide side = m_dragStartHit.target<BBoxSide>();
-    document->shearObjects(bounds(), side.normal, delta);
+    document->transformObjectsSpeculatively(
+      "Shear Objects",
+      vm::shear_bbox_matrix(m_bboxAtDragStart, side.normal, m_dragCumulativeDelta));
   }
 }
 
@@ -0,0 +1,223 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SpeculativeTransformer.h"
+
+#include "Ensure.h"
+#include "Model/BrushNode.h"
+#include "Model/EntityNode.h"
+#include "Model/GroupNode.h"
+#include "Model/LayerNode.h"
+#include "Model/ModelUtils.h"
+#include "Model/PatchNode.h"
+#include "Model/WorldNode.h"
+
+#include <kdl/overload.h>
+#include <kdl/parallel.h>
+
+namespace TrenchBroom
+{
+namespace View
+{
+NodeSnapshot snapshotNode(Model::Node& node, const bool lockTextures)
+{
+  return node.accept(kdl::overload(
+    [](Model::WorldNode*) -> NodeSnapshot { ensure(false, "Unexpected world node"); },
+    [](Model::LayerNode*) -> NodeSnapshot { ensure(false, "Unexpected layer node"); },
+    [](Model::GroupNode* groupNode) {
+      return NodeSnapshot{groupNode, groupNode->group(), false};
+    },
+    [](Model::EntityNode* entityNode) {
+      return NodeSnapshot{entityNode, entityNode->entity(), false};
+    },
+    [&](Model::BrushNode* brushNode) {
+      return NodeSnapshot{
+        brushNode,
+        brushNode->brush(),
+        lockTextures || (Model::findContainingLinkedGroup(*brushNode) != nullptr)};
+    },
+    [](Model::PatchNode* patchNode) {
+      return NodeSnapshot{patchNode, patchNode->patch(), false};
+    }));
+}
+
+TransformNodeResult transformNode(
+  NodeSnapshot snapshot,
+  const vm::mat4x4& transformation,
+  const vm::bbox3& worldBounds,
+  const Model::EntityPropertyConfig& propertyConfig)
+{
+  auto* node = snapshot.node;
+  return std::visit(
+    kdl::overload(
+      [&](Model::Layer&) -> TransformNodeResult { ensure(false, "Unexpected layer"); },
+      [&](Model::Group& group) -> TransformNodeResult {
+        group.transform(transformation);
+        return std::make_pair(node, Model::NodeContents{std::move(group)});
+      },
+      [&](Model::Entity& entity) -> TransformNodeResult {
+        entity.transform(propertyConfig, transformation);
+        return std::make_pair(node, Model::NodeContents{std::move(entity)});
+      },
+      [&](Model::Brush& brush) -> TransformNodeResult {
+        return brush.transform(worldBounds, transformation, snapshot.lockTextures)
+          .and_then([&]() -> TransformNodeResult {
+            return std::make_pair(node, Model::NodeContents{std::move(brush)});
+          });
+      },
+      [&](Model::BezierPatch& patch) -> TransformNodeResult {
+        patch.transform(transformation);
+        return std::make_pair(node, Model::NodeContents{std::move(patch)});
+      }),
+    snapshot.contents);
+}
+
+SpeculativeTransformer::SpeculativeTransformer(
+  const vm::bbox3& worldBounds,
+  Model::EntityPropertyConfig propertyConfig,
+  std::vector<NodeSnapshot> snapshots,
+  std::function<void()> evaluationAvailable)
+  : m_worldBounds{worldBounds}
+  , m_propertyConfig{std::move(propertyConfig)}
+  , m_snapshots{std::move(snapshots)}
+  , m_evaluationAvailable{std::move(evaluationAvailable)}
+  , m_evaluating{false}
+  , m_stopping{false}
+  , m_requestCount{0u}
+  , m_worker{[&]() { run(); }}
+{
+}
+
+SpeculativeTransformer::~SpeculativeTransformer()
+{
+  {
+    const auto lock = std::lock_guard<std::mutex>{m_mutex};
+    m_stopping = true;
+  }
+  m_condition.notify_all();
+  m_worker.join();
+}
+
+void SpeculativeTransformer::request(const vm::mat4x4& transformation)
+{
+  {
+    const auto lock = std::lock_guard<std::mutex>{m_mutex};
+    m_pendingTransformation = transformation;
+    ++m_requestCount;
+  }
+  m_condition.notify_all();
+}
+
+std::optional<SpeculativeTransformer::Evaluation> SpeculativeTransformer::takeEvaluation()
+{
+  const auto lock = std::lock_guard<std::mutex>{m_mutex};
+  return std::exchange(m_evaluation, std::nullopt);
+}
+
+std::optional<SpeculativeTransformer::Evaluation> SpeculativeTransformer::finish()
+{
+  auto lock = std::unique_lock<std::mutex>{m_mutex};
+  m_condition.wait(lock, [&]() { return !m_pendingTransformation && !m_evaluating; });
+  return std::exchange(m_evaluation, std::nullopt);
+}
+
+void SpeculativeTransformer::run()
+{
+  auto previousEvaluationCompleted = true;
+
+  auto lock = std::unique_lock<std::mutex>{m_mutex};
+  while (true)
+  {
+    m_condition.wait(lock, [&]() { return m_stopping || m_pendingTransformation; });
+    if (m_stopping)
+    {
+      return;
+    }
+
+    const auto transformation = *std::exchange(m_pendingTransformation, std::nullopt);
+    const auto requestCount = m_requestCount.load();
+    m_evaluating = true;
+    lock.unlock();
+
+    const auto mayCancel = previousEvaluationCompleted;
+    auto result = evaluate(transformation, [&]() {
+      return m_stopping || (mayCancel && m_requestCount != requestCount);
+    });
+
+    lock.lock();
+    m_evaluating = false;
+    previousEvaluationCompleted = result.has_value();
+    if (result)
+    {
+      m_evaluation = Evaluation{transformation, std::move(*result)};
+    }
+    m_condition.notify_all();
+
+    if (result)
+    {
+      lock.unlock();
+      m_evaluationAvailable();
+      lock.lock();
+    }
+  }
+}
+
+std::optional<SpeculativeTransformer::Result> SpeculativeTransformer::evaluate(
+  const vm::mat4x4& transformation, const std::function<bool()>& isCancelled) const
+{
+  auto nodeResults = std::vector<std::optional<TransformNodeResult>>(m_snapshots.size());
+  kdl::parallel_for(m_snapshots.size(), [&](const size_t i) {
+    if (!isCancelled())
+    {
+      nodeResults[i] =
+        transformNode(m_snapshots[i], transformation, m_worldBounds, m_propertyConfig);
+    }
+  });
+
+  auto nodes = std::vector<std::pair<Model::Node*, Model::NodeContents>>{};
+  nodes.reserve(nodeResults.size());
+
+  for (auto& nodeResult : nodeResults)
+  {
+    if (!nodeResult)
+    {
+      // the evaluation was cancelled before this node was transformed
+      return std::nullopt;
+    }
+
+    auto error = std::move(*nodeResult)
+                   .visit(kdl::overload(
+                     [&](std::pair<Model::Node*, Model::NodeContents>&& node)
+                       -> std::optional<Model::BrushError> {
+                       nodes.push_back(std::move(node));
+                       return std::nullopt;
+                     },
+                     [](const Model::BrushError e) -> std::optional<Model::BrushError> {
+                       return e;
+                     }));
+    if (error)
+    {
+      return Result{*error};
+    }
+  }
+
+  return Result{std::move(nodes)};
+}
+} // namespace View
+} // namespace TrenchBroom
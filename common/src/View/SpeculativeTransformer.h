@@ -0,0 +1,159 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "FloatType.h"
+#include "Macros.h"
+#include "Model/BrushError.h"
+#include "Model/EntityProperties.h"
+#include "Model/NodeContents.h"
+
+#include <kdl/result.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/mat.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace TrenchBroom
+{
+namespace Model
+{
+class Node;
+}
+
+namespace View
+{
+/**
+ * A copy of the contents of a node that is about to be transformed.
+ */
+struct NodeSnapshot
+{
+  Model::Node* node;
+  std::variant<
+    Model::Layer,
+    Model::Group,
+    Model::Entity,
+    Model::Brush,
+    Model::BezierPatch>
+    contents;
+  bool lockTextures;
+};
+
+/**
+ * Copies the contents of the given node. Textures are locked when transforming the
+ * snapshot if the given flag is set or if the node belongs to a linked group.
+ */
+NodeSnapshot snapshotNode(Model::Node& node, bool lockTextures);
+
+using TransformNodeResult =
+  kdl::result<std::pair<Model::Node*, Model::NodeContents>, Model::BrushError>;
+
+/**
+ * Applies the given transformation to the contents of the given snapshot and returns the
+ * node together with its transformed contents.
+ */
+TransformNodeResult transformNode(
+  NodeSnapshot snapshot,
+  const vm::mat4x4& transformation,
+  const vm::bbox3& worldBounds,
+  const Model::EntityPropertyConfig& propertyConfig);
+
+/**
+ * Transforms a set of node snapshots on a worker thread.
+ *
+ * Tools use this to preview transformations while the user drags a handle. Every request
+ * supersedes the previous one: a request that has not been started yet is dropped, and an
+ * evaluation that is still running is cancelled. To make sure that the preview keeps up
+ * with continuous input, an evaluation is only cancelled if the one before it completed.
+ *
+ * Whenever an evaluation completes, the callback passed to the constructor is called on
+ * the worker thread. The evaluation must then be fetched with takeEvaluation on the
+ * thread that owns the nodes.
+ */
+class SpeculativeTransformer
+{
+public:
+  using Result = kdl::result<
+    std::vector<std::pair<Model::Node*, Model::NodeContents>>,
+    Model::BrushError>;
+
+  struct Evaluation
+  {
+    vm::mat4x4 transformation;
+    Result result;
+  };
+
+private:
+  const vm::bbox3 m_worldBounds;
+  const Model::EntityPropertyConfig m_propertyConfig;
+  const std::vector<NodeSnapshot> m_snapshots;
+  const std::function<void()> m_evaluationAvailable;
+
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::optional<vm::mat4x4> m_pendingTransformation;
+  std::optional<Evaluation> m_evaluation;
+  bool m_evaluating;
+  std::atomic<bool> m_stopping;
+  std::atomic<size_t> m_requestCount;
+  std::thread m_worker;
+
+public:
+  SpeculativeTransformer(
+    const vm::bbox3& worldBounds,
+    Model::EntityPropertyConfig propertyConfig,
+    std::vector<NodeSnapshot> snapshots,
+    std::function<void()> evaluationAvailable);
+  ~SpeculativeTransformer();
+
+  /**
+   * Requests that the snapshots be transformed by the given transformation.
+   */
+  void request(const vm::mat4x4& transformation);
+
+  /**
+   * Returns the most recently completed evaluation unless it was taken already.
+   */
+  std::optional<Evaluation> takeEvaluation();
+
+  /**
+   * Waits until the most recently requested transformation has been evaluated and returns
+   * its evaluation unless it was taken already.
+   */
+  std::optional<Evaluation> finish();
+
+private:
+  void run();
+  std::optional<Result> evaluate(
+    const vm::mat4x4& transformation, const std::function<bool()>& isCancelled) const;
+
+  deleteCopyAndMove(SpeculativeTransformer);
+};
+} // namespace View
+} // namespace TrenchBroom
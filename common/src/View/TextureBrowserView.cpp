@@ -31,6 +31,7 @@
 #include "Renderer/ShaderManager.h"
 #include "Renderer/Shaders.h"
 #include "Renderer/TextureFont.h"
+#include "Renderer/TextureThumbnailAtlas.h"
 #include "Renderer/Transformation.h"
 #include "Renderer/VertexArray.h"
 #include "View/MapDocument.h"
@@ -44,7 +45,10 @@
 #include <vecmath/mat_ext.h>
 #include <vecmath/vec.h>
 
+#include <cmath>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <QMenu>
@@ -54,6 +58,17 @@ namespace TrenchBroom
 {
 namespace View
 {
+namespace
+{
+constexpr auto ThumbnailAtlasPageSize = size_t(2048);
+constexpr auto ThumbnailAtlasSlotSize = size_t(128);
+constexpr auto ThumbnailAtlasMaxPageCount = size_t(4);
+
+// reading textures back into the atlas stalls the GL pipeline, so only a few thumbnails
+// are added per frame
+constexpr auto MaxThumbnailInsertionsPerFrame = size_t(32);
+} // namespace
+
 TextureBrowserView::TextureBrowserView(
   QScrollBar* scrollBar,
   GLContextManager& contextManager,
@@ -64,14 +79,21 @@ TextureBrowserView::TextureBrowserView(
   , m_hideUnused(false)
   , m_sortOrder(TextureSortOrder::Name)
   , m_selectedTexture(nullptr)
+  , m_titleLayoutMaxWidth(0.0f)
 {
   auto doc = kdl::mem_lock(m_document);
   m_notifierConnection += doc->textureUsageCountsDidChangeNotifier.connect(
     this, &TextureBrowserView::usageCountDidChange);
+  m_notifierConnection += doc->textureCollectionsDidChangeNotifier.connect(
+    this, &TextureBrowserView::textureCollectionsDidChange);
+  m_notifierConnection += doc->documentWasClearedNotifier.connect(
+    this, &TextureBrowserView::documentWasCleared);
 }
 
 TextureBrowserView::~TextureBrowserView()
 {
+  // Deleting the thumbnail atlas deletes its GL textures, so we need to be current
+  makeCurrent();
   clear();
 }
 
@@ -148,6 +170,25 @@ void TextureBrowserView::usageCountDidChange()
   update();
 }
 
+void TextureBrowserView::textureCollectionsDidChange()
+{
+  clearThumbnails();
+}
+
+void TextureBrowserView::documentWasCleared(MapDocument*)
+{
+  clearThumbnails();
+}
+
+void TextureBrowserView::clearThumbnails()
+{
+  // the atlas refers to textures by their address, which may be reused by new textures
+  if (m_thumbnailAtlas)
+  {
+    m_thumbnailAtlas->clear();
+  }
+}
+
 void TextureBrowserView::doInitLayout(Layout& layout)
 {
   const float scaleFactor = pref(Preferences::TextureBrowserIconSize);
@@ -169,40 +210,49 @@ void TextureBrowserView::doReloadLayout(Layout& layout)
 
   const Renderer::FontDescriptor font(fontPath, static_cast<size_t>(fontSize));
 
+  const float maxCellWidth = layout.maxCellWidth();
+  if (
+    !m_titleLayoutFont || m_titleLayoutFont->compare(font) != 0
+    || m_titleLayoutMaxWidth != maxCellWidth)
+  {
+    m_titleLayoutCache.clear();
+    m_titleLayoutFont = font;
+    m_titleLayoutMaxWidth = maxCellWidth;
+  }
+
   if (m_group)
   {
     for (const Assets::TextureCollection& collection : getCollections())
     {
       layout.addGroup(collection.name(), static_cast<float>(fontSize) + 2.0f);
+
+      const auto groupTitleLayout = titleLayout(collection.name(), font, maxCellWidth);
       for (const Assets::Texture* texture : getTextures(collection))
-        addTextureToLayout(layout, texture, collection.name(), font);
+        addTextureToLayout(layout, texture, groupTitleLayout, font);
     }
   }
   else
   {
+    const auto groupTitleLayout = titleLayout("", font, maxCellWidth);
     for (const Assets::Texture* texture : getTextures())
-      addTextureToLayout(layout, texture, "", font);
+      addTextureToLayout(layout, texture, groupTitleLayout, font);
   }
 }
 
 void TextureBrowserView::addTextureToLayout(
   Layout& layout,
   const Assets::Texture* texture,
-  const std::string& groupName,
+  const TextureTitleLayout& groupTitleLayout,
   const Renderer::FontDescriptor& font)
 {
   const float maxCellWidth = layout.maxCellWidth();
 
-  const auto textureName = IO::Path(texture->name()).lastComponent().asString();
+  const auto& textureTitle = textureTitleLayout(texture, font, maxCellWidth);
+  const auto& textureNameSize = textureTitle.size;
+  const auto& groupNameSize = groupTitleLayout.size;
 
-  const auto textureFont =
-    fontManager().selectFontSize(font, textureName, maxCellWidth, 6);
-  const auto groupFont = fontManager().selectFontSize(font, groupName, maxCellWidth, 6);
-
-  const auto defaultTextHeight =
-    fontManager().font(font).measure(groupName + textureName).y();
-  const auto textureNameSize = fontManager().font(textureFont).measure(textureName);
-  const auto groupNameSize = fontManager().font(groupFont).measure(groupName);
+  // titles are single lines, so their height is the line height of the default font
+  const auto defaultTextHeight = fontManager().font(font).measure("").y();
 
   const auto totalSize = vm::vec2f(
     vm::max(groupNameSize.x(), textureNameSize.x()), 2.0f * defaultTextHeight + 4.0f);
@@ -215,12 +265,12 @@ void TextureBrowserView::addTextureToLayout(
 
   auto cellData = TextureCellData{
     texture,
-    textureName,
-    groupName,
+    textureTitle.title,
+    groupTitleLayout.title,
     vm::vec2f((maxCellWidth - textureNameSize.x()) / 2.0f, defaultTextHeight + 3.0f),
     vm::vec2f((maxCellWidth - groupNameSize.x()) / 2.0f, 1.0f),
-    textureFont,
-    groupFont};
+    textureTitle.font,
+    groupTitleLayout.font};
 
   layout.addItem(
     std::move(cellData),
@@ -230,6 +280,30 @@ void TextureBrowserView::addTextureToLayout(
     totalSize.y());
 }
 
+TextureTitleLayout TextureBrowserView::titleLayout(
+  std::string title, const Renderer::FontDescriptor& font, const float maxWidth)
+{
+  auto titleFont = fontManager().selectFontSize(font, title, maxWidth, 6);
+  const auto size = fontManager().font(titleFont).measure(title);
+  return TextureTitleLayout{std::move(title), std::move(titleFont), size};
+}
+
+const TextureTitleLayout& TextureBrowserView::textureTitleLayout(
+  const Assets::Texture* texture,
+  const Renderer::FontDescriptor& font,
+  const float maxWidth)
+{
+  auto it = m_titleLayoutCache.find(texture->name());
+  if (it == m_titleLayoutCache.end())
+  {
+    auto textureName = IO::Path(texture->name()).lastComponent().asString();
+    it = m_titleLayoutCache
+           .emplace(texture->name(), titleLayout(std::move(textureName), font, maxWidth))
+           .first;
+  }
+  return it->second;
+}
+
 struct TextureBrowserView::CompareByUsageCount
 {
   kdl::ci::string_less m_less;
@@ -373,27 +447,24 @@ void TextureBrowserView::renderBounds(Layout& layout, const float y, const float
   {
     if (group.intersectsY(y, height))
     {
-      for (const auto& row : group.rows())
+      for (const auto* row : group.rowsIntersectingY(y, height))
       {
-        if (row.intersectsY(y, height))
+        for (const auto& cell : row->cells())
         {
-          for (const auto& cell : row.cells())
-          {
-            const LayoutBounds& bounds = cell.itemBounds();
-            const Assets::Texture* texture = cellData(cell).texture;
-            const Color& color = textureColor(*texture);
-            vertices.emplace_back(
-              vm::vec2f(bounds.left() - 2.0f, height - (bounds.top() - 2.0f - y)), color);
-            vertices.emplace_back(
-              vm::vec2f(bounds.left() - 2.0f, height - (bounds.bottom() + 2.0f - y)),
-              color);
-            vertices.emplace_back(
-              vm::vec2f(bounds.right() + 2.0f, height - (bounds.bottom() + 2.0f - y)),
-              color);
-            vertices.emplace_back(
-              vm::vec2f(bounds.right() + 2.0f, height - (bounds.top() - 2.0f - y)),
-              color);
-          }
+          const LayoutBounds& bounds = cell.itemBounds();
+          const Assets::Texture* texture = cellData(cell).texture;
+          const Color& color = textureColor(*texture);
+          vertices.emplace_back(
+            vm::vec2f(bounds.left() - 2.0f, height - (bounds.top() - 2.0f - y)), color);
+          vertices.emplace_back(
+            vm::vec2f(bounds.left() - 2.0f, height - (bounds.bottom() + 2.0f - y)),
+            color);
+          vertices.emplace_back(
+            vm::vec2f(bounds.right() + 2.0f, height - (bounds.bottom() + 2.0f - y)),
+            color);
+          vertices.emplace_back(
+            vm::vec2f(bounds.right() + 2.0f, height - (bounds.top() - 2.0f - y)),
+            color);
         }
       }
     }
@@ -425,21 +496,75 @@ void TextureBrowserView::renderTextures(Layout& layout, const float y, const flo
   shader.set("Texture", 0);
   shader.set("Brightness", pref(Preferences::Brightness));
 
-  size_t num = 0;
+  if (!m_thumbnailAtlas)
+  {
+    m_thumbnailAtlas = std::make_unique<Renderer::TextureThumbnailAtlas>(
+      ThumbnailAtlasPageSize,
+      ThumbnailAtlasSlotSize,
+      ThumbnailAtlasMaxPageCount,
+      pref(Preferences::TextureMinFilter),
+      pref(Preferences::TextureMagFilter));
+  }
+
+  // every preference change renders the view again, so this picks up the current filters
+  m_thumbnailAtlas->setTextureMode(
+    pref(Preferences::TextureMinFilter), pref(Preferences::TextureMagFilter));
+  m_thumbnailAtlas->beginFrame();
+
+  // thumbnails from the atlas are batched by atlas page and gray scale flag
+  using BatchKey = std::pair<size_t, bool>;
+  auto thumbnailVertices = std::map<BatchKey, std::vector<TextureVertex>>{};
+  auto insertions = size_t(0);
+  auto deferredThumbnails = false;
 
   for (const auto& group : layout.groups())
   {
     if (group.intersectsY(y, height))
     {
-      for (const auto& row : group.rows())
+      for (const auto* row : group.rowsIntersectingY(y, height))
       {
-        if (row.intersectsY(y, height))
+        for (const auto& cell : row->cells())
         {
-          for (const auto& cell : row.cells())
+          const LayoutBounds& bounds = cell.itemBounds();
+          const Assets::Texture* texture = cellData(cell).texture;
+
+          auto thumbnail = std::optional<Renderer::TextureThumbnailAtlas::Thumbnail>{};
+          if (const auto size = thumbnailSize(*texture, bounds))
+          {
+            thumbnail = m_thumbnailAtlas->find(*texture, *size);
+            if (!thumbnail)
+            {
+              if (insertions < MaxThumbnailInsertionsPerFrame)
+              {
+                thumbnail = m_thumbnailAtlas->insert(*texture, *size);
+                ++insertions;
+              }
+              else
+              {
+                deferredThumbnails = true;
+              }
+            }
+          }
+
+          if (thumbnail)
           {
-            const LayoutBounds& bounds = cell.itemBounds();
-            const Assets::Texture* texture = cellData(cell).texture;
+            const auto& min = thumbnail->minTexCoords;
+            const auto& max = thumbnail->maxTexCoords;
 
+            auto& vertices = thumbnailVertices[{thumbnail->page, texture->overridden()}];
+            vertices.emplace_back(
+              vm::vec2f(bounds.left(), height - (bounds.top() - y)), min);
+            vertices.emplace_back(
+              vm::vec2f(bounds.left(), height - (bounds.bottom() - y)),
+              vm::vec2f(min.x(), max.y()));
+            vertices.emplace_back(
+              vm::vec2f(bounds.right(), height - (bounds.bottom() - y)), max);
+            vertices.emplace_back(
+              vm::vec2f(bounds.right(), height - (bounds.top() - y)),
+              vm::vec2f(max.x(), min.y()));
+          }
+          else
+          {
             Renderer::VertexArray vertexArray =
               Renderer::VertexArray::move(std::vector<TextureVertex>(
                 {TextureVertex(
@@ -462,13 +587,65 @@ void TextureBrowserView::renderTextures(Layout& layout, const float y, const flo
             vertexArray.render(Renderer::PrimType::Quads);
 
             texture->deactivate();
-
-            ++num;
           }
         }
       }
     }
   }
+
+  for (auto& [key, vertices] : thumbnailVertices)
+  {
+    const auto& [page, grayScale] = key;
+
+    auto vertexArray = Renderer::VertexArray::move(std::move(vertices));
+    shader.set("GrayScale", grayScale);
+    m_thumbnailAtlas->activate(page);
+
+    vertexArray.prepare(vboManager());
+    vertexArray.render(Renderer::PrimType::Quads);
+
+    m_thumbnailAtlas->deactivate();
+  }
+
+  auto doc = kdl::mem_lock(m_document);
+  if (deferredThumbnails || doc->textureManager().hasPendingReloads())
+  {
+    // render again to add the remaining thumbnails to the atlas and to replace the
+    // placeholders of reloading textures
+    update();
+  }
+}
+
+std::optional<size_t> TextureBrowserView::thumbnailSize(
+  const Assets::Texture& texture, const LayoutBounds& bounds) const
+{
+  // the atlas cannot apply per texture blend functions or culling modes
+  if (
+    texture.blendFunc().enable != Assets::TextureBlendFunc::Enable::UseDefault
+    || (texture.culling() != Assets::TextureCulling::CullDefault
+        && texture.culling() != Assets::TextureCulling::CullBack))
+  {
+    return std::nullopt;
+  }
+
+  const auto textureSize = std::max(texture.width(), texture.height());
+  const auto displaySize = static_cast<size_t>(
+    std::ceil(std::max(bounds.width, bounds.height) * devicePixelRatioF()));
+
+  // use power of two sizes so that the thumbnails needn't be replaced when the icon size
+  // changes slightly
+  auto size = size_t(1);
+  while (size < displaySize && size < textureSize)
+  {
+    size *= 2u;
+  }
+  size = std::min(size, textureSize);
+
+  if (size > ThumbnailAtlasSlotSize)
+  {
+    return std::nullopt;
+  }
+  return size;
 }
 
 void TextureBrowserView::renderNames(Layout& layout, const float y, const float height)
@@ -567,55 +744,51 @@ TextureBrowserView::StringMap TextureBrowserView::collectStringVertices(
           std::end(vertices), std::begin(titleVertices), std::end(titleVertices));
       }
 
-      for (const auto& row : group.rows())
+      for (const auto* row : group.rowsIntersectingY(y, height))
       {
-        if (row.intersectsY(y, height))
+        for (const auto& cell : row->cells())
         {
-          for (const auto& cell : row.cells())
-          {
-            const auto titleBounds = cell.titleBounds();
-            const auto& textureFont = fontManager().font(cellData(cell).mainTitleFont);
-            const auto& groupFont = fontManager().font(cellData(cell).subTitleFont);
-
-            // y is relative to top, but OpenGL coords are relative to bottom, so invert
-            const auto titleOffset =
-              vm::vec2f(titleBounds.left(), y + height - titleBounds.bottom());
-
-            const auto textureNameOffset = titleOffset + cellData(cell).mainTitleOffset;
-            const auto groupNameOffset = titleOffset + cellData(cell).subTitleOffset;
-
-            const auto& textureName = cellData(cell).mainTitle;
-            const auto& groupName = cellData(cell).subTitle;
-
-            const auto textureNameQuads =
-              textureFont.quads(textureName, false, textureNameOffset);
-            const auto groupNameQuads =
-              groupFont.quads(groupName, false, groupNameOffset);
-
-            const auto textureNameVertices = TextVertex::toList(
-              textureNameQuads.size() / 2,
-              kdl::skip_iterator(
-                std::begin(textureNameQuads), std::end(textureNameQuads), 0, 2),
-              kdl::skip_iterator(
-                std::begin(textureNameQuads), std::end(textureNameQuads), 1, 2),
-              kdl::skip_iterator(std::begin(textColor), std::end(textColor), 0, 0));
-
-            const auto groupNameVertices = TextVertex::toList(
-              groupNameQuads.size() / 2,
-              kdl::skip_iterator(
-                std::begin(groupNameQuads), std::end(groupNameQuads), 0, 2),
-              kdl::skip_iterator(
-                std::begin(groupNameQuads), std::end(groupNameQuads), 1, 2),
-              kdl::skip_iterator(std::begin(subTextColor), std::end(subTextColor), 0, 0));
-
-            auto& mainTitleVertices = stringVertices[cellData(cell).mainTitleFont];
-            mainTitleVertices =
-              kdl::vec_concat(std::move(mainTitleVertices), textureNameVertices);
-
-            auto& subTitleVertices = stringVertices[cellData(cell).subTitleFont];
-            subTitleVertices =
-              kdl::vec_concat(std::move(subTitleVertices), groupNameVertices);
-          }
+          const auto titleBounds = cell.titleBounds();
+          const auto& textureFont = fontManager().font(cellData(cell).mainTitleFont);
+          const auto& groupFont = fontManager().font(cellData(cell).subTitleFont);
+
+          // y is relative to top, but OpenGL coords are relative to bottom, so invert
+          const auto titleOffset =
+            vm::vec2f(titleBounds.left(), y + height - titleBounds.bottom());
+
+          const auto textureNameOffset = titleOffset + cellData(cell).mainTitleOffset;
+          const auto groupNameOffset = titleOffset + cellData(cell).subTitleOffset;
+
+          const auto& textureName = cellData(cell).mainTitle;
+          const auto& groupName = cellData(cell).subTitle;
+
+          const auto textureNameQuads =
+            textureFont.quads(textureName, false, textureNameOffset);
+          const auto groupNameQuads = groupFont.quads(groupName, false, groupNameOffset);
+
+          const auto textureNameVertices = TextVertex::toList(
+            textureNameQuads.size() / 2,
+            kdl::skip_iterator(
+              std::begin(textureNameQuads), std::end(textureNameQuads), 0, 2),
+            kdl::skip_iterator(
+              std::begin(textureNameQuads), std::end(textureNameQuads), 1, 2),
+            kdl::skip_iterator(std::begin(textColor), std::end(textColor), 0, 0));
+
+          const auto groupNameVertices = TextVertex::toList(
+            groupNameQuads.size() / 2,
+            kdl::skip_iterator(
+              std::begin(groupNameQuads), std::end(groupNameQuads), 0, 2),
+            kdl::skip_iterator(
+              std::begin(groupNameQuads), std::end(groupNameQuads), 1, 2),
+            kdl::skip_iterator(std::begin(subTextColor), std::end(subTextColor), 0, 0));
+
+          auto& mainTitleVertices = stringVertices[cellData(cell).mainTitleFont];
+          mainTitleVertices =
+            kdl::vec_concat(std::move(mainTitleVertices), textureNameVertices);
+
+          auto& subTitleVertices = stringVertices[cellData(cell).subTitleFont];
+          subTitleVertices =
+            kdl::vec_concat(std::move(subTitleVertices), groupNameVertices);
         }
       }
     }
@@ -26,7 +26,9 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class QScrollBar;
@@ -39,6 +41,11 @@ class Texture;
 class TextureCollection;
 } // namespace Assets
 
+namespace Renderer
+{
+class TextureThumbnailAtlas;
+}
+
 namespace View
 {
 class GLContextManager;
@@ -56,6 +63,16 @@ struct TextureCellData
   Renderer::FontDescriptor subTitleFont;
 };
 
+/**
+ * The measured title of a texture browser cell.
+ */
+struct TextureTitleLayout
+{
+  std::string title;
+  Renderer::FontDescriptor font;
+  vm::vec2f size;
+};
+
 enum class TextureSortOrder
 {
   Name,
@@ -77,6 +94,14 @@ private:
 
   const Assets::Texture* m_selectedTexture;
 
+  // Measuring titles dominates the time it takes to reload the layout, so the results
+  // are cached by texture name until the font or the cell width changes.
+  std::unordered_map<std::string, TextureTitleLayout> m_titleLayoutCache;
+  std::optional<Renderer::FontDescriptor> m_titleLayoutFont;
+  float m_titleLayoutMaxWidth;
+
+  std::unique_ptr<Renderer::TextureThumbnailAtlas> m_thumbnailAtlas;
+
   NotifierConnection m_notifierConnection;
 
 public:
@@ -98,14 +123,21 @@ public:
 
 private:
   void usageCountDidChange();
+  void textureCollectionsDidChange();
+  void documentWasCleared(MapDocument* document);
+  void clearThumbnails();
 
   void doInitLayout(Layout& layout) override;
   void doReloadLayout(Layout& layout) override;
   void addTextureToLayout(
     Layout& layout,
     const Assets::Texture* texture,
-    const std::string& groupName,
+    const TextureTitleLayout& groupTitleLayout,
     const Renderer::FontDescriptor& font);
+  TextureTitleLayout titleLayout(
+    std::string title, const Renderer::FontDescriptor& font, float maxWidth);
+  const TextureTitleLayout& textureTitleLayout(
+    const Assets::Texture* texture, const Renderer::FontDescriptor& font, float maxWidth);
 
   struct CompareByUsageCount;
   struct CompareByName;
@@ -128,6 +160,8 @@ private:
   void renderBounds(Layout& layout, float y, float height);
   const Color& textureColor(const Assets::Texture& texture) const;
   void renderTextures(Layout& layout, float y, float height);
+  std::optional<size_t> thumbnailSize(
+    const Assets::Texture& texture, const LayoutBounds& bounds) const;
   void renderNames(Layout& layout, float y, float height);
   void renderGroupTitleBackgrounds(Layout& layout, float y, float height);
   void renderStrings(Layout& layout, float y, float height);
@@ -20,6 +20,7 @@
 #include "UVView.h"
 
 #include "Assets/Texture.h"
+#include "Assets/TextureManager.h"
 #include "FloatType.h"
 #include "Model/BrushFace.h"
 #include "Model/BrushFaceHandle.h"
@@ -193,6 +194,12 @@ void UVView::doRender()
     renderTextureAxes(renderContext, renderBatch);
 
     renderBatch.render(renderContext);
+
+    // render again until the evicted textures which were just activated are uploaded
+    if (document->textureManager().hasPendingReloads())
+    {
+      update();
+    }
   }
 }
 
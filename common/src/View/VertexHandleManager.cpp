@@ -25,18 +25,96 @@
 #include "Preferences.h"
 #include "View/Grid.h"
 
+#include <vecmath/bbox.h>
 #include <vecmath/distance.h>
 #include <vecmath/intersection.h>
 #include <vecmath/plane.h>
 #include <vecmath/ray.h>
 #include <vecmath/vec.h>
 
+#include <cmath>
+#include <functional>
+
 namespace TrenchBroom
 {
 namespace View
 {
 VertexHandleManagerBase::~VertexHandleManagerBase() {}
 
+/**
+ * The size of the grid cells. Most handles are far apart compared to the handle radius,
+ * so the cells can be large to keep their number small.
+ */
+static constexpr auto CellSize = FloatType(256.0);
+
+size_t VertexHandleManagerBase::CellKeyHash::operator()(const CellKey& key) const
+{
+  auto result = std::hash<std::int64_t>{}(key.x);
+  result = result * 31u + std::hash<std::int64_t>{}(key.y);
+  result = result * 31u + std::hash<std::int64_t>{}(key.z);
+  return result;
+}
+
+VertexHandleManagerBase::CellKey VertexHandleManagerBase::cellKey(
+  const vm::vec3& position)
+{
+  return CellKey{
+    static_cast<std::int64_t>(std::floor(position.x() / CellSize)),
+    static_cast<std::int64_t>(std::floor(position.y() / CellSize)),
+    static_cast<std::int64_t>(std::floor(position.z() / CellSize))};
+}
+
+vm::vec3 VertexHandleManagerBase::handlePosition(const vm::vec3& handle)
+{
+  return handle;
+}
+
+vm::vec3 VertexHandleManagerBase::handlePosition(const vm::segment3& handle)
+{
+  return handle.center();
+}
+
+vm::vec3 VertexHandleManagerBase::handlePosition(const vm::polygon3& handle)
+{
+  return handle.center();
+}
+
+vm::bbox3 VertexHandleManagerBase::handleBounds(const vm::vec3& handle)
+{
+  return vm::bbox3{handle, handle};
+}
+
+vm::bbox3 VertexHandleManagerBase::handleBounds(const vm::segment3& handle)
+{
+  return vm::bbox3{
+    vm::min(handle.start(), handle.end()), vm::max(handle.start(), handle.end())};
+}
+
+vm::bbox3 VertexHandleManagerBase::handleBounds(const vm::polygon3& handle)
+{
+  return vm::bbox3::merge_all(std::begin(handle), std::end(handle));
+}
+
+bool VertexHandleManagerBase::mayHitHandle(
+  const vm::ray3& pickRay,
+  const Renderer::Camera& camera,
+  const FloatType handleRadius,
+  const vm::bbox3& bounds)
+{
+  // the scaling factor is linear in the distance to the camera, so its maximum within
+  // the bounds is attained at one of their corners
+  auto maxScaling = FloatType(0.0);
+  for (const auto& corner : bounds.vertices())
+  {
+    const auto scaling = camera.perspectiveScalingFactor(vm::vec3f{corner});
+    maxScaling = std::max(maxScaling, std::abs(static_cast<FloatType>(scaling)));
+  }
+
+  const auto expandedBounds = bounds.expand(FloatType(2.0) * handleRadius * maxScaling);
+  return expandedBounds.contains(pickRay.origin)
+         || !vm::is_nan(vm::intersect_ray_bbox(pickRay, expandedBounds));
+}
+
 const Model::HitType::Type VertexHandleManager::HandleHitType =
   Model::HitType::freeType();
 
@@ -45,34 +123,33 @@ void VertexHandleManager::pick(
   const Renderer::Camera& camera,
   Model::PickResult& pickResult) const
 {
-  for (const auto& [position, info] : m_handles)
-  {
-    const auto distance = camera.pickPointHandle(
-      pickRay, position, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+  const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+  forEachHandleNearRay(pickRay, camera, handleRadius, [&](const vm::vec3& position) {
+    const auto distance = camera.pickPointHandle(pickRay, position, handleRadius);
     if (!vm::is_nan(distance))
     {
       const auto hitPoint = vm::point_at_distance(pickRay, distance);
       const auto error = vm::squared_distance(pickRay, position).distance;
       pickResult.addHit(Model::Hit(HandleHitType, distance, hitPoint, position, error));
     }
-  }
+  });
 }
 
-void VertexHandleManager::addHandles(const Model::BrushNode* brushNode)
+void VertexHandleManager::addHandles(Model::BrushNode* brushNode)
 {
   const Model::Brush& brush = brushNode->brush();
   for (const Model::BrushVertex* vertex : brush.vertices())
   {
-    add(vertex->position());
+    add(vertex->position(), brushNode);
   }
 }
 
-void VertexHandleManager::removeHandles(const Model::BrushNode* brushNode)
+void VertexHandleManager::removeHandles(Model::BrushNode* brushNode)
 {
   const Model::Brush& brush = brushNode->brush();
   for (const Model::BrushVertex* vertex : brush.vertices())
   {
-    assertResult(remove(vertex->position()));
+    assertResult(remove(vertex->position(), brushNode));
   }
 }
 
@@ -81,13 +158,6 @@ Model::HitType::Type VertexHandleManager::hitType() const
   return HandleHitType;
 }
 
-bool VertexHandleManager::isIncident(
-  const Handle& handle, const Model::BrushNode* brushNode) const
-{
-  const Model::Brush& brush = brushNode->brush();
-  return brush.hasVertex(handle);
-}
-
 const Model::HitType::Type EdgeHandleManager::HandleHitType = Model::HitType::freeType();
 
 void EdgeHandleManager::pickGridHandle(
@@ -96,16 +166,16 @@ void EdgeHandleManager::pickGridHandle(
   const Grid& grid,
   Model::PickResult& pickResult) const
 {
-  for (const auto& [position, info] : m_handles)
-  {
-    const FloatType edgeDist = camera.pickLineSegmentHandle(
-      pickRay, position, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+  const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+  forEachHandleNearRay(pickRay, camera, handleRadius, [&](const vm::segment3& position) {
+    const FloatType edgeDist =
+      camera.pickLineSegmentHandle(pickRay, position, handleRadius);
     if (!vm::is_nan(edgeDist))
     {
       const vm::vec3 pointHandle =
         grid.snap(vm::point_at_distance(pickRay, edgeDist), position);
-      const FloatType pointDist = camera.pickPointHandle(
-        pickRay, pointHandle, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+      const FloatType pointDist =
+        camera.pickPointHandle(pickRay, pointHandle, handleRadius);
       if (!vm::is_nan(pointDist))
       {
         const vm::vec3 hitPoint = vm::point_at_distance(pickRay, pointDist);
@@ -113,7 +183,7 @@ void EdgeHandleManager::pickGridHandle(
           Model::Hit(HandleHitType, pointDist, hitPoint, HitType(position, pointHandle)));
       }
     }
-  }
+  });
 }
 
 void EdgeHandleManager::pickCenterHandle(
@@ -121,36 +191,39 @@ void EdgeHandleManager::pickCenterHandle(
   const Renderer::Camera& camera,
   Model::PickResult& pickResult) const
 {
-  for (const auto& [position, info] : m_handles)
-  {
+  const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+  forEachHandleNearRay(pickRay, camera, handleRadius, [&](const vm::segment3& position) {
     const vm::vec3 pointHandle = position.center();
 
-    const FloatType pointDist = camera.pickPointHandle(
-      pickRay, pointHandle, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+    const FloatType pointDist =
+      camera.pickPointHandle(pickRay, pointHandle, handleRadius);
     if (!vm::is_nan(pointDist))
     {
       const vm::vec3 hitPoint = vm::point_at_distance(pickRay, pointDist);
       pickResult.addHit(Model::Hit(HandleHitType, pointDist, hitPoint, position));
     }
-  }
+  });
 }
 
-void EdgeHandleManager::addHandles(const Model::BrushNode* brushNode)
+void EdgeHandleManager::addHandles(Model::BrushNode* brushNode)
 {
   const Model::Brush& brush = brushNode->brush();
   for (const Model::BrushEdge* edge : brush.edges())
   {
-    add(vm::segment3(edge->firstVertex()->position(), edge->secondVertex()->position()));
+    add(
+      vm::segment3(edge->firstVertex()->position(), edge->secondVertex()->position()),
+      brushNode);
   }
 }
 
-void EdgeHandleManager::removeHandles(const Model::BrushNode* brushNode)
+void EdgeHandleManager::removeHandles(Model::BrushNode* brushNode)
 {
   const Model::Brush& brush = brushNode->brush();
   for (const Model::BrushEdge* edge : brush.edges())
   {
     assertResult(remove(
-      vm::segment3(edge->firstVertex()->position(), edge->secondVertex()->position())));
+      vm::segment3(edge->firstVertex()->position(), edge->secondVertex()->position()),
+      brushNode));
   }
 }
 
@@ -159,13 +232,6 @@ Model::HitType::Type EdgeHandleManager::hitType() const
   return HandleHitType;
 }
 
-bool EdgeHandleManager::isIncident(
-  const Handle& handle, const Model::BrushNode* brushNode) const
-{
-  const Model::Brush& brush = brushNode->brush();
-  return brush.hasEdge(handle);
-}
-
 const Model::HitType::Type FaceHandleManager::HandleHitType = Model::HitType::freeType();
 
 void FaceHandleManager::pickGridHandle(
@@ -174,12 +240,12 @@ void FaceHandleManager::pickGridHandle(
   const Grid& grid,
   Model::PickResult& pickResult) const
 {
-  for (const auto& [position, info] : m_handles)
-  {
+  const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+  forEachHandleNearRay(pickRay, camera, handleRadius, [&](const vm::polygon3& position) {
     const auto [valid, plane] = vm::from_points(std::begin(position), std::end(position));
     if (!valid)
     {
-      continue;
+      return;
     }
 
     const auto distance =
@@ -188,8 +254,7 @@ void FaceHandleManager::pickGridHandle(
     {
       const auto pointHandle = grid.snap(vm::point_at_distance(pickRay, distance), plane);
 
-      const auto pointDist = camera.pickPointHandle(
-        pickRay, pointHandle, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+      const auto pointDist = camera.pickPointHandle(pickRay, pointHandle, handleRadius);
       if (!vm::is_nan(pointDist))
       {
         const auto hitPoint = vm::point_at_distance(pickRay, pointDist);
@@ -197,7 +262,7 @@ void FaceHandleManager::pickGridHandle(
           Model::Hit(HandleHitType, pointDist, hitPoint, HitType(position, pointHandle)));
       }
     }
-  }
+  });
 }
 
 void FaceHandleManager::pickCenterHandle(
@@ -205,35 +270,34 @@ void FaceHandleManager::pickCenterHandle(
   const Renderer::Camera& camera,
   Model::PickResult& pickResult) const
 {
-  for (const auto& [position, info] : m_handles)
-  {
+  const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+  forEachHandleNearRay(pickRay, camera, handleRadius, [&](const vm::polygon3& position) {
     const auto pointHandle = position.center();
 
-    const auto pointDist = camera.pickPointHandle(
-      pickRay, pointHandle, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+    const auto pointDist = camera.pickPointHandle(pickRay, pointHandle, handleRadius);
     if (!vm::is_nan(pointDist))
     {
       const auto hitPoint = vm::point_at_distance(pickRay, pointDist);
       pickResult.addHit(Model::Hit(HandleHitType, pointDist, hitPoint, position));
     }
-  }
+  });
 }
 
-void FaceHandleManager::addHandles(const Model::BrushNode* brushNode)
+void FaceHandleManager::addHandles(Model::BrushNode* brushNode)
 {
   const Model::Brush& brush = brushNode->brush();
   for (const Model::BrushFace& face : brush.faces())
   {
-    add(face.polygon());
+    add(face.polygon(), brushNode);
   }
 }
 
-void FaceHandleManager::removeHandles(const Model::BrushNode* brushNode)
+void FaceHandleManager::removeHandles(Model::BrushNode* brushNode)
 {
   const Model::Brush& brush = brushNode->brush();
   for (const Model::BrushFace& face : brush.faces())
   {
-    assertResult(remove(face.polygon()));
+    assertResult(remove(face.polygon(), brushNode));
   }
 }
 
@@ -241,12 +305,5 @@ Model::HitType::Type FaceHandleManager::hitType() const
 {
   return HandleHitType;
 }
-
-bool FaceHandleManager::isIncident(
-  const Handle& handle, const Model::BrushNode* brushNode) const
-{
-  const Model::Brush& brush = brushNode->brush();
-  return brush.hasFace(handle);
-}
 } // namespace View
 } // namespace TrenchBroom
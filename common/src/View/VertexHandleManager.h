@@ -28,10 +28,15 @@
 
 #include <kdl/vector_set.h>
 
+#include <vecmath/bbox.h>
+#include <vecmath/polygon.h>
 #include <vecmath/segment.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <iterator>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 namespace TrenchBroom
@@ -73,7 +78,7 @@ public:
    *
    * @param brushNode the brush whose handles to add
    */
-  virtual void addHandles(const Model::BrushNode* brushNode) = 0;
+  virtual void addHandles(Model::BrushNode* brushNode) = 0;
 
   /**
    * Removes all handles of the given range of brushes from this handle manager.
@@ -97,7 +102,61 @@ public:
    *
    * @param brushNode the brush whose handles to remove
    */
-  virtual void removeHandles(const Model::BrushNode* brushNode) = 0;
+  virtual void removeHandles(Model::BrushNode* brushNode) = 0;
+
+protected:
+  /**
+   * Identifies a cell of the grid that is used to find handles by their positions.
+   */
+  struct CellKey
+  {
+    std::int64_t x;
+    std::int64_t y;
+    std::int64_t z;
+
+    bool operator==(const CellKey& other) const
+    {
+      return x == other.x && y == other.y && z == other.z;
+    }
+  };
+
+  struct CellKeyHash
+  {
+    size_t operator()(const CellKey& key) const;
+  };
+
+  /**
+   * Returns the key of the grid cell that contains the given position.
+   */
+  static CellKey cellKey(const vm::vec3& position);
+
+  /**
+   * Returns the position by which the given handle is sorted into the grid. Handles that
+   * are equal within some epsilon have positions which are equal within the same
+   * epsilon.
+   */
+  static vm::vec3 handlePosition(const vm::vec3& handle);
+  static vm::vec3 handlePosition(const vm::segment3& handle);
+  static vm::vec3 handlePosition(const vm::polygon3& handle);
+
+  /**
+   * Returns the bounds of the given handle.
+   */
+  static vm::bbox3 handleBounds(const vm::vec3& handle);
+  static vm::bbox3 handleBounds(const vm::segment3& handle);
+  static vm::bbox3 handleBounds(const vm::polygon3& handle);
+
+  /**
+   * Indicates whether the given pick ray can hit a handle with the given radius at any
+   * point within the given bounds when picked with the given camera. The radius of a
+   * handle depends on its distance to the camera, so the bounds are expanded by the
+   * largest radius that a handle within them can have.
+   */
+  static bool mayHitHandle(
+    const vm::ray3& pickRay,
+    const Renderer::Camera& camera,
+    FloatType handleRadius,
+    const vm::bbox3& bounds);
 };
 
 template <typename H>
@@ -110,17 +169,16 @@ public:
 private:
 protected:
   /**
-   * Represents the status of a handle, i.e., how many duplicates exist at the same
+   * Represents the status of a handle, i.e., which brushes have a handle at the same
    * coordinates and whether or not all of these are selected.
    */
   struct HandleInfo
   {
-    size_t count;
+    std::vector<Model::BrushNode*> brushes;
     bool selected;
 
     HandleInfo()
-      : count(0)
-      , selected(false)
+      : selected(false)
     {
     }
 
@@ -158,16 +216,6 @@ protected:
       selected = !selected;
       return selected;
     }
-
-    /**
-     * Increments the number of handles at the same coordinates.
-     */
-    void inc() { ++count; }
-
-    /**
-     * Deccrements the number of handles at the same coordinates.
-     */
-    void dec() { --count; }
   };
 
   using HandleMap = std::map<H, HandleInfo>;
@@ -178,6 +226,25 @@ protected:
    */
   HandleMap m_handles;
 
+  /**
+   * A cell of the grid that is used to find handles by their positions.
+   */
+  struct Cell
+  {
+    /**
+     * The bounds of the handles in this cell. The bounds are not shrunk when a handle is
+     * removed, so they may be larger than necessary until the cell becomes empty.
+     */
+    vm::bbox3 bounds;
+    std::vector<HandleEntry*> entries;
+  };
+
+  /**
+   * Additionally sorts the handles into a uniform grid by their positions, so that
+   * handles at or near a position can be found without checking every handle.
+   */
+  std::unordered_map<CellKey, Cell, CellKeyHash> m_cells;
+
   /**
    * The total number of selected handles, not counting duplicates.
    */
@@ -318,34 +385,46 @@ public:
 
 public:
   /**
-   * Adds the given handle to this manager.
+   * Adds the given handle of the given brush to this manager.
    *
    * @param handle the handle to add
+   * @param brushNode the brush which the handle belongs to
    */
-  void add(const Handle& handle)
+  void add(const Handle& handle, Model::BrushNode* brushNode)
   {
-    m_handles[handle].inc(); // unknown value gets value constructed, which for HandleInfo
-                             // means its default constructor is called
+    auto [it, inserted] = m_handles.try_emplace(handle);
+    it->second.brushes.push_back(brushNode);
+
+    if (inserted)
+    {
+      addToCell(*it);
+    }
   }
 
   /**
-   * Removes the given handle from this manager.
+   * Removes the given handle of the given brush from this manager.
    *
    * @param handle the handle to remove
+   * @param brushNode the brush which the handle belongs to
    * @return true if the given handle was contained in this manager (and therefore
    * removed) and false otherwise
    */
-  bool remove(const Handle& handle)
+  bool remove(const Handle& handle, Model::BrushNode* brushNode)
   {
     const auto it = m_handles.find(handle);
     if (it != std::end(m_handles))
     {
       HandleInfo& info = it->second;
-      info.dec();
+      const auto brushIt = std::find(info.brushes.begin(), info.brushes.end(), brushNode);
+      if (brushIt != info.brushes.end())
+      {
+        info.brushes.erase(brushIt);
+      }
 
-      if (info.count == 0)
+      if (info.brushes.empty())
       {
         deselect(info);
+        removeFromCell(*it);
         m_handles.erase(it);
       }
       return true;
@@ -360,6 +439,7 @@ public:
   void clear()
   {
     m_handles.clear();
+    m_cells.clear();
     m_selectedHandleCount = 0;
   }
 
@@ -462,15 +542,57 @@ public:
   }
 
 private:
+  void addToCell(HandleEntry& entry)
+  {
+    const auto& handle = entry.first;
+    auto& cell = m_cells[cellKey(handlePosition(handle))];
+
+    const auto bounds = handleBounds(handle);
+    cell.bounds = cell.entries.empty() ? bounds : vm::merge(cell.bounds, bounds);
+    cell.entries.push_back(&entry);
+  }
+
+  void removeFromCell(HandleEntry& entry)
+  {
+    const auto it = m_cells.find(cellKey(handlePosition(entry.first)));
+    assert(it != m_cells.end());
+
+    auto& entries = it->second.entries;
+    entries.erase(std::remove(entries.begin(), entries.end(), &entry), entries.end());
+    if (entries.empty())
+    {
+      m_cells.erase(it);
+    }
+  }
+
   template <typename F>
   void forEachCloseHandle(const H& otherHandle, F fun)
   {
     static const auto epsilon = 0.001 * 0.001;
-    for (auto& [handle, info] : m_handles)
+
+    // close handles may be sorted into a neighbouring cell
+    const auto position = handlePosition(otherHandle);
+    const auto min = cellKey(position - vm::vec3::fill(epsilon));
+    const auto max = cellKey(position + vm::vec3::fill(epsilon));
+
+    for (auto x = min.x; x <= max.x; ++x)
     {
-      if (compare(otherHandle, handle, epsilon) == 0)
+      for (auto y = min.y; y <= max.y; ++y)
       {
-        fun(info);
+        for (auto z = min.z; z <= max.z; ++z)
+        {
+          const auto it = m_cells.find(CellKey{x, y, z});
+          if (it != m_cells.end())
+          {
+            for (auto* entry : it->second.entries)
+            {
+              if (compare(otherHandle, entry->first, epsilon) == 0)
+              {
+                fun(entry->second);
+              }
+            }
+          }
+        }
       }
     }
   }
@@ -530,83 +652,91 @@ public:
     }
   }
 
+protected:
+  /**
+   * Applies the given function to every handle that may be hit by the given pick ray
+   * when picked with the given camera and the given handle radius. Only the handles in
+   * the grid cells whose bounds are close enough to the pick ray are considered.
+   *
+   * @tparam F the type of the function to apply, must accept a handle
+   * @param pickRay the pick ray
+   * @param camera the camera
+   * @param handleRadius the handle radius
+   * @param fun the function to apply
+   */
+  template <typename F>
+  void forEachHandleNearRay(
+    const vm::ray3& pickRay,
+    const Renderer::Camera& camera,
+    const FloatType handleRadius,
+    F fun) const
+  {
+    for (const auto& [key, cell] : m_cells)
+    {
+      if (mayHitHandle(pickRay, camera, handleRadius, cell.bounds))
+      {
+        for (const auto* entry : cell.entries)
+        {
+          fun(entry->first);
+        }
+      }
+    }
+  }
+
 public:
   /**
-   * Finds and returns all brushes in the given range which are incident to the given
-   * handle.
+   * Finds and returns all brushes which are incident to the given handle, that is, all
+   * brushes whose handles at the handle's position were added to this manager.
    *
-   * @tparam I the type of the range iterators
    * @param handle the handle
-   * @param begin the beginning of the range of brushes
-   * @param end the end of the range of brushes
    * @return a set of all brushes that are incident to the given handle
    */
-  template <typename I>
-  std::vector<Model::BrushNode*> findIncidentBrushes(
-    const Handle& handle, I begin, I end) const
+  std::vector<Model::BrushNode*> findIncidentBrushes(const Handle& handle) const
   {
     kdl::vector_set<Model::BrushNode*> result;
-    findIncidentBrushes(handle, begin, end, std::inserter(result, result.end()));
+    findIncidentBrushes(handle, std::inserter(result, result.end()));
     return result.release_data();
   }
 
   /**
-   * Finds and returns all brushes in the given range which are incident to any handle in
-   * the given range.
+   * Finds and returns all brushes which are incident to any handle in the given range.
    *
-   * @tparam I1 the type of range iterators for the range of handles
-   * @tparam I2 the type of range iterators for the range of brushes
-   * @param hBegin the beginning of the range of handles
-   * @param hEnd the end of the range of handles
-   * @param bBegin the beginning of the range of brushes
-   * @param bEnd the end of the range of brushes
+   * @tparam I the type of range iterators for the range of handles
+   * @param begin the beginning of the range of handles
+   * @param end the end of the range of handles
    * @return a set containing all incident brushes
    */
-  template <typename I1, typename I2>
-  std::vector<Model::BrushNode*> findIncidentBrushes(
-    I1 hBegin, I1 hEnd, I2 bBegin, I2 bEnd) const
+  template <typename I>
+  std::vector<Model::BrushNode*> findIncidentBrushes(I begin, I end) const
   {
     kdl::vector_set<Model::BrushNode*> result;
-    auto out = std::inserter(result, std::end(result));
-    for (auto hCur = hBegin; hCur != hEnd; ++hCur)
+    for (auto cur = begin; cur != end; ++cur)
     {
-      findIncidentBrushes(*hCur, bBegin, bEnd, out);
+      const auto it = m_handles.find(*cur);
+      if (it != std::end(m_handles))
+      {
+        result.insert(it->second.brushes.begin(), it->second.brushes.end());
+      }
     }
     return result.release_data();
   }
 
   /**
-   * Finds all brushes in the given range which are incident to the given handle.
+   * Finds all brushes which are incident to the given handle.
    *
-   * @tparam I the type of the range iterators
    * @tparam O an output iterator to append the resulting brushes to
    * @param handle the handle
-   * @param begin the beginning of the range of brushes
-   * @param end the end of the range of brushes
    * @param out an output iterator that accepts the incident brushes
    */
-  template <typename I, typename O>
-  void findIncidentBrushes(const Handle& handle, I begin, I end, O out) const
+  template <typename O>
+  void findIncidentBrushes(const Handle& handle, O out) const
   {
-    for (auto cur = begin; cur != end; ++cur)
+    const auto it = m_handles.find(handle);
+    if (it != std::end(m_handles))
     {
-      if (isIncident(handle, *cur))
-      {
-        out++ = *cur;
-      }
+      std::copy(it->second.brushes.begin(), it->second.brushes.end(), out);
     }
   }
-
-private:
-  /**
-   * Checks whether the given brush is incident to the given handle.
-   *
-   * @param handle the handle to check
-   * @param brushNode the brush to check
-   * @return true if and only if the given brush is incident to the given handle
-   */
-  virtual bool isIncident(
-    const Handle& handle, const Model::BrushNode* brushNode) const = 0;
 };
 
 /**
@@ -636,13 +766,10 @@ public:
     Model::PickResult& pickResult) const;
 
 public:
-  void addHandles(const Model::BrushNode* brushNode) override;
-  void removeHandles(const Model::BrushNode* brushNode) override;
+  void addHandles(Model::BrushNode* brushNode) override;
+  void removeHandles(Model::BrushNode* brushNode) override;
 
   Model::HitType::Type hitType() const override;
-
-private:
-  bool isIncident(const Handle& handle, const Model::BrushNode* brushNode) const override;
 };
 
 /**
@@ -694,13 +821,10 @@ public:
     Model::PickResult& pickResult) const;
 
 public:
-  void addHandles(const Model::BrushNode* brushNode) override;
-  void removeHandles(const Model::BrushNode* brushNode) override;
+  void addHandles(Model::BrushNode* brushNode) override;
+  void removeHandles(Model::BrushNode* brushNode) override;
 
   Model::HitType::Type hitType() const override;
-
-private:
-  bool isIncident(const Handle& handle, const Model::BrushNode* brushNode) const override;
 };
 
 /**
@@ -752,13 +876,10 @@ public:
     Model::PickResult& pickResult) const;
 
 public:
-  void addHandles(const Model::BrushNode* brushNode) override;
-  void removeHandles(const Model::BrushNode* brushNode) override;
+  void addHandles(Model::BrushNode* brushNode) override;
+  void removeHandles(Model::BrushNode* brushNode) override;
 
   Model::HitType::Type hitType() const override;
-
-private:
-  bool isIncident(const Handle& handle, const Model::BrushNode* brushNode) const override;
 };
 } // namespace View
 } // namespace TrenchBroom
@@ -150,6 +150,11 @@ QWidget* ViewPreferencePane::createViewPreferences()
   m_enableMsaa = new QCheckBox();
   m_enableMsaa->setToolTip("Enable multisampling");
 
+  m_compressTextures = new QCheckBox();
+  m_compressTextures->setToolTip(
+    "Compress opaque textures to reduce the amount of video memory they use, at the cost "
+    "of image quality and loading time.");
+
   m_textureBrowserIconSizeCombo = new QComboBox();
   m_textureBrowserIconSizeCombo->addItem("25%");
   m_textureBrowserIconSizeCombo->addItem("50%");
@@ -186,6 +191,7 @@ QWidget* ViewPreferencePane::createViewPreferences()
   layout->addRow("Show axes", m_showAxes);
   layout->addRow("Texture mode", m_textureModeCombo);
   layout->addRow("Enable multisampling", m_enableMsaa);
+  layout->addRow("Compress textures", m_compressTextures);
 
   layout->addSection("Texture Browser");
   layout->addRow("Icon size", m_textureBrowserIconSizeCombo);
@@ -222,6 +228,11 @@ void ViewPreferencePane::bindEvents()
     m_showAxes, &QCheckBox::stateChanged, this, &ViewPreferencePane::showAxesChanged);
   connect(
     m_enableMsaa, &QCheckBox::stateChanged, this, &ViewPreferencePane::enableMsaaChanged);
+  connect(
+    m_compressTextures,
+    &QCheckBox::stateChanged,
+    this,
+    &ViewPreferencePane::compressTexturesChanged);
   connect(
     m_themeCombo,
     QOverload<int>::of(&QComboBox::activated),
@@ -258,6 +269,7 @@ void ViewPreferencePane::doResetToDefaults()
   prefs.resetToDefault(Preferences::CameraFov);
   prefs.resetToDefault(Preferences::ShowAxes);
   prefs.resetToDefault(Preferences::EnableMSAA);
+  prefs.resetToDefault(Preferences::CompressTextures);
   prefs.resetToDefault(Preferences::TextureMinFilter);
   prefs.resetToDefault(Preferences::TextureMagFilter);
   prefs.resetToDefault(Preferences::Theme);
@@ -278,6 +290,7 @@ void ViewPreferencePane::doUpdateControls()
 
   m_showAxes->setChecked(pref(Preferences::ShowAxes));
   m_enableMsaa->setChecked(pref(Preferences::EnableMSAA));
+  m_compressTextures->setChecked(pref(Preferences::CompressTextures));
   m_themeCombo->setCurrentIndex(findThemeIndex(pref(Preferences::Theme)));
 
   const auto textureBrowserIconSize = pref(Preferences::TextureBrowserIconSize);
@@ -384,6 +397,13 @@ void ViewPreferencePane::enableMsaaChanged(const int state)
   prefs.set(Preferences::EnableMSAA, value);
 }
 
+void ViewPreferencePane::compressTexturesChanged(const int state)
+{
+  const auto value = state == Qt::Checked;
+  auto& prefs = PreferenceManager::instance();
+  prefs.set(Preferences::CompressTextures, value);
+}
+
 void ViewPreferencePane::textureModeChanged(const int value)
 {
   const auto index = static_cast<size_t>(value);
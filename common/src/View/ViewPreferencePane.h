@@ -41,6 +41,7 @@ private:
   QCheckBox* m_showAxes;
   QComboBox* m_textureModeCombo;
   QCheckBox* m_enableMsaa;
+  QCheckBox* m_compressTextures;
   QComboBox* m_themeCombo;
   QComboBox* m_textureBrowserIconSizeCombo;
   QComboBox* m_rendererFontSizeCombo;
@@ -68,6 +69,7 @@ private slots:
   void fovChanged(int value);
   void showAxesChanged(int state);
   void enableMsaaChanged(int state);
+  void compressTexturesChanged(int state);
   void textureModeChanged(int index);
   void themeChanged(int index);
   void textureBrowserIconSizeChanged(int index);
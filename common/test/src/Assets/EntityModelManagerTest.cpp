@@ -0,0 +1,232 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TestLogger.h"
+
+#include "Assets/EntityModel.h"
+#include "Assets/EntityModelManager.h"
+#include "Assets/ModelDefinition.h"
+#include "Exceptions.h"
+#include "IO/EntityModelLoader.h"
+#include "IO/Path.h"
+#include "NotifierConnection.h"
+
+#include <kdl/vector_utils.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Assets
+{
+namespace
+{
+class TestEntityModelLoader : public IO::EntityModelLoader
+{
+public:
+  mutable std::atomic<size_t> initializeCount = 0u;
+
+private:
+  std::unique_ptr<EntityModel> doInitializeModel(
+    const IO::Path& path, Logger&) const override
+  {
+    ++initializeCount;
+    if (path == IO::Path("missing.mdl"))
+    {
+      throw GameException("Model not found");
+    }
+
+    auto model = std::make_unique<EntityModel>(
+      path.asString(), PitchType::Normal, Orientation::Oriented);
+    model->addFrame();
+    model->addFrame();
+    model->addFrame();
+    return model;
+  }
+
+  void doLoadFrame(
+    const IO::Path&, const size_t frameIndex, EntityModel& model, Logger&) const override
+  {
+    model.loadFrame(frameIndex, "frame", vm::bbox3f{8.0f});
+  }
+};
+
+/**
+ * Calls loadPendingModels until no models are pending and returns the processed
+ * specifications.
+ */
+std::vector<ModelSpecification> loadAllPendingModels(EntityModelManager& manager)
+{
+  auto result = std::vector<ModelSpecification>{};
+  while (manager.hasPendingModels())
+  {
+    result = kdl::vec_concat(
+      std::move(result), manager.loadPendingModels(std::chrono::milliseconds{100}));
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("EntityModelManagerTest.loadPendingModels", "[EntityModelManagerTest]")
+{
+  auto logger = TestLogger{};
+  auto loader = TestEntityModelLoader{};
+  auto manager = EntityModelManager{0, 0, logger};
+  manager.setLoader(&loader);
+
+  const auto spec = ModelSpecification{IO::Path("model.mdl"), 0, 0};
+
+  // requesting a frame doesn't load the model immediately
+  CHECK(manager.frame(spec) == nullptr);
+  CHECK(manager.renderer(spec) == nullptr);
+  CHECK(loader.initializeCount == 0u);
+  CHECK(manager.hasPendingModels());
+  CHECK(manager.isPending(spec));
+
+  CHECK(loadAllPendingModels(manager) == std::vector<ModelSpecification>{spec});
+  CHECK_FALSE(manager.hasPendingModels());
+  CHECK_FALSE(manager.isPending(spec));
+  CHECK(loader.initializeCount == 1u);
+
+  const auto* frame = manager.frame(spec);
+  REQUIRE(frame != nullptr);
+  CHECK(frame->loaded());
+  CHECK_FALSE(manager.hasPendingModels());
+
+  CHECK(manager.loadPendingModels(std::chrono::milliseconds{100}).empty());
+  CHECK(loader.initializeCount == 1u);
+}
+
+TEST_CASE(
+  "EntityModelManagerTest.loadPendingModelsConcurrently", "[EntityModelManagerTest]")
+{
+  auto logger = TestLogger{};
+  auto loader = TestEntityModelLoader{};
+  auto manager = EntityModelManager{0, 0, logger};
+  manager.setLoader(&loader);
+
+  const auto spec1 = ModelSpecification{IO::Path("model1.mdl"), 0, 0};
+  const auto spec2 = ModelSpecification{IO::Path("model2.mdl"), 0, 1};
+  const auto spec3 = ModelSpecification{IO::Path("model1.mdl"), 0, 2};
+  manager.frame(spec1);
+  manager.frame(spec2);
+  manager.frame(spec3);
+
+  // every model is initialized once, together with all of its requested frames
+  CHECK_THAT(
+    loadAllPendingModels(manager),
+    Catch::UnorderedEquals(std::vector<ModelSpecification>{spec1, spec2, spec3}));
+  CHECK(loader.initializeCount == 2u);
+
+  for (const auto& spec : {spec1, spec2, spec3})
+  {
+    const auto* frame = manager.frame(spec);
+    REQUIRE(frame != nullptr);
+    CHECK(frame->loaded());
+  }
+  CHECK_FALSE(manager.hasPendingModels());
+}
+
+TEST_CASE(
+  "EntityModelManagerTest.loadPendingFramesWithBudget", "[EntityModelManagerTest]")
+{
+  auto logger = TestLogger{};
+  auto loader = TestEntityModelLoader{};
+  auto manager = EntityModelManager{0, 0, logger};
+  manager.setLoader(&loader);
+
+  manager.frame(ModelSpecification{IO::Path("model.mdl"), 0, 0});
+  loadAllPendingModels(manager);
+
+  // frames of loaded models are processed in the order in which they were requested
+  const auto spec1 = ModelSpecification{IO::Path("model.mdl"), 0, 2};
+  const auto spec2 = ModelSpecification{IO::Path("model.mdl"), 0, 1};
+  manager.frame(spec1);
+  manager.frame(spec2);
+
+  // at least one frame is loaded per call, even if the budget is exhausted
+  CHECK(
+    manager.loadPendingModels(std::chrono::milliseconds{0})
+    == std::vector<ModelSpecification>{spec1});
+  CHECK(manager.hasPendingModels());
+
+  CHECK(
+    manager.loadPendingModels(std::chrono::milliseconds{0})
+    == std::vector<ModelSpecification>{spec2});
+  CHECK_FALSE(manager.hasPendingModels());
+  CHECK(loader.initializeCount == 1u);
+}
+
+TEST_CASE("EntityModelManagerTest.mismatches", "[EntityModelManagerTest]")
+{
+  auto logger = TestLogger{};
+  auto loader = TestEntityModelLoader{};
+  auto manager = EntityModelManager{0, 0, logger};
+  manager.setLoader(&loader);
+
+  const auto missingSpec = ModelSpecification{IO::Path("missing.mdl"), 0, 0};
+  const auto invalidFrameSpec = ModelSpecification{IO::Path("model.mdl"), 0, 3};
+
+  manager.frame(missingSpec);
+  manager.frame(invalidFrameSpec);
+  CHECK(loadAllPendingModels(manager).size() == 2u);
+  CHECK(loader.initializeCount == 2u);
+
+  // failed models and invalid frames are not queued again
+  CHECK(manager.frame(missingSpec) == nullptr);
+  CHECK(manager.frame(invalidFrameSpec) == nullptr);
+  CHECK_FALSE(manager.hasPendingModels());
+
+  // empty model paths are never queued
+  CHECK(manager.frame(ModelSpecification{}) == nullptr);
+  CHECK_FALSE(manager.hasPendingModels());
+}
+
+TEST_CASE("EntityModelManagerTest.modelsWereQueuedNotifier", "[EntityModelManagerTest]")
+{
+  auto logger = TestLogger{};
+  auto loader = TestEntityModelLoader{};
+  auto manager = EntityModelManager{0, 0, logger};
+  manager.setLoader(&loader);
+
+  auto notificationCount = 0u;
+  auto notifierConnection = NotifierConnection{};
+  notifierConnection +=
+    manager.modelsWereQueuedNotifier.connect([&]() { ++notificationCount; });
+
+  // only the first specification queued while the queue is empty notifies
+  manager.frame(ModelSpecification{IO::Path("model1.mdl"), 0, 0});
+  manager.frame(ModelSpecification{IO::Path("model2.mdl"), 0, 0});
+  CHECK(notificationCount == 1u);
+
+  loadAllPendingModels(manager);
+  CHECK(notificationCount == 1u);
+
+  manager.frame(ModelSpecification{IO::Path("model3.mdl"), 0, 0});
+  CHECK(notificationCount == 2u);
+}
+} // namespace Assets
+} // namespace TrenchBroom
@@ -0,0 +1,106 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Assets/EntityModel.h"
+#include "Renderer/GLVertex.h"
+#include "Renderer/PrimType.h"
+
+#include <vecmath/intersection.h>
+#include <vecmath/ray.h>
+#include <vecmath/scalar.h>
+#include <vecmath/vec.h>
+
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Assets
+{
+TEST_CASE("EntityModelTest.intersectLoadedFrame", "[EntityModelTest]")
+{
+  // a height field of 16x16 cells with two triangles each
+  constexpr auto CellCount = 16u;
+  const auto height = [](const size_t x, const size_t y) {
+    return float((x * 7u + y * 13u) % 5u);
+  };
+
+  auto vertices = std::vector<EntityModelVertex>{};
+  for (size_t y = 0u; y < CellCount; ++y)
+  {
+    for (size_t x = 0u; x < CellCount; ++x)
+    {
+      const auto p1 = vm::vec3f{float(x), float(y), height(x, y)};
+      const auto p2 = vm::vec3f{float(x + 1u), float(y), height(x + 1u, y)};
+      const auto p3 = vm::vec3f{float(x + 1u), float(y + 1u), height(x + 1u, y + 1u)};
+      const auto p4 = vm::vec3f{float(x), float(y + 1u), height(x, y + 1u)};
+      for (const auto& p : {p1, p2, p3, p1, p3, p4})
+      {
+        vertices.emplace_back(p, vm::vec2f{});
+      }
+    }
+  }
+
+  auto frame = EntityModelLoadedFrame{
+    0, "frame", vm::bbox3f{16.0f}, PitchType::Normal, Orientation::Oriented};
+  frame.addToSpacialTree(vertices, Renderer::PrimType::Triangles, 0u, vertices.size());
+
+  const auto bruteForce = [&](const vm::ray3f& ray) {
+    auto result = vm::nan<float>();
+    for (size_t i = 0u; i < vertices.size(); i += 3u)
+    {
+      result = vm::safe_min(
+        result,
+        vm::intersect_ray_triangle(
+          ray,
+          Renderer::getVertexComponent<0>(vertices[i]),
+          Renderer::getVertexComponent<0>(vertices[i + 1u]),
+          Renderer::getVertexComponent<0>(vertices[i + 2u])));
+    }
+    return result;
+  };
+
+  for (size_t y = 0u; y < CellCount; ++y)
+  {
+    for (size_t x = 0u; x < CellCount; ++x)
+    {
+      const auto origin = vm::vec3f{float(x) + 0.3f, float(y) + 0.6f, 10.0f};
+      const auto ray = vm::ray3f{origin, vm::normalize(vm::vec3f{0.02f, -0.03f, -1.0f})};
+
+      const auto expected = bruteForce(ray);
+      REQUIRE_FALSE(vm::is_nan(expected));
+      CHECK(frame.intersect(ray) == Approx(expected));
+    }
+  }
+
+  CHECK(vm::is_nan(frame.intersect(vm::ray3f{vm::vec3f{0, 0, 10}, vm::vec3f::pos_z()})));
+  CHECK(vm::is_nan(
+    frame.intersect(vm::ray3f{vm::vec3f{-1, 8, 2}, vm::normalize(vm::vec3f{-1, 1, 0})})));
+}
+
+TEST_CASE("EntityModelTest.intersectEmptyLoadedFrame", "[EntityModelTest]")
+{
+  auto frame = EntityModelLoadedFrame{
+    0, "frame", vm::bbox3f{16.0f}, PitchType::Normal, Orientation::Oriented};
+  frame.buildSpacialTree();
+  CHECK(vm::is_nan(frame.intersect(vm::ray3f{vm::vec3f::zero(), vm::vec3f::pos_z()})));
+}
+} // namespace Assets
+} // namespace TrenchBroom
@@ -0,0 +1,120 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Assets/Palette.h"
+#include "Assets/TextureBuffer.h"
+#include "Color.h"
+#include "IO/Reader.h"
+
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Assets
+{
+static Palette makePalette()
+{
+  auto data = std::vector<unsigned char>(768);
+  for (size_t i = 0; i < 256; ++i)
+  {
+    data[3 * i + 0] = static_cast<unsigned char>(i);
+    data[3 * i + 1] = static_cast<unsigned char>(255 - i);
+    data[3 * i + 2] = static_cast<unsigned char>(i / 2);
+  }
+  return Palette{data};
+}
+
+TEST_CASE("PaletteTest.indexedToRgba", "[PaletteTest]")
+{
+  const auto palette = makePalette();
+
+  // more pixels than are read at once to test reading in chunks
+  auto indices = std::vector<char>(5000);
+  for (size_t i = 0; i < indices.size(); ++i)
+  {
+    indices[i] = static_cast<char>(i % 255);
+  }
+
+  SECTION("Opaque")
+  {
+    auto reader = IO::Reader::from(indices.data(), indices.data() + indices.size());
+    auto buffer = TextureBuffer{4 * indices.size()};
+    auto averageColor = Color{};
+
+    CHECK_FALSE(palette.indexedToRgba(
+      reader, indices.size(), buffer, PaletteTransparency::Opaque, averageColor));
+    CHECK(reader.eof());
+
+    auto expectedSum = std::vector<double>(3, 0.0);
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+      const auto index = static_cast<unsigned char>(indices[i]);
+      const auto* pixel = buffer.data() + 4 * i;
+
+      CHECK(pixel[0] == index);
+      CHECK(pixel[1] == 255 - index);
+      CHECK(pixel[2] == index / 2);
+      CHECK(pixel[3] == 0xFF);
+
+      expectedSum[0] += index;
+      expectedSum[1] += 255 - index;
+      expectedSum[2] += index / 2;
+    }
+
+    const auto divisor = 255.0 * static_cast<double>(indices.size());
+    CHECK(averageColor.r() == Approx(expectedSum[0] / divisor));
+    CHECK(averageColor.g() == Approx(expectedSum[1] / divisor));
+    CHECK(averageColor.b() == Approx(expectedSum[2] / divisor));
+    CHECK(averageColor.a() == 1.0f);
+  }
+
+  SECTION("Index 255 transparent")
+  {
+    auto averageColor = Color{};
+
+    {
+      auto reader = IO::Reader::from(indices.data(), indices.data() + indices.size());
+      auto buffer = TextureBuffer{4 * indices.size()};
+      CHECK_FALSE(palette.indexedToRgba(
+        reader,
+        indices.size(),
+        buffer,
+        PaletteTransparency::Index255Transparent,
+        averageColor));
+    }
+
+    indices[4999] = static_cast<char>(255);
+
+    {
+      auto reader = IO::Reader::from(indices.data(), indices.data() + indices.size());
+      auto buffer = TextureBuffer{4 * indices.size()};
+      CHECK(palette.indexedToRgba(
+        reader,
+        indices.size(),
+        buffer,
+        PaletteTransparency::Index255Transparent,
+        averageColor));
+      CHECK(buffer.data()[4 * 4999 + 3] == 0);
+    }
+  }
+}
+} // namespace Assets
+} // namespace TrenchBroom
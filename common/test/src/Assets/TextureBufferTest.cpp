@@ -0,0 +1,160 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Assets/TextureBuffer.h"
+
+#include <vecmath/vec.h>
+#include <vecmath/vec_io.h>
+
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Assets
+{
+static std::vector<unsigned char> toVector(const TextureBuffer& buffer)
+{
+  return std::vector<unsigned char>(buffer.data(), buffer.data() + buffer.size());
+}
+
+TEST_CASE("TextureBufferTest.sizeAtMipLevel", "[TextureBufferTest]")
+{
+  CHECK(sizeAtMipLevel(64, 32, 0) == vm::vec2s{64, 32});
+  CHECK(sizeAtMipLevel(64, 32, 1) == vm::vec2s{32, 16});
+  CHECK(sizeAtMipLevel(64, 32, 6) == vm::vec2s{1, 1});
+}
+
+TEST_CASE("TextureBufferTest.resizeMips", "[TextureBufferTest]")
+{
+  auto buffers = TextureBufferList{};
+  setMipBufferSize(buffers, 2, 4, 2, GL_RGBA);
+
+  // level 0 is 4x2 pixels, each pair of horizontally adjacent pixels averages to
+  // {10, 20, 30, 40} or {100, 100, 100, 100}
+  const auto level0 = std::vector<unsigned char>{
+    0,   10,  20,  30,  20,  30,  40,  50,  100, 100, 100, 100, 100, 100, 100, 100,
+    10,  20,  30,  40,  10,  20,  30,  40,  90,  90,  90,  90,  110, 110, 110, 110,
+  };
+  std::copy(level0.begin(), level0.end(), buffers[0].data());
+
+  // level 1 is 2x1 pixels
+  const auto level1 = std::vector<unsigned char>{1, 2, 3, 4, 5, 6, 7, 8};
+  std::copy(level1.begin(), level1.end(), buffers[1].data());
+
+  SECTION("Same size")
+  {
+    resizeMips(buffers, {4, 2}, {4, 2}, GL_RGBA);
+    CHECK(toVector(buffers[0]) == level0);
+    CHECK(toVector(buffers[1]) == level1);
+  }
+
+  SECTION("Shrink")
+  {
+    resizeMips(buffers, {4, 2}, {2, 1}, GL_RGBA);
+    REQUIRE(buffers.size() == 2u);
+    CHECK(
+      toVector(buffers[0])
+      == std::vector<unsigned char>{10, 20, 30, 40, 100, 100, 100, 100});
+    CHECK(toVector(buffers[1]) == std::vector<unsigned char>{3, 4, 5, 6});
+  }
+
+  SECTION("Enlarge")
+  {
+    resizeMips(buffers, {4, 2}, {8, 4}, GL_RGBA);
+    REQUIRE(buffers.size() == 2u);
+    CHECK(buffers[0].size() == 4u * 8u * 4u);
+    CHECK(
+      toVector(buffers[1])
+      == std::vector<unsigned char>{
+        1, 2, 3, 4, 1, 2, 3, 4, 5, 6, 7, 8, 5, 6, 7, 8,
+        1, 2, 3, 4, 1, 2, 3, 4, 5, 6, 7, 8, 5, 6, 7, 8,
+      });
+  }
+}
+
+TEST_CASE("TextureBufferTest.generateMips", "[TextureBufferTest]")
+{
+  auto buffers = TextureBufferList{};
+  setMipBufferSize(buffers, 1, 4, 2, GL_RGB);
+
+  const auto level0 = std::vector<unsigned char>{
+    0,  0,  0,  20, 20, 20, 100, 100, 100, 100, 100, 100,
+    40, 40, 40, 60, 60, 60, 200, 200, 200, 0,   0,   0,
+  };
+  std::copy(level0.begin(), level0.end(), buffers[0].data());
+
+  generateMips(buffers, 3, 4, 2, GL_RGB);
+  REQUIRE(buffers.size() == 3u);
+  CHECK(toVector(buffers[0]) == level0);
+  CHECK(toVector(buffers[1]) == std::vector<unsigned char>{30, 30, 30, 100, 100, 100});
+  CHECK(toVector(buffers[2]) == std::vector<unsigned char>{65, 65, 65});
+}
+
+TEST_CASE("TextureBufferTest.compressMips", "[TextureBufferTest]")
+{
+  // an 8x6 image with a horizontal gradient from red to blue in BGRA order
+  const auto width = size_t(8);
+  const auto height = size_t(6);
+
+  auto buffers = TextureBufferList{};
+  setMipBufferSize(buffers, 2, width, height, GL_BGRA);
+  for (size_t level = 0; level < buffers.size(); ++level)
+  {
+    const auto size = sizeAtMipLevel(width, height, level);
+    auto* pixel = buffers[level].data();
+    for (size_t y = 0; y < size.y(); ++y)
+    {
+      for (size_t x = 0; x < size.x(); ++x)
+      {
+        const auto t = static_cast<unsigned char>(255u * x / (size.x() - 1u));
+        *pixel++ = t;
+        *pixel++ = 0;
+        *pixel++ = static_cast<unsigned char>(255u - t);
+        *pixel++ = 0xFF;
+      }
+    }
+  }
+
+  const auto compressed = compressMips(buffers, width, height, GL_BGRA);
+  REQUIRE(compressed.size() == 2u);
+  CHECK(compressed[0].size() == 2u * 2u * 8u);
+  CHECK(compressed[1].size() == 8u);
+
+  const auto decompressed = decompressMips(compressed, width, height);
+  REQUIRE(decompressed.size() == 2u);
+  for (size_t level = 0; level < decompressed.size(); ++level)
+  {
+    const auto size = sizeAtMipLevel(width, height, level);
+    REQUIRE(decompressed[level].size() == 4u * size.x() * size.y());
+
+    const auto* expected = buffers[level].data();
+    const auto* actual = decompressed[level].data();
+    for (size_t i = 0; i < size.x() * size.y(); ++i)
+    {
+      CHECK(int(actual[4u * i + 0u]) == Approx(int(expected[4u * i + 2u])).margin(24));
+      CHECK(int(actual[4u * i + 1u]) == Approx(int(expected[4u * i + 1u])).margin(24));
+      CHECK(int(actual[4u * i + 2u]) == Approx(int(expected[4u * i + 0u])).margin(24));
+      CHECK(actual[4u * i + 3u] == 0xFF);
+    }
+  }
+}
+} // namespace Assets
+} // namespace TrenchBroom
@@ -0,0 +1,194 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestLogger.h"
+
+#include "Assets/Texture.h"
+#include "Assets/TextureBuffer.h"
+#include "Assets/TextureCollection.h"
+#include "Assets/TextureManager.h"
+#include "IO/Path.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Assets
+{
+static constexpr size_t TextureSize = 16u;
+static constexpr size_t TextureBytes = TextureSize * TextureSize * 4u;
+
+static Texture makeTexture(const std::string& name)
+{
+  return Texture{
+    name,
+    TextureSize,
+    TextureSize,
+    Color{},
+    TextureBuffer{TextureBytes},
+    GL_RGBA,
+    TextureType::Opaque};
+}
+
+static Texture makeEvictableTexture(const std::string& name)
+{
+  auto texture = makeTexture(name);
+  texture.setLoader([=]() { return makeTexture(name); });
+  return texture;
+}
+
+static size_t countResidentTextures(const TextureManager& manager)
+{
+  return static_cast<size_t>(std::count_if(
+    std::begin(manager.textures()),
+    std::end(manager.textures()),
+    [](const auto* texture) { return texture->residentSize() > 0u; }));
+}
+
+TEST_CASE("TextureManagerTest.evictTextures", "[TextureManagerTest]")
+{
+  TestLogger logger;
+
+  auto textures = std::vector<Texture>{};
+  textures.push_back(makeEvictableTexture("a"));
+  textures.push_back(makeEvictableTexture("b"));
+  textures.push_back(makeEvictableTexture("c"));
+
+  auto collections = std::vector<TextureCollection>{};
+  collections.emplace_back(IO::Path{"textures"}, std::move(textures));
+
+  TextureManager manager(0, 0, logger);
+  manager.setTextureCollections(std::move(collections));
+  REQUIRE(manager.textures().size() == 3u);
+  REQUIRE(manager.textures().front()->residentSize() == TextureBytes);
+
+  // textures that were never activated are not protected by the recency window
+  const auto now = std::chrono::steady_clock::time_point{} + std::chrono::hours{1};
+
+  SECTION("Textures are not evicted if they fit into the cache")
+  {
+    manager.setCacheSize(3u * TextureBytes);
+    manager.evictTextures(now);
+    CHECK(countResidentTextures(manager) == 3u);
+  }
+
+  SECTION("Textures are evicted until they fit into the cache")
+  {
+    manager.setCacheSize(2u * TextureBytes);
+    manager.evictTextures(now);
+    CHECK(countResidentTextures(manager) == 2u);
+
+    manager.setCacheSize(0u);
+    manager.evictTextures(now + std::chrono::seconds{1});
+    CHECK(countResidentTextures(manager) == 0u);
+    CHECK(manager.texture("a")->buffersIfUnprepared().empty());
+  }
+
+  SECTION("Textures are evicted at most once per second")
+  {
+    manager.setCacheSize(3u * TextureBytes);
+    manager.evictTextures(now);
+
+    manager.setCacheSize(0u);
+    manager.evictTextures(now + std::chrono::milliseconds{500});
+    CHECK(countResidentTextures(manager) == 3u);
+
+    manager.evictTextures(now + std::chrono::seconds{1});
+    CHECK(countResidentTextures(manager) == 0u);
+  }
+}
+
+TEST_CASE("TextureManagerTest.evictTexturesWithoutLoader", "[TextureManagerTest]")
+{
+  TestLogger logger;
+
+  auto textures = std::vector<Texture>{};
+  textures.push_back(makeEvictableTexture("a"));
+  textures.push_back(makeTexture("b"));
+
+  // textures without a loader would be uploaded when they are prepared
+  auto collections = std::vector<TextureCollection>{};
+  collections.emplace_back(std::move(textures));
+
+  TextureManager manager(0, 0, logger);
+  manager.setTextureCollections(std::move(collections));
+  manager.setCacheSize(0u);
+  manager.evictTextures(std::chrono::steady_clock::time_point{} + std::chrono::hours{1});
+
+  CHECK(manager.texture("a")->residentSize() == 0u);
+  CHECK(manager.texture("b")->residentSize() == TextureBytes);
+}
+
+TEST_CASE("TextureManagerTest.compressTextures", "[TextureManagerTest]")
+{
+  TestLogger logger;
+
+  auto textures = std::vector<Texture>{};
+  textures.push_back(makeTexture("opaque"));
+  textures.push_back(Texture{
+    "masked",
+    TextureSize,
+    TextureSize,
+    Color{},
+    TextureBuffer{TextureBytes},
+    GL_RGBA,
+    TextureType::Masked});
+  textures.push_back(Texture{
+    "odd", 6u, 6u, Color{}, TextureBuffer{6u * 6u * 4u}, GL_RGBA, TextureType::Opaque});
+
+  auto collections = std::vector<TextureCollection>{};
+  collections.emplace_back(IO::Path{"textures"}, std::move(textures));
+
+  TextureManager manager(0, 0, logger);
+
+  SECTION("Textures are not compressed by default")
+  {
+    manager.setTextureCollections(std::move(collections));
+    CHECK_FALSE(manager.texture("opaque")->compressed());
+  }
+
+  SECTION("Only opaque textures with a size that is a multiple of 4 are compressed")
+  {
+    manager.setCompressTextures(true);
+    manager.setTextureCollections(std::move(collections));
+
+    const auto* opaque = manager.texture("opaque");
+    CHECK(opaque->compressed());
+    CHECK(opaque->format() == GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+
+    // mipmaps were generated down to 1x1 pixels, and every level is at least one block
+    const auto& buffers = opaque->buffersIfUnprepared();
+    REQUIRE(buffers.size() == 5u);
+    CHECK(buffers[0].size() == 16u * 8u);
+    CHECK(buffers[1].size() == 4u * 8u);
+    CHECK(buffers[2].size() == 8u);
+    CHECK(buffers[3].size() == 8u);
+    CHECK(buffers[4].size() == 8u);
+
+    CHECK_FALSE(manager.texture("masked")->compressed());
+    CHECK_FALSE(manager.texture("odd")->compressed());
+  }
+}
+} // namespace Assets
+} // namespace TrenchBroom
@@ -106,6 +106,35 @@ TEST_CASE("DiskTest.fixPath", "[DiskTest]")
     Disk::fixPath(env.dir() + Path("anotHERDIR/./SUBdirTEST/../SubdirTesT/TesT2.MAP")))));
 }
 
+TEST_CASE("DiskTest.fixPathAfterChangingDirectory", "[DiskTest]")
+{
+  auto env = makeTestEnvironment();
+
+  if (Disk::isCaseSensitive())
+  {
+    // the directory contents are cached, make sure that changes are picked up
+    CHECK(
+      env.dir() + Path("ANOTHERdir/TEST4.MAP")
+      == Disk::fixPath(env.dir() + Path("ANOTHERdir/TEST4.MAP")));
+
+    env.createFile(Path("anotherDir/test4.map"), "//new test file\n{}");
+    CHECK(
+      env.dir() + Path("anotherDir/test4.map")
+      == Disk::fixPath(env.dir() + Path("ANOTHERdir/TEST4.MAP")));
+
+    Disk::deleteFile(env.dir() + Path("anotherDir/test4.map"));
+    CHECK(
+      env.dir() + Path("ANOTHERdir/TEST4.MAP")
+      == Disk::fixPath(env.dir() + Path("ANOTHERdir/TEST4.MAP")));
+
+    // paths are still fixed after the cached directory contents have been discarded
+    Disk::clearDirectoryCache();
+    CHECK(
+      env.dir() + Path("anotherDir/test3.map")
+      == Disk::fixPath(env.dir() + Path("ANOTHERdir/TEST3.MAP")));
+  }
+}
+
 TEST_CASE("DiskTest.directoryExists", "[DiskTest]")
 {
   const auto env = makeTestEnvironment();
@@ -0,0 +1,232 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Assets/EntityModel.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureBuffer.h"
+#include "Color.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/DiskIO.h"
+#include "IO/EntityModelCache.h"
+#include "IO/Path.h"
+#include "IO/TestEnvironment.h"
+#include "Logger.h"
+#include "Renderer/IndexRangeMap.h"
+#include "Renderer/GLVertex.h"
+#include "Renderer/PrimType.h"
+
+#include <kdl/vector_utils.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace IO
+{
+static const auto ModelPath = Path{"model.mdl"};
+
+static std::vector<Assets::EntityModelVertex> makeVertices(const float offset)
+{
+  return {
+    Assets::EntityModelVertex{vm::vec3f{offset, 0, 0}, vm::vec2f{0, 0}},
+    Assets::EntityModelVertex{vm::vec3f{offset, 1, 0}, vm::vec2f{1, 0}},
+    Assets::EntityModelVertex{vm::vec3f{offset, 0, 1}, vm::vec2f{0, 1}},
+  };
+}
+
+static void loadFrame(Assets::EntityModel& model, const size_t frameIndex)
+{
+  const auto offset = static_cast<float>(frameIndex);
+  auto& frame = model.loadFrame(
+    frameIndex,
+    "frame" + std::to_string(frameIndex),
+    vm::bbox3f{vm::vec3f{offset, 0, 0}, vm::vec3f{offset, 1, 1}});
+  model.surface(0).addIndexedMesh(
+    frame,
+    makeVertices(offset),
+    Assets::EntityModelIndices{Renderer::PrimType::Triangles, 0, 3});
+}
+
+static std::unique_ptr<Assets::EntityModel> makeModel()
+{
+  auto model = std::make_unique<Assets::EntityModel>(
+    "model", Assets::PitchType::MdlInverted, Assets::Orientation::Oriented);
+  model->addFrame();
+  model->addFrame();
+
+  auto skins = std::vector<Assets::Texture>{};
+  auto buffer = Assets::TextureBuffer{2u * 2u * 4u};
+  std::fill(buffer.data(), buffer.data() + buffer.size(), 0x7f);
+  skins.emplace_back(
+    "skin",
+    2u,
+    2u,
+    Color{1.0f, 0.0f, 0.0f, 1.0f},
+    std::move(buffer),
+    GL_RGBA,
+    Assets::TextureType::Opaque);
+
+  model->addSurface("surface").setSkins(std::move(skins));
+  loadFrame(*model, 0);
+  return model;
+}
+
+static std::vector<vm::vec3f> positions(
+  const std::vector<Assets::EntityModelVertex>& vertices)
+{
+  return kdl::vec_transform(
+    vertices, [](const auto& vertex) { return Renderer::getVertexComponent<0>(vertex); });
+}
+
+static std::vector<vm::vec3f> meshPositions(
+  const Assets::EntityModel& model, const size_t frameIndex)
+{
+  auto result = std::vector<vm::vec3f>{};
+  model.surfaces().front()->visitMesh(
+    frameIndex,
+    [&](const auto& vertices, const auto&) { result = positions(vertices); },
+    [](const auto&, const auto&) {});
+  return result;
+}
+
+TEST_CASE("EntityModelCacheTest.readModel", "[EntityModelCacheTest]")
+{
+  auto env = TestEnvironment{[](TestEnvironment& e) {
+    e.createFile(ModelPath, "model data");
+    e.createFile(Path{"skin.tga"}, "skin data");
+  }};
+
+  const auto fs = DiskFileSystem{env.dir()};
+  const auto cacheDir = env.dir() + Path{"cache"};
+  auto logger = NullLogger{};
+
+  {
+    auto model = makeModel();
+    auto cache = EntityModelCache{cacheDir};
+    cache.writeModel(fs, ModelPath, {ModelPath, Path{"skin.tga"}}, {}, *model, logger);
+
+    loadFrame(*model, 1);
+    cache.writeFrame(ModelPath, 1, *model, logger);
+  }
+
+  auto cache = EntityModelCache{cacheDir};
+  auto hashes = EntityModelCache::FileHashes{};
+
+  SECTION("Cached model is read if its sources are unchanged")
+  {
+    auto model = cache.readModel(fs, ModelPath, hashes, logger);
+    REQUIRE(model != nullptr);
+    CHECK(hashes.size() == 2u);
+
+    CHECK(model->name() == "model");
+    CHECK(model->pitchType() == Assets::PitchType::MdlInverted);
+    CHECK(model->frameCount() == 2u);
+    CHECK(model->surfaceCount() == 1u);
+
+    const auto* surface = model->surfaces().front();
+    CHECK(surface->name() == "surface");
+    REQUIRE(surface->skinCount() == 1u);
+    CHECK(surface->skin(0)->name() == "skin");
+    CHECK(surface->skin(0)->width() == 2u);
+    CHECK(surface->skin(0)->averageColor() == Color{1.0f, 0.0f, 0.0f, 1.0f});
+    CHECK(surface->skin(0)->buffersIfUnprepared().front().data()[0] == 0x7f);
+
+    REQUIRE(model->frame(0)->loaded());
+    CHECK(model->frame(0)->name() == "frame0");
+    CHECK(meshPositions(*model, 0) == positions(makeVertices(0.0f)));
+
+    // frames loaded after the model was written are stored separately
+    CHECK_FALSE(model->frame(1)->loaded());
+    CHECK(cache.readFrame(ModelPath, 1, *model, logger));
+    REQUIRE(model->frame(1)->loaded());
+    CHECK(model->frame(1)->bounds() == vm::bbox3f{vm::vec3f{1, 0, 0}, vm::vec3f{1, 1, 1}});
+    CHECK(meshPositions(*model, 1) == positions(makeVertices(1.0f)));
+  }
+
+  SECTION("Cached model is not read if a source has changed")
+  {
+    env.createFile(Path{"skin.tga"}, "other skin data");
+    CHECK(cache.readModel(fs, ModelPath, hashes, logger) == nullptr);
+
+    // the hashes of the checked files are passed on to writeModel
+    CHECK(hashes.count(ModelPath) == 1u);
+    CHECK(hashes.count(Path{"skin.tga"}) == 1u);
+  }
+
+  SECTION("Cached frames are not read after a model has become out of date")
+  {
+    REQUIRE(cache.readModel(fs, ModelPath, hashes, logger) != nullptr);
+
+    env.createFile(Path{"skin.tga"}, "other skin data");
+    REQUIRE(cache.readModel(fs, ModelPath, hashes, logger) == nullptr);
+
+    auto model = makeModel();
+    CHECK_FALSE(cache.readFrame(ModelPath, 1, *model, logger));
+  }
+
+  SECTION("Missing cache files are remembered until they are written")
+  {
+    const auto otherPath = Path{"other.mdl"};
+    env.createFile(otherPath, "other model data");
+    CHECK(cache.readModel(fs, otherPath, hashes, logger) == nullptr);
+
+    auto model = makeModel();
+    cache.writeModel(fs, otherPath, {otherPath}, hashes, *model, logger);
+    CHECK(cache.readModel(fs, otherPath, hashes, logger) != nullptr);
+  }
+
+  SECTION("Cached frames are not read for models that were not read from the cache")
+  {
+    auto model = makeModel();
+    CHECK_FALSE(cache.readFrame(ModelPath, 1, *model, logger));
+  }
+}
+
+TEST_CASE("EntityModelCacheTest.prune", "[EntityModelCacheTest]")
+{
+  const auto env = TestEnvironment{[](TestEnvironment& e) {
+    e.createDirectory(Path{"cache"});
+    e.createFile(Path{"cache/a.model"}, "0123456789");
+    e.createFile(Path{"cache/b.model"}, "0123456789");
+    e.createFile(Path{"cache/c.model"}, "0123456789");
+  }};
+
+  const auto cacheDir = env.dir() + Path{"cache"};
+
+  SECTION("Files are kept if the cache is not too large")
+  {
+    EntityModelCache{cacheDir, 30u};
+    CHECK(Disk::findItems(cacheDir).size() == 3u);
+  }
+
+  SECTION("Files are deleted if the cache is too large")
+  {
+    EntityModelCache{cacheDir, 25u};
+    CHECK(Disk::findItems(cacheDir).size() == 2u);
+  }
+}
+} // namespace IO
+} // namespace TrenchBroom
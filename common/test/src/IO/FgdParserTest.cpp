@@ -1084,5 +1084,48 @@ TEST_CASE("FgdParserTest.parseStringContinuations", "[FgdParserTest]")
 
   kdl::vec_clear_and_delete(definitions);
 }
+
+TEST_CASE("FgdParserTest.parseSameFileTwice", "[FgdParserTest]")
+{
+  const std::string file =
+    "@PointClass color(0 255 0) color(255 0 0) = cached_entity : \"Cached\" []\n";
+
+  const Color defaultColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+  // the second parser uses the cached class infos and replays the parser messages
+  for (size_t i = 0u; i < 2u; ++i)
+  {
+    FgdParser parser(file, defaultColor);
+
+    TestParserStatus status;
+    auto definitions = parser.parseDefinitions(status);
+    CHECK(definitions.size() == 1u);
+    CHECK(definitions.front()->name() == "cached_entity");
+    CHECK(status.countStatus(LogLevel::Warn) == 1u);
+
+    kdl::vec_clear_and_delete(definitions);
+  }
+}
+
+TEST_CASE("FgdParserTest.parseSameNestedIncludeTwice", "[FgdParserTest]")
+{
+  const Path path = Disk::getCurrentWorkingDir()
+                    + Path("fixture/test/IO/Fgd/parseNestedInclude/host.fgd");
+  auto file = Disk::openFile(path);
+  auto reader = file->reader().buffer();
+
+  const Color defaultColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+  for (size_t i = 0u; i < 2u; ++i)
+  {
+    FgdParser parser(reader.stringView(), defaultColor, file->path());
+
+    TestParserStatus status;
+    auto defs = parser.parseDefinitions(status);
+    CHECK(defs.size() == 3u);
+
+    kdl::vec_clear_and_delete(defs);
+  }
+}
 } // namespace IO
 } // namespace TrenchBroom
@@ -21,6 +21,8 @@
 #include "Exceptions.h"
 #include "IO/PathQt.h"
 
+#include <kdl/string_compare.h>
+
 #include <string>
 
 #include "Catch2.h"
@@ -388,6 +390,28 @@ TEST_CASE("PathTest.operatorLT", "[PathTest]")
   CHECK(Path("dir/dir") < Path("dir/dir2"));
   CHECK_FALSE(Path("dir/dir2") < Path("dir/dir2"));
   CHECK_FALSE(Path("dir/dir2/dir3") < Path("dir/dir2"));
+  // components are compared separately
+  CHECK(Path("dir/dir2") < Path("dir-2"));
+  CHECK_FALSE(Path("dir-2") < Path("dir/dir2"));
+}
+
+TEST_CASE("PathTest.less", "[PathTest]")
+{
+  const auto csLess = Path::Less<kdl::cs::string_less>{};
+  CHECK_FALSE(csLess(Path(""), Path("")));
+  CHECK_FALSE(csLess(Path("dir"), Path("dir")));
+  CHECK(csLess(Path(""), Path("dir")));
+  CHECK(csLess(Path("DIR"), Path("dir")));
+  CHECK(csLess(Path("dir"), Path("dir/dir2")));
+  CHECK(csLess(Path("dir/dir2"), Path("dir-2")));
+  CHECK_FALSE(csLess(Path("dir/dir2/dir3"), Path("dir/dir2")));
+
+  const auto ciLess = Path::Less<kdl::ci::string_less>{};
+  CHECK_FALSE(ciLess(Path("DIR"), Path("dir")));
+  CHECK_FALSE(ciLess(Path("dir"), Path("DIR")));
+  CHECK(ciLess(Path("DIR"), Path("dir/dir2")));
+  CHECK(ciLess(Path("dir/DIR"), Path("Dir/dir2")));
+  CHECK_FALSE(ciLess(Path("Dir/dir2"), Path("dir/DIR")));
 }
 
 TEST_CASE("PathTest.pathAsQString", "[PathTest]")
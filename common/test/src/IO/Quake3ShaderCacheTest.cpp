@@ -0,0 +1,125 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Assets/Quake3Shader.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/Path.h"
+#include "IO/Quake3ShaderCache.h"
+#include "IO/TestEnvironment.h"
+#include "Logger.h"
+
+#include <string>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace IO
+{
+static const auto ScriptPath = Path{"scripts/test.shader"};
+static const auto OtherScriptPath = Path{"scripts/other.shader"};
+static const auto ShaderSearchPath = Path{"scripts"};
+
+static Assets::Quake3Shader makeShader()
+{
+  auto shader = Assets::Quake3Shader();
+  shader.shaderPath = Path{"textures/test/shader"};
+  shader.editorImage = Path{"textures/test/editor.tga"};
+  shader.culling = Assets::Quake3Shader::Culling::None;
+  shader.surfaceParms = {"nodraw", "trans"};
+
+  auto& stage = shader.addStage();
+  stage.map = Path{"textures/test/stage.tga"};
+  stage.blendFunc.srcFactor = Assets::Quake3ShaderStage::BlendFunc::One;
+  stage.blendFunc.destFactor = Assets::Quake3ShaderStage::BlendFunc::Zero;
+  return shader;
+}
+
+TEST_CASE("Quake3ShaderCacheTest.readScripts", "[Quake3ShaderCacheTest]")
+{
+  auto env = TestEnvironment{[](TestEnvironment& e) {
+    e.createDirectory(ShaderSearchPath);
+    e.createFile(ScriptPath, "shader script");
+    e.createFile(OtherScriptPath, "other shader script");
+  }};
+
+  const auto fs = DiskFileSystem{env.dir()};
+  const auto cacheDir = env.dir() + Path{"cache"};
+  const auto paths = std::vector<Path>{ScriptPath, OtherScriptPath};
+  auto logger = NullLogger{};
+
+  const auto script =
+    Quake3ShaderScript{ScriptPath, {makeShader()}, {{LogLevel::Warn, "warning"}}, ""};
+  const auto otherScript = Quake3ShaderScript{OtherScriptPath, {}, {}, "error"};
+
+  const auto hostFiles = Quake3ShaderCache::findHostFiles(fs, paths);
+  REQUIRE(hostFiles.size() == 2u);
+  CHECK(hostFiles.at(ScriptPath).path == env.dir() + ScriptPath);
+  CHECK(hostFiles.at(ScriptPath).size == 13u);
+
+  {
+    auto cache = Quake3ShaderCache{cacheDir};
+    cache.writeScripts(ShaderSearchPath, {script, otherScript}, hostFiles, logger);
+  }
+
+  auto cache = Quake3ShaderCache{cacheDir};
+
+  SECTION("Cached scripts are read if their host files are unchanged")
+  {
+    const auto cachedScripts = cache.readScripts(ShaderSearchPath, hostFiles, logger);
+    REQUIRE(cachedScripts.size() == 2u);
+
+    const auto& cachedScript = cachedScripts.at(ScriptPath);
+    CHECK(cachedScript.path == ScriptPath);
+    CHECK(cachedScript.shaders == script.shaders);
+    CHECK(cachedScript.messages == script.messages);
+    CHECK(cachedScript.error.empty());
+
+    CHECK(cachedScripts.at(OtherScriptPath).error == "error");
+  }
+
+  SECTION("Cached scripts are not read if their host files have changed")
+  {
+    env.createFile(ScriptPath, "changed shader script");
+
+    const auto cachedScripts = cache.readScripts(
+      ShaderSearchPath, Quake3ShaderCache::findHostFiles(fs, paths), logger);
+    CHECK(cachedScripts.count(ScriptPath) == 0u);
+    CHECK(cachedScripts.count(OtherScriptPath) == 1u);
+  }
+
+  SECTION("Scripts without host files are not cached")
+  {
+    auto otherHostFiles = hostFiles;
+    otherHostFiles.erase(OtherScriptPath);
+    cache.writeScripts(ShaderSearchPath, {script, otherScript}, otherHostFiles, logger);
+
+    const auto cachedScripts = cache.readScripts(ShaderSearchPath, hostFiles, logger);
+    CHECK(cachedScripts.count(ScriptPath) == 1u);
+    CHECK(cachedScripts.count(OtherScriptPath) == 0u);
+  }
+
+  SECTION("Scripts are not read for other shader search paths")
+  {
+    CHECK(cache.readScripts(Path{"other"}, hostFiles, logger).empty());
+  }
+}
+} // namespace IO
+} // namespace TrenchBroom
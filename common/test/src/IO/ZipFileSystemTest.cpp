@@ -21,10 +21,18 @@
 #include "Exceptions.h"
 #include "IO/DiskFileSystem.h"
 #include "IO/DiskIO.h"
+#include "IO/File.h"
 #include "IO/FileMatcher.h"
+#include "IO/Reader.h"
+
+#include <kdl/parallel.h>
+#include <kdl/string_compare.h>
+#include <kdl/vector_utils.h>
 
 #include <algorithm>
 #include <cassert>
+#include <string>
+#include <vector>
 
 #include "Catch2.h"
 
@@ -156,5 +164,51 @@ TEST_CASE("ZipFileSystemTest.openFile", "[ZipFileSystemTest]")
 
   CHECK(fs.openFile(Path("amnet.cfg")) != nullptr);
 }
+
+TEST_CASE("ZipFileSystemTest.readFile", "[ZipFileSystemTest]")
+{
+  const Path zipPath =
+    Disk::getCurrentWorkingDir() + Path("fixture/test/IO/Zip/zip_test.zip");
+
+  const ZipFileSystem fs(zipPath);
+
+  const auto file = fs.openFile(Path("amnet.cfg"));
+  CHECK(file->size() == 447u);
+
+  auto reader = file->reader().buffer();
+  CHECK(reader.size() == 447u);
+  CHECK(kdl::cs::str_is_prefix(reader.stringView(), "//\r\n// my stuff\r\n"));
+
+  // reopening the file yields the same contents
+  auto otherReader = fs.openFile(Path("amnet.cfg"))->reader().buffer();
+  CHECK(otherReader.stringView() == reader.stringView());
+}
+
+TEST_CASE("ZipFileSystemTest.readFilesInParallel", "[ZipFileSystemTest]")
+{
+  const Path zipPath =
+    Disk::getCurrentWorkingDir() + Path("fixture/test/IO/Zip/zip_test.zip");
+
+  const ZipFileSystem fs(zipPath);
+
+  const auto paths = fs.findItemsRecursively(Path(""), FileExtensionMatcher("wal"));
+  const auto files =
+    kdl::vec_transform(paths, [&](const auto& path) { return fs.openFile(path); });
+
+  // the files are decompressed when they are read
+  const auto contents = kdl::vec_parallel_transform(files, [](const auto& file) {
+    auto reader = file->reader().buffer();
+    return std::string{reader.stringView()};
+  });
+
+  REQUIRE(contents.size() == files.size());
+  for (size_t i = 0u; i < files.size(); ++i)
+  {
+    CHECK(contents[i].size() == files[i]->size());
+
+    auto reader = fs.openFile(paths[i])->reader().buffer();
+    CHECK(reader.stringView() == contents[i]);
+  }
+}
 } // namespace IO
 } // namespace TrenchBroom
@@ -0,0 +1,200 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Model/EntityNode.h"
+#include "Model/EntityNodeStringIndex.h"
+
+#include <kdl/vector_utils.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Model
+{
+TEST_CASE("EntityNodeStringIndexTest.findExact", "[EntityNodeStringIndexTest]")
+{
+  auto node1 = std::make_unique<EntityNode>(Entity{});
+  auto node2 = std::make_unique<EntityNode>(Entity{});
+
+  EntityNodeStringIndex index;
+  CHECK(index.empty());
+
+  index.insert("light", node1.get());
+  index.insert("light", node2.get());
+  index.insert("light_torch", node2.get());
+  CHECK_FALSE(index.empty());
+
+  CHECK_THAT(
+    index.findExact("light"),
+    Catch::UnorderedEquals(std::vector<EntityNodeBase*>{node1.get(), node2.get()}));
+  CHECK(index.findExact("light_torch") == std::vector<EntityNodeBase*>{node2.get()});
+  CHECK(index.findExact("ligh").empty());
+  CHECK(index.findExact("light*").empty());
+}
+
+TEST_CASE("EntityNodeStringIndexTest.findPrefix", "[EntityNodeStringIndexTest]")
+{
+  auto node1 = std::make_unique<EntityNode>(Entity{});
+  auto node2 = std::make_unique<EntityNode>(Entity{});
+
+  EntityNodeStringIndex index;
+  index.insert("light", node1.get());
+  index.insert("light_torch", node2.get());
+  index.insert("light_flame", node2.get());
+  index.insert("info_player_start", node1.get());
+
+  CHECK_THAT(
+    index.findPrefix("light"),
+    Catch::UnorderedEquals(std::vector<EntityNodeBase*>{node1.get(), node2.get()}));
+  CHECK(index.findPrefix("light_") == std::vector<EntityNodeBase*>{node2.get()});
+  CHECK(index.findPrefix("info") == std::vector<EntityNodeBase*>{node1.get()});
+  CHECK(index.findPrefix("func").empty());
+  CHECK(index.findPrefix("").size() == 2u);
+}
+
+TEST_CASE("EntityNodeStringIndexTest.findNumbered", "[EntityNodeStringIndexTest]")
+{
+  auto node1 = std::make_unique<EntityNode>(Entity{});
+  auto node2 = std::make_unique<EntityNode>(Entity{});
+  auto node3 = std::make_unique<EntityNode>(Entity{});
+
+  EntityNodeStringIndex index;
+  index.insert("target", node1.get());
+  index.insert("target12", node2.get());
+  index.insert("target1a", node3.get());
+  index.insert("targetname", node3.get());
+
+  CHECK_THAT(
+    index.findNumbered("target"),
+    Catch::UnorderedEquals(std::vector<EntityNodeBase*>{node1.get(), node2.get()}));
+  CHECK(index.findNumbered("target1") == std::vector<EntityNodeBase*>{node2.get()});
+  CHECK(index.findNumbered("killtarget").empty());
+}
+
+TEST_CASE("EntityNodeStringIndexTest.remove", "[EntityNodeStringIndexTest]")
+{
+  auto node1 = std::make_unique<EntityNode>(Entity{});
+  auto node2 = std::make_unique<EntityNode>(Entity{});
+
+  EntityNodeStringIndex index;
+
+  SECTION("Removing a string that was never inserted does nothing")
+  {
+    index.insert("value", node1.get());
+    index.remove("other", node1.get());
+    index.remove("value", node2.get());
+    CHECK(index.findExact("value") == std::vector<EntityNodeBase*>{node1.get()});
+  }
+
+  SECTION("Removing a node keeps the other nodes of the string")
+  {
+    index.insert("value", node1.get());
+    index.insert("value", node2.get());
+    index.remove("value", node1.get());
+    CHECK(index.findExact("value") == std::vector<EntityNodeBase*>{node2.get()});
+    CHECK(index.keys() == std::vector<std::string>{"value"});
+
+    index.remove("value", node2.get());
+    CHECK(index.findExact("value").empty());
+    CHECK(index.keys().empty());
+    CHECK(index.empty());
+  }
+
+  SECTION("Nodes inserted multiple times must be removed as often")
+  {
+    index.insert("value", node1.get());
+    index.insert("value", node1.get());
+    CHECK(index.findExact("value") == std::vector<EntityNodeBase*>{node1.get()});
+
+    index.remove("value", node1.get());
+    CHECK(index.findExact("value") == std::vector<EntityNodeBase*>{node1.get()});
+
+    index.remove("value", node1.get());
+    CHECK(index.findExact("value").empty());
+  }
+}
+
+TEST_CASE("EntityNodeStringIndexTest.manyStrings", "[EntityNodeStringIndexTest]")
+{
+  auto nodes = std::vector<std::unique_ptr<EntityNode>>{};
+  for (size_t i = 0u; i < 100u; ++i)
+  {
+    nodes.push_back(std::make_unique<EntityNode>(Entity{}));
+  }
+
+  EntityNodeStringIndex index;
+  for (size_t i = 0u; i < 1000u; ++i)
+  {
+    index.insert("target" + std::to_string(i), nodes[i % nodes.size()].get());
+  }
+
+  CHECK(index.keys().size() == 1000u);
+  CHECK(index.findExact("target17") == std::vector<EntityNodeBase*>{nodes[17].get()});
+  CHECK(index.findNumbered("target").size() == nodes.size());
+
+  // remove enough strings to trigger compaction of the index
+  for (size_t i = 0u; i < 900u; ++i)
+  {
+    index.remove("target" + std::to_string(i), nodes[i % nodes.size()].get());
+  }
+
+  CHECK(index.keys().size() == 100u);
+  CHECK(index.findExact("target17").empty());
+  CHECK(index.findExact("target917") == std::vector<EntityNodeBase*>{nodes[17].get()});
+  CHECK(index.findPrefix("target9").size() == nodes.size());
+  CHECK(index.findPrefix("target91").size() == 10u);
+  CHECK(index.findPrefix("target1").empty());
+
+  index.insert("target17", nodes[17].get());
+  CHECK(index.findExact("target17") == std::vector<EntityNodeBase*>{nodes[17].get()});
+  CHECK(index.findPrefix("target1") == std::vector<EntityNodeBase*>{nodes[17].get()});
+  CHECK(index.keys().size() == 101u);
+}
+
+TEST_CASE("EntityNodeStringIndexTest.insertAfterQuery", "[EntityNodeStringIndexTest]")
+{
+  auto node1 = std::make_unique<EntityNode>(Entity{});
+  auto node2 = std::make_unique<EntityNode>(Entity{});
+  auto node3 = std::make_unique<EntityNode>(Entity{});
+
+  EntityNodeStringIndex index;
+  index.insert("light2", node2.get());
+  index.insert("monster", node3.get());
+  CHECK(index.findPrefix("light") == std::vector<EntityNodeBase*>{node2.get()});
+
+  // strings inserted after a query must be merged into the sorted strings
+  index.insert("light1", node1.get());
+  index.insert("a", node3.get());
+  index.insert("light3", node3.get());
+
+  CHECK_THAT(
+    index.findPrefix("light"),
+    Catch::UnorderedEquals(
+      std::vector<EntityNodeBase*>{node1.get(), node2.get(), node3.get()}));
+  CHECK(index.findNumbered("light") == index.findPrefix("light"));
+  CHECK(index.findPrefix("a") == std::vector<EntityNodeBase*>{node3.get()});
+  CHECK(index.findPrefix("m") == std::vector<EntityNodeBase*>{node3.get()});
+}
+} // namespace Model
+} // namespace TrenchBroom
@@ -0,0 +1,128 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Exceptions.h"
+#include "IO/DiskIO.h"
+#include "IO/File.h"
+#include "IO/Path.h"
+#include "IO/TestEnvironment.h"
+#include "Logger.h"
+#include "Model/GameConfig.h"
+#include "Model/GameFileSystem.h"
+
+#include <string>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Model
+{
+static GameConfig makeConfig()
+{
+  return GameConfig{
+    "Quake2",
+    IO::Path{},
+    IO::Path{},
+    false,
+    {},
+    FileSystemConfig{IO::Path{"baseq2"}, PackageFormatConfig{}},
+    TextureConfig{
+      TextureDirectoryPackageConfig{IO::Path{"textures"}},
+      PackageFormatConfig{{"wal"}, "wal"},
+      IO::Path{"pics/colormap.pcx"},
+      "_tb_textures",
+      IO::Path{},
+      std::vector<std::string>{}},
+    EntityConfig{},
+    FaceAttribsConfig{},
+    std::vector<SmartTag>{},
+    std::nullopt, // soft map bounds
+    {}            // compilation tools
+  };
+}
+
+TEST_CASE("GameFileSystemTest.findFiles", "[GameFileSystemTest]")
+{
+  const auto config = makeConfig();
+  const auto gamePath =
+    IO::Disk::getCurrentWorkingDir() + IO::Path("fixture/test/Model/Game/Quake2");
+  auto logger = NullLogger();
+
+  auto fs = GameFileSystem{};
+  fs.initialize(config, gamePath, {}, logger);
+
+  // repeated lookups are answered from the cache and must yield the same results
+  for (size_t i = 0u; i < 2u; ++i)
+  {
+    CHECK(fs.fileExists(IO::Path("textures/lavatest.wal")));
+    CHECK(fs.fileExists(IO::Path("TEXTURES/LavaTest.wal")));
+    CHECK(fs.fileExists(IO::Path("textures/e1m1/f1/b_rc_v4.wal")));
+    CHECK_FALSE(fs.fileExists(IO::Path("textures/missing.wal")));
+    CHECK_FALSE(fs.fileExists(IO::Path("textures")));
+
+    CHECK(fs.openFile(IO::Path("textures/lavatest.wal")) != nullptr);
+    CHECK_THROWS_AS(fs.openFile(IO::Path("textures/missing.wal")), FileSystemException);
+  }
+
+  SECTION("Reinitializing the file system clears the cache")
+  {
+    fs.initialize(config, IO::Path{}, {}, logger);
+    CHECK_FALSE(fs.fileExists(IO::Path("textures/lavatest.wal")));
+    CHECK_THROWS_AS(
+      fs.openFile(IO::Path("textures/lavatest.wal")), FileSystemException);
+  }
+}
+
+TEST_CASE("GameFileSystemTest.findAddedFiles", "[GameFileSystemTest]")
+{
+  auto env = IO::TestEnvironment{
+    [](IO::TestEnvironment& e) { e.createDirectory(IO::Path{"baseq2/textures"}); }};
+
+  const auto config = makeConfig();
+  auto logger = NullLogger();
+
+  auto fs = GameFileSystem{};
+  fs.initialize(config, env.dir(), {}, logger);
+
+  const auto path = IO::Path{"textures/added.wal"};
+  CHECK_FALSE(fs.fileExists(path));
+
+  env.createFile(IO::Path{"baseq2"} + path, "texture");
+
+  // the failed lookup is cached until the cache is cleared
+  CHECK_FALSE(fs.fileExists(path));
+
+  SECTION("Clearing the file owners")
+  {
+    fs.clearFileOwners();
+    CHECK(fs.fileExists(path));
+    CHECK(fs.openFile(path) != nullptr);
+  }
+
+  SECTION("Reloading shaders")
+  {
+    fs.reloadShaders();
+    CHECK(fs.fileExists(path));
+    CHECK(fs.openFile(path) != nullptr);
+  }
+}
+} // namespace Model
+} // namespace TrenchBroom
@@ -23,6 +23,7 @@
 #include "Model/Polyhedron_DefaultPayload.h"
 #include "Model/Polyhedron_Instantiation.h"
 
+#include <vecmath/approx.h>
 #include <vecmath/plane.h>
 #include <vecmath/scalar.h>
 #include <vecmath/vec.h>
@@ -507,6 +508,23 @@ TEST_CASE("PolyhedronTest.swap", "[PolyhedronTest]")
   CHECK(rhs.bounds() == original.bounds());
 }
 
+TEST_CASE("PolyhedronTest.volume", "[PolyhedronTest]")
+{
+  CHECK(Polyhedron3d{}.volume() == 0.0);
+  CHECK(
+    Polyhedron3d{vm::vec3d(0, 0, 0), vm::vec3d(8, 0, 0), vm::vec3d(0, 8, 0)}.volume()
+    == 0.0);
+  CHECK(
+    Polyhedron3d{
+      vm::vec3d(0, 0, 0), vm::vec3d(6, 0, 0), vm::vec3d(0, 6, 0), vm::vec3d(0, 0, 6)}
+      .volume()
+    == vm::approx(36.0));
+  CHECK(Polyhedron3d{vm::bbox3d(8.0)}.volume() == vm::approx(4096.0));
+  CHECK(
+    Polyhedron3d{vm::bbox3d(vm::vec3d(-8, 0, 16), vm::vec3d(8, 2, 20))}.volume()
+    == vm::approx(128.0));
+}
+
 TEST_CASE("PolyhedronTest.clipCubeWithHorizontalPlane", "[PolyhedronTest]")
 {
   const vm::vec3d p1(-64.0, -64.0, -64.0);
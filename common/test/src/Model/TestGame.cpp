@@ -96,6 +96,9 @@ void TestGame::doSetAdditionalSearchPaths(
   const std::vector<IO::Path>& /* searchPaths */, Logger& /* logger */)
 {
 }
+
+void TestGame::doRefreshFileSystem() {}
+
 Game::PathErrors TestGame::doCheckAdditionalSearchPaths(
   const std::vector<IO::Path>& /* searchPaths */) const
 {
@@ -61,6 +61,7 @@ private:
   Game::SoftMapBounds doExtractSoftMapBounds(const Entity& entity) const override;
   void doSetAdditionalSearchPaths(
     const std::vector<IO::Path>& searchPaths, Logger& logger) override;
+  void doRefreshFileSystem() override;
   PathErrors doCheckAdditionalSearchPaths(
     const std::vector<IO::Path>& searchPaths) const override;
 
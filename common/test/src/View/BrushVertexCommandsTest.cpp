@@ -0,0 +1,155 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Model/Brush.h"
+#include "Model/BrushNode.h"
+#include "View/MapDocument.h"
+#include "View/MapDocumentTest.h"
+
+#include <kdl/result.h>
+#include <kdl/vector_utils.h>
+
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/polygon.h>
+#include <vecmath/segment.h>
+#include <vecmath/vec.h>
+
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace View
+{
+// enough brushes so that their handles are moved in parallel
+static constexpr size_t BrushCount = 32u;
+
+static std::vector<Model::Node*> toNodes(const std::vector<Model::BrushNode*>& brushNodes)
+{
+  return std::vector<Model::Node*>{brushNodes.begin(), brushNodes.end()};
+}
+
+TEST_CASE_METHOD(MapDocumentTest, "BrushVertexCommandsTest.moveVertices")
+{
+  auto movedBrushNodes = std::vector<Model::BrushNode*>{};
+  auto otherBrushNodes = std::vector<Model::BrushNode*>{};
+  for (size_t i = 0u; i < BrushCount; ++i)
+  {
+    movedBrushNodes.push_back(createBrushNode());
+    otherBrushNodes.push_back(createBrushNode("texture", [&](Model::Brush& brush) {
+      const auto transformation = vm::translation_matrix(vm::vec3(64, 0, 0));
+      REQUIRE(
+        brush.transform(document->worldBounds(), transformation, false).is_success());
+    }));
+  }
+
+  const auto nodes = kdl::vec_concat(toNodes(movedBrushNodes), toNodes(otherBrushNodes));
+  document->addNodes({{document->parentForNodes(), nodes}});
+  document->selectNodes(nodes);
+
+  SECTION("Moving a vertex shared by many brushes")
+  {
+    const auto result =
+      document->moveVertices({vm::vec3::fill(16.0)}, vm::vec3::fill(1.0));
+    CHECK(result.success);
+    CHECK(result.hasRemainingVertices);
+
+    for (const auto* brushNode : movedBrushNodes)
+    {
+      CHECK(brushNode->brush().hasVertex(vm::vec3::fill(17.0)));
+      CHECK_FALSE(brushNode->brush().hasVertex(vm::vec3::fill(16.0)));
+    }
+    for (const auto* brushNode : otherBrushNodes)
+    {
+      CHECK(brushNode->brush().hasVertex(vm::vec3(80, 16, 16)));
+    }
+
+    document->undoCommand();
+    for (const auto* brushNode : movedBrushNodes)
+    {
+      CHECK(brushNode->brush().hasVertex(vm::vec3::fill(16.0)));
+    }
+  }
+
+  SECTION("Moving a vertex fails if it fails for any brush")
+  {
+    // moves the vertex of the other brushes out of the world bounds
+    const auto result = document->moveVertices(
+      {vm::vec3::fill(16.0), vm::vec3(80, 16, 16)}, vm::vec3(32700, 0, 0));
+    CHECK_FALSE(result.success);
+
+    for (const auto* brushNode : movedBrushNodes)
+    {
+      CHECK(brushNode->brush().hasVertex(vm::vec3::fill(16.0)));
+    }
+    for (const auto* brushNode : otherBrushNodes)
+    {
+      CHECK(brushNode->brush().hasVertex(vm::vec3(80, 16, 16)));
+    }
+  }
+}
+
+TEST_CASE_METHOD(MapDocumentTest, "BrushVertexCommandsTest.moveEdges")
+{
+  auto brushNodes = std::vector<Model::BrushNode*>{};
+  for (size_t i = 0u; i < BrushCount; ++i)
+  {
+    brushNodes.push_back(createBrushNode());
+  }
+
+  document->addNodes({{document->parentForNodes(), toNodes(brushNodes)}});
+  document->selectNodes(toNodes(brushNodes));
+
+  const auto edge = vm::segment3(vm::vec3(-16, 16, 16), vm::vec3(16, 16, 16));
+  CHECK(document->moveEdges({edge}, vm::vec3(0, 0, 8)));
+
+  for (const auto* brushNode : brushNodes)
+  {
+    CHECK(brushNode->brush().hasEdge(edge.translate(vm::vec3(0, 0, 8))));
+  }
+}
+
+TEST_CASE_METHOD(MapDocumentTest, "BrushVertexCommandsTest.moveFaces")
+{
+  auto brushNodes = std::vector<Model::BrushNode*>{};
+  for (size_t i = 0u; i < BrushCount; ++i)
+  {
+    brushNodes.push_back(createBrushNode());
+  }
+
+  document->addNodes({{document->parentForNodes(), toNodes(brushNodes)}});
+  document->selectNodes(toNodes(brushNodes));
+
+  const auto face = vm::polygon3{
+    vm::vec3(-16, -16, 16),
+    vm::vec3(16, -16, 16),
+    vm::vec3(16, 16, 16),
+    vm::vec3(-16, 16, 16)};
+  CHECK(document->moveFaces({face}, vm::vec3(0, 0, 8)));
+
+  for (const auto* brushNode : brushNodes)
+  {
+    CHECK(brushNode->brush().hasFace(face.translate(vm::vec3(0, 0, 8))));
+    CHECK(brushNode->brush().bounds().max.z() == 24.0);
+  }
+}
+} // namespace View
+} // namespace TrenchBroom
@@ -0,0 +1,114 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "View/CellLayout.h"
+
+#include <string>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace View
+{
+static CellLayout makeLayout(const size_t itemCount)
+{
+  auto layout = CellLayout{};
+  layout.setWidth(300.0f);
+  layout.setCellWidth(100.0f, 100.0f);
+  layout.setCellHeight(100.0f, 100.0f);
+
+  layout.addGroup("group", 10.0f);
+  for (size_t i = 0; i < itemCount; ++i)
+  {
+    layout.addItem(std::to_string(i), 100.0f, 100.0f, 100.0f, 0.0f);
+  }
+  return layout;
+}
+
+static std::vector<std::string> rowItems(const LayoutRow& row)
+{
+  auto result = std::vector<std::string>{};
+  for (const auto& cell : row.cells())
+  {
+    result.push_back(cell.itemAs<std::string>());
+  }
+  return result;
+}
+
+TEST_CASE("CellLayoutTest.cellAt", "[CellLayoutTest]")
+{
+  auto layout = makeLayout(7);
+
+  const auto& group = layout.groups().front();
+  REQUIRE(group.rows().size() == 3u);
+
+  const auto& contentBounds = group.contentBounds();
+  for (size_t i = 0; i < 7; ++i)
+  {
+    const auto x = contentBounds.left() + 50.0f + float(i % 3) * 100.0f;
+    const auto y = contentBounds.top() + 50.0f + float(i / 3) * 100.0f;
+
+    const auto* cell = layout.cellAt(x, y);
+    REQUIRE(cell != nullptr);
+    CHECK(cell->itemAs<std::string>() == std::to_string(i));
+  }
+
+  CHECK(layout.cellAt(250.0f, contentBounds.top() + 250.0f) == nullptr);
+  CHECK(layout.cellAt(50.0f, contentBounds.top() + 350.0f) == nullptr);
+  CHECK(layout.cellAt(350.0f, contentBounds.top() + 50.0f) == nullptr);
+}
+
+TEST_CASE("CellLayoutTest.rowsIntersectingY", "[CellLayoutTest]")
+{
+  auto layout = makeLayout(10);
+
+  const auto& group = layout.groups().front();
+  REQUIRE(group.rows().size() == 4u);
+
+  const auto top = group.contentBounds().top();
+  const auto rows = group.rowsIntersectingY(top + 150.0f, 120.0f);
+  REQUIRE(rows.size() == 2u);
+  CHECK(rowItems(*rows[0]) == std::vector<std::string>{"3", "4", "5"});
+  CHECK(rowItems(*rows[1]) == std::vector<std::string>{"6", "7", "8"});
+
+  CHECK(group.rowsIntersectingY(top + 500.0f, 100.0f).empty());
+  CHECK(group.rowsIntersectingY(top - 1000.0f, 10.0f).empty());
+  CHECK(group.rowsIntersectingY(top - 1000.0f, 2000.0f).size() == 4u);
+
+  CHECK(group.indexOfRowAt(top + 50.0f) == 0u);
+  CHECK(group.indexOfRowAt(top + 250.0f) == 2u);
+  CHECK(group.indexOfRowAt(top + 500.0f) == 4u);
+}
+
+TEST_CASE("CellLayoutTest.setWidth", "[CellLayoutTest]")
+{
+  auto layout = makeLayout(10);
+  REQUIRE(layout.groups().front().rows().size() == 4u);
+
+  layout.setWidth(500.0f);
+
+  const auto& group = layout.groups().front();
+  REQUIRE(group.rows().size() == 2u);
+  CHECK(rowItems(group.rows()[0]) == std::vector<std::string>{"0", "1", "2", "3", "4"});
+  CHECK(rowItems(group.rows()[1]) == std::vector<std::string>{"5", "6", "7", "8", "9"});
+}
+} // namespace View
+} // namespace TrenchBroom
@@ -237,6 +237,44 @@ TEST_CASE_METHOD(MapDocumentTest, "CsgTest.csgSubtractMultipleBrushes")
   CHECK(remainder2->logicalBounds() == expectedBBox2);
 }
 
+TEST_CASE_METHOD(MapDocumentTest, "CsgTest.csgSubtractMergesConvexFragments")
+{
+  const Model::BrushBuilder builder(
+    document->world()->mapFormat(), document->worldBounds());
+
+  auto* entity = new Model::EntityNode{Model::Entity{}};
+  document->addNodes({{document->parentForNodes(), {entity}}});
+
+  Model::BrushNode* minuend = new Model::BrushNode(
+    builder.createCuboid(vm::bbox3(vm::vec3(0, 0, 0), vm::vec3(64, 64, 64)), "texture")
+      .value());
+  Model::BrushNode* subtrahend1 = new Model::BrushNode(
+    builder.createCuboid(vm::bbox3(vm::vec3(0, 0, 48), vm::vec3(32, 64, 64)), "other")
+      .value());
+  Model::BrushNode* subtrahend2 = new Model::BrushNode(
+    builder.createCuboid(vm::bbox3(vm::vec3(32, 0, 48), vm::vec3(64, 64, 64)), "other")
+      .value());
+
+  document->addNodes({{entity, {minuend, subtrahend1, subtrahend2}}});
+
+  // subtracting the subtrahends one after the other splits the minuend at x = 32, but
+  // the two fragments form a box again
+  document->selectNodes({subtrahend1, subtrahend2});
+  CHECK(document->csgSubtract());
+  CHECK(entity->children().size() == 1u);
+
+  auto* remainder = dynamic_cast<Model::BrushNode*>(entity->children()[0]);
+  REQUIRE(remainder != nullptr);
+  CHECK(remainder->logicalBounds() == vm::bbox3(vm::vec3(0, 0, 0), vm::vec3(64, 64, 48)));
+
+  const auto& brush = remainder->brush();
+  CHECK(brush.faceCount() == 6u);
+  const auto& top = brush.face(*brush.findFace(vm::vec3::pos_z()));
+  const auto& bottom = brush.face(*brush.findFace(vm::vec3::neg_z()));
+  CHECK(top.attributes().textureName() == "other");
+  CHECK(bottom.attributes().textureName() == "texture");
+}
+
 TEST_CASE_METHOD(MapDocumentTest, "CsgTest.csgSubtractAndUndoRestoresSelection")
 {
   const Model::BrushBuilder builder(
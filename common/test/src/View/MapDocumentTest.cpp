@@ -21,7 +21,9 @@
 #include "TestUtils.h"
 
 #include "Assets/EntityDefinition.h"
+#include "Assets/TextureManager.h"
 #include "Exceptions.h"
+#include "IO/Path.h"
 #include "IO/WorldReader.h"
 #include "Model/BrushBuilder.h"
 #include "Model/BrushNode.h"
@@ -33,6 +35,9 @@
 #include "Model/PatchNode.h"
 #include "Model/TestGame.h"
 #include "Model/WorldNode.h"
+#include "NotifierConnection.h"
+#include "PreferenceManager.h"
+#include "Preferences.h"
 #include "View/MapDocumentCommandFacade.h"
 
 #include <kdl/result.h>
@@ -158,6 +163,43 @@ TEST_CASE("MapDocumentTest.mixedFormats", "[MapDocumentTest]")
     IO::WorldReaderException);
 }
 
+TEST_CASE_METHOD(MapDocumentTest, "MapDocumentTest.compressTexturesReloadsTextures")
+{
+  document->setEnabledTextureCollections({IO::Path("fixture/test/IO/Wad/cr8_czg.wad")});
+
+  // like the texture browser, hold on to the textures between notifications
+  auto cachedTextures = document->textureManager().textures();
+  REQUIRE_FALSE(cachedTextures.empty());
+
+  auto willChangeCount = size_t(0);
+  auto didChangeCount = size_t(0);
+
+  auto notifierConnection = NotifierConnection{};
+  notifierConnection += document->textureCollectionsWillChangeNotifier.connect([&]() {
+    ++willChangeCount;
+    cachedTextures.clear();
+  });
+  notifierConnection += document->textureCollectionsDidChangeNotifier.connect([&]() {
+    ++didChangeCount;
+    cachedTextures = document->textureManager().textures();
+  });
+
+  {
+    const auto compressTextures = TemporarilySetPref{
+      Preferences::CompressTextures, !pref(Preferences::CompressTextures)};
+
+    CHECK(willChangeCount == 1u);
+    CHECK(didChangeCount == 1u);
+    CHECK(cachedTextures == document->textureManager().textures());
+    CHECK(kdl::vec_contains(
+      cachedTextures, document->textureManager().texture("bongs2")));
+  }
+
+  CHECK(willChangeCount == 2u);
+  CHECK(didChangeCount == 2u);
+  CHECK(cachedTextures == document->textureManager().textures());
+}
+
 TEST_CASE_METHOD(MapDocumentTest, "Brush Node Selection")
 {
   auto* brushNodeInDefaultLayer = createBrushNode("brushNodeInDefaultLayer");
@@ -0,0 +1,135 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Model/Brush.h"
+#include "Model/BrushNode.h"
+#include "Model/WorldNode.h"
+#include "View/MapDocument.h"
+#include "View/MapDocumentTest.h"
+#include "View/SpeculativeTransformer.h"
+#include "View/TransactionScope.h"
+
+#include <kdl/result.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/vec.h>
+
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace View
+{
+TEST_CASE_METHOD(MapDocumentTest, "SpeculativeTransformerTest.finish")
+{
+  auto* brushNode = createBrushNode();
+  document->addNodes({{document->parentForNodes(), {brushNode}}});
+
+  auto transformer = SpeculativeTransformer{
+    document->worldBounds(),
+    document->world()->entityPropertyConfig(),
+    {snapshotNode(*brushNode, false)},
+    []() {}};
+
+  for (size_t i = 1u; i <= 10u; ++i)
+  {
+    transformer.request(vm::translation_matrix(vm::vec3(FloatType(i), 0, 0)));
+  }
+
+  const auto evaluation = transformer.finish();
+  REQUIRE(evaluation.has_value());
+  CHECK(evaluation->transformation == vm::translation_matrix(vm::vec3(10, 0, 0)));
+
+  REQUIRE(evaluation->result.is_success());
+  const auto& nodes = evaluation->result.value();
+  REQUIRE(nodes.size() == 1u);
+  CHECK(nodes.front().first == brushNode);
+
+  const auto& brush = std::get<Model::Brush>(nodes.front().second.get());
+  CHECK(brush.bounds() == vm::bbox3(vm::vec3(-6, -16, -16), vm::vec3(26, 16, 16)));
+
+  // the node itself is not changed
+  CHECK(brushNode->brush().bounds() == vm::bbox3(16.0));
+
+  // the evaluation can only be taken once
+  CHECK_FALSE(transformer.finish().has_value());
+  CHECK_FALSE(transformer.takeEvaluation().has_value());
+}
+
+TEST_CASE_METHOD(MapDocumentTest, "SpeculativeTransformerTest.error")
+{
+  auto* brushNode = createBrushNode();
+  document->addNodes({{document->parentForNodes(), {brushNode}}});
+
+  auto transformer = SpeculativeTransformer{
+    document->worldBounds(),
+    document->world()->entityPropertyConfig(),
+    {snapshotNode(*brushNode, false)},
+    []() {}};
+
+  // moves the brush out of the world bounds
+  transformer.request(vm::translation_matrix(vm::vec3(32768, 0, 0)));
+
+  const auto evaluation = transformer.finish();
+  REQUIRE(evaluation.has_value());
+  CHECK(evaluation->result.is_error());
+}
+
+TEST_CASE_METHOD(
+  MapDocumentTest, "SpeculativeTransformerTest.transformObjectsSpeculatively")
+{
+  auto* brushNode = createBrushNode();
+  document->addNodes({{document->parentForNodes(), {brushNode}}});
+  document->selectNodes({brushNode});
+
+  document->startTransaction("Scale Objects", TransactionScope::LongRunning);
+  for (size_t i = 1u; i <= 4u; ++i)
+  {
+    const auto newBounds = vm::bbox3(vm::vec3::fill(-16.0), vm::vec3::fill(16.0 * i));
+    document->transformObjectsSpeculatively(
+      "Scale Objects", vm::scale_bbox_matrix(vm::bbox3(16.0), newBounds));
+  }
+
+  SECTION("Finishing applies the last transformation")
+  {
+    document->finishSpeculativeTransformation();
+    document->commitTransaction();
+
+    CHECK(
+      brushNode->brush().bounds()
+      == vm::bbox3(vm::vec3::fill(-16.0), vm::vec3::fill(64.0)));
+
+    document->undoCommand();
+    CHECK(brushNode->brush().bounds() == vm::bbox3(16.0));
+  }
+
+  SECTION("Cancelling discards the transformation")
+  {
+    document->cancelSpeculativeTransformation();
+    document->cancelTransaction();
+
+    CHECK(brushNode->brush().bounds() == vm::bbox3(16.0));
+  }
+}
+} // namespace View
+} // namespace TrenchBroom
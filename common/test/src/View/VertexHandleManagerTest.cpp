@@ -0,0 +1,181 @@
+/*
+ Copyright (C) 2022 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FloatType.h"
+#include "Model/Hit.h"
+#include "Model/PickResult.h"
+#include "Renderer/OrthographicCamera.h"
+#include "View/Grid.h"
+#include "View/VertexHandleManager.h"
+
+#include <kdl/vector_utils.h>
+
+#include <vecmath/ray.h>
+#include <vecmath/segment.h>
+#include <vecmath/vec.h>
+
+#include <tuple>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace View
+{
+static std::vector<vm::vec3> pickVertexHandles(
+  const VertexHandleManager& manager, const vm::ray3& pickRay)
+{
+  const auto camera = Renderer::OrthographicCamera{};
+  auto pickResult = Model::PickResult{};
+  manager.pick(pickRay, camera, pickResult);
+
+  return kdl::vec_sort(kdl::vec_transform(
+    pickResult.all(), [](const auto& hit) { return hit.template target<vm::vec3>(); }));
+}
+
+TEST_CASE("VertexHandleManagerTest.pick", "[VertexHandleManagerTest]")
+{
+  // the grid cells are 256 units large, so these handles are in different cells
+  const auto belowBoundary = vm::vec3{100, 250, 0};
+  const auto aboveBoundary = vm::vec3{100, 262, 0};
+
+  auto manager = VertexHandleManager{};
+  manager.add(belowBoundary, nullptr);
+  manager.add(aboveBoundary, nullptr);
+
+  SECTION("Handles on either side of a cell boundary are picked")
+  {
+    CHECK(
+      pickVertexHandles(manager, vm::ray3{vm::vec3{0, 250, 0}, vm::vec3::pos_x()})
+      == std::vector<vm::vec3>{belowBoundary});
+    CHECK(
+      pickVertexHandles(manager, vm::ray3{vm::vec3{0, 262, 0}, vm::vec3::pos_x()})
+      == std::vector<vm::vec3>{aboveBoundary});
+  }
+
+  SECTION("Handles in cells that the pick ray misses are not picked")
+  {
+    CHECK(
+      pickVertexHandles(manager, vm::ray3{vm::vec3{0, 1000, 0}, vm::vec3::pos_x()})
+        .empty());
+  }
+
+  SECTION("Handles in every cell crossed by the pick ray are picked")
+  {
+    const auto handles = std::vector<vm::vec3>{
+      vm::vec3{-300, -300, 0},
+      vm::vec3{200, 200, 0},
+      vm::vec3{300, 300, 0},
+      vm::vec3{600, 600, 0},
+      vm::vec3{1000, 1000, 0},
+    };
+    for (const auto& handle : handles)
+    {
+      manager.add(handle, nullptr);
+    }
+
+    // the diagonal ray crosses the cells of all handles except the one behind its origin
+    CHECK(
+      pickVertexHandles(
+        manager, vm::ray3{vm::vec3::zero(), vm::normalize(vm::vec3{1, 1, 0})})
+      == std::vector<vm::vec3>{
+        vm::vec3{200, 200, 0},
+        vm::vec3{300, 300, 0},
+        vm::vec3{600, 600, 0},
+        vm::vec3{1000, 1000, 0},
+      });
+  }
+}
+
+TEST_CASE("VertexHandleManagerTest.selectCloseHandles", "[VertexHandleManagerTest]")
+{
+  auto manager = VertexHandleManager{};
+
+  SECTION("Handles in the next cell are found")
+  {
+    const auto handle = vm::vec3{256, 0, 0};
+    manager.add(handle, nullptr);
+
+    // sorted into the cell below the boundary
+    manager.select(vm::vec3{256.0 - 0.0000005, 0, 0});
+    CHECK(manager.selected(handle));
+    CHECK(manager.selectedHandleCount() == 1u);
+
+    manager.deselect(vm::vec3{256.0 - 0.0000005, 0, 0});
+    CHECK_FALSE(manager.selected(handle));
+    CHECK(manager.selectedHandleCount() == 0u);
+  }
+
+  SECTION("Handles in the previous cell are found")
+  {
+    const auto handle = vm::vec3{256.0 - 0.0000005, -256.0 - 0.0000005, 0};
+    manager.add(handle, nullptr);
+
+    // sorted into the cells above the boundaries
+    manager.select(vm::vec3{256, -256, 0});
+    CHECK(manager.selected(handle));
+    CHECK(manager.selectedHandleCount() == 1u);
+  }
+
+  SECTION("Handles that are not close are not found")
+  {
+    const auto handle = vm::vec3{256, 0, 0};
+    manager.add(handle, nullptr);
+
+    manager.select(vm::vec3{255, 0, 0});
+    CHECK_FALSE(manager.selected(handle));
+    CHECK(manager.selectedHandleCount() == 0u);
+  }
+}
+
+TEST_CASE("EdgeHandleManagerTest.pickGridHandle", "[EdgeHandleManagerTest]")
+{
+  // the edge is sorted into the cell of its center at (512, 100, 0), but it extends
+  // through several other cells
+  const auto edge = vm::segment3{vm::vec3{0, 100, 0}, vm::vec3{1024, 100, 0}};
+
+  auto manager = EdgeHandleManager{};
+  manager.add(edge, nullptr);
+
+  const auto camera = Renderer::OrthographicCamera{};
+  const auto grid = Grid{4};
+  auto pickResult = Model::PickResult{};
+
+  SECTION("Edges are picked far from their centers")
+  {
+    manager.pickGridHandle(
+      vm::ray3{vm::vec3{96, 100, -500}, vm::vec3::pos_z()}, camera, grid, pickResult);
+    REQUIRE(pickResult.all().size() == 1u);
+
+    const auto [hitEdge, hitPoint] =
+      pickResult.all().front().target<EdgeHandleManager::HitType>();
+    CHECK(hitEdge == edge);
+    CHECK(vm::is_equal(hitPoint, vm::vec3{96, 100, 0}, vm::C::almost_zero()));
+  }
+
+  SECTION("Edges are not picked beyond their ends")
+  {
+    manager.pickGridHandle(
+      vm::ray3{vm::vec3{1200, 100, -500}, vm::vec3::pos_z()}, camera, grid, pickResult);
+    CHECK(pickResult.all().empty());
+  }
+}
+} // namespace View
+} // namespace TrenchBroom
@@ -0,0 +1,335 @@
+/*
+ Copyright 2010-2022 Kristian Duske
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ software and associated documentation files (the "Software"), to deal in the Software
+ without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ persons to whom the Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace kdl
+{
+namespace detail
+{
+struct interned_string_entry
+{
+  std::string string;
+  std::size_t hash;
+  mutable std::atomic<std::size_t> ref_count;
+
+  interned_string_entry(std::string_view i_string, const std::size_t i_hash)
+    : string{i_string}
+    , hash{i_hash}
+    , ref_count{0u}
+  {
+  }
+};
+
+/**
+ * A thread safe pool of interned strings.
+ *
+ * The pool is split into shards, each protected by its own mutex, so that threads
+ * interning different strings rarely contend. Entries are reference counted by the
+ * handles that refer to them, but an entry whose reference count drops to zero is not
+ * removed immediately. Instead, every shard removes its unreferenced entries once it has
+ * grown to twice its size after the previous sweep. This keeps releasing a handle lock
+ * free and amortizes the cost of removing entries.
+ */
+class interned_string_pool
+{
+private:
+  static constexpr std::size_t shard_count = 32u;
+  static constexpr std::size_t min_sweep_threshold = 1024u;
+
+  struct shard
+  {
+    std::mutex mutex;
+    std::unordered_map<std::string_view, std::unique_ptr<interned_string_entry>> entries;
+    std::size_t sweep_threshold = min_sweep_threshold;
+  };
+
+  std::array<shard, shard_count> m_shards;
+
+public:
+  /**
+   * Returns the entry for the given string, creating it if necessary. The reference count
+   * of the returned entry has already been incremented.
+   */
+  const interned_string_entry* acquire(const std::string_view str)
+  {
+    const auto hash = std::hash<std::string_view>{}(str);
+    auto& s = m_shards[hash % shard_count];
+
+    const auto lock = std::lock_guard<std::mutex>{s.mutex};
+    if (auto it = s.entries.find(str); it != s.entries.end())
+    {
+      // the entry may be resurrected here, so this must happen while holding the lock
+      it->second->ref_count.fetch_add(1u, std::memory_order_relaxed);
+      return it->second.get();
+    }
+
+    if (s.entries.size() >= s.sweep_threshold)
+    {
+      sweep(s);
+    }
+
+    auto entry = std::make_unique<interned_string_entry>(str, hash);
+    entry->ref_count.store(1u, std::memory_order_relaxed);
+
+    auto* result = entry.get();
+    s.entries.emplace(std::string_view{result->string}, std::move(entry));
+    return result;
+  }
+
+  /**
+   * Returns the number of entries in this pool, including unreferenced entries which have
+   * not been removed yet.
+   */
+  std::size_t size()
+  {
+    auto result = std::size_t(0);
+    for (auto& s : m_shards)
+    {
+      const auto lock = std::lock_guard<std::mutex>{s.mutex};
+      result += s.entries.size();
+    }
+    return result;
+  }
+
+  /**
+   * Removes all unreferenced entries from this pool.
+   */
+  void sweep()
+  {
+    for (auto& s : m_shards)
+    {
+      const auto lock = std::lock_guard<std::mutex>{s.mutex};
+      sweep(s);
+    }
+  }
+
+private:
+  static void sweep(shard& s)
+  {
+    for (auto it = s.entries.begin(); it != s.entries.end();)
+    {
+      if (it->second->ref_count.load(std::memory_order_acquire) == 0u)
+      {
+        it = s.entries.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+
+    s.sweep_threshold = std::max(min_sweep_threshold, 2u * s.entries.size());
+  }
+};
+
+/**
+ * Returns the global string pool. The pool is intentionally leaked so that interned
+ * strings with static storage duration can be destroyed safely.
+ */
+inline interned_string_pool& global_interned_string_pool()
+{
+  static auto* pool = new interned_string_pool{};
+  return *pool;
+}
+
+inline const interned_string_entry* empty_interned_string_entry()
+{
+  static const auto entry = interned_string_entry{"", std::hash<std::string_view>{}("")};
+  return &entry;
+}
+} // namespace detail
+
+/**
+ * An immutable string whose contents are stored only once in a global pool.
+ *
+ * Copying an interned string only copies a pointer and increments a reference count, and
+ * two interned strings are equal if and only if they refer to the same pool entry. This
+ * makes interned strings well suited for values which are stored many times, such as
+ * entity property keys or texture names.
+ *
+ * Interning a string is thread safe.
+ */
+class interned_string
+{
+private:
+  const detail::interned_string_entry* m_entry;
+
+public:
+  /**
+   * Creates an empty string. This does not access the pool.
+   */
+  interned_string()
+    : m_entry{detail::empty_interned_string_entry()}
+  {
+  }
+
+  explicit interned_string(const std::string_view str)
+    : m_entry{
+      str.empty() ? detail::empty_interned_string_entry()
+                  : detail::global_interned_string_pool().acquire(str)}
+  {
+  }
+
+  explicit interned_string(const std::string& str)
+    : interned_string{std::string_view{str}}
+  {
+  }
+
+  explicit interned_string(const char* str)
+    : interned_string{std::string_view{str}}
+  {
+  }
+
+  interned_string(const interned_string& other)
+    : m_entry{other.m_entry}
+  {
+    retain();
+  }
+
+  interned_string(interned_string&& other) noexcept
+    : m_entry{std::exchange(other.m_entry, detail::empty_interned_string_entry())}
+  {
+  }
+
+  ~interned_string() { release(); }
+
+  interned_string& operator=(const interned_string& other)
+  {
+    other.retain();
+    release();
+    m_entry = other.m_entry;
+    return *this;
+  }
+
+  interned_string& operator=(interned_string&& other) noexcept
+  {
+    std::swap(m_entry, other.m_entry);
+    return *this;
+  }
+
+  const std::string& str() const { return m_entry->string; }
+  std::string_view view() const { return m_entry->string; }
+  operator const std::string&() const { return m_entry->string; }
+
+  bool empty() const { return m_entry->string.empty(); }
+  std::size_t size() const { return m_entry->string.size(); }
+  std::size_t hash() const { return m_entry->hash; }
+
+  friend bool operator==(const interned_string& lhs, const interned_string& rhs)
+  {
+    return lhs.m_entry == rhs.m_entry;
+  }
+
+  friend bool operator!=(const interned_string& lhs, const interned_string& rhs)
+  {
+    return lhs.m_entry != rhs.m_entry;
+  }
+
+  friend bool operator<(const interned_string& lhs, const interned_string& rhs)
+  {
+    return lhs.m_entry != rhs.m_entry && lhs.str() < rhs.str();
+  }
+
+  friend bool operator<=(const interned_string& lhs, const interned_string& rhs)
+  {
+    return !(rhs < lhs);
+  }
+
+  friend bool operator>(const interned_string& lhs, const interned_string& rhs)
+  {
+    return rhs < lhs;
+  }
+
+  friend bool operator>=(const interned_string& lhs, const interned_string& rhs)
+  {
+    return !(lhs < rhs);
+  }
+
+  friend bool operator==(const interned_string& lhs, const std::string_view rhs)
+  {
+    return lhs.view() == rhs;
+  }
+
+  friend bool operator==(const std::string_view lhs, const interned_string& rhs)
+  {
+    return lhs == rhs.view();
+  }
+
+  friend bool operator!=(const interned_string& lhs, const std::string_view rhs)
+  {
+    return lhs.view() != rhs;
+  }
+
+  friend bool operator!=(const std::string_view lhs, const interned_string& rhs)
+  {
+    return lhs != rhs.view();
+  }
+
+  friend std::ostream& operator<<(std::ostream& lhs, const interned_string& rhs)
+  {
+    return lhs << rhs.str();
+  }
+
+private:
+  bool is_pooled() const { return m_entry != detail::empty_interned_string_entry(); }
+
+  void retain() const
+  {
+    if (is_pooled())
+    {
+      m_entry->ref_count.fetch_add(1u, std::memory_order_relaxed);
+    }
+  }
+
+  void release() const
+  {
+    if (is_pooled())
+    {
+      m_entry->ref_count.fetch_sub(1u, std::memory_order_acq_rel);
+    }
+  }
+};
+} // namespace kdl
+
+namespace std
+{
+template <>
+struct hash<kdl::interned_string>
+{
+  std::size_t operator()(const kdl::interned_string& str) const noexcept
+  {
+    return str.hash();
+  }
+};
+} // namespace std
@@ -0,0 +1,169 @@
+/*
+ Copyright 2010-2022 Kristian Duske
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ software and associated documentation files (the "Software"), to deal in the Software
+ without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ persons to whom the Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+#include "kdl/interned_string.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace kdl
+{
+TEST_CASE("interned_string_test.constructor", "[interned_string_test]")
+{
+  CHECK(interned_string{}.empty());
+  CHECK(interned_string{}.str() == "");
+  CHECK(interned_string{""} == interned_string{});
+
+  const auto str = std::string{"classname"};
+  CHECK(interned_string{str}.str() == str);
+  CHECK(interned_string{std::string_view{str}}.str() == str);
+  CHECK(interned_string{"classname"}.str() == str);
+  CHECK(interned_string{str}.size() == str.size());
+}
+
+TEST_CASE("interned_string_test.interning", "[interned_string_test]")
+{
+  const auto a = interned_string{"light"};
+  const auto b = interned_string{std::string{"li"} + "ght"};
+  const auto c = interned_string{"light_torch"};
+
+  CHECK(&a.str() == &b.str());
+  CHECK(&a.str() != &c.str());
+  CHECK(a.hash() == b.hash());
+  CHECK(std::hash<interned_string>{}(a) == std::hash<std::string_view>{}("light"));
+}
+
+TEST_CASE("interned_string_test.copy_and_move", "[interned_string_test]")
+{
+  auto a = interned_string{"some_texture"};
+
+  auto b = a;
+  CHECK(b == a);
+
+  auto c = std::move(b);
+  CHECK(c == a);
+  CHECK(b.empty());
+
+  b = c;
+  CHECK(b == a);
+
+  c = interned_string{"other_texture"};
+  CHECK(c != a);
+  CHECK(c.str() == "other_texture");
+
+  const auto& self = a;
+  a = self;
+  CHECK(a.str() == "some_texture");
+}
+
+TEST_CASE("interned_string_test.comparison", "[interned_string_test]")
+{
+  const auto a = interned_string{"a"};
+  const auto b = interned_string{"b"};
+
+  CHECK(a == interned_string{"a"});
+  CHECK(a != b);
+  CHECK(a < b);
+  CHECK(a <= b);
+  CHECK(a <= a);
+  CHECK_FALSE(a < a);
+  CHECK(b > a);
+  CHECK(b >= a);
+
+  CHECK(a == "a");
+  CHECK("a" == a);
+  CHECK(a == std::string{"a"});
+  CHECK(a != "b");
+  CHECK("b" != a);
+}
+
+TEST_CASE("interned_string_test.stream_insertion", "[interned_string_test]")
+{
+  auto str = std::stringstream{};
+  str << interned_string{"worldspawn"};
+  CHECK(str.str() == "worldspawn");
+}
+
+TEST_CASE("interned_string_test.unordered_set", "[interned_string_test]")
+{
+  auto set = std::unordered_set<interned_string>{};
+  set.insert(interned_string{"a"});
+  set.insert(interned_string{"a"});
+  set.insert(interned_string{"b"});
+  CHECK(set.size() == 2u);
+  CHECK(set.count(interned_string{"b"}) == 1u);
+}
+
+TEST_CASE("interned_string_test.sweep", "[interned_string_test]")
+{
+  auto& pool = detail::global_interned_string_pool();
+  pool.sweep();
+
+  const auto initialSize = pool.size();
+  {
+    const auto a = interned_string{"interned_string_test.sweep.a"};
+    const auto b = a;
+    CHECK(pool.size() == initialSize + 1u);
+  }
+
+  CHECK(pool.size() == initialSize + 1u);
+  pool.sweep();
+  CHECK(pool.size() == initialSize);
+
+  const auto c = interned_string{"interned_string_test.sweep.c"};
+  pool.sweep();
+  CHECK(pool.size() == initialSize + 1u);
+  CHECK(c.str() == "interned_string_test.sweep.c");
+}
+
+TEST_CASE("interned_string_test.threads", "[interned_string_test]")
+{
+  auto threads = std::vector<std::thread>{};
+  auto results = std::vector<std::vector<interned_string>>(4u);
+
+  for (size_t t = 0u; t < results.size(); ++t)
+  {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0u; i < 5000u; ++i)
+      {
+        results[t].emplace_back(std::to_string(i % 1000u));
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  for (size_t i = 0u; i < 5000u; ++i)
+  {
+    CHECK(results[0][i] == results[1][i]);
+    CHECK(results[0][i] == results[2][i]);
+    CHECK(results[0][i] == results[3][i]);
+    CHECK(results[0][i].str() == std::to_string(i % 1000u));
+  }
+}
+} // namespace kdl